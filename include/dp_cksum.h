@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __INCLUDE_DP_CKSUM_H__
+#define __INCLUDE_DP_CKSUM_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <rte_byteorder.h>
+#include <rte_ethdev.h>
+#include <rte_mbuf.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Checksums requested via mbuf Tx offload flags that the port may not be able to compute
+#define DP_CKSUM_TX_OFFLOAD_FLAGS (RTE_MBUF_F_TX_IP_CKSUM | RTE_MBUF_F_TX_L4_MASK)
+#define DP_CKSUM_PORT_OFFLOADS \
+	(RTE_ETH_TX_OFFLOAD_IPV4_CKSUM | RTE_ETH_TX_OFFLOAD_UDP_CKSUM | RTE_ETH_TX_OFFLOAD_TCP_CKSUM)
+
+// Incremental updates (RFC 1624) of checksums stored in packets
+// all values are taken as they are in memory (network order), one's complement sum is byte-order independent
+static __rte_always_inline uint16_t dp_cksum_fold(uint32_t sum)
+{
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	return (uint16_t)sum;
+}
+
+// HC' = ~(~HC + ~m + m')
+static __rte_always_inline uint16_t dp_cksum_update16(uint16_t cksum, uint16_t old_val, uint16_t new_val)
+{
+	return (uint16_t)~dp_cksum_fold((uint32_t)(uint16_t)~cksum + (uint16_t)~old_val + new_val);
+}
+
+static __rte_always_inline uint16_t dp_cksum_update32(uint16_t cksum, uint32_t old_val, uint32_t new_val)
+{
+	return (uint16_t)~dp_cksum_fold((uint32_t)(uint16_t)~cksum
+									+ (uint16_t)~(old_val >> 16) + (uint16_t)~(old_val & 0xffff)
+									+ (new_val >> 16) + (new_val & 0xffff));
+}
+
+// add/remove a partial sum (e.g. a pseudo-header from rte_ipv6_phdr_cksum()) to/from a checksum
+static __rte_always_inline uint16_t dp_cksum_add(uint16_t cksum, uint16_t sum)
+{
+	return (uint16_t)~dp_cksum_fold((uint32_t)(uint16_t)~cksum + sum);
+}
+
+static __rte_always_inline uint16_t dp_cksum_sub(uint16_t cksum, uint16_t sum)
+{
+	return (uint16_t)~dp_cksum_fold((uint32_t)(uint16_t)~cksum + (uint16_t)~sum);
+}
+
+// Offloaded checksums are computed in software when the port cannot do it
+// (ports are checked on init, so this is only a flag test for capable ports)
+void dp_cksum_tx_software(struct rte_mbuf *m, uint64_t port_offloads);
+
+static __rte_always_inline void dp_cksum_tx_prepare(struct rte_mbuf *m, bool port_cksum_fallback, uint64_t port_offloads)
+{
+	if (unlikely(port_cksum_fallback) && (m->ol_flags & DP_CKSUM_TX_OFFLOAD_FLAGS))
+		dp_cksum_tx_software(m, port_offloads);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,12 +12,16 @@
 extern "C" {
 #endif
 
+struct flow_value;
+
 void dp_cntrack_init(void);
 
 int dp_cntrack_handle(struct rte_mbuf *m, struct dp_flow *df);
 
 void dp_cntrack_flush_cache(void);
 
+void dp_cntrack_release_flow(const struct flow_value *flow_val);
+
 #ifdef __cplusplus
 }
 #endif
@@ -10,6 +10,7 @@ extern "C" {
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <sys/socket.h>
 #include <rte_byteorder.h>
 
 #ifdef ENABLE_VIRTSVC
@@ -27,6 +28,11 @@ struct dp_conf_virtual_services {
 };
 #endif
 
+struct dp_conf_ipfix_collector {
+	struct sockaddr_storage addr;
+	socklen_t addrlen;  // zero when not configured
+};
+
 struct dp_conf_dhcp_dns {
 	uint8_t len;
 	uint8_t *array;
@@ -49,6 +55,7 @@ const struct dp_conf_dhcp_dns *dp_conf_get_dhcpv6_dns(void);
 #ifdef ENABLE_VIRTSVC
 const struct dp_conf_virtual_services *dp_conf_get_virtual_services(void);
 #endif
+const struct dp_conf_ipfix_collector *dp_conf_get_ipfix_collector(void);
 
 #ifdef __cplusplus
 }
@@ -14,6 +14,11 @@ enum dp_conf_nic_type {
 	DP_CONF_NIC_TYPE_BLUEFIELD2,
 };
 
+enum dp_conf_idle_poll {
+	DP_CONF_IDLE_POLL_BUSY,
+	DP_CONF_IDLE_POLL_ADAPTIVE,
+};
+
 enum dp_conf_color {
 	DP_CONF_COLOR_NEVER,
 	DP_CONF_COLOR_ALWAYS,
@@ -25,10 +30,19 @@ enum dp_conf_log_format {
 	DP_CONF_LOG_FORMAT_JSON,
 };
 
+enum dp_conf_flow_limit_policy {
+	DP_CONF_FLOW_LIMIT_POLICY_DROP,
+	DP_CONF_FLOW_LIMIT_POLICY_MONITOR,
+};
+
 const char *dp_conf_get_pf0_name(void);
 const char *dp_conf_get_pf1_name(void);
 const char *dp_conf_get_vf_pattern(void);
 int dp_conf_get_dhcp_mtu(void);
+int dp_conf_get_underlay_mtu(void);
+int dp_conf_get_icmp_error_rate_limit(void);
+bool dp_conf_is_mss_clamp_enabled(void);
+bool dp_conf_is_gro_enabled(void);
 int dp_conf_get_wcmp_perc(void);
 enum dp_conf_nic_type dp_conf_get_nic_type(void);
 bool dp_conf_is_stats_enabled(void);
@@ -38,12 +52,31 @@ bool dp_conf_is_offload_enabled(void);
 #ifdef ENABLE_PYTEST
 int dp_conf_get_graphtrace_loglevel(void);
 #endif
+int dp_conf_get_latency_sampling(void);
+enum dp_conf_idle_poll dp_conf_get_idle_poll(void);
+int dp_conf_get_idle_sleep_max(void);
 enum dp_conf_color dp_conf_get_color(void);
 enum dp_conf_log_format dp_conf_get_log_format(void);
+int dp_conf_get_log_rate_limit(void);
 int dp_conf_get_grpc_port(void);
+int dp_conf_get_flow_table_size(void);
+int dp_conf_get_flow_table_max_size(void);
+int dp_conf_get_nat_table_size(void);
+int dp_conf_get_lb_table_size(void);
+int dp_conf_get_vnf_table_size(void);
+int dp_conf_get_frag_table_size(void);
+int dp_conf_get_frag_timeout(void);
+int dp_conf_get_flow_limit(void);
+int dp_conf_get_flow_rate_limit(void);
+enum dp_conf_flow_limit_policy dp_conf_get_flow_limit_policy(void);
+int dp_conf_get_syn_limit(void);
 #ifdef ENABLE_PYTEST
 int dp_conf_get_flow_timeout(void);
 #endif
+#ifdef ENABLE_PYTEST
+bool dp_conf_is_tx_cksum_offload_enabled(void);
+#endif
+const char *dp_conf_get_ipfix_file(void);
 
 enum dp_conf_runmode {
 	DP_CONF_RUNMODE_NORMAL, /**< Start normally */
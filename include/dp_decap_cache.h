@@ -0,0 +1,110 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __INCLUDE_DP_DECAP_CACHE_H__
+#define __INCLUDE_DP_DECAP_CACHE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <rte_common.h>
+#include <rte_hash_crc.h>
+#include <rte_memcpy.h>
+#include "dp_ipaddr.h"
+#include "dp_vnf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// direct-mapped, needs to be a power of two
+#define DP_DECAP_CACHE_SIZE 1024
+
+// forward declaration, only a pointer is stored
+struct flow_value;
+
+// underlay destination and the inner 5-tuple as seen right after decapsulation (i.e. before any NAT)
+struct dp_decap_cache_key {
+	uint8_t		ul_dst[DP_IPV6_ADDR_SIZE];
+	uint8_t		src[DP_IPV6_ADDR_SIZE];  // IPv4 uses the first four bytes, the rest stays zeroed
+	uint8_t		dst[DP_IPV6_ADDR_SIZE];
+	rte_be16_t	src_port;
+	rte_be16_t	dst_port;
+	uint8_t		proto;
+	uint8_t		_padding[3];  // compared as a whole, needs to be zeroed
+};
+
+struct dp_decap_cache_entry {
+	struct dp_decap_cache_key	key;
+	uint64_t					generation;
+	struct flow_value			*conntrack;
+	uint32_t					vni;
+	uint16_t					port_id;
+	enum dp_vnf_type			vnf_type;
+};
+
+// hidden state for the inline functions to access
+extern struct dp_decap_cache_entry _dp_decap_cache[DP_DECAP_CACHE_SIZE];
+extern uint64_t _dp_decap_cache_generation;
+
+// Entries (and everything else validated by the generation) are only usable until the next configuration change
+// or flow removal; 64 bits never wrap around, so a stale entry cannot become valid again.
+// (only the worker lcore uses the cache and also processes gRPC requests and flow aging)
+static __rte_always_inline void dp_decap_cache_invalidate(void)
+{
+	_dp_decap_cache_generation++;
+}
+
+static __rte_always_inline uint64_t dp_decap_cache_get_generation(void)
+{
+	return _dp_decap_cache_generation;
+}
+
+static __rte_always_inline void dp_decap_cache_set_key(struct dp_decap_cache_key *key,
+													   const uint8_t ul_dst[DP_IPV6_ADDR_SIZE],
+													   const void *src, const void *dst, size_t addr_len,
+													   uint8_t proto, rte_be16_t src_port, rte_be16_t dst_port)
+{
+	memset(key, 0, sizeof(*key));
+	rte_memcpy(key->ul_dst, ul_dst, sizeof(key->ul_dst));
+	rte_memcpy(key->src, src, addr_len);
+	rte_memcpy(key->dst, dst, addr_len);
+	key->src_port = src_port;
+	key->dst_port = dst_port;
+	key->proto = proto;
+}
+
+static __rte_always_inline struct dp_decap_cache_entry *dp_decap_cache_get_slot(const struct dp_decap_cache_key *key)
+{
+	return &_dp_decap_cache[rte_hash_crc(key, sizeof(*key), 0) & (DP_DECAP_CACHE_SIZE - 1)];
+}
+
+static __rte_always_inline const struct dp_decap_cache_entry *dp_decap_cache_lookup(const struct dp_decap_cache_key *key)
+{
+	const struct dp_decap_cache_entry *entry = dp_decap_cache_get_slot(key);
+
+	if (entry->generation != _dp_decap_cache_generation || memcmp(&entry->key, key, sizeof(*key)))
+		return NULL;
+
+	return entry;
+}
+
+// simply overwrites any previous entry in the slot
+static __rte_always_inline void dp_decap_cache_insert(const struct dp_decap_cache_key *key,
+													  uint32_t vni, enum dp_vnf_type vnf_type, uint16_t port_id,
+													  struct flow_value *conntrack)
+{
+	struct dp_decap_cache_entry *entry = dp_decap_cache_get_slot(key);
+
+	entry->key = *key;
+	entry->generation = _dp_decap_cache_generation;
+	entry->conntrack = conntrack;
+	entry->vni = vni;
+	entry->port_id = port_id;
+	entry->vnf_type = vnf_type;
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __INCLUDE_DP_DROP_REASON_H__
+#define __INCLUDE_DP_DROP_REASON_H__
+
+#include <assert.h>
+#include <stdint.h>
+#include <rte_common.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Every node sets one of these before sending a packet to the drop node,
+// names are used in telemetry and dpservice-dump (thus must stay stable)
+#define DP_DROP_REASONS(REASON) \
+	REASON(DP_DROP_REASON_UNKNOWN,				"unknown") \
+	REASON(DP_DROP_REASON_INVALID_PACKET,		"invalid_packet") \
+	REASON(DP_DROP_REASON_UNSUPPORTED_PROTOCOL,	"unsupported_protocol") \
+	REASON(DP_DROP_REASON_INVALID_PORT,			"invalid_port") \
+	REASON(DP_DROP_REASON_NOT_ALLOWED,			"not_allowed") \
+	REASON(DP_DROP_REASON_IGNORED,				"ignored") \
+	REASON(DP_DROP_REASON_NO_ROUTE,				"no_route") \
+	REASON(DP_DROP_REASON_UNKNOWN_VNI,			"unknown_vni") \
+	REASON(DP_DROP_REASON_UNKNOWN_VNF,			"unknown_vnf") \
+	REASON(DP_DROP_REASON_FIREWALL,				"firewall") \
+	REASON(DP_DROP_REASON_FLOW_LIMIT,			"flow_limit") \
+	REASON(DP_DROP_REASON_FLOW_INSERT,			"flow_insert") \
+	REASON(DP_DROP_REASON_CONNTRACK_ERROR,		"conntrack_error") \
+	REASON(DP_DROP_REASON_NAT_NO_PORTS,			"nat_no_ports") \
+	REASON(DP_DROP_REASON_NAT_FAILED,			"nat_failed") \
+	REASON(DP_DROP_REASON_METER,				"meter") \
+	REASON(DP_DROP_REASON_LB_NO_BACKEND,		"lb_no_backend") \
+	REASON(DP_DROP_REASON_VIRTSVC_CONN,			"virtsvc_conn") \
+	REASON(DP_DROP_REASON_NO_HEADROOM,			"no_headroom") \
+	REASON(DP_DROP_REASON_REPLY_FAILED,			"reply_failed") \
+	REASON(DP_DROP_REASON_TX_FULL,				"tx_full") \
+	REASON(DP_DROP_REASON_REASSEMBLY,			"reassembly_failed") \
+	REASON(DP_DROP_REASON_FRAGMENTATION,		"fragmentation_failed") \
+	REASON(DP_DROP_REASON_PMTU_RATE_LIMIT,		"pmtu_rate_limit") \
+	REASON(DP_DROP_REASON_SEGMENTATION,			"segmentation_failed")
+
+#define _DP_DROP_REASON_GENERATE_ENUM(ENUM, NAME) ENUM,
+#define _DP_DROP_REASON_GENERATE_NAME(ENUM, NAME) [ENUM] = NAME,
+
+enum dp_drop_reason {
+	DP_DROP_REASONS(_DP_DROP_REASON_GENERATE_ENUM)
+	DP_DROP_REASON_COUNT
+};
+
+static_assert(DP_DROP_REASON_COUNT <= 64, "Drop reasons do not fit into a 64-bit mask");
+
+#define DP_DROP_REASON_MASK(REASON) (UINT64_C(1) << (REASON))
+
+static inline const char *dp_get_drop_reason_name(unsigned int reason)
+{
+	static const char *names[] = {
+		DP_DROP_REASONS(_DP_DROP_REASON_GENERATE_NAME)
+	};
+
+	return reason < RTE_DIM(names) ? names[reason] : names[DP_DROP_REASON_UNKNOWN];
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -8,7 +8,9 @@
 #include <rte_jhash.h>
 #include <rte_flow.h>
 #include <rte_malloc.h>
+#include <rte_telemetry.h>
 #include "dpdk_layer.h"
+#include "dp_decap_cache.h"
 #include "dp_ipaddr.h"
 #include "dp_firewall.h"
 #include "dp_mbuf_dyn.h"
@@ -20,13 +22,14 @@
 extern "C" {
 #endif
 
-// arbitrary big number
+// default size, arbitrary big number
 #define DP_FLOW_TABLE_MAX				850000
 
 #define DP_FLOW_VAL_AGE_CTX_CAPACITY	6
 
 #define DP_FLOW_DEFAULT_TIMEOUT			30				/* 30 seconds */
 #define DP_FLOW_TCP_EXTENDED_TIMEOUT	(60 * 60 * 24)	/* 1 day */
+#define DP_FLOW_TCP_HALF_OPEN_TIMEOUT	5				/* 5 seconds */
 
 #define DP_FLOW_FLAG_NONE				0x00
 #define DP_FLOW_FLAG_SRC_NAT			0x01
@@ -68,6 +71,14 @@ enum dp_flow_tcp_state {
 	DP_FLOW_TCP_STATE_RST_FIN,
 };
 
+// values correspond to IPFIX flowEndReason (RFC 5102)
+enum dp_flow_end_reason {
+	DP_FLOW_END_NONE				= 0,
+	DP_FLOW_END_IDLE_TIMEOUT		= 1,
+	DP_FLOW_END_DETECTED			= 3,
+	DP_FLOW_END_FORCED				= 4,
+} __rte_packed;
+
 struct flow_key {
 	struct dp_ip_address l3_dst;
 	uint8_t  proto;
@@ -98,8 +109,14 @@ struct flow_value {
 	struct flow_age_ctx *rte_age_ctxs[DP_FLOW_VAL_AGE_CTX_CAPACITY];
 	struct flow_nf_info	nf_info;
 	uint64_t		timestamp;
+	uint64_t		created;
+	struct {
+		uint64_t	packets;
+		uint64_t	bytes;
+	} counters[DP_FLOW_DIR_CAPACITY];  // includes offloaded traffic once the rte_flow rules are removed
 	uint32_t		timeout_value; //actual timeout in sec = dp-service timer's resolution * timeout_value
 	uint16_t		created_port_id;
+	uint16_t		owner_port_id;	// port this flow is accounted to (for limits)
 	uint8_t			flow_flags;
 	enum dp_fwall_action	fwall_action[DP_FLOW_DIR_CAPACITY];
 	struct {
@@ -114,7 +131,14 @@ struct flow_value {
 	union {
 		enum dp_flow_tcp_state		tcp_state;
 	} l4_state;
+	bool			half_open;
 	bool			aged;
+	enum dp_flow_end_reason	end_reason;
+	struct {
+		uint64_t			generation;  // valid only for the current decap cache generation
+		uint16_t			port_id;
+		enum dp_flow_type	flow_type;
+	} route_cache[DP_FLOW_DIR_CAPACITY];  // route lookup result for decapsulated packets
 };
 
 struct flow_age_ctx {
@@ -122,6 +146,8 @@ struct flow_age_ctx {
 	struct rte_flow		*rte_flow;
 	uint8_t				ref_index_in_cntrack;
 	uint8_t				port_id;
+	bool				counted;
+	enum dp_flow_dir	flow_dir;
 	struct rte_flow_action_handle *handle;
 };
 
@@ -144,6 +170,8 @@ int dp_build_flow_key(struct flow_key *key /* out */, struct rte_mbuf *m /* in *
 void dp_invert_flow_key(const struct flow_key *key /* in */, struct flow_key *inv_key /* out */);
 int dp_flow_init(int socket_id);
 void dp_flow_free(void);
+void dp_flow_prepare_table_growth(void);
+int dp_flow_get_tables_telemetry(struct rte_tel_data *dict);
 void dp_process_aged_flows(uint16_t port_id);
 void dp_process_aged_flows_non_offload(void);
 void dp_free_flow(struct dp_ref *ref);
@@ -157,6 +185,38 @@ hash_sig_t dp_get_conntrack_flow_hash_value(const struct flow_key *key);
 int dp_add_rte_age_ctx(struct flow_value *cntrack, struct flow_age_ctx *ctx);
 int dp_del_rte_age_ctx(struct flow_value *cntrack, const struct flow_age_ctx *ctx);
 
+// decapsulated packets of a flow take the same route until the configuration changes
+static __rte_always_inline
+bool dp_flow_get_cached_route(const struct flow_value *flow_val, enum dp_flow_dir dir,
+							  uint16_t *port_id, enum dp_flow_type *flow_type)
+{
+	if (flow_val->route_cache[dir].generation != dp_decap_cache_get_generation())
+		return false;
+
+	*port_id = flow_val->route_cache[dir].port_id;
+	*flow_type = flow_val->route_cache[dir].flow_type;
+	return true;
+}
+
+static __rte_always_inline
+void dp_flow_cache_route(struct flow_value *flow_val, enum dp_flow_dir dir, uint16_t port_id, enum dp_flow_type flow_type)
+{
+	flow_val->route_cache[dir].generation = dp_decap_cache_get_generation();
+	flow_val->route_cache[dir].port_id = port_id;
+	flow_val->route_cache[dir].flow_type = flow_type;
+}
+
+// hidden counter for the inline function to access
+extern uint32_t _dp_flow_values_used;
+
+// every flow value successfully added to the table needs to be counted (uncounted in dp_free_flow())
+static __rte_always_inline
+void dp_flow_value_added(void)
+{
+	// only the worker adds and frees flow values
+	_dp_flow_values_used++;
+}
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,23 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __INCLUDE_DP_GRO_H__
+#define __INCLUDE_DP_GRO_H__
+
+#include <stdint.h>
+#include <rte_mbuf.h>
+#include "dp_port.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Merges consecutive TCP/IPv4 segments of the same flow within one Rx burst,
+// merged packets are marked for segmentation (and checksum recomputation) on Tx
+// returns the new number of packets in the burst
+uint16_t dp_gro_reassemble_burst(struct dp_port *port, struct rte_mbuf **pkts, uint16_t nb_pkts);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __INCLUDE_DP_GSO_H__
+#define __INCLUDE_DP_GSO_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <rte_ether.h>
+#include <rte_mbuf.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// enough for a maximum-sized TCP/IPv4 packet split to a 1280B MTU
+#define DP_GSO_MAX_SEGS 64
+
+// only packets merged by GRO are marked for segmentation
+static __rte_always_inline bool dp_gso_is_needed(const struct rte_mbuf *m, uint16_t mtu)
+{
+	return (m->ol_flags & RTE_MBUF_F_TX_TCP_SEG)
+		&& rte_pktmbuf_pkt_len(m) - sizeof(struct rte_ether_hdr) > mtu;
+}
+
+// ports are not configured for TSO, the flag must never reach them
+// (also for merged packets that fit into MTU and are sent as they are)
+static __rte_always_inline void dp_gso_clear(struct rte_mbuf *m)
+{
+	m->ol_flags &= ~RTE_MBUF_F_TX_TCP_SEG;
+}
+
+// splits a TCP/IPv4 packet (possibly in the IPv6 underlay tunnel) into segments fitting into MTU
+// on success, the original packet is consumed and the number of segments is returned
+// (zero means the packet cannot be segmented and needs to be sent as-is)
+int dp_gso_segment(struct rte_mbuf *m, uint16_t mtu, struct rte_mbuf **segs, uint16_t max_segs);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __INCLUDE_DP_IDLE_H__
+#define __INCLUDE_DP_IDLE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <rte_common.h>
+#include <rte_graph.h>
+#include <rte_telemetry.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// hidden flag for the inline function to access
+extern bool _dp_idle_walk_active;
+
+void dp_idle_init(const struct rte_graph *graph);
+
+// call after every graph walk, waits (in adaptive mode) if there has been nothing to do for some time
+void dp_idle_walk_done(void);
+
+int dp_idle_get_stats_telemetry(struct rte_tel_data *dict);
+
+// every source node that found work (packets, messages) needs to call this
+static __rte_always_inline void dp_idle_mark_active(void)
+{
+	_dp_idle_walk_active = true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif
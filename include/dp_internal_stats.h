@@ -5,6 +5,7 @@
 #define _DP_INTERNAL_STATS_H_
 
 #include <rte_telemetry.h>
+#include "dp_drop_reason.h"
 #include "dp_log.h"
 
 #ifdef __cplusplus
@@ -15,8 +16,46 @@ struct dp_nat_stats {
 	uint16_t used_port_cnt;
 };
 
+struct dp_cntrack_stats {
+	uint32_t flow_cnt;
+	uint32_t half_open_cnt;
+	uint64_t limit_drop_cnt;
+};
+
+struct dp_tx_stats {
+	uint64_t flush_cnt;
+	uint64_t retry_cnt;
+	uint64_t drop_cnt;
+};
+
+struct dp_mtu_stats {
+	uint64_t icmp_sent_cnt;
+	uint64_t icmp_limited_cnt;
+	uint64_t mss_clamped_cnt;
+	uint64_t gro_merged_cnt;
+	uint64_t gso_segments_cnt;
+};
+
+struct dp_traffic_stats {
+	uint64_t rx_pkts;
+	uint64_t rx_bytes;
+	uint64_t tx_pkts;
+	uint64_t tx_bytes;
+	uint64_t drop_pkts;
+	uint64_t drop_bytes;
+};
+
+struct dp_drop_stats {
+	uint64_t reason_cnt[DP_DROP_REASON_COUNT];
+};
+
 struct dp_port_stats {
 	struct dp_nat_stats nat_stats;
+	struct dp_cntrack_stats cntrack_stats;
+	struct dp_tx_stats tx_stats;
+	struct dp_mtu_stats mtu_stats;
+	struct dp_traffic_stats traffic_stats;
+	struct dp_drop_stats drop_stats;
 };
 
 #define DP_STATS_NAT_INC_USED_PORT_CNT(PORT) do { \
@@ -27,7 +66,89 @@ struct dp_port_stats {
 	(PORT)->stats.nat_stats.used_port_cnt--; \
 } while (0)
 
+#define DP_STATS_CNTRACK_INC_FLOW_CNT(PORT) do { \
+	(PORT)->stats.cntrack_stats.flow_cnt++; \
+} while (0)
+
+#define DP_STATS_CNTRACK_DEC_FLOW_CNT(PORT) do { \
+	(PORT)->stats.cntrack_stats.flow_cnt--; \
+} while (0)
+
+#define DP_STATS_CNTRACK_INC_HALF_OPEN_CNT(PORT) do { \
+	(PORT)->stats.cntrack_stats.half_open_cnt++; \
+} while (0)
+
+#define DP_STATS_CNTRACK_DEC_HALF_OPEN_CNT(PORT) do { \
+	(PORT)->stats.cntrack_stats.half_open_cnt--; \
+} while (0)
+
+#define DP_STATS_CNTRACK_INC_LIMIT_DROP_CNT(PORT) do { \
+	(PORT)->stats.cntrack_stats.limit_drop_cnt++; \
+} while (0)
+
+#define DP_STATS_TX_INC_FLUSH_CNT(PORT) do { \
+	(PORT)->stats.tx_stats.flush_cnt++; \
+} while (0)
+
+#define DP_STATS_TX_INC_RETRY_CNT(PORT) do { \
+	(PORT)->stats.tx_stats.retry_cnt++; \
+} while (0)
+
+#define DP_STATS_TX_ADD_DROP_CNT(PORT, COUNT) do { \
+	(PORT)->stats.tx_stats.drop_cnt += (COUNT); \
+} while (0)
+
+#define DP_STATS_MTU_INC_ICMP_SENT_CNT(PORT) do { \
+	(PORT)->stats.mtu_stats.icmp_sent_cnt++; \
+} while (0)
+
+#define DP_STATS_MTU_INC_ICMP_LIMITED_CNT(PORT) do { \
+	(PORT)->stats.mtu_stats.icmp_limited_cnt++; \
+} while (0)
+
+#define DP_STATS_MTU_INC_MSS_CLAMPED_CNT(PORT) do { \
+	(PORT)->stats.mtu_stats.mss_clamped_cnt++; \
+} while (0)
+
+#define DP_STATS_MTU_ADD_GRO_MERGED_CNT(PORT, COUNT) do { \
+	(PORT)->stats.mtu_stats.gro_merged_cnt += (COUNT); \
+} while (0)
+
+#define DP_STATS_MTU_ADD_GSO_SEGMENTS_CNT(PORT, COUNT) do { \
+	(PORT)->stats.mtu_stats.gso_segments_cnt += (COUNT); \
+} while (0)
+
+#define DP_STATS_TRAFFIC_ADD_RX(PORT, PKTS, BYTES) do { \
+	(PORT)->stats.traffic_stats.rx_pkts += (PKTS); \
+	(PORT)->stats.traffic_stats.rx_bytes += (BYTES); \
+} while (0)
+
+#define DP_STATS_TRAFFIC_ADD_TX(PORT, PKTS, BYTES) do { \
+	(PORT)->stats.traffic_stats.tx_pkts += (PKTS); \
+	(PORT)->stats.traffic_stats.tx_bytes += (BYTES); \
+} while (0)
+
+#define DP_STATS_TRAFFIC_ADD_DROP(PORT, PKTS, BYTES) do { \
+	(PORT)->stats.traffic_stats.drop_pkts += (PKTS); \
+	(PORT)->stats.traffic_stats.drop_bytes += (BYTES); \
+} while (0)
+
+#define DP_STATS_DROP_INC_REASON_CNT(PORT, REASON) do { \
+	(PORT)->stats.drop_stats.reason_cnt[(REASON)]++; \
+} while (0)
+
 int dp_nat_get_used_ports_telemetry(struct rte_tel_data *dict);
+int dp_add_table_telemetry(struct rte_tel_data *dict, const char *name, uint32_t used, uint32_t capacity);
+// tables that grow online also report how many entries could not be moved to the bigger table
+int dp_add_growing_table_telemetry(struct rte_tel_data *dict, const char *name, uint32_t used, uint32_t capacity,
+								   uint64_t migration_failed);
+int dp_cntrack_get_flow_count_telemetry(struct rte_tel_data *dict);
+int dp_cntrack_get_limit_drops_telemetry(struct rte_tel_data *dict);
+int dp_tx_get_stats_telemetry(struct rte_tel_data *dict);
+int dp_mtu_get_stats_telemetry(struct rte_tel_data *dict);
+int dp_iface_get_stats_telemetry(struct rte_tel_data *dict);
+int dp_vni_get_stats_telemetry(struct rte_tel_data *dict);
+int dp_drop_get_stats_telemetry(struct rte_tel_data *dict);
 
 #ifdef __cplusplus
 }
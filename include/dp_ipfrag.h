@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __INCLUDE_DP_IPFRAG_H__
+#define __INCLUDE_DP_IPFRAG_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <rte_mbuf.h>
+#include <rte_telemetry.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// enough for a maximum-sized IP packet fragmented to a 1280B MTU
+#define DP_IPFRAG_MAX_FRAGS 64
+
+int dp_ipfrag_init(int socket_id);
+void dp_ipfrag_free(void);
+
+// takes ownership of the fragment, returns the whole packet once all fragments arrived, NULL otherwise
+// (l3_type is the one stored in dp_flow, the packet needs to start with an ethernet header)
+struct rte_mbuf *dp_ipfrag_reassemble(struct rte_mbuf *m, uint16_t l3_type, uint64_t tsc);
+
+// frees fragments of packets that timed out or could not be reassembled
+void dp_ipfrag_free_dropped(void);
+
+// IPv4 packets without the "don't fragment" flag can be fragmented when too big
+bool dp_ipfrag_is_allowed(struct rte_mbuf *m, bool tunneled);
+
+// splits a packet to fit into MTU, headers in front of the (inner) IP header are copied to each fragment
+// on success, the original packet is freed and the number of fragments is returned
+int dp_ipfrag_fragment(struct rte_mbuf *m, bool tunneled, uint16_t mtu, struct rte_mbuf **frags, uint16_t max_frags);
+
+int dp_ipfrag_get_stats_telemetry(struct rte_tel_data *dict);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
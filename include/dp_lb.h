@@ -8,6 +8,7 @@
 extern "C" {
 #endif
 
+#include <rte_telemetry.h>
 #include "dp_flow.h"
 #include "grpc/dp_grpc_responder.h"
 
@@ -40,6 +41,8 @@ struct lb_value {
 
 int dp_lb_init(int socket_id);
 void dp_lb_free(void);
+
+int dp_lb_get_tables_telemetry(struct rte_tel_data *dict);
 bool dp_is_ip_lb(struct dp_flow *df, uint32_t vni);
 uint8_t *dp_lb_get_backend_ip(struct flow_key *flow_key, uint32_t vni);
 bool dp_is_lb_enabled(void);
@@ -8,6 +8,8 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <rte_common.h>
 #include <rte_log.h>
 
@@ -55,6 +57,7 @@ extern "C" {
 // networking stack
 #define DP_LOG_IPV4(VALUE) _DP_LOG_IPV4("ipv4", VALUE)
 #define DP_LOG_IPV6(VALUE) _DP_LOG_IPV6("ipv6", VALUE)
+#define DP_LOG_MAC(VALUE) _DP_LOG_STR("mac", VALUE)
 #define DP_LOG_SRC_IPV4(VALUE) _DP_LOG_IPV4("src_ipv4", VALUE)
 #define DP_LOG_DST_IPV4(VALUE) _DP_LOG_IPV4("dst_ipv4", VALUE)
 #define DP_LOG_SRC_IPV6(VALUE) _DP_LOG_IPV6("src_ipv6", VALUE)
@@ -114,10 +117,30 @@ extern "C" {
 // compound macros
 #define DP_LOG_PORT(VALUE) DP_LOG_PORTID((VALUE)->port_id), DP_LOG_SOCKID((VALUE)->socket_id)
 
+// Everything known at compile time is stored once per call site and only referenced by log records
+// (the message must therefore be a string with static storage duration)
+struct dp_log_callsite {
+	unsigned int level;
+	unsigned int logtype;
+	const char *file;
+	unsigned int line;
+	const char *function;
+	bool unlimited;
+	// rate-limiting state, races between threads only make the limit imprecise
+	uint64_t window_start;
+	uint32_t window_count;
+	uint32_t suppressed;
+};
+
+#define _DP_STRUCTURED_LOG(UNLIMITED, LEVEL, LOGTYPE, MESSAGE, ...) do { \
+	static struct dp_log_callsite _dp_log_callsite = { \
+		RTE_LOG_##LEVEL, RTE_LOGTYPE_DP##LOGTYPE, __FILE__, __LINE__, __FUNCTION__, UNLIMITED, 0, 0, 0 \
+	}; \
+	_dp_log(&_dp_log_callsite, MESSAGE, ##__VA_ARGS__, NULL); \
+} while (0)
+
 #define DP_STRUCTURED_LOG(LEVEL, LOGTYPE, MESSAGE, ...) \
-	_dp_log(RTE_LOG_##LEVEL, RTE_LOGTYPE_DP##LOGTYPE, \
-			__FILE__, __LINE__, __FUNCTION__, \
-			MESSAGE, ##__VA_ARGS__, NULL)
+	_DP_STRUCTURED_LOG(false, LEVEL, LOGTYPE, MESSAGE, ##__VA_ARGS__)
 
 // this way IDE autocomplete and click-through is working while not needing to write the full level/logtype names
 #define DPS_LOG_ERR(MESSAGE, ...)     DP_STRUCTURED_LOG(ERR,     SERVICE, MESSAGE, ##__VA_ARGS__)
@@ -139,10 +162,13 @@ void dp_log_set_thread_name(const char *name);
 
 int dp_log_init(void);
 
+/** Worker lcores only enqueue log records, a separate thread writes them out */
+int dp_log_async_init(void);
+/** Only call once all worker lcores have stopped */
+void dp_log_async_free(void);
+
 __rte_cold
-void _dp_log(unsigned int level, unsigned int logtype,
-			 const char *file, unsigned int line, const char *function,
-			 const char *message, ...);
+void _dp_log(struct dp_log_callsite *callsite, const char *message, ...);
 
 /** Use this for logging before dp_log_init() */
 __rte_cold __rte_format_printf(2, 3)
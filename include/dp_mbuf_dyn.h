@@ -7,8 +7,10 @@
 #include <assert.h>
 #include <rte_common.h>
 #include <rte_flow.h>
-#include <rte_atomic.h>
+#include <rte_lcore.h>
+#include <rte_per_lcore.h>
 #include "dpdk_layer.h"
+#include "dp_drop_reason.h"
 #include "dp_error.h"
 #ifdef ENABLE_VIRTSVC
 #	include "dp_virtsvc.h"
@@ -54,6 +56,8 @@ struct dp_flow {
 	enum dp_flow_dir			flow_dir : 1;		// store the direction of each packet
 	enum dp_pkt_offload_state	offload_state : 2;	// store the offload status of each packet
 	enum dp_vnf_type			vnf_type : 3;
+	bool						reassembled : 1;	// packet made of fragments, needs fragmenting on Tx
+	bool						decap_cached : 1;	// VNF info and conntrack pointer came from the decap cache
 
 	uint16_t	l3_type;  //layer-3 for inner packets. it can be crafted or extracted from raw frames
 	uint32_t	l3_payload_length;  //layer-3 playload length for inner packets.
@@ -104,6 +108,8 @@ struct dp_pkt_mark {
 	struct {
 		bool is_recirc : 1;
 	} flags;
+	uint8_t drop_reason;  // enum dp_drop_reason, valid only when sent to the drop node
+	uint16_t stats_port_id;  // port drops are accounted to (the target VF of incoming traffic once known)
 	// check the init function if adding more,
 	// due to this being small, memset has not been used
 };
@@ -113,7 +119,13 @@ static_assert(sizeof(struct dp_flow) + sizeof(struct dp_pkt_mark) <= DP_MBUF_PRI
 static_assert((1 << (sizeof(((struct dp_flow *)0)->nxt_hop) * 8)) >= DP_MAX_PORTS,
 			  "struct dp_flow::nxt_hop cannot hold all possible port_ids");
 
-extern rte_atomic32_t dp_pkt_id_counter;
+// Packet ids (for graphtrace) are made of the generating lcore and a per-lcore sequence number,
+// thus unique across lcores without any shared counter
+#define DP_PKT_ID_SEQ_BITS 24
+#define DP_PKT_ID_SEQ_MASK ((UINT32_C(1) << DP_PKT_ID_SEQ_BITS) - 1)
+#define DP_PKT_ID_LCORE(ID) ((ID) >> DP_PKT_ID_SEQ_BITS)
+
+RTE_DECLARE_PER_LCORE(uint32_t, dp_pkt_id_counter);
 
 static __rte_always_inline struct dp_flow *dp_get_flow_ptr(struct rte_mbuf *m)
 {
@@ -139,8 +151,15 @@ static __rte_always_inline void dp_init_pkt_mark(struct rte_mbuf *m)
 {
 	struct dp_pkt_mark *mark = dp_get_pkt_mark(m);
 
-	mark->id = rte_atomic32_add_return(&dp_pkt_id_counter, 1);
+	mark->id = (rte_lcore_id() << DP_PKT_ID_SEQ_BITS) | (++RTE_PER_LCORE(dp_pkt_id_counter) & DP_PKT_ID_SEQ_MASK);
 	mark->flags.is_recirc = false;
+	mark->drop_reason = DP_DROP_REASON_UNKNOWN;
+	mark->stats_port_id = m->port;
+}
+
+static __rte_always_inline void dp_set_drop_reason(struct rte_mbuf *m, enum dp_drop_reason reason)
+{
+	dp_get_pkt_mark(m)->drop_reason = (uint8_t)reason;
 }
 
 
@@ -8,6 +8,7 @@
 #include <sys/queue.h>
 #include <rte_common.h>
 #include <rte_mbuf.h>
+#include <rte_telemetry.h>
 #include "dp_flow.h"
 #include "dp_ipaddr.h"
 #include "grpc/dp_grpc_responder.h"
@@ -20,6 +21,10 @@ extern "C" {
 
 #define DP_NETWORK_NAT_ALL_VNI		0
 
+// This is based on the fact that neighnats are being put in the table along with local NAT/VIP
+// To prevent it from being too large, this is assuming 2048 ports per NAT range (32 ranges/IP)
+#define DP_NAT_TABLE_MAX (DP_MAX_VF_PORTS * 32)
+
 struct nat_key {
 	uint32_t	ip;
 	uint32_t	vni;
@@ -77,6 +82,8 @@ struct nat_check_result {
 int dp_nat_init(int socket_id);
 void dp_nat_free(void);
 
+int dp_nat_get_tables_telemetry(struct rte_tel_data *dict);
+
 int dp_set_iface_vip_ip(uint32_t iface_ip, uint32_t vip_ip, uint32_t vni,
 						const uint8_t ul_ipv6[DP_IPV6_ADDR_SIZE]);
 int dp_del_iface_vip_ip(uint32_t iface_ip, uint32_t vni);
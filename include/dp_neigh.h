@@ -0,0 +1,20 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __INCLUDE_DP_NEIGH_H__
+#define __INCLUDE_DP_NEIGH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Watches the kernel neighbor table of PFs for underlay router MAC changes and passes them to the worker
+// (ports need to be initialized already, PFs without a kernel interface are not watched)
+// Only the router entry found during port initialization is followed (or the first one seen if there was none)
+int dp_neigh_init(void);
+void dp_neigh_free(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -4,8 +4,10 @@
 #ifndef __INCLUDE_DP_NETLINK_H__
 #define __INCLUDE_DP_NETLINK_H__
 
+#include <stdbool.h>
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
+#include "dp_ipaddr.h"
 
 #define DP_NLINK_BUF_SIZE 8192
 
@@ -25,7 +27,11 @@ struct dp_nlnk_req {
 	struct dp_nl_tlv if_tlv;
 };
 
-int dp_get_pf_neigh_mac(int if_idx, struct rte_ether_addr *neigh, const struct rte_ether_addr *own_mac);
+int dp_get_pf_neigh_mac(int if_idx, struct rte_ether_addr *neigh, uint8_t neigh_ipv6[DP_IPV6_ADDR_SIZE],
+						const struct rte_ether_addr *own_mac);
+
+// returns true if the message is a valid IPv6 router neighbor entry with an address and a link-layer address
+bool dp_netlink_get_router(struct nlmsghdr *nh, struct rte_ether_addr *mac, uint8_t ipv6[DP_IPV6_ADDR_SIZE]);
 
 #ifdef __cplusplus
 }
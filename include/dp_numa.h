@@ -0,0 +1,28 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __INCLUDE_DP_NUMA_H__
+#define __INCLUDE_DP_NUMA_H__
+
+#include <rte_telemetry.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// NUMA node of the worker lcore (main lcore's if there is no worker)
+int dp_numa_get_worker_socket_id(void);
+
+// memory objects are tracked to be able to report their actual placement
+void dp_numa_register(const char *name, const void *addr, int socket_id);
+void dp_numa_unregister(const void *addr);
+
+// warns about ports and memory objects not local to the worker
+void dp_numa_check_placement(void);
+
+int dp_numa_get_placement_telemetry(struct rte_tel_data *dict);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
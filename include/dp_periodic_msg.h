@@ -11,10 +11,10 @@
 extern "C" {
 #endif
 
-void send_to_all_vfs(const struct rte_mbuf *pkt, uint16_t eth_type);
-void trigger_garp(void);
-void trigger_nd_unsol_adv(void);
-void trigger_nd_ra(void);
+// Sends GARP (and ND-NA, ND-RA if IPv6 is enabled) to all VFs assigned to the given slot
+// (port_id % slot_count == slot), so calling this for every slot covers all VFs once
+void dp_periodic_msg_send(unsigned int slot, unsigned int slot_count, bool ipv6_enabled);
+void dp_periodic_msg_free(void);
 
 #ifdef __cplusplus
 }
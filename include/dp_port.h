@@ -45,12 +45,27 @@ struct dp_port_iface {
 	uint64_t				public_flow_rate_cap;
 };
 
+struct dp_port_flow_limiter {
+	uint64_t				window_start;
+	uint32_t				window_cnt;
+	uint64_t				log_timestamp;
+};
+
+struct dp_port_icmp_limiter {
+	uint64_t				window_start;
+	uint32_t				window_cnt;
+};
+
 struct dp_port {
 	bool							is_pf;
 	uint16_t						port_id;
 	char							port_name[IF_NAMESIZE];
 	int								socket_id;
 	uint8_t							link_status;
+	uint16_t						mtu;
+	uint64_t						tx_offloads;
+	bool							tx_cksum_fallback;
+	bool							rx_gro;
 	bool							allocated;
 	char							vf_name[IF_NAMESIZE];
 	char							dev_name[RTE_ETH_NAME_MAX_LEN];
@@ -58,11 +73,14 @@ struct dp_port {
 	uint16_t						peer_pf_port_id;
 	struct rte_ether_addr			own_mac;
 	struct rte_ether_addr			neigh_mac;
+	uint8_t							neigh_ipv6[DP_IPV6_ADDR_SIZE];
 	struct dp_port_iface			iface;
 	struct rte_flow					*default_jump_flow;
 	struct rte_flow					*default_capture_flow;
 	bool							captured;
 	struct dp_port_stats			stats;
+	struct dp_port_flow_limiter		flow_limiter;
+	struct dp_port_icmp_limiter		icmp_limiter;
 	struct rte_meter_srtcm			port_srtcm;
 	struct rte_meter_srtcm_profile	port_srtcm_profile;
 };
@@ -107,6 +125,13 @@ struct dp_port *dp_get_in_port(struct rte_mbuf *m)
 	return _dp_port_table[m->port];
 }
 
+// for port ids that have not necessarily been validated (returns NULL for unknown ports, without logging)
+static __rte_always_inline
+struct dp_port *dp_get_port_by_id_checked(uint16_t port_id)
+{
+	return port_id < RTE_DIM(_dp_port_table) ? _dp_port_table[port_id] : NULL;
+}
+
 static __rte_always_inline
 struct dp_port *dp_get_out_port(struct dp_flow *df)
 {
@@ -22,6 +22,9 @@ extern "C" {
 #define DP_LB_ID_MAX_LEN		64
 #define DP_LB_MAX_PORTS			16
 
+// sanity limit for configurable table sizes
+#define DP_TABLE_SIZE_LIMIT		(1 << 25)
+
 #define DP_MAC_EQUAL(mac1, mac2) (((mac1)->addr_bytes[0] == (mac2)->addr_bytes[0]) && \
 								((mac1)->addr_bytes[1] == (mac2)->addr_bytes[1]) && \
 								((mac1)->addr_bytes[2] == (mac2)->addr_bytes[2]) && \
@@ -10,7 +10,9 @@ extern "C" {
 
 #include <rte_byteorder.h>
 #include <rte_hash.h>
+#include <rte_memcpy.h>
 #include <rte_telemetry.h>
+#include "dp_error.h"
 
 // limit number of services to one byte due to various implementation reasons
 #define DP_VIRTSVC_MAX 256
@@ -25,6 +27,15 @@ enum dp_virtsvc_conn_state {
 	DP_VIRTSVC_CONN_ESTABLISHED
 };
 
+// connection tables are allocated on demand in chunks of this many connections
+#define DP_VIRTSVC_CONN_CHUNK_SHIFT 10
+#define DP_VIRTSVC_CONN_CHUNK_SIZE (1 << DP_VIRTSVC_CONN_CHUNK_SHIFT)
+#define DP_VIRTSVC_CONN_CHUNK_COUNT (DP_VIRTSVC_PORTCOUNT / DP_VIRTSVC_CONN_CHUNK_SIZE)
+static_assert(DP_VIRTSVC_PORTCOUNT % DP_VIRTSVC_CONN_CHUNK_SIZE == 0, "Virtsvc ports do not fit into chunks");
+
+// used as a 'NULL' index in connection lists
+#define DP_VIRTSVC_CONN_NONE DP_VIRTSVC_PORTCOUNT
+
 struct dp_virtsvc_conn {
 	uint64_t last_pkt_timestamp;
 	// if pressed for space, this can be recovered from vf_port_id, but it's relatively costly
@@ -34,6 +45,9 @@ struct dp_virtsvc_conn {
 	// due to alignment (and direct use of enum), this causes 8B increase of size
 	// if pressed for space, this can be lowered
 	enum dp_virtsvc_conn_state state;
+	// connections in use are in a LRU list, released ones are in a free list (using 'next' only)
+	uint16_t prev;
+	uint16_t next;
 };
 
 struct dp_virtsvc {
@@ -42,57 +56,66 @@ struct dp_virtsvc {
 	rte_be16_t virtual_port;
 	rte_be16_t service_port;
 	uint8_t    proto;
-	uint16_t   last_assigned_port;
-	struct rte_hash *open_ports;
-	struct dp_virtsvc_conn connections[DP_VIRTSVC_PORTCOUNT];
+	// connections below this index have already been used
+	uint16_t   next_unused_conn;
+	uint16_t   free_head;
+	uint16_t   lru_head;
+	uint16_t   lru_tail;
+	struct dp_virtsvc_conn *conn_chunks[DP_VIRTSVC_CONN_CHUNK_COUNT];
 };
 
-struct dp_virtsvc_lookup_entry {
-	struct dp_virtsvc *virtsvc;
-	struct dp_virtsvc_lookup_entry *left;
-	struct dp_virtsvc_lookup_entry *right;
-};
+// packed, because hashing would include padding otherwise
+struct dp_virtsvc_ipv4_key {
+	rte_be32_t addr;
+	rte_be16_t port;
+	uint8_t    proto;
+} __rte_packed;
+
+struct dp_virtsvc_ipv6_key {
+	uint8_t    addr[16];
+	rte_be16_t port;
+	uint8_t    proto;
+} __rte_packed;
 
-const struct dp_virtsvc_lookup_entry *dp_virtsvc_get_ipv4_tree(void);
-const struct dp_virtsvc_lookup_entry *dp_virtsvc_get_ipv6_tree(void);
+const struct rte_hash *dp_virtsvc_get_ipv4_table(void);
+const struct rte_hash *dp_virtsvc_get_ipv6_table(void);
 
 static __rte_always_inline
-int dp_virtsvc_ipv4_cmp(uint8_t proto1, rte_be32_t addr1, rte_be16_t port1,
-						uint8_t proto2, rte_be32_t addr2, rte_be16_t port2)
+struct dp_virtsvc *dp_virtsvc_ipv4_lookup(const struct rte_hash *table, uint8_t proto, rte_be32_t addr, rte_be16_t port)
 {
-	int diff;
-	// this creates a diff between two Network-Byte-Order numbers
-	// the tree structure will work fine, but the actual values (IPs, ports)
-	// are not ordered properly, i.e. the semantics of the values are ignored
-	// but for finding a service in the tree, it works fine
+	struct dp_virtsvc_ipv4_key key = {
+		.addr = addr,
+		.port = port,
+		.proto = proto,
+	};
+	void *virtsvc;
 
-	diff = proto1 - proto2;
-	if (diff)
-		return diff;
+	if (DP_FAILED(rte_hash_lookup_data(table, &key, &virtsvc)))
+		return NULL;
 
-	diff = addr1 - addr2;
-	if (diff)
-		return diff;
-
-	return port1 - port2;
+	return (struct dp_virtsvc *)virtsvc;
 }
 
 static __rte_always_inline
-int dp_virtsvc_ipv6_cmp(uint8_t proto1, const uint8_t addr1[16], rte_be16_t port1,
-						uint8_t proto2, const uint8_t addr2[16], rte_be16_t port2)
+struct dp_virtsvc *dp_virtsvc_ipv6_lookup(const struct rte_hash *table, uint8_t proto, const uint8_t addr[16], rte_be16_t port)
 {
-	int diff;
-	// dtto, see above
+	struct dp_virtsvc_ipv6_key key = {
+		.port = port,
+		.proto = proto,
+	};
+	void *virtsvc;
 
-	diff = proto1 - proto2;
-	if (diff)
-		return diff;
+	rte_memcpy(key.addr, addr, sizeof(key.addr));
+	if (DP_FAILED(rte_hash_lookup_data(table, &key, &virtsvc)))
+		return NULL;
 
-	diff = memcmp(addr1, addr2, 16);
-	if (diff)
-		return diff;
+	return (struct dp_virtsvc *)virtsvc;
+}
 
-	return port1 - port2;
+static __rte_always_inline
+struct dp_virtsvc_conn *dp_virtsvc_get_conn(struct dp_virtsvc *virtsvc, uint16_t conn_idx)
+{
+	return &virtsvc->conn_chunks[conn_idx >> DP_VIRTSVC_CONN_CHUNK_SHIFT][conn_idx & (DP_VIRTSVC_CONN_CHUNK_SIZE - 1)];
 }
 
 int dp_virtsvc_init(int socket_id);
@@ -109,9 +132,12 @@ int dp_virtsvc_get_pf_route(struct dp_virtsvc *virtsvc,
 							 uint16_t *pf_port_id,
 							 int *conn_idx);
 
+struct dp_virtsvc_conn *dp_virtsvc_get_reply_conn(struct dp_virtsvc *virtsvc, rte_be16_t l4_port);
+
 void dp_virtsvc_del_iface(uint16_t port_id);
 
 int dp_virtsvc_get_used_ports_telemetry(struct rte_tel_data *dict);
+int dp_virtsvc_get_tables_telemetry(struct rte_tel_data *dict);
 
 #ifdef __cplusplus
 }
@@ -7,6 +7,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <rte_common.h>
+#include <rte_telemetry.h>
 #include "dp_ipaddr.h"
 
 #ifdef __cplusplus
@@ -15,6 +16,8 @@ extern "C" {
 
 #define DP_VNF_MATCH_ALL_PORT_IDS 0xFFFF
 
+#define DP_VNF_TABLE_MAX 1000
+
 // forward declaration as 'struct dp_grpc_responder' needs some definitions from here
 struct dp_grpc_responder;
 
@@ -43,6 +46,8 @@ struct dp_vnf {
 int dp_vnf_init(int socket_id);
 void dp_vnf_free(void);
 
+int dp_vnf_get_tables_telemetry(struct rte_tel_data *dict);
+
 int dp_add_vnf(const uint8_t ul_addr6[DP_IPV6_ADDR_SIZE], enum dp_vnf_type type,
 			   uint16_t port_id, uint32_t vni, const struct dp_ip_address *pfx_ip, uint8_t prefix_len);
 const struct dp_vnf *dp_get_vnf(const uint8_t ul_addr6[DP_IPV6_ADDR_SIZE]);
@@ -8,6 +8,7 @@
 #include <rte_jhash.h>
 #include <rte_rib.h>
 #include <rte_rib6.h>
+#include <rte_telemetry.h>
 #include "dp_refcount.h"
 #include "dp_lpm.h"
 #include "dp_error.h"
@@ -78,6 +79,8 @@ struct rte_rib6 *dp_get_vni_route6_table(uint32_t vni)
 
 int dp_vni_init(int socket_id);
 void dp_vni_free(void);
+
+int dp_vni_get_tables_telemetry(struct rte_tel_data *dict);
 bool dp_is_vni_route_table_available(uint32_t vni, int type);
 int dp_create_vni_route_tables(uint32_t vni, int socket_id);
 int dp_delete_vni_route_tables(uint32_t vni);
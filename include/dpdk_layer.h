@@ -42,7 +42,9 @@ extern "C" {
 #endif
 
 struct dp_dpdk_layer {
+	// pool on the (first) worker's NUMA node
 	struct rte_mempool	*rte_mempool;
+	struct rte_mempool	*rte_mempools[RTE_MAX_NUMA_NODES];
 	struct rte_ring		*grpc_tx_queue;
 	struct rte_ring		*grpc_rx_queue;
 	struct rte_ring		*periodic_msg_queue;
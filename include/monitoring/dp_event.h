@@ -22,6 +22,10 @@ int dp_send_event_flow_aging_msg(void);
 
 void dp_process_event_flow_aging_msg(struct rte_mbuf *m);
 
+int dp_send_event_neigh_msg(uint16_t port_id, const struct rte_ether_addr *mac);
+
+void dp_process_event_neigh_msg(struct rte_mbuf *m);
+
 #ifdef __cplusplus
 }
 #endif
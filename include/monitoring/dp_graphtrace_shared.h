@@ -49,11 +49,14 @@ struct dp_graphtrace_pktinfo {
 	const struct rte_node *node;
 	const struct rte_node *next_node;
 	uint16_t dst_port_id;
+	uint8_t drop_reason;
 };
 
 struct dp_graphtrace_params_start {
 	bool drops;
 	bool nodes;
+	uint64_t drop_reasons;  // mask of DP_DROP_REASON_MASK()
+	uint32_t drop_sample;   // only send every N-th dropped packet
 };
 
 struct dp_graphtrace_mp_request {
@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __INCLUDE_DP_IPFIX_H__
+#define __INCLUDE_DP_IPFIX_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <rte_telemetry.h>
+#include "dp_flow.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DP_IPFIX_RING_SIZE		8192
+#define DP_IPFIX_MAX_MSG_SIZE	1400
+// how long can finished flows wait in a partially filled message
+#define DP_IPFIX_FLUSH_INTERVAL_MS	1000
+// UDP collectors can restart, templates need to be repeated
+#define DP_IPFIX_TEMPLATE_INTERVAL_S	60
+
+// snapshot of a finished flow passed from the worker to the exporter thread
+struct dp_ipfix_record {
+	struct flow_key	orig;
+	struct flow_key	reply;
+	uint64_t		start_tsc;
+	uint64_t		end_tsc;
+	uint64_t		packets[DP_FLOW_DIR_CAPACITY];
+	uint64_t		bytes[DP_FLOW_DIR_CAPACITY];
+	uint16_t		port_id;
+	enum dp_flow_end_reason	end_reason;
+};
+
+struct dp_ipfix_stats {
+	uint64_t	queued;
+	uint64_t	ring_full;
+	uint64_t	exported;
+	uint64_t	messages;
+	uint64_t	errors;
+};
+
+int dp_ipfix_init(int socket_id);
+void dp_ipfix_free(void);
+
+bool dp_ipfix_is_enabled(void);
+
+void dp_ipfix_export_flow(const struct flow_value *cntrack);
+
+int dp_ipfix_get_stats_telemetry(struct rte_tel_data *dict);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
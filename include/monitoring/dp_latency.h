@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __INCLUDE_DP_LATENCY_H__
+#define __INCLUDE_DP_LATENCY_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <rte_cycles.h>
+#include <rte_graph.h>
+#include <rte_telemetry.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// bucket N contains durations in the range of [2^(N-1), 2^N) cycles, bucket 0 is for zero
+#define DP_LATENCY_BUCKETS 65
+
+struct dp_latency_hist {
+	uint64_t count;
+	uint64_t max;
+	uint64_t buckets[DP_LATENCY_BUCKETS];
+};
+
+enum dp_latency_handler {
+	DP_LATENCY_HANDLER_GRPC_REQUEST,
+	DP_LATENCY_HANDLER_AGED_FLOWS,
+	DP_LATENCY_HANDLER_AGED_FLOWS_NON_OFFLOAD,
+	DP_LATENCY_HANDLER_OFFLOAD,
+	DP_LATENCY_HANDLER_COUNT,
+};
+
+extern bool _dp_latency_enabled;
+extern struct dp_latency_hist _dp_latency_handlers[DP_LATENCY_HANDLER_COUNT];
+
+int dp_latency_init(struct rte_graph *graph);
+void dp_latency_free(void);
+
+void dp_latency_walk_sampled(struct rte_graph *graph);
+
+int dp_latency_get_graph_telemetry(struct rte_tel_data *dict);
+int dp_latency_get_handlers_telemetry(struct rte_tel_data *dict);
+
+static __rte_always_inline void dp_latency_hist_add(struct dp_latency_hist *hist, uint64_t cycles)
+{
+	hist->buckets[cycles ? 64 - __builtin_clzll(cycles) : 0]++;
+	hist->count++;
+	if (cycles > hist->max)
+		hist->max = cycles;
+}
+
+// Handlers are heavy enough for two TSC reads to not matter, thus always measured when enabled
+static __rte_always_inline uint64_t dp_latency_start(void)
+{
+	return _dp_latency_enabled ? rte_rdtsc() : 0;
+}
+
+static __rte_always_inline void dp_latency_end(enum dp_latency_handler handler, uint64_t start)
+{
+	if (_dp_latency_enabled)
+		dp_latency_hist_add(&_dp_latency_handlers[handler], rte_rdtsc() - start);
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif
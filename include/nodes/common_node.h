@@ -12,11 +12,78 @@ extern "C" {
 #include <rte_graph_worker.h>
 #include <rte_mbuf.h>
 
+#include "dp_mbuf_dyn.h"
 #include "dp_port.h"
 #include "monitoring/dp_graphtrace.h"
 
 #define DP_GRAPH_NO_SPECULATED_NODE (-1)
 
+// Packets are processed in groups, while the next groups are being prefetched
+#define DP_GRAPH_BATCH_SIZE 4u
+
+// Prefetching is staged: mbuf headers two groups ahead, then (as the header is needed to find them)
+// packet data and the private area (dp_flow) one group ahead
+static __rte_always_inline
+void dp_prefetch_graph_packets(void **objs, unsigned int index, unsigned int nb_objs)
+{
+	struct rte_mbuf *pkt;
+
+	for (unsigned int i = index + 2*DP_GRAPH_BATCH_SIZE; i < RTE_MIN(index + 3*DP_GRAPH_BATCH_SIZE, nb_objs); ++i)
+		rte_prefetch0(objs[i]);
+
+	for (unsigned int i = index + DP_GRAPH_BATCH_SIZE; i < RTE_MIN(index + 2*DP_GRAPH_BATCH_SIZE, nb_objs); ++i) {
+		pkt = (struct rte_mbuf *)objs[i];
+		rte_prefetch0(rte_pktmbuf_mtod(pkt, void *));
+		rte_prefetch0(dp_get_flow_ptr(pkt));
+	}
+}
+
+static __rte_always_inline
+rte_edge_t dp_get_graph_packet_next(struct rte_node *node,
+									void *obj,
+									rte_edge_t (*get_next_index)(struct rte_node *node,
+																 struct rte_mbuf *pkt))
+{
+	struct rte_mbuf *pkt = (struct rte_mbuf *)obj;
+	rte_edge_t next_index;
+
+	dp_graphtrace_node(node, pkt);
+	next_index = get_next_index(node, pkt);
+	dp_graphtrace_next(node, pkt, next_index);
+	return next_index;
+}
+
+// State of moving packets to the speculated node's stream
+struct dp_graph_speculation {
+	void **from;
+	void **to_next;
+	uint16_t held;
+	uint16_t last_spec;
+};
+
+static __rte_always_inline
+void dp_speculate_graph_packet(struct rte_graph *graph,
+							   struct rte_node *node,
+							   struct dp_graph_speculation *spec,
+							   rte_edge_t speculated_next_index,
+							   rte_edge_t next_index)
+{
+	if (likely(next_index == speculated_next_index)) {
+		spec->last_spec++;
+		return;
+	}
+
+	// packet diverged, move all previous speculated packets and send this one away
+	rte_memcpy(spec->to_next, spec->from, spec->last_spec * sizeof(spec->from[0]));
+	spec->from += spec->last_spec;
+	spec->to_next += spec->last_spec;
+	spec->held = (uint16_t)(spec->held + spec->last_spec);
+	spec->last_spec = 0;
+
+	rte_node_enqueue_x1(graph, node, next_index, spec->from[0]);
+	spec->from += 1;
+}
+
 static __rte_always_inline
 void dp_foreach_graph_packet(struct rte_graph *graph,
 							 struct rte_node *node,
@@ -26,55 +93,81 @@ void dp_foreach_graph_packet(struct rte_graph *graph,
 							 rte_edge_t (*get_next_index)(struct rte_node *node,
 														  struct rte_mbuf *pkt))
 {
-	struct rte_mbuf *pkt;
-	rte_edge_t next_index, speculated_next_node_index;
-	void **to_next, **from;
-	uint16_t last_spec = 0;
-	uint16_t held = 0;
+	struct dp_graph_speculation spec;
+	rte_edge_t speculated_next_index;
+	rte_edge_t cached_next_index = RTE_EDGE_ID_INVALID;
+	rte_edge_t next0, next1, next2, next3;
+	unsigned int i;
+
+	for (i = 0; i < RTE_MIN(2*DP_GRAPH_BATCH_SIZE, nb_objs); ++i)
+		rte_prefetch0(objs[i]);
+	for (i = 0; i < RTE_MIN(DP_GRAPH_BATCH_SIZE, nb_objs); ++i)
+		rte_prefetch0(dp_get_flow_ptr((struct rte_mbuf *)objs[i]));
 
 	// If there is a valid speculated node, the pkts are moved to next node using rte_node_next_stream_move
-	// otherwise, always using rte_node_enqueue_x1
+	// and only packets diverging from it are enqueued separately
 	if (speculated_node >= 0) {
-		speculated_next_node_index = (rte_edge_t)speculated_node;
-		from = objs;
-		to_next = rte_node_next_stream_get(graph, node, speculated_next_node_index, nb_objs);
-		for (uint16_t i = 0; i < nb_objs; ++i) {
-			pkt = (struct rte_mbuf *)objs[i];
-			rte_prefetch0(objs[i+1]);
-			dp_graphtrace_node(node, pkt);
-			next_index = get_next_index(node, pkt);
-
-			if (unlikely(next_index != speculated_next_node_index)) {
-				rte_memcpy(to_next, from, last_spec * sizeof(from[0]));
-				from += last_spec;
-				to_next += last_spec;
-				held += last_spec;
-				last_spec = 0;
-
-				rte_node_enqueue_x1(graph, node, next_index, from[0]);
-				from += 1;
-			} else {
-				last_spec += 1;
+		speculated_next_index = (rte_edge_t)speculated_node;
+		spec.from = objs;
+		spec.to_next = rte_node_next_stream_get(graph, node, speculated_next_index, nb_objs);
+		spec.held = 0;
+		spec.last_spec = 0;
+
+		for (i = 0; i + DP_GRAPH_BATCH_SIZE <= nb_objs; i += DP_GRAPH_BATCH_SIZE) {
+			dp_prefetch_graph_packets(objs, i, nb_objs);
+			next0 = dp_get_graph_packet_next(node, objs[i], get_next_index);
+			next1 = dp_get_graph_packet_next(node, objs[i+1], get_next_index);
+			next2 = dp_get_graph_packet_next(node, objs[i+2], get_next_index);
+			next3 = dp_get_graph_packet_next(node, objs[i+3], get_next_index);
+
+			if (likely((next0 == speculated_next_index) & (next1 == speculated_next_index)
+					 & (next2 == speculated_next_index) & (next3 == speculated_next_index))) {
+				spec.last_spec = (uint16_t)(spec.last_spec + DP_GRAPH_BATCH_SIZE);
+				continue;
 			}
-			dp_graphtrace_next(node, pkt, next_index);
+
+			dp_speculate_graph_packet(graph, node, &spec, speculated_next_index, next0);
+			dp_speculate_graph_packet(graph, node, &spec, speculated_next_index, next1);
+			dp_speculate_graph_packet(graph, node, &spec, speculated_next_index, next2);
+			dp_speculate_graph_packet(graph, node, &spec, speculated_next_index, next3);
+		}
+		for (; i < nb_objs; ++i) {
+			next0 = dp_get_graph_packet_next(node, objs[i], get_next_index);
+			dp_speculate_graph_packet(graph, node, &spec, speculated_next_index, next0);
 		}
 
-		if (likely(last_spec == nb_objs)) {
-			rte_node_next_stream_move(graph, node, speculated_next_node_index);
+		if (likely(spec.last_spec == nb_objs)) {
+			rte_node_next_stream_move(graph, node, speculated_next_index);
 			return;
 		}
 
-		held += last_spec;
-		rte_memcpy(to_next, from, last_spec * sizeof(from[0]));
-		rte_node_next_stream_put(graph, node, speculated_next_node_index, held);
+		spec.held = (uint16_t)(spec.held + spec.last_spec);
+		rte_memcpy(spec.to_next, spec.from, spec.last_spec * sizeof(spec.from[0]));
+		rte_node_next_stream_put(graph, node, speculated_next_index, spec.held);
 	} else {
-		for (uint16_t i = 0; i < nb_objs; ++i) {
-			pkt = (struct rte_mbuf *)objs[i];
-			// __builtin_prefetch(&objs[i+1]);
-			dp_graphtrace_node(node, pkt);
-			next_index = get_next_index(node, pkt);
-			dp_graphtrace_next(node, pkt, next_index);
-			rte_node_enqueue_x1(graph, node, next_index, pkt);
+		// without speculation, remember the last used edge and enqueue whole groups to it if possible
+		for (i = 0; i + DP_GRAPH_BATCH_SIZE <= nb_objs; i += DP_GRAPH_BATCH_SIZE) {
+			dp_prefetch_graph_packets(objs, i, nb_objs);
+			next0 = dp_get_graph_packet_next(node, objs[i], get_next_index);
+			next1 = dp_get_graph_packet_next(node, objs[i+1], get_next_index);
+			next2 = dp_get_graph_packet_next(node, objs[i+2], get_next_index);
+			next3 = dp_get_graph_packet_next(node, objs[i+3], get_next_index);
+
+			if (likely((next0 == cached_next_index) & (next1 == cached_next_index)
+					 & (next2 == cached_next_index) & (next3 == cached_next_index))) {
+				rte_node_enqueue_x4(graph, node, cached_next_index, objs[i], objs[i+1], objs[i+2], objs[i+3]);
+				continue;
+			}
+
+			rte_node_enqueue_x1(graph, node, next0, objs[i]);
+			rte_node_enqueue_x1(graph, node, next1, objs[i+1]);
+			rte_node_enqueue_x1(graph, node, next2, objs[i+2]);
+			rte_node_enqueue_x1(graph, node, next3, objs[i+3]);
+			cached_next_index = next3;
+		}
+		for (; i < nb_objs; ++i) {
+			next0 = dp_get_graph_packet_next(node, objs[i], get_next_index);
+			rte_node_enqueue_x1(graph, node, next0, objs[i]);
 		}
 	}
 }
@@ -92,6 +185,38 @@ void dp_forward_graph_packets(struct rte_graph *graph,
 	rte_node_next_stream_move(graph, node, next_index);
 }
 
+// Use when returning the drop edge from get_next_index(), so the reason gets accounted for in the drop node
+static __rte_always_inline
+rte_edge_t dp_node_drop(struct rte_mbuf *pkt, enum dp_drop_reason reason, rte_edge_t drop_edge)
+{
+	dp_set_drop_reason(pkt, reason);
+	return drop_edge;
+}
+
+static __rte_always_inline
+void dp_count_dropped_packets(void **objs, uint16_t nb_objs)
+{
+	const struct dp_pkt_mark *mark;
+	struct rte_mbuf *pkt;
+	struct dp_port *port;
+	uint8_t reason;
+
+	// drops are accounted to the port the packet came from,
+	// unless it came from a PF and its target VF is already known (so VMs see their dropped incoming traffic)
+	for (uint16_t i = 0; i < nb_objs; ++i) {
+		pkt = (struct rte_mbuf *)objs[i];
+		mark = dp_get_pkt_mark(pkt);
+		port = dp_get_port_by_id_checked(mark->stats_port_id);
+		if (port) {
+			reason = mark->drop_reason;
+			if (unlikely(reason >= DP_DROP_REASON_COUNT))
+				reason = DP_DROP_REASON_UNKNOWN;
+			DP_STATS_TRAFFIC_ADD_DROP(port, 1, pkt->pkt_len);
+			DP_STATS_DROP_INC_REASON_CNT(port, reason);
+		}
+	}
+}
+
 //
 // Functions for creating dynamic graph edges based on connectet PF/VF ports
 //
@@ -12,6 +12,9 @@ extern "C" {
 
 int ipip_encap_node_append_pf_tx(uint16_t port_id, const char *tx_node_name);
 
+// needs to be called when underlay addresses or PF neighbor MACs change
+void ipip_encap_node_invalidate_templates(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,43 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __INCLUDE_PMTU_NODE_H__
+#define __INCLUDE_PMTU_NODE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_mbuf.h>
+#include "dp_mbuf_dyn.h"
+#include "dp_port.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int pmtu_node_append_vf_tx(uint16_t port_id, const char *tx_node_name);
+
+// Packet from a VM will not fit into the uplink once encapsulated and cannot be fragmented,
+// the sender needs to be told to lower its packet size ("fragmentation needed"/"packet too big").
+// IPv4 packets allowed to be fragmented (and reassembled packets) are fragmented on Tx instead,
+// same for TCP packets merged on Rx (GRO), those are segmented again.
+// Called from ipv4/ipv6_lookup, i.e. before NAT (the error quotes the packet as sent) and also before the firewall
+// (egress drops are not enforced anyway). Load-balanced traffic relayed between PFs never gets here,
+// it keeps its size by being re-encapsulated and there is no VM to answer.
+static __rte_always_inline bool dp_pmtu_is_exceeded(struct rte_mbuf *m, const struct dp_flow *df, const struct dp_port *pf)
+{
+	if (likely(rte_pktmbuf_pkt_len(m) - sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv6_hdr) <= pf->mtu)
+		|| df->reassembled
+		|| (m->ol_flags & RTE_MBUF_F_TX_TCP_SEG))
+		return false;
+
+	return df->l3_type == RTE_ETHER_TYPE_IPV6
+		|| (dp_get_ipv4_hdr(m)->fragment_offset & htons(RTE_IPV4_HDR_DF_FLAG));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
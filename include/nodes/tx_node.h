@@ -4,6 +4,7 @@
 #ifndef __INCLUDE_TX_NODE_H__
 #define __INCLUDE_TX_NODE_H__
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -12,6 +13,11 @@ extern "C" {
 
 int tx_node_create(uint16_t port_id);
 
+// Sends out packets buffered by Tx nodes if appropriate (or always if 'force' is set)
+// to be called by the worker thread after every graph walk
+void tx_node_flush_pending(bool force);
+bool tx_node_is_pending(void);
+
 #ifdef __cplusplus
 }
 #endif
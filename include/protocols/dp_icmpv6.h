@@ -4,6 +4,7 @@
 #ifndef __INCLUDE_DP_ICMPV6_H__
 #define __INCLUDE_DP_ICMPV6_H__
 
+#define	DP_ICMPV6_PACKET_TOO_BIG	2
 #define	DP_ICMPV6_ECHO_REQUEST	128
 #define	DP_ICMPV6_ECHO_REPLY	129
 
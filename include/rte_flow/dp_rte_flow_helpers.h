@@ -513,6 +513,15 @@ void dp_set_send_to_port_action(struct rte_flow_action *action,
 	action->conf = send_to_port_action;
 }
 
+static __rte_always_inline
+void dp_set_flow_count_action(struct rte_flow_action *action,
+							  struct rte_flow_action_count *flow_count_action)
+{
+	flow_count_action->id = 0;
+	action->type = RTE_FLOW_ACTION_TYPE_COUNT;
+	action->conf = flow_count_action;
+}
+
 static __rte_always_inline
 void dp_set_flow_age_action(struct rte_flow_action *action,
 							struct rte_flow_action_age *flow_age_action,
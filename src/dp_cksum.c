@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dp_cksum.h"
+#include <stddef.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+
+static void dp_cksum_l4_software(struct rte_mbuf *m, uint64_t port_offloads, const void *l3_hdr, uint16_t l4_offset, bool ipv4)
+{
+	unaligned_uint16_t *cksum;
+	uint16_t value;
+
+	switch (m->ol_flags & RTE_MBUF_F_TX_L4_MASK) {
+	case RTE_MBUF_F_TX_TCP_CKSUM:
+		if (port_offloads & RTE_ETH_TX_OFFLOAD_TCP_CKSUM)
+			return;
+		cksum = rte_pktmbuf_mtod_offset(m, unaligned_uint16_t *, l4_offset + offsetof(struct rte_tcp_hdr, cksum));
+		break;
+	case RTE_MBUF_F_TX_UDP_CKSUM:
+		if (port_offloads & RTE_ETH_TX_OFFLOAD_UDP_CKSUM)
+			return;
+		cksum = rte_pktmbuf_mtod_offset(m, unaligned_uint16_t *, l4_offset + offsetof(struct rte_udp_hdr, dgram_cksum));
+		break;
+	default:
+		return;
+	}
+
+	*cksum = 0;
+	value = ipv4
+		? rte_ipv4_udptcp_cksum_mbuf(m, (const struct rte_ipv4_hdr *)l3_hdr, l4_offset)
+		: rte_ipv6_udptcp_cksum_mbuf(m, (const struct rte_ipv6_hdr *)l3_hdr, l4_offset);
+	*cksum = value;
+	m->ol_flags &= ~RTE_MBUF_F_TX_L4_MASK;
+}
+
+void dp_cksum_tx_software(struct rte_mbuf *m, uint64_t port_offloads)
+{
+	uint16_t l3_offset = m->l2_len;
+	uint16_t l4_offset;
+	struct rte_ipv4_hdr *ipv4_hdr;
+
+	// the checksummed (inner) header is behind the tunnel
+	if (m->ol_flags & RTE_MBUF_F_TX_TUNNEL_MASK)
+		l3_offset = (uint16_t)(l3_offset + m->outer_l2_len + m->outer_l3_len);
+	l4_offset = (uint16_t)(l3_offset + m->l3_len);
+
+	if (m->ol_flags & RTE_MBUF_F_TX_IPV4) {
+		ipv4_hdr = rte_pktmbuf_mtod_offset(m, struct rte_ipv4_hdr *, l3_offset);
+		if ((m->ol_flags & RTE_MBUF_F_TX_IP_CKSUM) && !(port_offloads & RTE_ETH_TX_OFFLOAD_IPV4_CKSUM)) {
+			ipv4_hdr->hdr_checksum = 0;
+			ipv4_hdr->hdr_checksum = rte_ipv4_cksum(ipv4_hdr);
+			m->ol_flags &= ~RTE_MBUF_F_TX_IP_CKSUM;
+		}
+		dp_cksum_l4_software(m, port_offloads, ipv4_hdr, l4_offset, true);
+	} else if (m->ol_flags & RTE_MBUF_F_TX_IPV6) {
+		dp_cksum_l4_software(m, port_offloads, rte_pktmbuf_mtod_offset(m, struct rte_ipv6_hdr *, l3_offset), l4_offset, false);
+	}
+}
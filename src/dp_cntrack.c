@@ -3,7 +3,9 @@
 
 #include "dp_cntrack.h"
 #include "dp_conf.h"
+#include "dp_decap_cache.h"
 #include "dp_error.h"
+#include "dp_internal_stats.h"
 #include "dp_log.h"
 #include "dp_port.h"
 #include "dp_vnf.h"
@@ -11,6 +13,13 @@
 #include "rte_flow/dp_rte_flow_helpers.h"
 #include "monitoring/dp_graphtrace.h"
 
+#define DP_CNTRACK_LIMIT_LOG_DELAY 5  /* seconds */
+
+#define DP_TCP_OPT_END	0
+#define DP_TCP_OPT_NOP	1
+#define DP_TCP_OPT_MSS	2
+#define DP_TCP_OPT_MSS_LEN	4
+
 static struct flow_key key_cache[2] = {0};
 static int key_cache_index = 0;
 static struct flow_key *prev_key = NULL;
@@ -18,14 +27,44 @@ static struct flow_key *curr_key = &key_cache[0];
 static struct flow_value *cached_flow_val = NULL;
 
 static int flow_timeout = DP_FLOW_DEFAULT_TIMEOUT;
+static int half_open_timeout = DP_FLOW_TCP_HALF_OPEN_TIMEOUT;
 static bool offload_mode_enabled = 0;
 
+static uint32_t flow_limit = 0;
+static uint32_t flow_rate_limit = 0;
+static uint32_t syn_limit = 0;
+static bool flow_limit_enforced = true;
+static uint64_t flow_rate_window;
+static uint64_t flow_limit_log_delay;
+static bool mss_clamp_enabled = false;
+static uint16_t mss_clamp_ipv4;
+static uint16_t mss_clamp_ipv6;
+
 void dp_cntrack_init(void)
 {
+	uint16_t mtu;
+
 	offload_mode_enabled = dp_conf_is_offload_enabled();
 #ifdef ENABLE_PYTEST
 	flow_timeout = dp_conf_get_flow_timeout();
 #endif
+	half_open_timeout = RTE_MIN(DP_FLOW_TCP_HALF_OPEN_TIMEOUT, flow_timeout);
+
+	flow_limit = (uint32_t)dp_conf_get_flow_limit();
+	flow_rate_limit = (uint32_t)dp_conf_get_flow_rate_limit();
+	syn_limit = (uint32_t)dp_conf_get_syn_limit();
+	flow_limit_enforced = dp_conf_get_flow_limit_policy() == DP_CONF_FLOW_LIMIT_POLICY_DROP;
+	flow_rate_window = rte_get_timer_hz();
+	flow_limit_log_delay = rte_get_timer_hz() * DP_CNTRACK_LIMIT_LOG_DELAY;
+
+	// the biggest packet needs to fit both into the VM's MTU and into the encapsulated uplink packet
+	mss_clamp_enabled = dp_conf_is_mss_clamp_enabled();
+	if (mss_clamp_enabled) {
+		mtu = (uint16_t)RTE_MIN(dp_get_pf0()->mtu, dp_get_pf1()->mtu);
+		mtu = RTE_MIN((uint16_t)(mtu - sizeof(struct rte_ipv6_hdr)), (uint16_t)dp_conf_get_dhcp_mtu());
+		mss_clamp_ipv4 = (uint16_t)(mtu - sizeof(struct rte_ipv4_hdr) - sizeof(struct rte_tcp_hdr));
+		mss_clamp_ipv6 = (uint16_t)(mtu - sizeof(struct rte_ipv6_hdr) - sizeof(struct rte_tcp_hdr));
+	}
 }
 
 void dp_cntrack_flush_cache(void)
@@ -41,6 +80,15 @@ static __rte_always_inline void dp_cache_flow_val(struct flow_value *flow_val)
 	cached_flow_val = flow_val;
 }
 
+static __rte_always_inline struct rte_tcp_hdr *dp_cntrack_get_tcp_hdr(struct rte_mbuf *m, const struct dp_flow *df)
+{
+	if (df->l3_type == RTE_ETHER_TYPE_IPV4)
+		return (struct rte_tcp_hdr *)(dp_get_ipv4_hdr(m) + 1);
+	else if (df->l3_type == RTE_ETHER_TYPE_IPV6)
+		return (struct rte_tcp_hdr *)(dp_get_ipv6_hdr(m) + 1);
+	return NULL;
+}
+
 static __rte_always_inline void dp_cntrack_tcp_state(struct flow_value *flow_val, struct rte_tcp_hdr *tcp_hdr)
 {
 	uint8_t tcp_flags = tcp_hdr->tcp_flags;
@@ -130,7 +178,7 @@ static __rte_always_inline void dp_cntrack_set_timeout_tcp_flow(struct rte_mbuf
 		flow_val->timeout_value = DP_FLOW_TCP_EXTENDED_TIMEOUT;
 		dp_cntrack_change_flow_offload_flags(m, flow_val, df);
 	} else {
-		flow_val->timeout_value = flow_timeout;
+		flow_val->timeout_value = flow_val->half_open ? half_open_timeout : flow_timeout;
 		if (flow_val->l4_state.tcp_state == DP_FLOW_TCP_STATE_FINWAIT
 			|| flow_val->l4_state.tcp_state == DP_FLOW_TCP_STATE_RST_FIN)
 			dp_cntrack_change_flow_offload_flags(m, flow_val, df);
@@ -145,7 +193,125 @@ static __rte_always_inline void dp_cntrack_set_pkt_offload_decision(struct dp_fl
 		df->offload_state = df->conntrack->offload_state.reply;
 }
 
-static __rte_always_inline struct flow_value *flow_table_insert_entry(struct flow_key *key, struct dp_flow *df, const struct dp_port *port)
+static __rte_always_inline struct dp_port *dp_cntrack_get_owner_port(struct rte_mbuf *m, struct dp_flow *df)
+{
+	struct dp_port *port = dp_get_in_port(m);
+
+	// incoming traffic is accounted to the target interface (already validated by ipip-decap)
+	if (port->is_pf)
+		return dp_get_out_port(df);
+
+	return port;
+}
+
+static __rte_always_inline bool dp_cntrack_limit_exceeded(struct dp_port *port, const char *reason)
+{
+	uint64_t timestamp;
+
+	// this is expected to happen for every packet during a flood, thus rate-limited (per interface)
+	timestamp = rte_rdtsc();
+	if (timestamp > port->flow_limiter.log_timestamp + flow_limit_log_delay) {
+		port->flow_limiter.log_timestamp = timestamp;
+		DPS_LOG_WARNING(reason, DP_LOG_IFACE(port->iface.id), DP_LOG_PORT(port));
+	}
+
+	// when only monitoring, the flow gets created anyway, so the other limits still need to be accounted for
+	return flow_limit_enforced;
+}
+
+static __rte_always_inline int dp_cntrack_check_limits(struct rte_mbuf *m, struct dp_flow *df,
+													   struct dp_port *owner, bool *half_open /* out */)
+{
+	struct dp_port_flow_limiter *limiter = &owner->flow_limiter;
+	struct rte_tcp_hdr *tcp_hdr;
+	uint64_t timestamp;
+	bool exceeded = false;
+
+	*half_open = false;
+
+	// only VMs are limited (PF-owned flows are loadbalancer flows before target selection)
+	if (owner->is_pf)
+		return DP_OK;
+
+	if (flow_limit && owner->stats.cntrack_stats.flow_cnt >= flow_limit) {
+		exceeded = true;
+		if (dp_cntrack_limit_exceeded(owner, "Interface flow limit reached"))
+			goto drop;
+	}
+
+	if (syn_limit && df->l4_type == IPPROTO_TCP && dp_get_in_port(m)->is_pf) {
+		tcp_hdr = dp_cntrack_get_tcp_hdr(m, df);
+		if (!tcp_hdr)
+			return DP_ERROR;
+		// only a connection attempt can create a new incoming TCP flow
+		if (!DP_TCP_PKT_FLAG_SYN(tcp_hdr->tcp_flags) || DP_TCP_PKT_FLAG_ACK(tcp_hdr->tcp_flags)) {
+			exceeded = true;
+			if (dp_cntrack_limit_exceeded(owner, "Incoming TCP flow not started by SYN"))
+				goto drop;
+		} else {
+			if (owner->stats.cntrack_stats.half_open_cnt >= syn_limit) {
+				exceeded = true;
+				if (dp_cntrack_limit_exceeded(owner, "Interface half-open TCP connection limit reached"))
+					goto drop;
+			}
+			*half_open = true;
+		}
+	}
+
+	if (flow_rate_limit) {
+		timestamp = rte_rdtsc();
+		if (timestamp - limiter->window_start >= flow_rate_window) {
+			limiter->window_start = timestamp;
+			limiter->window_cnt = 0;
+		}
+		if (limiter->window_cnt >= flow_rate_limit) {
+			exceeded = true;
+			if (dp_cntrack_limit_exceeded(owner, "Interface new flow rate limit reached"))
+				goto drop;
+		}
+		limiter->window_cnt++;
+	}
+
+	// every packet is only counted once, even when exceeding multiple limits
+	if (exceeded)
+		DP_STATS_CNTRACK_INC_LIMIT_DROP_CNT(owner);
+
+	return DP_OK;
+
+drop:
+	DP_STATS_CNTRACK_INC_LIMIT_DROP_CNT(owner);
+	return DP_ERROR;
+}
+
+void dp_cntrack_release_flow(const struct flow_value *flow_val)
+{
+	struct dp_port *owner = dp_get_port_by_id(flow_val->owner_port_id);
+
+	if (!owner)
+		return;
+
+	DP_STATS_CNTRACK_DEC_FLOW_CNT(owner);
+	if (flow_val->half_open)
+		DP_STATS_CNTRACK_DEC_HALF_OPEN_CNT(owner);
+}
+
+static __rte_always_inline void dp_cntrack_update_half_open(struct flow_value *flow_val)
+{
+	struct dp_port *owner;
+
+	if (flow_val->l4_state.tcp_state == DP_FLOW_TCP_STATE_NEW_SYN
+		|| flow_val->l4_state.tcp_state == DP_FLOW_TCP_STATE_NEW_SYNACK)
+		return;
+
+	owner = dp_get_port_by_id(flow_val->owner_port_id);
+	if (owner)
+		DP_STATS_CNTRACK_DEC_HALF_OPEN_CNT(owner);
+	flow_val->half_open = false;
+}
+
+static __rte_always_inline struct flow_value *flow_table_insert_entry(struct flow_key *key, struct dp_flow *df,
+																	   const struct dp_port *port, struct dp_port *owner,
+																	   bool half_open)
 {
 	struct flow_value *flow_val;
 	struct flow_key inverted_key;
@@ -159,7 +325,10 @@ static __rte_always_inline struct flow_value *flow_table_insert_entry(struct flo
 	rte_memcpy(&flow_val->flow_key[DP_FLOW_DIR_ORG], key, sizeof(*key));
 	flow_val->flow_flags = DP_FLOW_FLAG_NONE;
 	flow_val->timeout_value = flow_timeout;
+	flow_val->created = rte_rdtsc();
 	flow_val->created_port_id = port->port_id;
+	flow_val->owner_port_id = owner->port_id;
+	flow_val->half_open = half_open;
 
 	/* Target ip of the traffic is an alias prefix of a VM in the same VNI on this dp-service */
 	/* This will be an uni-directional traffic, which does not expect its corresponding reverse traffic */
@@ -193,6 +362,11 @@ static __rte_always_inline struct flow_value *flow_table_insert_entry(struct flo
 	if (DP_FAILED(dp_add_flow(&inverted_key, flow_val)))
 		goto error_add_inv;
 
+	dp_flow_value_added();
+	DP_STATS_CNTRACK_INC_FLOW_CNT(owner);
+	if (half_open)
+		DP_STATS_CNTRACK_INC_HALF_OPEN_CNT(owner);
+
 	return flow_val;
 
 error_add_inv:
@@ -235,12 +409,16 @@ static __rte_always_inline void dp_set_flow_offload_flag(struct rte_mbuf *m, str
 
 static __rte_always_inline int dp_get_flow_val(struct rte_mbuf *m, struct dp_flow *df, struct flow_value **p_flow_val)
 {
+	struct dp_port *owner;
+	bool half_open;
 	int ret;
 
 	// TODO(plague): discuss making DP_FAILED() unlikely by default
 	ret = dp_build_flow_key(curr_key, m);
-	if (unlikely(DP_FAILED(ret)))
+	if (unlikely(DP_FAILED(ret))) {
+		dp_set_drop_reason(m, DP_DROP_REASON_INVALID_PACKET);
 		return ret;
+	}
 
 	if (prev_key && dp_are_flows_identical(curr_key, prev_key)) {
 		// flow is the same as it was for the previous packet
@@ -250,17 +428,36 @@ static __rte_always_inline int dp_get_flow_val(struct rte_mbuf *m, struct dp_flo
 		return DP_OK;
 	}
 
+	// decap cache already provided the flow, only verify that it is the right one
+	if (df->decap_cached
+		&& (dp_are_flows_identical(curr_key, &df->conntrack->flow_key[DP_FLOW_DIR_ORG])
+			|| dp_are_flows_identical(curr_key, &df->conntrack->flow_key[DP_FLOW_DIR_REPLY]))
+	) {
+		*p_flow_val = df->conntrack;
+		dp_set_pkt_flow_direction(curr_key, *p_flow_val, df);
+		dp_set_flow_offload_flag(m, *p_flow_val, df);
+		dp_cache_flow_val(*p_flow_val);
+		return DP_OK;
+	}
+
 	// cache miss, try the flow table
 	ret = dp_get_flow(curr_key, p_flow_val);
 	if (unlikely(DP_FAILED(ret))) {
 		if (unlikely(ret != -ENOENT)) {
 			DPS_LOG_WARNING("Flow table key search failed", DP_LOG_RET(ret));
+			dp_set_drop_reason(m, DP_DROP_REASON_CONNTRACK_ERROR);
 			return ret;
 		}
-		// create new flow if needed
-		*p_flow_val = flow_table_insert_entry(curr_key, df, dp_get_in_port(m));
+		// create new flow if needed (and allowed)
+		owner = dp_cntrack_get_owner_port(m, df);
+		if (DP_FAILED(dp_cntrack_check_limits(m, df, owner, &half_open))) {
+			dp_set_drop_reason(m, DP_DROP_REASON_FLOW_LIMIT);
+			return DP_ERROR;
+		}
+		*p_flow_val = flow_table_insert_entry(curr_key, df, dp_get_in_port(m), owner, half_open);
 		if (unlikely(!*p_flow_val)) {
 			DPS_LOG_WARNING("Failed to create a new flow table entry");
+			dp_set_drop_reason(m, DP_DROP_REASON_FLOW_INSERT);
 			return DP_ERROR;
 		}
 		dp_cache_flow_val(*p_flow_val);
@@ -274,6 +471,59 @@ static __rte_always_inline int dp_get_flow_val(struct rte_mbuf *m, struct dp_flo
 	return DP_OK;
 }
 
+// Remember the decapsulation result of simple established flows, see ipip_decap node
+static __rte_always_inline void dp_cntrack_update_decap_cache(const struct dp_flow *df)
+{
+	struct dp_decap_cache_key key;
+
+	if ((df->l4_type != IPPROTO_TCP && df->l4_type != IPPROTO_UDP) || df->reassembled)
+		return;
+
+	if (df->l3_type == RTE_ETHER_TYPE_IPV4)
+		dp_decap_cache_set_key(&key, df->tun_info.ul_dst_addr6,
+							   &df->src.src_addr, &df->dst.dst_addr, sizeof(df->src.src_addr),
+							   df->l4_type, df->l4_info.trans_port.src_port, df->l4_info.trans_port.dst_port);
+	else
+		dp_decap_cache_set_key(&key, df->tun_info.ul_dst_addr6,
+							   df->src.src_addr6, df->dst.dst_addr6, sizeof(df->src.src_addr6),
+							   df->l4_type, df->l4_info.trans_port.src_port, df->l4_info.trans_port.dst_port);
+
+	dp_decap_cache_insert(&key, df->tun_info.dst_vni, df->vnf_type, df->nxt_hop, df->conntrack);
+}
+
+// Lower the MSS option of SYN packets so that TCP segments fit into the path without ICMP errors or fragmentation
+static __rte_always_inline void dp_cntrack_clamp_mss(struct rte_mbuf *m, const struct dp_flow *df, struct rte_tcp_hdr *tcp_hdr)
+{
+	uint16_t max_mss = df->l3_type == RTE_ETHER_TYPE_IPV4 ? mss_clamp_ipv4 : mss_clamp_ipv6;
+	uint8_t *opt = (uint8_t *)(tcp_hdr + 1);
+	const uint8_t *end = (uint8_t *)tcp_hdr + ((tcp_hdr->data_off & 0xf0) >> 2);
+
+	while (opt < end) {
+		if (*opt == DP_TCP_OPT_END)
+			return;
+		if (*opt == DP_TCP_OPT_NOP) {
+			opt++;
+			continue;
+		}
+		if (opt + 1 >= end || opt[1] < 2 || opt + opt[1] > end)
+			return;
+		if (*opt == DP_TCP_OPT_MSS) {
+			if (opt[1] != DP_TCP_OPT_MSS_LEN || rte_be_to_cpu_16(*(unaligned_uint16_t *)(opt + 2)) <= max_mss)
+				return;
+			*(unaligned_uint16_t *)(opt + 2) = rte_cpu_to_be_16(max_mss);
+			// SYN packets are small, simply recompute the checksum instead of handling unaligned incremental updates
+			tcp_hdr->cksum = 0;
+			if (df->l3_type == RTE_ETHER_TYPE_IPV4)
+				tcp_hdr->cksum = rte_ipv4_udptcp_cksum(dp_get_ipv4_hdr(m), tcp_hdr);
+			else
+				tcp_hdr->cksum = rte_ipv6_udptcp_cksum(dp_get_ipv6_hdr(m), tcp_hdr);
+			DP_STATS_MTU_INC_MSS_CLAMPED_CNT(dp_get_in_port(m));
+			return;
+		}
+		opt += opt[1];
+	}
+}
+
 int dp_cntrack_handle(struct rte_mbuf *m, struct dp_flow *df)
 {
 	struct flow_value *flow_val;
@@ -285,19 +535,27 @@ int dp_cntrack_handle(struct rte_mbuf *m, struct dp_flow *df)
 		return ret;
 
 	flow_val->timestamp = rte_rdtsc();
+	flow_val->counters[df->flow_dir].packets++;
+	flow_val->counters[df->flow_dir].bytes += rte_pktmbuf_pkt_len(m);
 
 	if (df->l4_type == IPPROTO_TCP && df->vnf_type != DP_VNF_TYPE_LB) {
-		if (df->l3_type == RTE_ETHER_TYPE_IPV4)
-			tcp_hdr = (struct rte_tcp_hdr *)(dp_get_ipv4_hdr(m) + 1);
-		else if (df->l3_type == RTE_ETHER_TYPE_IPV6)
-			tcp_hdr = (struct rte_tcp_hdr *)(dp_get_ipv6_hdr(m) + 1);
-		else
+		tcp_hdr = dp_cntrack_get_tcp_hdr(m, df);
+		if (!tcp_hdr) {
+			dp_set_drop_reason(m, DP_DROP_REASON_INVALID_PACKET);
 			return DP_ERROR;
+		}
 		dp_cntrack_tcp_state(flow_val, tcp_hdr);
+		if (mss_clamp_enabled && DP_TCP_PKT_FLAG_SYN(tcp_hdr->tcp_flags) && rte_pktmbuf_is_contiguous(m))
+			dp_cntrack_clamp_mss(m, df, tcp_hdr);
+		if (flow_val->half_open)
+			dp_cntrack_update_half_open(flow_val);
 		dp_cntrack_set_timeout_tcp_flow(m, flow_val, df);
 	}
 	df->conntrack = flow_val;
 	dp_cntrack_set_pkt_offload_decision(df);
 
+	if (dp_get_in_port(m)->is_pf && !df->decap_cached)
+		dp_cntrack_update_decap_cache(df);
+
 	return DP_OK;
 }
@@ -5,6 +5,7 @@
 
 #include <stddef.h>
 #include <getopt.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -13,7 +14,10 @@
 
 #include "dp_error.h"
 #include "dp_flow.h"
+#include "dp_lb.h"
 #include "dp_log.h"
+#include "dp_nat.h"
+#include "dp_util.h"
 #include "dp_version.h"
 #include "nodes/common_node.h"  // graphtrace level limit
 #include "dpdk_layer.h"  // underlay conf struct
@@ -37,6 +41,7 @@ static struct dp_conf_dhcp_dns dhcpv6_dns = {0};
 #ifdef ENABLE_VIRTSVC
 static struct dp_conf_virtual_services virtual_services = {0};
 #endif
+static struct dp_conf_ipfix_collector ipfix_collector = {0};
 
 int dp_conf_is_wcmp_enabled(void)
 {
@@ -75,6 +80,11 @@ const struct dp_conf_virtual_services *dp_conf_get_virtual_services(void)
 }
 #endif
 
+const struct dp_conf_ipfix_collector *dp_conf_get_ipfix_collector(void)
+{
+	return &ipfix_collector;
+}
+
 static int add_dhcpv6_dns(const char *str)
 {
 	struct in6_addr addr6;
@@ -228,6 +238,50 @@ static int add_virtsvc(uint8_t proto, const char *str)
 }
 #endif
 
+static int set_ipfix_collector(const char *str)
+{
+	struct sockaddr_in *addr4 = (struct sockaddr_in *)&ipfix_collector.addr;
+	struct sockaddr_in6 *addr6 = (struct sockaddr_in6 *)&ipfix_collector.addr;
+	unsigned long longport;
+	char parse_str[INET6_ADDRSTRLEN + sizeof(",65535")];
+	char *tok;
+	char *endptr;
+
+	// strtok() is destructive, make a copy
+	snprintf(parse_str, sizeof(parse_str), "%s", str);
+
+	tok = strtok(parse_str, ",");
+	if (!tok) {
+		DP_EARLY_ERR("Missing IPFIX collector address");
+		return DP_ERROR;
+	}
+	memset(&ipfix_collector, 0, sizeof(ipfix_collector));
+	if (inet_pton(AF_INET, tok, &addr4->sin_addr) == 1) {
+		addr4->sin_family = AF_INET;
+		ipfix_collector.addrlen = sizeof(*addr4);
+	} else if (inet_pton(AF_INET6, tok, &addr6->sin6_addr) == 1) {
+		addr6->sin6_family = AF_INET6;
+		ipfix_collector.addrlen = sizeof(*addr6);
+	} else {
+		DP_EARLY_ERR("Invalid IPFIX collector address '%s'", tok);
+		return DP_ERROR;
+	}
+
+	tok = strtok(NULL, ",");
+	if (!tok) {
+		DP_EARLY_ERR("Missing IPFIX collector port");
+		return DP_ERROR;
+	}
+	longport = strtoul(tok, &endptr, 10);
+	if (!*tok || *endptr || !longport || longport > UINT16_MAX) {
+		DP_EARLY_ERR("Invalid IPFIX collector port '%s'", tok);
+		return DP_ERROR;
+	}
+	// port is at the same offset for both families
+	addr4->sin_port = htons((uint16_t)longport);
+	return DP_OK;
+}
+
 static const struct option *get_opt_by_name(const char *name)
 {
 	const struct option *longopt;
@@ -366,3 +420,8 @@ static int dp_argparse_opt_tcp_virtsvc(const char *arg)
 	return add_virtsvc(IPPROTO_TCP, arg);
 }
 #endif
+
+static int dp_argparse_opt_ipfix_collector(const char *arg)
+{
+	return set_ipfix_collector(arg);
+}
@@ -23,6 +23,10 @@ _OPT_SHOPT_MAX = 255,
 	OPT_IPV6,
 	OPT_VF_PATTERN,
 	OPT_DHCP_MTU,
+	OPT_UNDERLAY_MTU,
+	OPT_ICMP_ERROR_RATE_LIMIT,
+	OPT_ENABLE_MSS_CLAMP,
+	OPT_ENABLE_GRO,
 	OPT_DHCP_DNS,
 	OPT_DHCPV6_DNS,
 #ifdef ENABLE_VIRTSVC
@@ -40,12 +44,32 @@ _OPT_SHOPT_MAX = 255,
 #ifdef ENABLE_PYTEST
 	OPT_GRAPHTRACE_LOGLEVEL,
 #endif
+	OPT_LATENCY_SAMPLING,
+	OPT_IDLE_POLL,
+	OPT_IDLE_SLEEP_MAX,
 	OPT_COLOR,
 	OPT_LOG_FORMAT,
+	OPT_LOG_RATE_LIMIT,
 	OPT_GRPC_PORT,
+	OPT_FLOW_TABLE_SIZE,
+	OPT_FLOW_TABLE_MAX_SIZE,
+	OPT_NAT_TABLE_SIZE,
+	OPT_LB_TABLE_SIZE,
+	OPT_VNF_TABLE_SIZE,
+	OPT_FRAG_TABLE_SIZE,
+	OPT_FRAG_TIMEOUT,
+	OPT_FLOW_LIMIT,
+	OPT_FLOW_RATE_LIMIT,
+	OPT_FLOW_LIMIT_POLICY,
+	OPT_SYN_LIMIT,
 #ifdef ENABLE_PYTEST
 	OPT_FLOW_TIMEOUT,
 #endif
+#ifdef ENABLE_PYTEST
+	OPT_NO_TX_CKSUM_OFFLOAD,
+#endif
+	OPT_IPFIX_COLLECTOR,
+	OPT_IPFIX_FILE,
 };
 
 #define OPTSTRING ":hv" \
@@ -58,6 +82,10 @@ static const struct option dp_conf_longopts[] = {
 	{ "ipv6", 1, 0, OPT_IPV6 },
 	{ "vf-pattern", 1, 0, OPT_VF_PATTERN },
 	{ "dhcp-mtu", 1, 0, OPT_DHCP_MTU },
+	{ "underlay-mtu", 1, 0, OPT_UNDERLAY_MTU },
+	{ "icmp-error-rate-limit", 1, 0, OPT_ICMP_ERROR_RATE_LIMIT },
+	{ "enable-mss-clamp", 0, 0, OPT_ENABLE_MSS_CLAMP },
+	{ "enable-gro", 0, 0, OPT_ENABLE_GRO },
 	{ "dhcp-dns", 1, 0, OPT_DHCP_DNS },
 	{ "dhcpv6-dns", 1, 0, OPT_DHCPV6_DNS },
 #ifdef ENABLE_VIRTSVC
@@ -75,12 +103,32 @@ static const struct option dp_conf_longopts[] = {
 #ifdef ENABLE_PYTEST
 	{ "graphtrace-loglevel", 1, 0, OPT_GRAPHTRACE_LOGLEVEL },
 #endif
+	{ "latency-sampling", 1, 0, OPT_LATENCY_SAMPLING },
+	{ "idle-poll", 1, 0, OPT_IDLE_POLL },
+	{ "idle-sleep-max", 1, 0, OPT_IDLE_SLEEP_MAX },
 	{ "color", 1, 0, OPT_COLOR },
 	{ "log-format", 1, 0, OPT_LOG_FORMAT },
+	{ "log-rate-limit", 1, 0, OPT_LOG_RATE_LIMIT },
 	{ "grpc-port", 1, 0, OPT_GRPC_PORT },
+	{ "flow-table-size", 1, 0, OPT_FLOW_TABLE_SIZE },
+	{ "flow-table-max-size", 1, 0, OPT_FLOW_TABLE_MAX_SIZE },
+	{ "nat-table-size", 1, 0, OPT_NAT_TABLE_SIZE },
+	{ "lb-table-size", 1, 0, OPT_LB_TABLE_SIZE },
+	{ "vnf-table-size", 1, 0, OPT_VNF_TABLE_SIZE },
+	{ "frag-table-size", 1, 0, OPT_FRAG_TABLE_SIZE },
+	{ "frag-timeout", 1, 0, OPT_FRAG_TIMEOUT },
+	{ "flow-limit", 1, 0, OPT_FLOW_LIMIT },
+	{ "flow-rate-limit", 1, 0, OPT_FLOW_RATE_LIMIT },
+	{ "flow-limit-policy", 1, 0, OPT_FLOW_LIMIT_POLICY },
+	{ "syn-limit", 1, 0, OPT_SYN_LIMIT },
 #ifdef ENABLE_PYTEST
 	{ "flow-timeout", 1, 0, OPT_FLOW_TIMEOUT },
 #endif
+#ifdef ENABLE_PYTEST
+	{ "no-tx-cksum-offload", 0, 0, OPT_NO_TX_CKSUM_OFFLOAD },
+#endif
+	{ "ipfix-collector", 1, 0, OPT_IPFIX_COLLECTOR },
+	{ "ipfix-file", 1, 0, OPT_IPFIX_FILE },
 	{ NULL, 0, 0, 0 }
 };
 
@@ -90,6 +138,11 @@ static const char *nic_type_choices[] = {
 	"bluefield2",
 };
 
+static const char *idle_poll_choices[] = {
+	"busy",
+	"adaptive",
+};
+
 static const char *color_choices[] = {
 	"never",
 	"always",
@@ -101,10 +154,19 @@ static const char *log_format_choices[] = {
 	"json",
 };
 
+static const char *flow_limit_policy_choices[] = {
+	"drop",
+	"monitor",
+};
+
 static char pf0_name[IF_NAMESIZE];
 static char pf1_name[IF_NAMESIZE];
 static char vf_pattern[IF_NAMESIZE];
 static int dhcp_mtu = 1500;
+static int underlay_mtu = 0;
+static int icmp_error_rate_limit = 100;
+static bool mss_clamp_enabled = false;
+static bool gro_enabled = false;
 static int wcmp_perc = 100;
 static enum dp_conf_nic_type nic_type = DP_CONF_NIC_TYPE_MELLANOX;
 static bool stats_enabled = true;
@@ -114,12 +176,31 @@ static bool offload_enabled = true;
 #ifdef ENABLE_PYTEST
 static int graphtrace_loglevel = 0;
 #endif
+static int latency_sampling = 0;
+static enum dp_conf_idle_poll idle_poll = DP_CONF_IDLE_POLL_BUSY;
+static int idle_sleep_max = 100;
 static enum dp_conf_color color = DP_CONF_COLOR_NEVER;
 static enum dp_conf_log_format log_format = DP_CONF_LOG_FORMAT_TEXT;
+static int log_rate_limit = 100;
 static int grpc_port = 1337;
+static int flow_table_size = DP_FLOW_TABLE_MAX;
+static int flow_table_max_size = 0;
+static int nat_table_size = DP_NAT_TABLE_MAX;
+static int lb_table_size = DP_LB_TABLE_MAX;
+static int vnf_table_size = DP_VNF_TABLE_MAX;
+static int frag_table_size = 1024;
+static int frag_timeout = 2000;
+static int flow_limit = 0;
+static int flow_rate_limit = 0;
+static enum dp_conf_flow_limit_policy flow_limit_policy = DP_CONF_FLOW_LIMIT_POLICY_DROP;
+static int syn_limit = 0;
 #ifdef ENABLE_PYTEST
 static int flow_timeout = DP_FLOW_DEFAULT_TIMEOUT;
 #endif
+#ifdef ENABLE_PYTEST
+static bool tx_cksum_offload_enabled = true;
+#endif
+static char ipfix_file[PATH_MAX];
 
 const char *dp_conf_get_pf0_name(void)
 {
@@ -141,6 +222,26 @@ int dp_conf_get_dhcp_mtu(void)
 	return dhcp_mtu;
 }
 
+int dp_conf_get_underlay_mtu(void)
+{
+	return underlay_mtu;
+}
+
+int dp_conf_get_icmp_error_rate_limit(void)
+{
+	return icmp_error_rate_limit;
+}
+
+bool dp_conf_is_mss_clamp_enabled(void)
+{
+	return mss_clamp_enabled;
+}
+
+bool dp_conf_is_gro_enabled(void)
+{
+	return gro_enabled;
+}
+
 int dp_conf_get_wcmp_perc(void)
 {
 	return wcmp_perc;
@@ -178,6 +279,21 @@ int dp_conf_get_graphtrace_loglevel(void)
 }
 
 #endif
+int dp_conf_get_latency_sampling(void)
+{
+	return latency_sampling;
+}
+
+enum dp_conf_idle_poll dp_conf_get_idle_poll(void)
+{
+	return idle_poll;
+}
+
+int dp_conf_get_idle_sleep_max(void)
+{
+	return idle_sleep_max;
+}
+
 enum dp_conf_color dp_conf_get_color(void)
 {
 	return color;
@@ -188,11 +304,71 @@ enum dp_conf_log_format dp_conf_get_log_format(void)
 	return log_format;
 }
 
+int dp_conf_get_log_rate_limit(void)
+{
+	return log_rate_limit;
+}
+
 int dp_conf_get_grpc_port(void)
 {
 	return grpc_port;
 }
 
+int dp_conf_get_flow_table_size(void)
+{
+	return flow_table_size;
+}
+
+int dp_conf_get_flow_table_max_size(void)
+{
+	return flow_table_max_size;
+}
+
+int dp_conf_get_nat_table_size(void)
+{
+	return nat_table_size;
+}
+
+int dp_conf_get_lb_table_size(void)
+{
+	return lb_table_size;
+}
+
+int dp_conf_get_vnf_table_size(void)
+{
+	return vnf_table_size;
+}
+
+int dp_conf_get_frag_table_size(void)
+{
+	return frag_table_size;
+}
+
+int dp_conf_get_frag_timeout(void)
+{
+	return frag_timeout;
+}
+
+int dp_conf_get_flow_limit(void)
+{
+	return flow_limit;
+}
+
+int dp_conf_get_flow_rate_limit(void)
+{
+	return flow_rate_limit;
+}
+
+enum dp_conf_flow_limit_policy dp_conf_get_flow_limit_policy(void)
+{
+	return flow_limit_policy;
+}
+
+int dp_conf_get_syn_limit(void)
+{
+	return syn_limit;
+}
+
 #ifdef ENABLE_PYTEST
 int dp_conf_get_flow_timeout(void)
 {
@@ -200,6 +376,18 @@ int dp_conf_get_flow_timeout(void)
 }
 
 #endif
+#ifdef ENABLE_PYTEST
+bool dp_conf_is_tx_cksum_offload_enabled(void)
+{
+	return tx_cksum_offload_enabled;
+}
+
+#endif
+const char *dp_conf_get_ipfix_file(void)
+{
+	return ipfix_file;
+}
+
 
 
 /* These functions need to be implemented by the user of this generated code */
@@ -213,6 +401,7 @@ static int dp_argparse_opt_udp_virtsvc(const char *arg);
 #ifdef ENABLE_VIRTSVC
 static int dp_argparse_opt_tcp_virtsvc(const char *arg);
 #endif
+static int dp_argparse_opt_ipfix_collector(const char *arg);
 
 
 static inline void dp_argparse_help(const char *progname, FILE *outfile)
@@ -225,6 +414,10 @@ static inline void dp_argparse_help(const char *progname, FILE *outfile)
 		"     --ipv6=ADDR6                       IPv6 underlay address\n"
 		"     --vf-pattern=PATTERN               virtual interface name pattern (e.g. 'eth1vf')\n"
 		"     --dhcp-mtu=SIZE                    set the mtu field in DHCP responses (68 - 1500)\n"
+		"     --underlay-mtu=SIZE                MTU of the underlay network if lower than the uplink MTU (0 = use uplink MTU)\n"
+		"     --icmp-error-rate-limit=RATE       maximum number of ICMP 'fragmentation needed'/'packet too big' messages per second per interface (0 = unlimited)\n"
+		"     --enable-mss-clamp                 clamp TCP MSS in SYN packets to fit into the underlay and interface MTU\n"
+		"     --enable-gro                       merge TCP/IPv4 segments received from VMs and split them again on Tx (software GRO/GSO, meant for TAP and virtio ports)\n"
 		"     --dhcp-dns=IPv4                    set the domain name server field in DHCP responses (can be used multiple times)\n"
 		"     --dhcpv6-dns=ADDR6                 set the domain name server field in DHCPv6 responses (can be used multiple times)\n"
 #ifdef ENABLE_VIRTSVC
@@ -242,12 +435,32 @@ static inline void dp_argparse_help(const char *progname, FILE *outfile)
 #ifdef ENABLE_PYTEST
 		"     --graphtrace-loglevel=LEVEL        verbosity level of packet traversing the graph framework\n"
 #endif
+		"     --latency-sampling=N               collect latency histograms of every N-th graph walk and of control handlers (0 = disabled)\n"
+		"     --idle-poll=MODE                   how the worker polls when there is no traffic ('adaptive' backs off to CPU-friendly waiting): 'busy' (default) or 'adaptive'\n"
+		"     --idle-sleep-max=USECS             longest single wait of an idle worker in adaptive polling mode (bounds the wake-up latency)\n"
 		"     --color=MODE                       output colorization mode: 'never' (default), 'always' or 'auto'\n"
 		"     --log-format=FORMAT                set the format of individual log lines (on standard output): 'text' (default) or 'json'\n"
+		"     --log-rate-limit=COUNT             maximum number of messages per second logged from a single place in code (0 = unlimited)\n"
 		"     --grpc-port=PORT                   listen for gRPC clients on this port\n"
+		"     --flow-table-size=COUNT            initial capacity of the connection tracking table\n"
+		"     --flow-table-max-size=COUNT        let the connection tracking table grow up to this capacity at runtime (0 = fixed size)\n"
+		"     --nat-table-size=COUNT             capacity of the VIP/NAT tables\n"
+		"     --lb-table-size=COUNT              capacity of the loadbalancer tables\n"
+		"     --vnf-table-size=COUNT             capacity of the VNF (underlay address) tables\n"
+		"     --frag-table-size=COUNT            maximum number of IP packets being reassembled from fragments at the same time\n"
+		"     --frag-timeout=MSECS               time to wait for all fragments of an IP packet before dropping them\n"
+		"     --flow-limit=COUNT                 maximum number of tracked flows per interface (0 = unlimited)\n"
+		"     --flow-rate-limit=RATE             maximum number of new flows per second per interface (0 = unlimited)\n"
+		"     --flow-limit-policy=POLICY         action to take on new flows over the interface limits: 'drop' (default) or 'monitor'\n"
+		"     --syn-limit=COUNT                  maximum number of half-open incoming TCP connections per interface (0 = no SYN flood protection)\n"
 #ifdef ENABLE_PYTEST
 		"     --flow-timeout=SECONDS             inactive flow timeout (except TCP established flows)\n"
 #endif
+#ifdef ENABLE_PYTEST
+		"     --no-tx-cksum-offload              compute all Tx checksums in software as if ports could not offload them\n"
+#endif
+		"     --ipfix-collector=ADDR,PORT        export finished flows as IPFIX records to this UDP collector (IPv4 or IPv6 address)\n"
+		"     --ipfix-file=PATH                  append finished flows as IPFIX records to this file\n"
 	, progname);
 }
 
@@ -265,6 +478,14 @@ static int dp_conf_parse_arg(int opt, const char *arg)
 		return dp_argparse_string(arg, vf_pattern, ARRAY_SIZE(vf_pattern));
 	case OPT_DHCP_MTU:
 		return dp_argparse_int(arg, &dhcp_mtu, 68, 1500);
+	case OPT_UNDERLAY_MTU:
+		return dp_argparse_int(arg, &underlay_mtu, 0, 9216);
+	case OPT_ICMP_ERROR_RATE_LIMIT:
+		return dp_argparse_int(arg, &icmp_error_rate_limit, 0, 65535);
+	case OPT_ENABLE_MSS_CLAMP:
+		return dp_argparse_store_true(&mss_clamp_enabled);
+	case OPT_ENABLE_GRO:
+		return dp_argparse_store_true(&gro_enabled);
 	case OPT_DHCP_DNS:
 		return dp_argparse_opt_dhcp_dns(arg);
 	case OPT_DHCPV6_DNS:
@@ -293,16 +514,54 @@ static int dp_conf_parse_arg(int opt, const char *arg)
 	case OPT_GRAPHTRACE_LOGLEVEL:
 		return dp_argparse_int(arg, &graphtrace_loglevel, 0, DP_GRAPHTRACE_LOGLEVEL_MAX);
 #endif
+	case OPT_LATENCY_SAMPLING:
+		return dp_argparse_int(arg, &latency_sampling, 0, 1000000);
+	case OPT_IDLE_POLL:
+		return dp_argparse_enum(arg, (int *)&idle_poll, idle_poll_choices, ARRAY_SIZE(idle_poll_choices));
+	case OPT_IDLE_SLEEP_MAX:
+		return dp_argparse_int(arg, &idle_sleep_max, 1, 100000);
 	case OPT_COLOR:
 		return dp_argparse_enum(arg, (int *)&color, color_choices, ARRAY_SIZE(color_choices));
 	case OPT_LOG_FORMAT:
 		return dp_argparse_enum(arg, (int *)&log_format, log_format_choices, ARRAY_SIZE(log_format_choices));
+	case OPT_LOG_RATE_LIMIT:
+		return dp_argparse_int(arg, &log_rate_limit, 0, 1000000);
 	case OPT_GRPC_PORT:
 		return dp_argparse_int(arg, &grpc_port, 1024, 65535);
+	case OPT_FLOW_TABLE_SIZE:
+		return dp_argparse_int(arg, &flow_table_size, 1, DP_TABLE_SIZE_LIMIT);
+	case OPT_FLOW_TABLE_MAX_SIZE:
+		return dp_argparse_int(arg, &flow_table_max_size, 0, DP_TABLE_SIZE_LIMIT);
+	case OPT_NAT_TABLE_SIZE:
+		return dp_argparse_int(arg, &nat_table_size, 1, DP_TABLE_SIZE_LIMIT);
+	case OPT_LB_TABLE_SIZE:
+		return dp_argparse_int(arg, &lb_table_size, 1, DP_TABLE_SIZE_LIMIT);
+	case OPT_VNF_TABLE_SIZE:
+		return dp_argparse_int(arg, &vnf_table_size, 1, DP_TABLE_SIZE_LIMIT);
+	case OPT_FRAG_TABLE_SIZE:
+		return dp_argparse_int(arg, &frag_table_size, 1, 65536);
+	case OPT_FRAG_TIMEOUT:
+		return dp_argparse_int(arg, &frag_timeout, 1, 60000);
+	case OPT_FLOW_LIMIT:
+		return dp_argparse_int(arg, &flow_limit, 0, DP_TABLE_SIZE_LIMIT);
+	case OPT_FLOW_RATE_LIMIT:
+		return dp_argparse_int(arg, &flow_rate_limit, 0, DP_TABLE_SIZE_LIMIT);
+	case OPT_FLOW_LIMIT_POLICY:
+		return dp_argparse_enum(arg, (int *)&flow_limit_policy, flow_limit_policy_choices, ARRAY_SIZE(flow_limit_policy_choices));
+	case OPT_SYN_LIMIT:
+		return dp_argparse_int(arg, &syn_limit, 0, DP_TABLE_SIZE_LIMIT);
 #ifdef ENABLE_PYTEST
 	case OPT_FLOW_TIMEOUT:
 		return dp_argparse_int(arg, &flow_timeout, 1, 300);
 #endif
+#ifdef ENABLE_PYTEST
+	case OPT_NO_TX_CKSUM_OFFLOAD:
+		return dp_argparse_store_false(&tx_cksum_offload_enabled);
+#endif
+	case OPT_IPFIX_COLLECTOR:
+		return dp_argparse_opt_ipfix_collector(arg);
+	case OPT_IPFIX_FILE:
+		return dp_argparse_string(arg, ipfix_file, ARRAY_SIZE(ipfix_file));
 	default:
 		fprintf(stderr, "Unimplemented option %d\n", opt);
 		return DP_ERROR;
@@ -0,0 +1,9 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dp_decap_cache.h"
+
+struct dp_decap_cache_entry _dp_decap_cache[DP_DECAP_CACHE_SIZE];
+
+// zeroed entries must never be valid
+uint64_t _dp_decap_cache_generation = 1;
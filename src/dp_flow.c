@@ -7,7 +7,9 @@
 
 #include "dp_cntrack.h"
 #include "dp_conf.h"
+#include "dp_decap_cache.h"
 #include "dp_error.h"
+#include "dp_internal_stats.h"
 #include "dp_log.h"
 #include "dp_lpm.h"
 #include "dp_nat.h"
@@ -17,16 +19,65 @@
 #include "protocols/dp_icmpv6.h"
 #include "rte_flow/dp_rte_flow.h"
 #include "dp_timers.h"
+#include "monitoring/dp_ipfix.h"
 #include "dp_error.h"
 
 #include "rte_flow/dp_rte_flow_traffic_forward.h"
 
+// how full the flow table can get before a bigger one is requested (in percent)
+#define DP_FLOW_TABLE_GROW_THRESHOLD	75
+// how many flows are migrated to the bigger table with every new flow
+#define DP_FLOW_TABLE_MIGRATE_BATCH		32
+// how many flows are migrated to the bigger table during periodic flow aging
+#define DP_FLOW_TABLE_MIGRATE_AGING_BATCH	8192
+
+struct dp_flow_tbl_iter {
+	struct rte_hash *table;
+	uint32_t pos;
+};
+
 static struct rte_hash *ipv4_flow_tbl = NULL;
 static bool offload_mode_enabled = 0;
 
+// Online growth of the flow table:
+//  - the worker requests a bigger table once the occupancy threshold is reached
+//  - the main core allocates it, so forwarding is not stalled by a big allocation
+//  - the worker switches to the new table and migrates old entries in small batches,
+//    while both tables are being used for lookups
+static struct rte_hash *ipv4_flow_tbl_prev = NULL;
+static uint32_t flow_tbl_prev_pos = 0;
+static struct rte_hash *ipv4_flow_tbl_next = NULL;  // written by the main core
+static uint32_t flow_tbl_requested_size = 0;  // written by the worker
+static uint32_t flow_tbl_size;
+static uint32_t flow_tbl_max_size;
+static uint32_t flow_tbl_grow_threshold;
+static uint32_t flow_tbl_used = 0;
+static uint64_t flow_tbl_migrate_failed = 0;
+static int flow_tbl_socket_id;
+
+// allocated flow values, a flow value can be referenced by up to two table entries
+uint32_t _dp_flow_values_used = 0;
+
+static __rte_always_inline void dp_remove_flow(struct flow_value *flow_val);
+
+static __rte_always_inline uint32_t dp_flow_tbl_threshold(uint32_t size)
+{
+	return (uint32_t)((uint64_t)size * DP_FLOW_TABLE_GROW_THRESHOLD / 100);
+}
+
 int dp_flow_init(int socket_id)
 {
-	ipv4_flow_tbl = dp_create_jhash_table(DP_FLOW_TABLE_MAX, sizeof(struct flow_key),
+	flow_tbl_size = (uint32_t)dp_conf_get_flow_table_size();
+	flow_tbl_max_size = (uint32_t)dp_conf_get_flow_table_max_size();
+	if (flow_tbl_max_size && flow_tbl_max_size < flow_tbl_size) {
+		DPS_LOG_ERR("Flow table maximum size is smaller than the initial size",
+					DP_LOG_VALUE(flow_tbl_size), DP_LOG_MAX(flow_tbl_max_size));
+		return DP_ERROR;
+	}
+	flow_tbl_grow_threshold = dp_flow_tbl_threshold(flow_tbl_size);
+	flow_tbl_socket_id = socket_id;
+
+	ipv4_flow_tbl = dp_create_jhash_table((int)flow_tbl_size, sizeof(struct flow_key),
 										  "ipv4_flow_table", socket_id);
 	if (!ipv4_flow_tbl)
 		return DP_ERROR;
@@ -38,9 +89,139 @@ int dp_flow_init(int socket_id)
 
 void dp_flow_free(void)
 {
+	dp_free_jhash_table(__atomic_exchange_n(&ipv4_flow_tbl_next, NULL, __ATOMIC_ACQ_REL));
+	dp_free_jhash_table(ipv4_flow_tbl_prev);
 	dp_free_jhash_table(ipv4_flow_tbl);
 }
 
+void dp_flow_prepare_table_growth(void)
+{
+	static uint32_t prepared_size = 0;
+	uint32_t size = __atomic_load_n(&flow_tbl_requested_size, __ATOMIC_ACQUIRE);
+	struct rte_hash *table;
+	char name[RTE_HASH_NAMESIZE];
+
+	// sizes are always growing, thus this also prevents preparing the same table twice
+	if (size <= prepared_size)
+		return;
+
+	snprintf(name, sizeof(name), "ipv4_flow_table_%u", size);
+	table = dp_create_jhash_table((int)size, sizeof(struct flow_key), name, flow_tbl_socket_id);
+	if (!table)
+		return;
+
+	prepared_size = size;
+	DPS_LOG_INFO("Prepared a bigger flow table", DP_LOG_VALUE(size));
+	__atomic_store_n(&ipv4_flow_tbl_next, table, __ATOMIC_RELEASE);
+}
+
+static void dp_flow_tbl_finish_migration(void)
+{
+	dp_free_jhash_table(ipv4_flow_tbl_prev);
+	ipv4_flow_tbl_prev = NULL;
+}
+
+// Flows that cannot be moved to the bigger table are removed, otherwise the previous table would never be freed;
+// this can only be done during flow aging, packets currently being processed can still be using the flow
+static void dp_flow_tbl_migrate(uint32_t count, bool remove_failed)
+{
+	const struct flow_key *key;
+	struct flow_value *flow_val;
+	uint32_t pos;
+	int ret;
+
+	while (count--) {
+		pos = flow_tbl_prev_pos;
+		ret = rte_hash_iterate(ipv4_flow_tbl_prev, (const void **)&key, (void **)&flow_val, &pos);
+		if (ret == -ENOENT) {
+			// removed flows can still be referenced (e.g. by offloading), their keys go away once they are freed
+			if (rte_hash_count(ipv4_flow_tbl_prev) > 0) {
+				flow_tbl_prev_pos = 0;
+				return;
+			}
+			dp_flow_tbl_finish_migration();
+			DPS_LOG_INFO("Flow table migration finished", DP_LOG_VALUE(flow_tbl_size));
+			return;
+		}
+		if (DP_FAILED(ret)) {
+			// the table cannot be walked at all, flows still in it are lost
+			flow_tbl_migrate_failed += (uint32_t)rte_hash_count(ipv4_flow_tbl_prev);
+			dp_flow_tbl_finish_migration();
+			DPS_LOG_ERR("Iterating flow table failed while migrating flows, abandoning the previous table", DP_LOG_RET(ret));
+			return;
+		}
+		ret = rte_hash_add_key_data(ipv4_flow_tbl, key, flow_val);
+		if (DP_FAILED(ret)) {
+			// retried during the next flow aging
+			if (!remove_failed)
+				return;
+			flow_tbl_prev_pos = pos;
+			// already removed flows stay in the previous table until freed
+			if (flow_val->aged)
+				continue;
+			DPS_LOG_WARNING("Cannot migrate flow to a bigger flow table, removing it", DP_LOG_RET(ret));
+			flow_tbl_migrate_failed++;
+			// both keys of the flow are deleted from whichever table holds them once the flow is freed
+			dp_remove_flow(flow_val);
+			continue;
+		}
+		// the key lives in the previous table, thus it can only be removed after being copied
+		ret = rte_hash_del_key(ipv4_flow_tbl_prev, key);
+		if (DP_FAILED(ret))
+			DPS_LOG_WARNING("Cannot remove migrated flow from the previous flow table", DP_LOG_RET(ret));
+		flow_tbl_prev_pos = pos;
+	}
+}
+
+static void dp_flow_tbl_maintain(uint32_t migrate_count, bool remove_failed)
+{
+	struct rte_hash *next;
+
+	if (unlikely(ipv4_flow_tbl_prev)) {
+		dp_flow_tbl_migrate(migrate_count, remove_failed);
+	} else if (unlikely(flow_tbl_requested_size > flow_tbl_size)) {
+		next = __atomic_exchange_n(&ipv4_flow_tbl_next, NULL, __ATOMIC_ACQ_REL);
+		if (next) {
+			ipv4_flow_tbl_prev = ipv4_flow_tbl;
+			flow_tbl_prev_pos = 0;
+			ipv4_flow_tbl = next;
+			flow_tbl_size = flow_tbl_requested_size;
+			flow_tbl_grow_threshold = dp_flow_tbl_threshold(flow_tbl_size);
+			DPS_LOG_INFO("Switched to a bigger flow table", DP_LOG_VALUE(flow_tbl_size));
+		}
+	} else if (unlikely(flow_tbl_size < flow_tbl_max_size && (uint32_t)rte_hash_count(ipv4_flow_tbl) >= flow_tbl_grow_threshold)) {
+		__atomic_store_n(&flow_tbl_requested_size, RTE_MIN(flow_tbl_size * 2, flow_tbl_max_size), __ATOMIC_RELEASE);
+	}
+}
+
+static __rte_always_inline void dp_flow_tbl_iter_init(struct dp_flow_tbl_iter *iter)
+{
+	iter->table = ipv4_flow_tbl_prev ? ipv4_flow_tbl_prev : ipv4_flow_tbl;
+	iter->pos = 0;
+}
+
+static __rte_always_inline int dp_flow_tbl_iterate(struct dp_flow_tbl_iter *iter, const void **key, void **data)
+{
+	int ret = rte_hash_iterate(iter->table, key, data, &iter->pos);
+
+	// during migration, the previous table is iterated first
+	if (ret == -ENOENT && iter->table != ipv4_flow_tbl) {
+		iter->table = ipv4_flow_tbl;
+		iter->pos = 0;
+		ret = rte_hash_iterate(iter->table, key, data, &iter->pos);
+	}
+	return ret;
+}
+
+int dp_flow_get_tables_telemetry(struct rte_tel_data *dict)
+{
+	// the worker updates the usage during flow aging, tables themselves can change at any time
+	if (DP_FAILED(dp_add_growing_table_telemetry(dict, "ipv4_flow_table", flow_tbl_used, flow_tbl_size, flow_tbl_migrate_failed))
+		|| DP_FAILED(dp_add_table_telemetry(dict, "flow_values", _dp_flow_values_used, flow_tbl_size / 2)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
 static inline void dp_flow_log_key(const struct flow_key *key, const char *message)
 {
 	char src_ip[INET6_ADDRSTRLEN];
@@ -216,6 +397,8 @@ static void dp_delete_flow_no_flush(const struct flow_key *key)
 	int ret;
 
 	ret = rte_hash_del_key(ipv4_flow_tbl, key);
+	if (unlikely(ret == -ENOENT && ipv4_flow_tbl_prev))
+		ret = rte_hash_del_key(ipv4_flow_tbl_prev, key);
 	if (DP_FAILED(ret)) {
 		if (ret == -ENOENT)
 			dp_flow_log_key(key, "Attempt to delete a non-existing hash key");
@@ -244,6 +427,7 @@ int dp_add_flow(const struct flow_key *key, struct flow_value *flow_val)
 		DPS_LOG_ERR("Cannot add data to flow table", DP_LOG_RET(ret));
 		return ret;
 	}
+	dp_flow_tbl_maintain(DP_FLOW_TABLE_MIGRATE_BATCH, false);
 	return DP_OK;
 }
 
@@ -251,6 +435,9 @@ int dp_get_flow(const struct flow_key *key, struct flow_value **p_flow_val)
 {
 	int ret = rte_hash_lookup_data(ipv4_flow_tbl, key, (void **)p_flow_val);
 
+	if (unlikely(ret == -ENOENT && ipv4_flow_tbl_prev))
+		ret = rte_hash_lookup_data(ipv4_flow_tbl_prev, key, (void **)p_flow_val);
+
 #ifdef ENABLE_PYTEST
 	if (DP_FAILED(ret))
 		dp_flow_log_key(key, "Cannot find data in flow table");
@@ -264,12 +451,20 @@ void dp_free_flow(struct dp_ref *ref)
 {
 	struct flow_value *cntrack = container_of(ref, struct flow_value, ref_count);
 
+	if (dp_ipfix_is_enabled())
+		dp_ipfix_export_flow(cntrack);
+
 	dp_free_network_nat_port(cntrack);
+	dp_cntrack_release_flow(cntrack);
 	dp_delete_flow_no_flush(&cntrack->flow_key[DP_FLOW_DIR_ORG]);
 	dp_delete_flow_no_flush(&cntrack->flow_key[DP_FLOW_DIR_REPLY]);
 	dp_cntrack_flush_cache();
+	// decap cache entries point to flow values too
+	// (only freeing matters, reply keys are rewritten before any reply traffic can be cached)
+	dp_decap_cache_invalidate();
 
 	rte_free(cntrack);
+	_dp_flow_values_used--;
 }
 
 void dp_free_network_nat_port(const struct flow_value *cntrack)
@@ -286,6 +481,29 @@ void dp_free_network_nat_port(const struct flow_value *cntrack)
 	}
 }
 
+static void dp_query_rte_flow_counter(const struct flow_age_ctx *agectx)
+{
+	static const struct rte_flow_action count_action[] = {
+		{ .type = RTE_FLOW_ACTION_TYPE_COUNT },
+		{ .type = RTE_FLOW_ACTION_TYPE_END },
+	};
+	struct rte_flow_query_count count = {0};
+	struct rte_flow_error error;
+	int ret;
+
+	ret = rte_flow_query(agectx->port_id, agectx->rte_flow, count_action, &count, &error);
+	if (DP_FAILED(ret)) {
+		DPS_LOG_WARNING("Failed to query rte flow counter", DP_LOG_PORTID(agectx->port_id),
+						DP_LOG_FLOW_ERROR(error.message), DP_LOG_RET(ret));
+		return;
+	}
+
+	if (count.hits_set)
+		agectx->cntrack->counters[agectx->flow_dir].packets += count.hits;
+	if (count.bytes_set)
+		agectx->cntrack->counters[agectx->flow_dir].bytes += count.bytes;
+}
+
 int dp_destroy_rte_flow_agectx(struct flow_age_ctx *agectx)
 {
 	struct rte_flow_error error;
@@ -303,6 +521,9 @@ int dp_destroy_rte_flow_agectx(struct flow_age_ctx *agectx)
 	}
 
 	if (agectx->rte_flow) {
+		// offloaded packets never reach conntrack, collect them before the rule is gone
+		if (agectx->counted && agectx->cntrack)
+			dp_query_rte_flow_counter(agectx);
 		ret = rte_flow_destroy(agectx->port_id, agectx->rte_flow, &error);
 		if (DP_FAILED(ret))
 			DPS_LOG_WARNING("Failed to destroy rte flow", DP_LOG_PORTID(agectx->port_id),
@@ -399,22 +620,34 @@ static __rte_always_inline int dp_rte_flow_query_and_remove(struct flow_value *f
 
 }
 
-static __rte_always_inline void dp_age_out_flow(struct flow_value *flow_val)
+static __rte_always_inline void dp_age_out_flow(struct flow_value *flow_val, enum dp_flow_end_reason reason)
 {
+	if (!flow_val->aged)
+		flow_val->end_reason = reason;
 	flow_val->aged = 1;
 	dp_ref_dec(&flow_val->ref_count);
 }
 
+static __rte_always_inline enum dp_flow_end_reason dp_get_flow_end_reason(const struct flow_value *flow_val)
+{
+	if (flow_val->flow_key[DP_FLOW_DIR_ORG].proto == IPPROTO_TCP
+		&& (flow_val->l4_state.tcp_state == DP_FLOW_TCP_STATE_FINWAIT
+			|| flow_val->l4_state.tcp_state == DP_FLOW_TCP_STATE_RST_FIN))
+		return DP_FLOW_END_DETECTED;
+	return DP_FLOW_END_IDLE_TIMEOUT;
+}
+
 void dp_process_aged_flows_non_offload(void)
 {
 	struct flow_value *flow_val = NULL;
 	const struct flow_key *next_key;
-	uint32_t iter = 0;
+	struct dp_flow_tbl_iter iter;
 	uint64_t current_timestamp = rte_rdtsc();
 	uint64_t timer_hz = rte_get_timer_hz();
 	int	ret;
 
-	while ((ret = rte_hash_iterate(ipv4_flow_tbl, (const void **)&next_key, (void **)&flow_val, &iter)) != -ENOENT) {
+	dp_flow_tbl_iter_init(&iter);
+	while ((ret = dp_flow_tbl_iterate(&iter, (const void **)&next_key, (void **)&flow_val)) != -ENOENT) {
 		if (DP_FAILED(ret)) {
 			DPS_LOG_ERR("Iterating flow table failed while aging flows", DP_LOG_RET(ret));
 			return;
@@ -428,25 +661,33 @@ void dp_process_aged_flows_non_offload(void)
 		}
 
 		if (unlikely((current_timestamp - flow_val->timestamp) > timer_hz * flow_val->timeout_value) && (!flow_val->aged))
-			dp_age_out_flow(flow_val);
+			dp_age_out_flow(flow_val, dp_get_flow_end_reason(flow_val));
 	}
+
+	// make sure migration finishes even without new flows coming in
+	dp_flow_tbl_maintain(DP_FLOW_TABLE_MIGRATE_AGING_BATCH, true);
+
+	flow_tbl_used = (uint32_t)rte_hash_count(ipv4_flow_tbl);
+	if (ipv4_flow_tbl_prev)
+		flow_tbl_used += (uint32_t)rte_hash_count(ipv4_flow_tbl_prev);
 }
 
 static __rte_always_inline void dp_remove_flow(struct flow_value *flow_val)
 {
 	if (offload_mode_enabled)
 		dp_rte_flow_remove(flow_val);
-	dp_age_out_flow(flow_val);
+	dp_age_out_flow(flow_val, DP_FLOW_END_FORCED);
 }
 
 void dp_remove_nat_flows(uint16_t port_id, enum dp_flow_nat_type nat_type)
 {
 	struct flow_value *flow_val = NULL;
 	const void *next_key;
-	uint32_t iter = 0;
+	struct dp_flow_tbl_iter iter;
 	int ret;
 
-	while ((ret = rte_hash_iterate(ipv4_flow_tbl, &next_key, (void **)&flow_val, &iter)) != -ENOENT) {
+	dp_flow_tbl_iter_init(&iter);
+	while ((ret = dp_flow_tbl_iterate(&iter, &next_key, (void **)&flow_val)) != -ENOENT) {
 		if (DP_FAILED(ret)) {
 			DPS_LOG_ERR("Iterating flow table failed while removing NAT flows", DP_LOG_RET(ret));
 			return;
@@ -461,10 +702,11 @@ void dp_remove_neighnat_flows(uint32_t ipv4, uint32_t vni, uint16_t min_port, ui
 {
 	struct flow_value *flow_val = NULL;
 	const struct flow_key *next_key;
-	uint32_t iter = 0;
+	struct dp_flow_tbl_iter iter;
 	int ret;
 
-	while ((ret = rte_hash_iterate(ipv4_flow_tbl, (const void **)&next_key, (void **)&flow_val, &iter)) != -ENOENT) {
+	dp_flow_tbl_iter_init(&iter);
+	while ((ret = dp_flow_tbl_iterate(&iter, (const void **)&next_key, (void **)&flow_val)) != -ENOENT) {
 		if (DP_FAILED(ret)) {
 			DPS_LOG_ERR("Iterating flow table failed while removing NAT flows", DP_LOG_RET(ret));
 			return;
@@ -481,10 +723,11 @@ void dp_remove_iface_flows(uint16_t port_id, uint32_t ipv4, uint32_t vni)
 {
 	struct flow_value *flow_val = NULL;
 	const struct flow_key *next_key;
-	uint32_t iter = 0;
+	struct dp_flow_tbl_iter iter;
 	int ret;
 
-	while ((ret = rte_hash_iterate(ipv4_flow_tbl, (const void **)&next_key, (void **)&flow_val, &iter)) != -ENOENT) {
+	dp_flow_tbl_iter_init(&iter);
+	while ((ret = dp_flow_tbl_iterate(&iter, (const void **)&next_key, (void **)&flow_val)) != -ENOENT) {
 		if (DP_FAILED(ret)) {
 			DPS_LOG_ERR("Iterating flow table failed while removing VM flows", DP_LOG_RET(ret));
 			return;
@@ -5,15 +5,19 @@
 #include <rte_memory.h>
 #include "dp_conf.h"
 #include "dp_error.h"
+#include "dp_idle.h"
 #include "dp_log.h"
+#include "dp_numa.h"
 #include "dp_port.h"
 #include "dp_timers.h"
 #include "monitoring/dp_graphtrace.h"
+#include "monitoring/dp_latency.h"
 #include "nodes/arp_node.h"
 #include "nodes/dhcp_node.h"
 #include "nodes/dhcpv6_node.h"
 #include "nodes/ipip_encap_node.h"
 #include "nodes/ipv6_nd_node.h"
+#include "nodes/pmtu_node.h"
 #include "nodes/firewall_node.h"
 #include "nodes/rx_node.h"
 #include "nodes/rx_periodic_node.h"
@@ -116,6 +120,7 @@ static rte_graph_t dp_graph_create(unsigned int lcore_id)
 		DPS_LOG_ERR("Graph not found after creation", DP_LOG_NAME(graph_name), DP_LOG_LCORE(lcore_id));
 		return RTE_GRAPH_ID_INVALID;
 	}
+	dp_numa_register(graph_name, dp_graph, graph_conf.socket_id);
 
 	return graph_id;
 }
@@ -145,6 +150,7 @@ static int dp_graph_init_nodes(void)
 				|| DP_FAILED(dhcpv6_node_append_vf_tx(port_id, name))
 				|| DP_FAILED(ipv6_nd_node_append_vf_tx(port_id, name))
 				|| DP_FAILED(firewall_node_append_vf_tx(port_id, name))
+				|| DP_FAILED(pmtu_node_append_vf_tx(port_id, name))
 				|| DP_FAILED(rx_periodic_node_append_vf_tx(port_id, name)))
 				return DP_ERROR;
 		}
@@ -183,6 +189,13 @@ int dp_graph_init(void)
 		break;
 	}
 
+	if (DP_FAILED(dp_latency_init(dp_graph))) {
+		rte_graph_destroy(dp_graph_id);
+		return DP_ERROR;
+	}
+
+	dp_idle_init(dp_graph);
+
 	// only now stats can be enabled as the graph(s) must already exist
 	if (dp_conf_is_stats_enabled()) {
 		if (!rte_graph_has_stats_feature()) {
@@ -201,6 +214,8 @@ int dp_graph_init(void)
 void dp_graph_free(void)
 {
 	dp_graph_stats_free();
+	dp_latency_free();
+	dp_numa_unregister(dp_graph);
 	if (dp_graph_id != RTE_GRAPH_ID_INVALID)
 		rte_graph_destroy(dp_graph_id);
 	dp_graphtrace_free();
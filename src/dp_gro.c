@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dp_gro.h"
+#include <rte_gro.h>
+#include <rte_net.h>
+#include "dp_internal_stats.h"
+#ifdef ENABLE_VIRTSVC
+#	include "dp_virtsvc.h"
+#endif
+
+// lightweight mode (no state kept between bursts), the library caps the number of items anyway
+#define DP_GRO_MAX_FLOWS 16
+#define DP_GRO_MAX_ITEMS_PER_FLOW (RTE_GRO_MAX_BURST_ITEM_NUM / DP_GRO_MAX_FLOWS)
+
+// checksums of merged packets are not updated by the library, segments need them computed anyway
+#define DP_GRO_TX_FLAGS \
+	(RTE_MBUF_F_TX_TCP_SEG | RTE_MBUF_F_TX_IPV4 | RTE_MBUF_F_TX_IP_CKSUM | RTE_MBUF_F_TX_TCP_CKSUM)
+
+static const struct rte_gro_param gro_param = {
+	.gro_types = RTE_GRO_TCP_IPV4,
+	.max_flow_num = DP_GRO_MAX_FLOWS,
+	.max_item_per_flow = DP_GRO_MAX_ITEMS_PER_FLOW,
+};
+
+static __rte_always_inline bool dp_gro_is_tcp_ipv4(uint32_t ptype)
+{
+	return RTE_ETH_IS_IPV4_HDR(ptype) && (ptype & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_TCP;
+}
+
+#ifdef ENABLE_VIRTSVC
+// virtual services translate to plain TCP/IPv6, which cannot be segmented again on Tx
+static __rte_always_inline bool dp_gro_is_virtsvc(const struct rte_mbuf *m, uint16_t l3_offset, uint16_t l4_offset)
+{
+	const struct rte_ipv4_hdr *ipv4_hdr;
+	const struct rte_tcp_hdr *tcp_hdr;
+
+	if (!dp_virtsvc_get_count())
+		return false;
+
+	ipv4_hdr = rte_pktmbuf_mtod_offset(m, const struct rte_ipv4_hdr *, l3_offset);
+	tcp_hdr = rte_pktmbuf_mtod_offset(m, const struct rte_tcp_hdr *, l4_offset);
+	return dp_virtsvc_ipv4_lookup(dp_virtsvc_get_ipv4_table(), IPPROTO_TCP, ipv4_hdr->dst_addr, tcp_hdr->dst_port);
+}
+#endif
+
+// the library relies on packet type and header lengths, software ports do not provide them
+static __rte_always_inline bool dp_gro_prepare(struct rte_mbuf *m)
+{
+	struct rte_net_hdr_lens hdr_lens;
+	uint32_t ptype;
+
+	ptype = rte_net_get_ptype(m, &hdr_lens, RTE_PTYPE_L2_MASK | RTE_PTYPE_L3_MASK | RTE_PTYPE_L4_MASK);
+	if (!dp_gro_is_tcp_ipv4(ptype))
+		return false;
+
+#ifdef ENABLE_VIRTSVC
+	if (dp_gro_is_virtsvc(m, hdr_lens.l2_len, (uint16_t)(hdr_lens.l2_len + hdr_lens.l3_len))) {
+		// the library merges any packet typed as TCP/IPv4 (classification only needs L2/L3 type)
+		m->packet_type &= ~RTE_PTYPE_L4_MASK;
+		return false;
+	}
+#endif
+
+	m->packet_type = ptype;
+	m->tx_offload = rte_mbuf_tx_offload(hdr_lens.l2_len, hdr_lens.l3_len, hdr_lens.l4_len, 0, 0, 0, 0);
+	return true;
+}
+
+uint16_t dp_gro_reassemble_burst(struct dp_port *port, struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	uint16_t nb_candidates = 0;
+	uint16_t nb_merged;
+	struct rte_mbuf *m;
+
+	for (uint16_t i = 0; i < nb_pkts; ++i)
+		if (dp_gro_prepare(pkts[i]))
+			nb_candidates++;
+
+	if (nb_candidates < 2)
+		return nb_pkts;
+
+	nb_merged = rte_gro_reassemble_burst(pkts, nb_pkts, &gro_param);
+	if (nb_merged == nb_pkts)
+		return nb_pkts;
+
+	// merged segments are chained to the first one
+	for (uint16_t i = 0; i < nb_merged; ++i) {
+		m = pkts[i];
+		if (m->nb_segs > 1 && dp_gro_is_tcp_ipv4(m->packet_type))
+			m->ol_flags |= DP_GRO_TX_FLAGS;
+	}
+
+	DP_STATS_MTU_ADD_GRO_MERGED_CNT(port, nb_pkts - nb_merged);
+	return nb_merged;
+}
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dp_gso.h"
+#include <rte_ethdev.h>
+#include <rte_gso.h>
+#include <rte_ip.h>
+#include "dp_error.h"
+#include "dp_mbuf_dyn.h"
+#include "dpdk_layer.h"
+
+static void dp_gso_finalize_segment(struct rte_mbuf *seg, uint16_t port_id, const uint8_t *meta, bool tunneled)
+{
+	struct rte_ipv6_hdr *outer_ipv6_hdr;
+
+	// the library only updates the IPv4 header, the underlay header got copied as-is
+	if (tunneled) {
+		outer_ipv6_hdr = rte_pktmbuf_mtod_offset(seg, struct rte_ipv6_hdr *, sizeof(struct rte_ether_hdr));
+		outer_ipv6_hdr->payload_len = htons((uint16_t)(rte_pktmbuf_pkt_len(seg)
+													   - sizeof(struct rte_ether_hdr) - sizeof(struct rte_ipv6_hdr)));
+	}
+
+	seg->port = port_id;
+
+	// keep packet metadata for tracing and drop accounting
+	rte_memcpy(dp_get_flow_ptr(seg), meta, sizeof(struct dp_flow) + sizeof(struct dp_pkt_mark));
+}
+
+int dp_gso_segment(struct rte_mbuf *m, uint16_t mtu, struct rte_mbuf **segs, uint16_t max_segs)
+{
+	struct rte_mempool *pool = get_dpdk_layer()->rte_mempool;
+	struct rte_gso_ctx gso_ctx = {
+		.direct_pool = pool,
+		.indirect_pool = pool,
+		.gso_types = RTE_ETH_TX_OFFLOAD_TCP_TSO,
+		// MTU is for the (outer) IP packet, segment size covers the whole frame (without FCS)
+		.gso_size = (uint16_t)(mtu + RTE_ETHER_HDR_LEN),
+		.flag = 0,  // IP ids of segments are incremented
+	};
+	uint8_t meta[sizeof(struct dp_flow) + sizeof(struct dp_pkt_mark)];
+	uint16_t port_id = m->port;
+	bool tunneled = false;
+	int nb_segs;
+
+	// the library only knows IPv4 tunnels, IPv6 underlay header is simply treated as a part of the L2 header
+	// (checksum offloads work the same way with such layout)
+	if (m->ol_flags & RTE_MBUF_F_TX_TUNNEL_MASK) {
+		m->tx_offload = rte_mbuf_tx_offload(m->outer_l2_len + m->outer_l3_len + m->l2_len, m->l3_len, m->l4_len, 0, 0, 0, 0);
+		m->ol_flags &= ~(RTE_MBUF_F_TX_TUNNEL_MASK | RTE_MBUF_F_TX_OUTER_IPV6);
+		tunneled = true;
+	}
+
+	// the original packet can be gone once segmented
+	rte_memcpy(meta, dp_get_flow_ptr(m), sizeof(meta));
+
+	nb_segs = rte_gso_segment(m, &gso_ctx, segs, max_segs);
+	if (nb_segs <= 0)
+		return nb_segs;
+
+	for (int i = 0; i < nb_segs; ++i)
+		dp_gso_finalize_segment(segs[i], port_id, meta, tunneled);
+
+	return nb_segs;
+}
@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dp_idle.h"
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_pause.h>
+#include <rte_power_intrinsics.h>
+#include "dp_conf.h"
+#include "dp_error.h"
+#include "dp_log.h"
+#include "dp_port.h"
+#include "dpdk_layer.h"
+#include "nodes/tx_node.h"
+
+// keep spinning for a while, traffic usually comes in bursts close to each other
+#define DP_IDLE_SPIN_WALKS		256
+// then only relax the CPU pipeline between walks
+#define DP_IDLE_PAUSE_WALKS		4096
+// then wait, starting short and doubling up to --idle-sleep-max
+#define DP_IDLE_FIRST_WAIT_US	1
+
+// every Rx queue and every ring the worker consumes
+#define DP_IDLE_MAX_MONITORS	(DP_MAX_PORTS + 3)
+
+struct dp_idle_stats {
+	uint64_t busy_cycles;
+	uint64_t idle_cycles;
+	uint64_t pauses;
+	uint64_t monitor_waits;
+	uint64_t sleeps;
+};
+
+bool _dp_idle_walk_active = false;
+
+static bool idle_adaptive = false;
+static bool idle_monitor_supported = false;
+static uint16_t idle_queue_id;
+static uint32_t idle_wait_max_us;
+static uint32_t idle_wait_us = DP_IDLE_FIRST_WAIT_US;
+static uint32_t empty_walks = 0;
+static uint64_t last_tsc = 0;
+static unsigned int worker_lcore_id = LCORE_ID_ANY;
+static struct dp_idle_stats idle_stats;
+static struct rte_power_monitor_cond monitor_conds[DP_IDLE_MAX_MONITORS];
+
+void dp_idle_init(const struct rte_graph *graph)
+{
+	struct rte_cpu_intrinsics intrinsics;
+
+	idle_queue_id = (uint16_t)graph->id;
+	idle_adaptive = dp_conf_get_idle_poll() == DP_CONF_IDLE_POLL_ADAPTIVE;
+	if (!idle_adaptive)
+		return;
+
+	idle_wait_max_us = (uint32_t)dp_conf_get_idle_sleep_max();
+
+	rte_cpu_get_intrinsics_support(&intrinsics);
+	idle_monitor_supported = intrinsics.power_monitor_multi;
+	if (!idle_monitor_supported)
+		DPS_LOG_INFO("CPU cannot monitor multiple addresses, idle worker will sleep instead");
+}
+
+// the worker is the only consumer, anything the producer adds makes the ring non-empty
+static int dp_idle_ring_monitor_cb(const uint64_t val, const uint64_t opaque[RTE_POWER_MONITOR_OPAQUE_SZ])
+{
+	return (uint32_t)val != (uint32_t)opaque[0] ? -1 : 0;
+}
+
+static __rte_always_inline void dp_idle_set_ring_monitor(struct rte_power_monitor_cond *pmc, struct rte_ring *ring)
+{
+	pmc->addr = &ring->prod.tail;
+	pmc->fn = dp_idle_ring_monitor_cb;
+	pmc->opaque[0] = ring->cons.tail;
+	pmc->size = sizeof(ring->prod.tail);
+}
+
+static int dp_idle_monitor_wait(uint64_t deadline_tsc)
+{
+	struct dp_dpdk_layer *dp_layer = get_dpdk_layer();
+	struct rte_power_monitor_cond *pmc = monitor_conds;
+
+	// ports come and go, thus monitored addresses need to be collected every time
+	DP_FOREACH_PORT(dp_get_ports(), port) {
+		if (!port->allocated)
+			continue;
+		// not every PMD supports this, the caller needs to fall back to sleeping
+		if (pmc >= monitor_conds + DP_MAX_PORTS
+			|| DP_FAILED(rte_eth_get_monitor_addr(port->port_id, idle_queue_id, pmc)))
+			return DP_ERROR;
+		pmc++;
+	}
+
+	// gRPC requests, monitoring events and timer messages (flow aging, ...)
+	dp_idle_set_ring_monitor(pmc++, dp_layer->grpc_tx_queue);
+	dp_idle_set_ring_monitor(pmc++, dp_layer->monitoring_rx_queue);
+	dp_idle_set_ring_monitor(pmc++, dp_layer->periodic_msg_queue);
+
+	return rte_power_monitor_multi(monitor_conds, (uint32_t)(pmc - monitor_conds), deadline_tsc);
+}
+
+static void dp_idle_wait(void)
+{
+	uint64_t deadline_tsc;
+
+	if (idle_monitor_supported) {
+		deadline_tsc = rte_rdtsc() + idle_wait_us * rte_get_tsc_hz() / US_PER_S;
+		if (!DP_FAILED(dp_idle_monitor_wait(deadline_tsc))) {
+			idle_stats.monitor_waits++;
+			goto waited;
+		}
+	}
+
+	// cannot wake up on traffic, but the duration is bounded
+	rte_delay_us_sleep(idle_wait_us);
+	idle_stats.sleeps++;
+
+waited:
+	if (idle_wait_us < idle_wait_max_us)
+		idle_wait_us = RTE_MIN(idle_wait_us * 2, idle_wait_max_us);
+}
+
+void dp_idle_walk_done(void)
+{
+	uint64_t now = rte_rdtsc();
+	uint64_t cycles = now - last_tsc;
+
+	if (unlikely(!last_tsc)) {
+		worker_lcore_id = rte_lcore_id();
+		last_tsc = now;
+		return;
+	}
+	last_tsc = now;
+
+	// packets waiting for Tx need more walks to be sent
+	if (_dp_idle_walk_active || tx_node_is_pending()) {
+		_dp_idle_walk_active = false;
+		idle_stats.busy_cycles += cycles;
+		empty_walks = 0;
+		idle_wait_us = DP_IDLE_FIRST_WAIT_US;
+		return;
+	}
+
+	idle_stats.idle_cycles += cycles;
+
+	if (!idle_adaptive || ++empty_walks < DP_IDLE_SPIN_WALKS)
+		return;
+
+	if (empty_walks < DP_IDLE_PAUSE_WALKS) {
+		rte_pause();
+		idle_stats.pauses++;
+		return;
+	}
+
+	dp_idle_wait();
+
+	// waiting is idle time even if the next walk is busy
+	now = rte_rdtsc();
+	idle_stats.idle_cycles += now - last_tsc;
+	last_tsc = now;
+}
+
+int dp_idle_get_stats_telemetry(struct rte_tel_data *dict)
+{
+	struct rte_tel_data *values;
+	uint64_t total_cycles = idle_stats.busy_cycles + idle_stats.idle_cycles;
+	char lcore_str[12];
+	int ret;
+
+	if (worker_lcore_id == LCORE_ID_ANY)
+		return DP_OK;
+
+	values = rte_tel_data_alloc();
+	if (!values) {
+		DPS_LOG_ERR("Failed to allocate worker telemetry data");
+		return DP_ERROR;
+	}
+
+	ret = rte_tel_data_start_dict(values);
+	if (DP_FAILED(ret)
+		|| DP_FAILED(ret = rte_tel_data_add_dict_string(values, "mode", idle_adaptive ? "adaptive" : "busy"))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(values, "busy_cycles", idle_stats.busy_cycles))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(values, "idle_cycles", idle_stats.idle_cycles))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(values, "busy_permille",
+													 total_cycles ? idle_stats.busy_cycles * 1000 / total_cycles : 0))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(values, "pauses", idle_stats.pauses))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(values, "monitor_waits", idle_stats.monitor_waits))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(values, "sleeps", idle_stats.sleeps)))
+		goto error;
+
+	snprintf(lcore_str, sizeof(lcore_str), "%u", worker_lcore_id);
+	ret = rte_tel_data_add_dict_container(dict, lcore_str, values, 0);
+	if (DP_FAILED(ret))
+		goto error;
+
+	return DP_OK;
+
+error:
+	DPS_LOG_ERR("Failed to add worker telemetry data", DP_LOG_RET(ret));
+	rte_tel_data_free(values);
+	return ret;
+}
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "dp_iface.h"
+#include "dp_numa.h"
 #include "dp_vni.h"
 
 static struct rte_hash *iface_id_table = NULL;
@@ -70,10 +71,13 @@ struct dp_port *dp_get_port_with_iface_id(const char iface_id[DP_IFACE_ID_MAX_LE
 
 int dp_setup_iface(struct dp_port *port, uint32_t vni)
 {
-	if (DP_FAILED(dp_create_vni_route_tables(vni, port->socket_id)))
+	if (DP_FAILED(dp_create_vni_route_tables(vni, dp_numa_get_worker_socket_id())))
 		return DP_ERROR;
 
 	dp_init_firewall_rules(port);
+	// traffic counters are per-interface (i.e. per-VM), not per-port
+	memset(&port->stats.traffic_stats, 0, sizeof(port->stats.traffic_stats));
+	memset(&port->stats.drop_stats, 0, sizeof(port->stats.drop_stats));
 	port->iface.vni = vni;
 	port->iface.ready = 1;
 	return DP_OK;
@@ -94,4 +98,6 @@ void dp_delete_iface(struct dp_port *port)
 	memset(&port->iface, 0, sizeof(port->iface));
 	// own mac address needs to be refilled due to the above cleaning process
 	dp_load_mac(port);
+	// the next VM on this port needs to be found by the ARP cycle again
+	memset(&port->neigh_mac, 0, sizeof(port->neigh_mac));
 }
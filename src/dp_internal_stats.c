@@ -29,3 +29,313 @@ int dp_nat_get_used_ports_telemetry(struct rte_tel_data *dict)
 
 	return DP_OK;
 }
+
+int dp_cntrack_get_flow_count_telemetry(struct rte_tel_data *dict)
+{
+	const struct dp_ports *ports = dp_get_ports();
+	int ret;
+
+	DP_FOREACH_PORT(ports, port) {
+		if (port->is_pf || !port->allocated)
+			continue;
+
+		ret = rte_tel_data_add_dict_u64(dict, port->iface.id, port->stats.cntrack_stats.flow_cnt);
+		if (DP_FAILED(ret)) {
+			DPS_LOG_ERR("Failed to add interface flow count telemetry data", DP_LOG_PORT(port), DP_LOG_RET(ret));
+			return ret;
+		}
+	}
+
+	return DP_OK;
+}
+
+int dp_cntrack_get_limit_drops_telemetry(struct rte_tel_data *dict)
+{
+	const struct dp_ports *ports = dp_get_ports();
+	int ret;
+
+	DP_FOREACH_PORT(ports, port) {
+		if (port->is_pf || !port->allocated)
+			continue;
+
+		ret = rte_tel_data_add_dict_u64(dict, port->iface.id, port->stats.cntrack_stats.limit_drop_cnt);
+		if (DP_FAILED(ret)) {
+			DPS_LOG_ERR("Failed to add interface flow limit telemetry data", DP_LOG_PORT(port), DP_LOG_RET(ret));
+			return ret;
+		}
+	}
+
+	return DP_OK;
+}
+
+static int dp_add_table_telemetry_data(struct rte_tel_data *dict, const char *name, uint32_t used, uint32_t capacity,
+									   const uint64_t *migration_failed)
+{
+	struct rte_tel_data *table;
+	int ret;
+
+	table = rte_tel_data_alloc();
+	if (!table) {
+		DPS_LOG_ERR("Failed to allocate table telemetry data", DP_LOG_NAME(name));
+		return DP_ERROR;
+	}
+
+	ret = rte_tel_data_start_dict(table);
+	if (DP_FAILED(ret)
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(table, "used", used))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(table, "capacity", capacity))
+		|| (migration_failed && DP_FAILED(ret = rte_tel_data_add_dict_u64(table, "migration_failed", *migration_failed)))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_container(dict, name, table, 0))
+	) {
+		DPS_LOG_ERR("Failed to add table telemetry data", DP_LOG_NAME(name), DP_LOG_RET(ret));
+		rte_tel_data_free(table);
+		return ret;
+	}
+
+	return DP_OK;
+}
+
+int dp_add_table_telemetry(struct rte_tel_data *dict, const char *name, uint32_t used, uint32_t capacity)
+{
+	return dp_add_table_telemetry_data(dict, name, used, capacity, NULL);
+}
+
+int dp_add_growing_table_telemetry(struct rte_tel_data *dict, const char *name, uint32_t used, uint32_t capacity,
+								   uint64_t migration_failed)
+{
+	return dp_add_table_telemetry_data(dict, name, used, capacity, &migration_failed);
+}
+
+static int dp_add_tx_stats_telemetry(struct rte_tel_data *dict, const char *name, const struct dp_tx_stats *stats)
+{
+	struct rte_tel_data *port_stats;
+	int ret;
+
+	port_stats = rte_tel_data_alloc();
+	if (!port_stats) {
+		DPS_LOG_ERR("Failed to allocate Tx telemetry data", DP_LOG_NAME(name));
+		return DP_ERROR;
+	}
+
+	ret = rte_tel_data_start_dict(port_stats);
+	if (DP_FAILED(ret)
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(port_stats, "flush", stats->flush_cnt))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(port_stats, "retry", stats->retry_cnt))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(port_stats, "drop", stats->drop_cnt))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_container(dict, name, port_stats, 0))
+	) {
+		DPS_LOG_ERR("Failed to add Tx telemetry data", DP_LOG_NAME(name), DP_LOG_RET(ret));
+		rte_tel_data_free(port_stats);
+		return ret;
+	}
+
+	return DP_OK;
+}
+
+int dp_tx_get_stats_telemetry(struct rte_tel_data *dict)
+{
+	const struct dp_ports *ports = dp_get_ports();
+
+	DP_FOREACH_PORT(ports, port) {
+		if (!port->allocated)
+			continue;
+
+		// PFs have no interface id
+		if (DP_FAILED(dp_add_tx_stats_telemetry(dict, port->is_pf ? port->port_name : port->iface.id, &port->stats.tx_stats)))
+			return DP_ERROR;
+	}
+
+	return DP_OK;
+}
+
+static int dp_add_mtu_stats_telemetry(struct rte_tel_data *dict, const char *name, const struct dp_mtu_stats *stats)
+{
+	struct rte_tel_data *port_stats;
+	int ret;
+
+	port_stats = rte_tel_data_alloc();
+	if (!port_stats) {
+		DPS_LOG_ERR("Failed to allocate MTU telemetry data", DP_LOG_NAME(name));
+		return DP_ERROR;
+	}
+
+	ret = rte_tel_data_start_dict(port_stats);
+	if (DP_FAILED(ret)
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(port_stats, "icmp_sent", stats->icmp_sent_cnt))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(port_stats, "icmp_limited", stats->icmp_limited_cnt))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(port_stats, "mss_clamped", stats->mss_clamped_cnt))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(port_stats, "gro_merged", stats->gro_merged_cnt))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(port_stats, "gso_segments", stats->gso_segments_cnt))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_container(dict, name, port_stats, 0))
+	) {
+		DPS_LOG_ERR("Failed to add MTU telemetry data", DP_LOG_NAME(name), DP_LOG_RET(ret));
+		rte_tel_data_free(port_stats);
+		return ret;
+	}
+
+	return DP_OK;
+}
+
+int dp_mtu_get_stats_telemetry(struct rte_tel_data *dict)
+{
+	const struct dp_ports *ports = dp_get_ports();
+
+	DP_FOREACH_PORT(ports, port) {
+		if (!port->allocated)
+			continue;
+
+		// PFs have no interface id
+		if (DP_FAILED(dp_add_mtu_stats_telemetry(dict, port->is_pf ? port->port_name : port->iface.id, &port->stats.mtu_stats)))
+			return DP_ERROR;
+	}
+
+	return DP_OK;
+}
+
+static int dp_add_traffic_stats_telemetry(struct rte_tel_data *dict, const char *name, const struct dp_traffic_stats *stats)
+{
+	struct rte_tel_data *traffic;
+	int ret;
+
+	traffic = rte_tel_data_alloc();
+	if (!traffic) {
+		DPS_LOG_ERR("Failed to allocate traffic telemetry data", DP_LOG_NAME(name));
+		return DP_ERROR;
+	}
+
+	ret = rte_tel_data_start_dict(traffic);
+	if (DP_FAILED(ret)
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(traffic, "rx_packets", stats->rx_pkts))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(traffic, "rx_bytes", stats->rx_bytes))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(traffic, "tx_packets", stats->tx_pkts))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(traffic, "tx_bytes", stats->tx_bytes))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(traffic, "drop_packets", stats->drop_pkts))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_u64(traffic, "drop_bytes", stats->drop_bytes))
+		|| DP_FAILED(ret = rte_tel_data_add_dict_container(dict, name, traffic, 0))
+	) {
+		DPS_LOG_ERR("Failed to add traffic telemetry data", DP_LOG_NAME(name), DP_LOG_RET(ret));
+		rte_tel_data_free(traffic);
+		return ret;
+	}
+
+	return DP_OK;
+}
+
+int dp_iface_get_stats_telemetry(struct rte_tel_data *dict)
+{
+	const struct dp_ports *ports = dp_get_ports();
+
+	DP_FOREACH_PORT(ports, port) {
+		if (!port->allocated)
+			continue;
+
+		// PFs have no interface id
+		if (DP_FAILED(dp_add_traffic_stats_telemetry(dict, port->is_pf ? port->port_name : port->iface.id,
+													 &port->stats.traffic_stats)))
+			return DP_ERROR;
+	}
+
+	return DP_OK;
+}
+
+int dp_vni_get_stats_telemetry(struct rte_tel_data *dict)
+{
+	const struct dp_ports *ports = dp_get_ports();
+	struct {
+		uint32_t vni;
+		struct dp_traffic_stats stats;
+	} vnis[DP_MAX_VF_PORTS];
+	int vni_count = 0;
+	int idx;
+	char name[sizeof("4294967295")];
+
+	// VNI traffic is the sum of traffic of all interfaces (VMs) in it
+	DP_FOREACH_PORT(ports, port) {
+		if (port->is_pf || !port->allocated || !port->iface.ready)
+			continue;
+
+		for (idx = 0; idx < vni_count; ++idx)
+			if (vnis[idx].vni == port->iface.vni)
+				break;
+
+		if (idx == vni_count) {
+			if (vni_count >= (int)RTE_DIM(vnis))
+				break;
+			vnis[idx].vni = port->iface.vni;
+			memset(&vnis[idx].stats, 0, sizeof(vnis[idx].stats));
+			vni_count++;
+		}
+
+		vnis[idx].stats.rx_pkts += port->stats.traffic_stats.rx_pkts;
+		vnis[idx].stats.rx_bytes += port->stats.traffic_stats.rx_bytes;
+		vnis[idx].stats.tx_pkts += port->stats.traffic_stats.tx_pkts;
+		vnis[idx].stats.tx_bytes += port->stats.traffic_stats.tx_bytes;
+		vnis[idx].stats.drop_pkts += port->stats.traffic_stats.drop_pkts;
+		vnis[idx].stats.drop_bytes += port->stats.traffic_stats.drop_bytes;
+	}
+
+	for (idx = 0; idx < vni_count; ++idx) {
+		snprintf(name, sizeof(name), "%u", vnis[idx].vni);
+		if (DP_FAILED(dp_add_traffic_stats_telemetry(dict, name, &vnis[idx].stats)))
+			return DP_ERROR;
+	}
+
+	return DP_OK;
+}
+
+static int dp_add_drop_stats_telemetry(struct rte_tel_data *dict, const char *name, const struct dp_drop_stats *stats)
+{
+	struct rte_tel_data *reasons;
+	int ret;
+
+	reasons = rte_tel_data_alloc();
+	if (!reasons) {
+		DPS_LOG_ERR("Failed to allocate drop telemetry data", DP_LOG_NAME(name));
+		return DP_ERROR;
+	}
+
+	ret = rte_tel_data_start_dict(reasons);
+	if (DP_FAILED(ret))
+		goto error;
+
+	// only list reasons that actually happened, there are too many of them
+	for (unsigned int i = 0; i < RTE_DIM(stats->reason_cnt); ++i) {
+		if (!stats->reason_cnt[i])
+			continue;
+		ret = rte_tel_data_add_dict_u64(reasons, dp_get_drop_reason_name(i), stats->reason_cnt[i]);
+		if (DP_FAILED(ret))
+			goto error;
+	}
+
+	ret = rte_tel_data_add_dict_container(dict, name, reasons, 0);
+	if (DP_FAILED(ret))
+		goto error;
+
+	return DP_OK;
+
+error:
+	DPS_LOG_ERR("Failed to add drop telemetry data", DP_LOG_NAME(name), DP_LOG_RET(ret));
+	rte_tel_data_free(reasons);
+	return ret;
+}
+
+int dp_drop_get_stats_telemetry(struct rte_tel_data *dict)
+{
+	const struct dp_ports *ports = dp_get_ports();
+	struct dp_drop_stats total = {0};
+
+	DP_FOREACH_PORT(ports, port) {
+		if (!port->allocated)
+			continue;
+
+		for (unsigned int i = 0; i < RTE_DIM(total.reason_cnt); ++i)
+			total.reason_cnt[i] += port->stats.drop_stats.reason_cnt[i];
+
+		// PFs have no interface id
+		if (DP_FAILED(dp_add_drop_stats_telemetry(dict, port->is_pf ? port->port_name : port->iface.id,
+												  &port->stats.drop_stats)))
+			return DP_ERROR;
+	}
+
+	return dp_add_drop_stats_telemetry(dict, "total", &total);
+}
@@ -0,0 +1,311 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dp_ipfrag.h"
+#include <rte_cycles.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_ip_frag.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include "dp_conf.h"
+#include "dp_error.h"
+#include "dp_log.h"
+#include "dp_mbuf_dyn.h"
+#include "dp_numa.h"
+#include "dp_port.h"
+#include "dpdk_layer.h"
+#include "nodes/common_node.h"
+
+// associativity of the reassembly table (same as in DPDK examples)
+#define DP_IPFRAG_BUCKET_ENTRIES 16
+#define DP_IPFRAG_PREFETCH_OFFSET 3
+
+// fragments are copied into newly allocated packets, underlay headers need to fit in the headroom
+#define DP_IPFRAG_MAX_HDR_LEN (sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv6_hdr))
+static_assert(DP_IPFRAG_MAX_HDR_LEN <= RTE_PKTMBUF_HEADROOM,
+			  "Fragment headers do not fit into packet headroom");
+
+struct dp_ipfrag_stats {
+	uint64_t reassembled;
+	uint64_t dropped_fragments;
+	uint64_t fragmented;
+	uint64_t fragments;
+	uint64_t failed;
+};
+
+static struct rte_ip_frag_tbl *ipfrag_table = NULL;
+static struct rte_ip_frag_death_row ipfrag_death_row;
+static struct dp_ipfrag_stats ipfrag_stats;
+
+int dp_ipfrag_init(int socket_id)
+{
+	uint32_t size = (uint32_t)dp_conf_get_frag_table_size();
+	uint64_t timeout_cycles = (uint64_t)dp_conf_get_frag_timeout() * rte_get_tsc_hz() / MS_PER_S;
+
+	// every packet has its own bucket to lower the chance of collisions
+	ipfrag_table = rte_ip_frag_table_create(size, DP_IPFRAG_BUCKET_ENTRIES, size, timeout_cycles, socket_id);
+	if (!ipfrag_table) {
+		DPS_LOG_ERR("Cannot create IP reassembly table", DP_LOG_VALUE(size), DP_LOG_SOCKID(socket_id), DP_LOG_RET(rte_errno));
+		return DP_ERROR;
+	}
+	dp_numa_register("ip_frag_table", ipfrag_table, socket_id);
+
+	return DP_OK;
+}
+
+void dp_ipfrag_free(void)
+{
+	if (!ipfrag_table)
+		return;
+
+	dp_ipfrag_free_dropped();
+	dp_numa_unregister(ipfrag_table);
+	// this also frees all fragments still waiting for reassembly
+	rte_ip_frag_table_destroy(ipfrag_table);
+	ipfrag_table = NULL;
+}
+
+void dp_ipfrag_free_dropped(void)
+{
+	if (!ipfrag_death_row.cnt)
+		return;
+
+	ipfrag_stats.dropped_fragments += ipfrag_death_row.cnt;
+
+	// expired, duplicate or overlapping fragments, or no room in the table
+	for (uint32_t i = 0; i < ipfrag_death_row.cnt; ++i)
+		dp_set_drop_reason(ipfrag_death_row.row[i], DP_DROP_REASON_REASSEMBLY);
+	dp_count_dropped_packets((void **)ipfrag_death_row.row, (uint16_t)ipfrag_death_row.cnt);
+
+	rte_ip_frag_free_death_row(&ipfrag_death_row, DP_IPFRAG_PREFETCH_OFFSET);
+}
+
+// The reassembly key is only made of addresses and IP ID, fragments from different VMs (or VNIs in the underlay)
+// using overlapping addresses can end up in one packet. Such packets must not leave the tenant, drop them instead.
+static bool dp_ipfrag_is_same_origin(struct rte_mbuf *m)
+{
+	const struct dp_flow *df = dp_get_flow_ptr(m);
+	bool from_pf = dp_get_in_port(m)->is_pf;
+
+	for (struct rte_mbuf *seg = m->next; seg; seg = seg->next) {
+		if (dp_get_flow_ptr(seg)->tun_info.dst_vni != df->tun_info.dst_vni)
+			return false;
+		// underlay packets can come via any PF, the VNI is what matters there
+		if (from_pf ? !dp_get_in_port(seg)->is_pf : seg->port != m->port)
+			return false;
+	}
+	return true;
+}
+
+struct rte_mbuf *dp_ipfrag_reassemble(struct rte_mbuf *m, uint16_t l3_type, uint64_t tsc)
+{
+	struct rte_ipv4_hdr *ipv4_hdr;
+	struct rte_ipv6_hdr *ipv6_hdr;
+	struct rte_ipv6_fragment_ext *frag_hdr;
+	struct rte_mbuf *reassembled;
+
+	// a single call can put all fragments of a packet into the death row, make sure they fit
+	if (unlikely(ipfrag_death_row.cnt > RTE_DIM(ipfrag_death_row.row) - RTE_LIBRTE_IP_FRAG_MAX_FRAG - 1))
+		dp_ipfrag_free_dropped();
+
+	m->l2_len = sizeof(struct rte_ether_hdr);
+
+	if (l3_type == RTE_ETHER_TYPE_IPV4) {
+		ipv4_hdr = rte_pktmbuf_mtod_offset(m, struct rte_ipv4_hdr *, m->l2_len);
+		m->l3_len = rte_ipv4_hdr_len(ipv4_hdr);
+		reassembled = rte_ipv4_frag_reassemble_packet(ipfrag_table, &ipfrag_death_row, m, tsc, ipv4_hdr);
+		if (!reassembled)
+			return NULL;
+		// the library leaves the checksum empty
+		ipv4_hdr = rte_pktmbuf_mtod_offset(reassembled, struct rte_ipv4_hdr *, reassembled->l2_len);
+		ipv4_hdr->hdr_checksum = rte_ipv4_cksum(ipv4_hdr);
+	} else {
+		ipv6_hdr = rte_pktmbuf_mtod_offset(m, struct rte_ipv6_hdr *, m->l2_len);
+		frag_hdr = rte_ipv6_frag_get_ipv6_fragment_header(ipv6_hdr);
+		if (unlikely(!frag_hdr))
+			return m;
+		m->l3_len = sizeof(struct rte_ipv6_hdr) + sizeof(struct rte_ipv6_fragment_ext);
+		reassembled = rte_ipv6_frag_reassemble_packet(ipfrag_table, &ipfrag_death_row, m, tsc, ipv6_hdr, frag_hdr);
+		if (!reassembled)
+			return NULL;
+	}
+
+	if (unlikely(!dp_ipfrag_is_same_origin(reassembled))) {
+		// there is always room for one more packet, see above
+		ipfrag_death_row.row[ipfrag_death_row.cnt++] = reassembled;
+		return NULL;
+	}
+
+	ipfrag_stats.reassembled++;
+	return reassembled;
+}
+
+// L4 checksum covers the whole packet, it cannot be offloaded once fragmented
+static void dp_ipfrag_finalize_l4_cksum(struct rte_mbuf *m, uint16_t l3_type)
+{
+	uint64_t l4_flags = m->ol_flags & RTE_MBUF_F_TX_L4_MASK;
+	struct rte_ipv4_hdr *ipv4_hdr;
+	struct rte_ipv6_hdr *ipv6_hdr;
+	uint16_t l3_len;
+	uint16_t cksum;
+
+	if (l4_flags != RTE_MBUF_F_TX_TCP_CKSUM && l4_flags != RTE_MBUF_F_TX_UDP_CKSUM)
+		return;
+
+	if (l3_type == RTE_ETHER_TYPE_IPV4) {
+		ipv4_hdr = rte_pktmbuf_mtod(m, struct rte_ipv4_hdr *);
+		l3_len = (uint16_t)rte_ipv4_hdr_len(ipv4_hdr);
+		cksum = rte_ipv4_udptcp_cksum_mbuf(m, ipv4_hdr, l3_len);
+	} else {
+		ipv6_hdr = rte_pktmbuf_mtod(m, struct rte_ipv6_hdr *);
+		l3_len = sizeof(struct rte_ipv6_hdr);
+		cksum = rte_ipv6_udptcp_cksum_mbuf(m, ipv6_hdr, l3_len);
+	}
+
+	if (l4_flags == RTE_MBUF_F_TX_TCP_CKSUM)
+		rte_pktmbuf_mtod_offset(m, struct rte_tcp_hdr *, l3_len)->cksum = cksum;
+	else
+		rte_pktmbuf_mtod_offset(m, struct rte_udp_hdr *, l3_len)->dgram_cksum = cksum;
+}
+
+static void dp_ipfrag_finalize_fragment(struct rte_mbuf *frag, struct rte_mbuf *orig,
+										const uint8_t *hdr, uint16_t hdr_len, uint16_t l3_type)
+{
+	struct rte_ipv6_hdr *outer_ipv6_hdr;
+	struct rte_ipv4_hdr *ipv4_hdr;
+	uint8_t *data;
+
+	// cannot fail, fragments are direct mbufs with the default headroom
+	data = (uint8_t *)rte_pktmbuf_prepend(frag, hdr_len);
+	rte_memcpy(data, hdr, hdr_len);
+
+	if (hdr_len > sizeof(struct rte_ether_hdr)) {
+		outer_ipv6_hdr = (struct rte_ipv6_hdr *)(data + sizeof(struct rte_ether_hdr));
+		outer_ipv6_hdr->payload_len = htons((uint16_t)(rte_pktmbuf_pkt_len(frag) - hdr_len));
+	}
+
+	if (l3_type == RTE_ETHER_TYPE_IPV4) {
+		ipv4_hdr = (struct rte_ipv4_hdr *)(data + hdr_len);
+		ipv4_hdr->hdr_checksum = 0;
+		ipv4_hdr->hdr_checksum = rte_ipv4_cksum(ipv4_hdr);
+	}
+
+	// everything is already computed, nothing to offload
+	frag->ol_flags &= ~RTE_MBUF_F_TX_OFFLOAD_MASK;
+	frag->tx_offload = 0;
+	frag->port = orig->port;
+
+	// keep packet metadata for tracing and drop accounting
+	rte_memcpy(dp_get_flow_ptr(frag), dp_get_flow_ptr(orig),
+			   sizeof(struct dp_flow) + sizeof(struct dp_pkt_mark));
+}
+
+// finds the (inner) IP header, returns its ethertype
+static uint16_t dp_ipfrag_get_l3_type(struct rte_mbuf *m, bool tunneled, uint16_t *hdr_len)
+{
+	const struct rte_ether_hdr *ether_hdr = rte_pktmbuf_mtod(m, struct rte_ether_hdr *);
+	uint16_t l3_type = ntohs(ether_hdr->ether_type);
+	uint8_t proto;
+
+	*hdr_len = sizeof(struct rte_ether_hdr);
+
+	if (tunneled && l3_type == RTE_ETHER_TYPE_IPV6) {
+		proto = ((const struct rte_ipv6_hdr *)(ether_hdr + 1))->proto;
+		if (proto == IPPROTO_IPIP || proto == IPPROTO_IPV6) {
+			*hdr_len += sizeof(struct rte_ipv6_hdr);
+			return proto == IPPROTO_IPIP ? RTE_ETHER_TYPE_IPV4 : RTE_ETHER_TYPE_IPV6;
+		}
+	}
+
+	return l3_type;
+}
+
+bool dp_ipfrag_is_allowed(struct rte_mbuf *m, bool tunneled)
+{
+	uint16_t hdr_len;
+
+	if (dp_ipfrag_get_l3_type(m, tunneled, &hdr_len) != RTE_ETHER_TYPE_IPV4)
+		return false;
+
+	return !(rte_pktmbuf_mtod_offset(m, struct rte_ipv4_hdr *, hdr_len)->fragment_offset & htons(RTE_IPV4_HDR_DF_FLAG));
+}
+
+int dp_ipfrag_fragment(struct rte_mbuf *m, bool tunneled, uint16_t mtu, struct rte_mbuf **frags, uint16_t max_frags)
+{
+	struct rte_mempool *pool = get_dpdk_layer()->rte_mempool;
+	uint8_t hdr[DP_IPFRAG_MAX_HDR_LEN];
+	uint16_t ipv4_hdr_len;
+	uint16_t hdr_len;
+	uint16_t l3_type;
+	int nb_frags;
+
+	l3_type = dp_ipfrag_get_l3_type(m, tunneled, &hdr_len);
+	if (l3_type != RTE_ETHER_TYPE_IPV4 && l3_type != RTE_ETHER_TYPE_IPV6) {
+		ipfrag_stats.failed++;
+		return DP_ERROR;
+	}
+
+	// MTU is for the outer packet
+	mtu = (uint16_t)(mtu - (hdr_len - sizeof(struct rte_ether_hdr)));
+
+	rte_memcpy(hdr, rte_pktmbuf_mtod(m, void *), hdr_len);
+	rte_pktmbuf_adj(m, hdr_len);
+
+	dp_ipfrag_finalize_l4_cksum(m, l3_type);
+
+	if (l3_type == RTE_ETHER_TYPE_IPV4) {
+		// fragment payload needs to be aligned (IPv6 variant does this on its own)
+		ipv4_hdr_len = (uint16_t)rte_ipv4_hdr_len(rte_pktmbuf_mtod(m, struct rte_ipv4_hdr *));
+		mtu = (uint16_t)(ipv4_hdr_len + RTE_ALIGN_FLOOR(mtu - ipv4_hdr_len, RTE_IPV4_HDR_OFFSET_UNITS));
+		nb_frags = rte_ipv4_fragment_packet(m, frags, max_frags, mtu, pool, pool);
+	} else
+		nb_frags = rte_ipv6_fragment_packet(m, frags, max_frags, mtu, pool, pool);
+
+	if (DP_FAILED(nb_frags)) {
+		// headers are still in the buffer
+		rte_pktmbuf_prepend(m, hdr_len);
+		ipfrag_stats.failed++;
+		return nb_frags;
+	}
+
+	for (int i = 0; i < nb_frags; ++i)
+		dp_ipfrag_finalize_fragment(frags[i], m, hdr, hdr_len, l3_type);
+
+	rte_pktmbuf_free(m);
+
+	ipfrag_stats.fragmented++;
+	ipfrag_stats.fragments += (uint64_t)nb_frags;
+	return nb_frags;
+}
+
+int dp_ipfrag_get_stats_telemetry(struct rte_tel_data *dict)
+{
+	int ret;
+
+	ret = rte_tel_data_add_dict_u64(dict, "reassembled", ipfrag_stats.reassembled);
+	if (DP_FAILED(ret))
+		goto error;
+
+	ret = rte_tel_data_add_dict_u64(dict, "dropped_fragments", ipfrag_stats.dropped_fragments);
+	if (DP_FAILED(ret))
+		goto error;
+
+	ret = rte_tel_data_add_dict_u64(dict, "fragmented", ipfrag_stats.fragmented);
+	if (DP_FAILED(ret))
+		goto error;
+
+	ret = rte_tel_data_add_dict_u64(dict, "fragments", ipfrag_stats.fragments);
+	if (DP_FAILED(ret))
+		goto error;
+
+	ret = rte_tel_data_add_dict_u64(dict, "failed", ipfrag_stats.failed);
+	if (DP_FAILED(ret))
+		goto error;
+
+	return DP_OK;
+
+error:
+	DPS_LOG_ERR("Failed to add IP fragmentation telemetry data", DP_LOG_RET(ret));
+	return ret;
+}
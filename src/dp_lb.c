@@ -10,22 +10,27 @@
 #include <rte_jhash.h>
 #include <rte_malloc.h>
 #include <rte_rib6.h>
+#include "dp_conf.h"
 #include "dp_error.h"
 #include "dp_flow.h"
+#include "dp_internal_stats.h"
 #include "dp_log.h"
 #include "grpc/dp_grpc_responder.h"
 
 static struct rte_hash *ipv4_lb_tbl = NULL;
 static struct rte_hash *id_map_lb_tbl = NULL;
+static int lb_table_size = DP_LB_TABLE_MAX;
 
 int dp_lb_init(int socket_id)
 {
-	ipv4_lb_tbl = dp_create_jhash_table(DP_LB_TABLE_MAX, sizeof(struct lb_key),
+	lb_table_size = dp_conf_get_lb_table_size();
+
+	ipv4_lb_tbl = dp_create_jhash_table(lb_table_size, sizeof(struct lb_key),
 										"ipv4_lb_table", socket_id);
 	if (!ipv4_lb_tbl)
 		return DP_ERROR;
 
-	id_map_lb_tbl = dp_create_jhash_table(DP_LB_TABLE_MAX, DP_LB_ID_MAX_LEN,
+	id_map_lb_tbl = dp_create_jhash_table(lb_table_size, DP_LB_ID_MAX_LEN,
 										  "lb_id_map_table", socket_id);
 	if (!id_map_lb_tbl)
 		return DP_ERROR;
@@ -39,6 +44,14 @@ void dp_lb_free(void)
 	dp_free_jhash_table(ipv4_lb_tbl);
 }
 
+int dp_lb_get_tables_telemetry(struct rte_tel_data *dict)
+{
+	if (DP_FAILED(dp_add_table_telemetry(dict, "ipv4_lb_table", (uint32_t)rte_hash_count(ipv4_lb_tbl), (uint32_t)lb_table_size))
+		|| DP_FAILED(dp_add_table_telemetry(dict, "lb_id_map_table", (uint32_t)rte_hash_count(id_map_lb_tbl), (uint32_t)lb_table_size)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
 static int dp_map_lb_handle(const void *id_key, const struct lb_key *l_key, struct lb_value *l_val)
 {
 	struct lb_key *lb_k;
@@ -7,15 +7,26 @@
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
 #include <rte_log.h>
+#include <rte_ring_elem.h>
+#include <rte_thread.h>
 
 #include "dp_error.h"
 #include "dp_conf.h"
+#include "dp_ipaddr.h"
 
 #define TIMESTAMP_FMT "%Y-%m-%d %H:%M:%S"
 #define TIMESTAMP_NUL "0000-00-00 00:00:00.000"
 #define TIMESTAMP_MAXSIZE sizeof(TIMESTAMP_NUL)
 
+#define DP_LOG_MAX_ARGS			20
+#define DP_LOG_STRINGS_SIZE		1024
+#define DP_LOG_RING_SIZE		512
+#define DP_LOG_DRAIN_BURST		64
+#define DP_LOG_IDLE_SLEEP_US	1000
+
 // prevent unnecessary `if (log_json)`
 #define FORMAT_HEADER log_formatter[0]
 #define FORMAT_CALLER log_formatter[1]
@@ -57,6 +68,33 @@ static const char *const log_levels[] = {
 };
 static_assert(RTE_DIM(log_levels) == RTE_LOG_MAX+1, "Unknown log levels in DPDK");
 
+struct dp_log_arg {
+	const char *key;
+	int format;
+	union {
+		int int_value;
+		unsigned int uint_value;
+		rte_be32_t ipv4_value;
+		uint8_t ipv6_value[DP_IPV6_ADDR_SIZE];
+		const void *ptr_value;
+		uint16_t str_offset;
+	};
+};
+
+// Binary form of a log line, formatting is deferred until it is written out
+struct dp_log_record {
+	struct dp_log_callsite *callsite;
+	const char *message;
+	struct timespec timestamp;
+	uint32_t suppressed;
+	uint16_t thread_id;
+	uint16_t nb_args;
+	char thread_name[16];
+	struct dp_log_arg args[DP_LOG_MAX_ARGS];
+	uint16_t strings_used;
+	char strings[DP_LOG_STRINGS_SIZE];
+};
+
 static bool log_colors = false;
 static bool log_json = false;
 static const char *const *log_formatter = log_formatter_text;
@@ -67,6 +105,20 @@ static uint16_t thread_id_generator = 0;
 static __thread uint16_t thread_id = 0;
 static __thread char thread_name[16] = "thread";
 
+static uint32_t log_rate_limit = 0;
+static uint64_t log_rate_window;
+
+// EAL does not provide call sites, share one per log level
+static struct dp_log_callsite eal_callsites[RTE_LOG_MAX+1];
+
+// only worker lcores have a ring, everyone else writes directly
+static struct rte_ring *log_rings[RTE_MAX_LCORE];
+static uint64_t log_lost[RTE_MAX_LCORE];
+static uint64_t log_lost_reported[RTE_MAX_LCORE];
+static rte_thread_t log_thread_id;
+static bool log_thread_started = false;
+static volatile bool log_thread_running = false;
+
 void dp_log_set_thread_name(const char *name)
 {
 	snprintf(thread_name, sizeof(thread_name), "%s", name);
@@ -88,8 +140,7 @@ static int dp_log_eal(__rte_unused FILE *stream, const char *format, va_list ap)
 
 	// as _dp_log only supports custom logtypes, provide one directly
 	// logleves are supported fully
-	_dp_log(rte_log_cur_msg_loglevel(), RTE_LOGTYPE_DPSERVICE,
-			__FILE__, __LINE__, __FUNCTION__,
+	_dp_log(&eal_callsites[RTE_MIN((unsigned int)rte_log_cur_msg_loglevel(), (unsigned int)RTE_LOG_MAX)],
 			"EAL log message", _DP_LOG_STR("eal_msg", buf), NULL);
 
 	return written;
@@ -106,8 +157,18 @@ int dp_log_init(void)
 		return ret;
 	}
 
+	for (unsigned int level = 0; level < RTE_DIM(eal_callsites); ++level) {
+		eal_callsites[level].level = level;
+		eal_callsites[level].logtype = RTE_LOGTYPE_DPSERVICE;
+		eal_callsites[level].file = __FILE__;
+		eal_callsites[level].line = __LINE__;
+		eal_callsites[level].function = "dp_log_eal";
+	}
 	rte_log_set_print_func(dp_log_eal);
 
+	log_rate_limit = (uint32_t)dp_conf_get_log_rate_limit();
+	log_rate_window = rte_get_timer_hz();
+
 	log_json = dp_conf_get_log_format() == DP_CONF_LOG_FORMAT_JSON;
 	if (log_json) {
 		log_formatter = log_formatter_json;
@@ -147,21 +208,19 @@ static __rte_always_inline void clear_color(FILE *f)
 	fwrite(COLOR_END, 1, sizeof(COLOR_END)-1, f);
 }
 
-static inline int get_timestamp(char *buf)
+static inline int get_timestamp(const struct timespec *now, char *buf)
 {
-	struct timespec now;
 	struct tm tmnow;
 	size_t offset;
 
-	// coarse time is enough unless we want < 1ms precision
-	if (clock_gettime(CLOCK_REALTIME_COARSE, &now) < 0 || !gmtime_r(&now.tv_sec, &tmnow))
+	if (!gmtime_r(&now->tv_sec, &tmnow))
 		return DP_ERROR;
 
 	offset = strftime(buf, TIMESTAMP_MAXSIZE, TIMESTAMP_FMT, &tmnow);
 	if (!offset)
 		return DP_ERROR;
 
-	offset += snprintf(buf+offset, TIMESTAMP_MAXSIZE-offset, ".%.03lu", now.tv_nsec / 1000000);
+	offset += snprintf(buf+offset, TIMESTAMP_MAXSIZE-offset, ".%.03lu", now->tv_nsec / 1000000);
 	if (offset >= TIMESTAMP_MAXSIZE)
 		return DP_ERROR;
 
@@ -207,92 +266,76 @@ static __rte_always_inline const char *escape_message(const char *message, char
 	return log_json ? json_escape(message, buf, bufsize) : message;
 }
 
-void _dp_log(unsigned int level, unsigned int logtype,
-			 const char *file, unsigned int line, const char *function,
-			 const char *message, ...)
+static void dp_log_write(const struct dp_log_record *record)
 {
+	const struct dp_log_callsite *callsite = record->callsite;
 	char timestamp[TIMESTAMP_MAXSIZE];
-	va_list args;
 	FILE *f;
-	const char *key;
-	int format;
 	char escaped[3072];  // worst-case: 512 encoded characters (\u1234)
 	const char *str_value;
 	rte_be32_t ipv4_value;
 
-	if (!rte_log_can_log(logtype, level))
-		return;
-
-	if (DP_FAILED(get_timestamp(timestamp)))
+	if (DP_FAILED(get_timestamp(&record->timestamp, timestamp)))
 		memcpy(timestamp, TIMESTAMP_NUL, TIMESTAMP_MAXSIZE);  // including \0
 
-	// generate a new thread ID if this is the first log in a thread
-	if (!thread_id)
-		thread_id = __sync_add_and_fetch(&thread_id_generator, 1);
-
 	f = rte_log_get_stream();  // cannot fail (will return stderr instead)
 
 	flockfile(f);
 
 	if (log_colors)
-		set_color(f, level);
+		set_color(f, callsite->level);
 
 #ifdef DEBUG
 	// check the message for printf-format to prevent issues
-	for (const char *cur = message; *cur; ++cur)
+	for (const char *cur = record->message; *cur; ++cur)
 		assert(*cur != '%');
 #endif
 
 	// everything except the message value is JSON-safe
-	assert(level > 0 && level < RTE_DIM(log_levels));
-	assert(logtype >= RTE_LOGTYPE_USER1 && logtype <= RTE_LOGTYPE_USER1 + RTE_DIM(log_types_text));
-	fprintf(f, FORMAT_HEADER, timestamp, thread_id, thread_name,
-			log_levels[level], log_types[logtype-RTE_LOGTYPE_USER1],
-			escape_message(message, escaped, sizeof(escaped)));
-
-	va_start(args, message);
-
-	// this is pretty dangrous as there are no typechecks possible (that's varargs)
-	// but all logging should be done via wrapper macros, that should not allow the caller to mess up
-	while ((key = va_arg(args, const char *))) {
-		// custom format identifier with canary values should prevent some stack errors
-		format = va_arg(args, int);
-		switch (format) {
+	assert(callsite->level > 0 && callsite->level < RTE_DIM(log_levels));
+	assert(callsite->logtype >= RTE_LOGTYPE_USER1 && callsite->logtype <= RTE_LOGTYPE_USER1 + RTE_DIM(log_types_text));
+	fprintf(f, FORMAT_HEADER, timestamp, record->thread_id, record->thread_name,
+			log_levels[callsite->level], log_types[callsite->logtype-RTE_LOGTYPE_USER1],
+			escape_message(record->message, escaped, sizeof(escaped)));
+
+	for (const struct dp_log_arg *arg = record->args; arg < record->args + record->nb_args; ++arg) {
+		switch (arg->format) {
 		case _DP_LOG_FMT_STR:
-			str_value = escape_message(va_arg(args, const char *), escaped, sizeof(escaped));
-			fprintf(f, FORMAT_STR, key, str_value);
+			str_value = escape_message(record->strings + arg->str_offset, escaped, sizeof(escaped));
+			fprintf(f, FORMAT_STR, arg->key, str_value);
 			break;
 		case _DP_LOG_FMT_INT:
-			fprintf(f, FORMAT_INT, key, va_arg(args, int));
+			fprintf(f, FORMAT_INT, arg->key, arg->int_value);
 			break;
 		case _DP_LOG_FMT_UINT:
-			fprintf(f, FORMAT_UINT, key, va_arg(args, unsigned int));
+			fprintf(f, FORMAT_UINT, arg->key, arg->uint_value);
 			break;
 		case _DP_LOG_FMT_IPV4:
-			ipv4_value = va_arg(args, rte_be32_t);
-			fprintf(f, FORMAT_IPV4, key, ((ipv4_value) >> 24) & 0xFF,
-										 ((ipv4_value) >> 16) & 0xFF,
-										 ((ipv4_value) >> 8) & 0xFF,
-										  (ipv4_value) & 0xFF);
+			ipv4_value = arg->ipv4_value;
+			fprintf(f, FORMAT_IPV4, arg->key, ((ipv4_value) >> 24) & 0xFF,
+											  ((ipv4_value) >> 16) & 0xFF,
+											  ((ipv4_value) >> 8) & 0xFF,
+											   (ipv4_value) & 0xFF);
 			break;
 		case _DP_LOG_FMT_IPV6:
 			// re-use the escaping buffer for IP conversion
-			str_value = inet_ntop(AF_INET6, va_arg(args, const uint8_t *), escaped, INET6_ADDRSTRLEN);
-			fprintf(f, FORMAT_STR, key, str_value);
+			str_value = inet_ntop(AF_INET6, arg->ipv6_value, escaped, INET6_ADDRSTRLEN);
+			fprintf(f, FORMAT_STR, arg->key, str_value);
 			break;
 		case _DP_LOG_FMT_PTR:
-			fprintf(f, FORMAT_PTR, key, va_arg(args, const void *));
+			fprintf(f, FORMAT_PTR, arg->key, arg->ptr_value);
 			break;
 		default:
 			assert(false);
-			goto parse_error;
+			break;
 		}
 	}
-parse_error:
-	va_end(args);
+
+	if (record->suppressed)
+		fprintf(f, FORMAT_UINT, "suppressed", record->suppressed);
 
 	// everything here should be JSON-safe
-	fprintf(f, FORMAT_CALLER, file, line, function);
+	fprintf(f, FORMAT_CALLER, callsite->file, callsite->line, callsite->function);
 
 	if (log_colors)
 		clear_color(f);
@@ -304,6 +347,233 @@ parse_error:
 	funlockfile(f);
 }
 
+// strings are copied, because the record can outlive them
+static uint16_t dp_log_record_add_string(struct dp_log_record *record, const char *value)
+{
+	uint16_t offset = record->strings_used;
+	size_t len;
+
+	if (!value)
+		value = "(null)";
+
+	// the last byte is always a terminator, point there when out of space
+	if (offset >= sizeof(record->strings) - 1)
+		return (uint16_t)(sizeof(record->strings) - 1);
+
+	len = strnlen(value, sizeof(record->strings) - 1 - offset);
+	memcpy(record->strings + offset, value, len);
+	record->strings[offset + len] = '\0';
+	record->strings_used = (uint16_t)(offset + len + 1);
+	return offset;
+}
+
+static void dp_log_record_fill(struct dp_log_record *record, const char *message, va_list args)
+{
+	struct dp_log_arg *arg;
+	const char *key;
+
+	record->message = message;
+	record->nb_args = 0;
+	record->strings_used = 0;
+	record->strings[sizeof(record->strings) - 1] = '\0';
+
+	// this is pretty dangrous as there are no typechecks possible (that's varargs)
+	// but all logging should be done via wrapper macros, that should not allow the caller to mess up
+	while ((key = va_arg(args, const char *))) {
+		if (record->nb_args >= RTE_DIM(record->args)) {
+			assert(false);
+			break;
+		}
+		arg = &record->args[record->nb_args];
+		arg->key = key;
+		// custom format identifier with canary values should prevent some stack errors
+		arg->format = va_arg(args, int);
+		switch (arg->format) {
+		case _DP_LOG_FMT_STR:
+			arg->str_offset = dp_log_record_add_string(record, va_arg(args, const char *));
+			break;
+		case _DP_LOG_FMT_INT:
+			arg->int_value = va_arg(args, int);
+			break;
+		case _DP_LOG_FMT_UINT:
+			arg->uint_value = va_arg(args, unsigned int);
+			break;
+		case _DP_LOG_FMT_IPV4:
+			arg->ipv4_value = va_arg(args, rte_be32_t);
+			break;
+		case _DP_LOG_FMT_IPV6:
+			memcpy(arg->ipv6_value, va_arg(args, const uint8_t *), sizeof(arg->ipv6_value));
+			break;
+		case _DP_LOG_FMT_PTR:
+			arg->ptr_value = va_arg(args, const void *);
+			break;
+		default:
+			// arguments up to this point are still valid
+			assert(false);
+			return;
+		}
+		record->nb_args++;
+	}
+}
+
+static __rte_always_inline bool dp_log_rate_limited(struct dp_log_callsite *callsite, uint32_t *suppressed)
+{
+	uint64_t now;
+
+	*suppressed = 0;
+
+	if (!log_rate_limit || callsite->unlimited)
+		return false;
+
+	now = rte_get_timer_cycles();
+	if (now - callsite->window_start > log_rate_window) {
+		callsite->window_start = now;
+		callsite->window_count = 0;
+		// the first message of a new window reports what was lost in the previous ones
+		*suppressed = __atomic_exchange_n(&callsite->suppressed, 0, __ATOMIC_RELAXED);
+	}
+
+	if (callsite->window_count >= log_rate_limit) {
+		__atomic_fetch_add(&callsite->suppressed, 1, __ATOMIC_RELAXED);
+		return true;
+	}
+
+	callsite->window_count++;
+	return false;
+}
+
+void _dp_log(struct dp_log_callsite *callsite, const char *message, ...)
+{
+	struct dp_log_record record;
+	unsigned int lcore_id;
+	struct rte_ring *ring;
+	va_list args;
+
+	if (!rte_log_can_log(callsite->logtype, callsite->level))
+		return;
+
+	if (dp_log_rate_limited(callsite, &record.suppressed))
+		return;
+
+	// generate a new thread ID if this is the first log in a thread
+	if (!thread_id)
+		thread_id = __sync_add_and_fetch(&thread_id_generator, 1);
+
+	// coarse time is enough unless we want < 1ms precision
+	if (clock_gettime(CLOCK_REALTIME_COARSE, &record.timestamp) < 0)
+		memset(&record.timestamp, 0, sizeof(record.timestamp));
+
+	record.callsite = callsite;
+	record.thread_id = thread_id;
+	memcpy(record.thread_name, thread_name, sizeof(record.thread_name));
+
+	va_start(args, message);
+	dp_log_record_fill(&record, message, args);
+	va_end(args);
+
+	// worker lcores must never wait for the output stream
+	lcore_id = rte_lcore_id();
+	ring = lcore_id < RTE_MAX_LCORE ? log_rings[lcore_id] : NULL;
+	if (ring) {
+		if (unlikely(rte_ring_sp_enqueue_elem(ring, &record, sizeof(record)) != 0))
+			log_lost[lcore_id]++;
+		return;
+	}
+
+	dp_log_write(&record);
+}
+
+
+static unsigned int dp_log_drain_rings(void)
+{
+	struct dp_log_record record;
+	unsigned int lcore_id;
+	unsigned int drained = 0;
+	uint64_t lost;
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (!log_rings[lcore_id])
+			continue;
+		// do not let one busy lcore starve others
+		for (unsigned int i = 0; i < DP_LOG_DRAIN_BURST; ++i) {
+			if (rte_ring_sc_dequeue_elem(log_rings[lcore_id], &record, sizeof(record)) != 0)
+				break;
+			dp_log_write(&record);
+			drained++;
+		}
+		lost = log_lost[lcore_id];
+		if (lost != log_lost_reported[lcore_id]) {
+			DPS_LOG_WARNING("Log messages lost, log ring is full", DP_LOG_LCORE(lcore_id),
+							DP_LOG_VALUE((int)(lost - log_lost_reported[lcore_id])));
+			log_lost_reported[lcore_id] = lost;
+		}
+	}
+
+	return drained;
+}
+
+static uint32_t dp_log_main_loop(__rte_unused void *arg)
+{
+	dp_log_set_thread_name("log");
+
+	while (log_thread_running) {
+		if (!dp_log_drain_rings())
+			usleep(DP_LOG_IDLE_SLEEP_US);
+	}
+
+	// workers are already stopped, write out everything that is left
+	while (dp_log_drain_rings());
+	return 0;
+}
+
+int dp_log_async_init(void)
+{
+	char name[RTE_RING_NAMESIZE];
+	unsigned int lcore_id;
+	int ret;
+
+	static_assert(sizeof(struct dp_log_record) % 4 == 0, "Log record cannot be used as a ring element");
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		snprintf(name, sizeof(name), "log_ring_%u", lcore_id);
+		log_rings[lcore_id] = rte_ring_create_elem(name, sizeof(struct dp_log_record), DP_LOG_RING_SIZE,
+												   (int)rte_lcore_to_socket_id(lcore_id), RING_F_SP_ENQ | RING_F_SC_DEQ);
+		if (!log_rings[lcore_id]) {
+			DPS_LOG_ERR("Cannot create log ring", DP_LOG_LCORE(lcore_id), DP_LOG_RET(rte_errno));
+			dp_log_async_free();
+			return DP_ERROR;
+		}
+	}
+
+	log_thread_running = true;
+	ret = rte_thread_create_control(&log_thread_id, "log-thread", dp_log_main_loop, NULL);
+	if (DP_FAILED(ret)) {
+		DPS_LOG_ERR("Cannot create logging thread", DP_LOG_RET(ret));
+		log_thread_running = false;
+		dp_log_async_free();
+		return ret;
+	}
+	log_thread_started = true;
+
+	return DP_OK;
+}
+
+void dp_log_async_free(void)
+{
+	unsigned int lcore_id;
+
+	if (log_thread_started) {
+		log_thread_running = false;
+		rte_thread_join(log_thread_id, NULL);
+		log_thread_started = false;
+	}
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		rte_ring_free(log_rings[lcore_id]);
+		log_rings[lcore_id] = NULL;
+	}
+}
+
 void _dp_log_early(FILE *f, const char *format, ...)
 {
 	va_list args;
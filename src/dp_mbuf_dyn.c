@@ -3,4 +3,4 @@
 
 #include "dp_mbuf_dyn.h"
 
-rte_atomic32_t dp_pkt_id_counter = {0};
+RTE_DEFINE_PER_LCORE(uint32_t, dp_pkt_id_counter);
@@ -10,6 +10,8 @@
 #include <rte_ip.h>
 #include <rte_tcp.h>
 #include <rte_udp.h>
+#include "dp_cksum.h"
+#include "dp_conf.h"
 #include "dp_error.h"
 #include "dp_internal_stats.h"
 #include "dp_log.h"
@@ -22,10 +24,6 @@
 
 #define DP_NAT_FULL_LOG_DELAY 5  /* seconds */
 
-// This is based on the fact that neighnats are being put in the table along with local NAT/VIP
-// To prevent it from being too large, this is assuming 2048 ports per NAT range (32 ranges/IP)
-#define DP_NAT_TABLE_MAX (DP_MAX_VF_PORTS * 32)
-
 TAILQ_HEAD(network_nat_head, network_nat_entry);
 
 static struct rte_hash *ipv4_dnat_tbl = NULL;
@@ -37,25 +35,32 @@ static struct network_nat_head nat_headp;
 
 static uint64_t dp_nat_full_log_delay;
 
+static int nat_table_size = DP_NAT_TABLE_MAX;
+static int netnat_table_size = DP_FLOW_TABLE_MAX;
+
 int dp_nat_init(int socket_id)
 {
-	ipv4_snat_tbl = dp_create_jhash_table(DP_NAT_TABLE_MAX, sizeof(struct nat_key),
+	nat_table_size = dp_conf_get_nat_table_size();
+	// there can be as many network NAT entries as there are flows (even after the flow table grows)
+	netnat_table_size = RTE_MAX(dp_conf_get_flow_table_size(), dp_conf_get_flow_table_max_size());
+
+	ipv4_snat_tbl = dp_create_jhash_table(nat_table_size, sizeof(struct nat_key),
 										  "ipv4_snat_table", socket_id);
 	if (!ipv4_snat_tbl)
 		return DP_ERROR;
 
-	ipv4_dnat_tbl = dp_create_jhash_table(DP_NAT_TABLE_MAX, sizeof(struct nat_key),
+	ipv4_dnat_tbl = dp_create_jhash_table(nat_table_size, sizeof(struct nat_key),
 										  "ipv4_dnat_table", socket_id);
 	if (!ipv4_dnat_tbl)
 		return DP_ERROR;
 
-	ipv4_netnat_portmap_tbl = dp_create_jhash_table(DP_FLOW_TABLE_MAX, sizeof(struct netnat_portmap_key),
+	ipv4_netnat_portmap_tbl = dp_create_jhash_table(netnat_table_size, sizeof(struct netnat_portmap_key),
 												  "ipv4_netnat_portmap_table", socket_id);
 
 	if (!ipv4_netnat_portmap_tbl)
 		return DP_ERROR;
 
-	ipv4_netnat_portoverload_tbl = dp_create_jhash_table(DP_FLOW_TABLE_MAX, sizeof(struct netnat_portoverload_tbl_key),
+	ipv4_netnat_portoverload_tbl = dp_create_jhash_table(netnat_table_size, sizeof(struct netnat_portoverload_tbl_key),
 												  "ipv4_netnat_portoverload_tbl", socket_id);
 
 	if (!ipv4_netnat_portoverload_tbl)
@@ -76,6 +81,20 @@ void dp_nat_free(void)
 	dp_free_jhash_table(ipv4_snat_tbl);
 }
 
+int dp_nat_get_tables_telemetry(struct rte_tel_data *dict)
+{
+	if (DP_FAILED(dp_add_table_telemetry(dict, "ipv4_snat_table",
+										 (uint32_t)rte_hash_count(ipv4_snat_tbl), (uint32_t)nat_table_size))
+		|| DP_FAILED(dp_add_table_telemetry(dict, "ipv4_dnat_table",
+											(uint32_t)rte_hash_count(ipv4_dnat_tbl), (uint32_t)nat_table_size))
+		|| DP_FAILED(dp_add_table_telemetry(dict, "ipv4_netnat_portmap_table",
+											(uint32_t)rte_hash_count(ipv4_netnat_portmap_tbl), (uint32_t)netnat_table_size))
+		|| DP_FAILED(dp_add_table_telemetry(dict, "ipv4_netnat_portoverload_table",
+											(uint32_t)rte_hash_count(ipv4_netnat_portoverload_tbl), (uint32_t)netnat_table_size)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
 struct snat_data *dp_get_iface_snat_data(uint32_t iface_ip, uint32_t vni)
 {
 	struct snat_data *data;
@@ -297,25 +316,6 @@ void dp_nat_chg_ip(struct dp_flow *df, struct rte_ipv4_hdr *ipv4_hdr,
 	}
 }
 
-static void dp_calculate_icmp_checksum(struct rte_icmp_hdr *icmp_hdr, size_t icmp_len)
-{
-	uint32_t sum = 0;
-	uint16_t word;
-	uint8_t *ptr = (uint8_t *)icmp_hdr;
-
-	icmp_hdr->icmp_cksum = 0;
-
-	for (size_t i = 0; i < icmp_len; i += 2) {
-		word = (uint16_t)((uint16_t)ptr[i] | ((uint16_t)ptr[i + 1] << 8));
-		sum += word;
-	}
-
-	while (sum >> 16)
-		sum = (sum & 0xFFFF) + (sum >> 16);
-
-	icmp_hdr->icmp_cksum = ~((uint16_t)sum);
-}
-
 int dp_nat_chg_ipv6_to_ipv4_hdr(struct dp_flow *df, struct rte_mbuf *m, uint32_t nat_ip, rte_be32_t *dest_ip /* out */)
 {
 	struct rte_ether_hdr *eth_hdr;
@@ -324,6 +324,9 @@ int dp_nat_chg_ipv6_to_ipv4_hdr(struct dp_flow *df, struct rte_mbuf *m, uint32_t
 	struct rte_icmp_hdr *icmp_hdr;
 	struct rte_udp_hdr *udp_hdr;
 	struct rte_tcp_hdr *tcp_hdr;
+	unaligned_uint16_t *icmp_type_code;
+	uint16_t icmp_old_type_code;
+	uint16_t icmp_phdr_cksum = 0;
 	uint8_t l4_proto;
 
 	eth_hdr = rte_pktmbuf_mtod(m, struct rte_ether_hdr *);
@@ -333,6 +336,10 @@ int dp_nat_chg_ipv6_to_ipv4_hdr(struct dp_flow *df, struct rte_mbuf *m, uint32_t
 	*dest_ip = *(int *)&ipv6_hdr->dst_addr[12];
 	l4_proto = ipv6_hdr->proto;
 
+	// ICMPv6 checksum covers the IPv6 pseudo-header, needs to be taken out before the header gets overwritten
+	if (df->l4_type == IPPROTO_ICMPV6)
+		icmp_phdr_cksum = rte_ipv6_phdr_cksum(ipv6_hdr, 0);
+
 	// Adjust the packet data to fit IPv4
 	if (rte_pktmbuf_adj(m, sizeof(struct rte_ipv6_hdr) - sizeof(struct rte_ipv4_hdr)) == NULL)
 		return DP_ERROR;
@@ -383,6 +390,8 @@ int dp_nat_chg_ipv6_to_ipv4_hdr(struct dp_flow *df, struct rte_mbuf *m, uint32_t
 		m->l4_type = IPPROTO_ICMP;
 
 		icmp_hdr = (struct rte_icmp_hdr *)(ipv4_hdr + 1);
+		icmp_type_code = (unaligned_uint16_t *)icmp_hdr;
+		icmp_old_type_code = *icmp_type_code;
 		icmp_hdr->icmp_code = 0;
 		if (icmp_hdr->icmp_type == DP_ICMPV6_ECHO_REQUEST)
 			icmp_hdr->icmp_type = RTE_IP_ICMP_ECHO_REQUEST;
@@ -390,7 +399,9 @@ int dp_nat_chg_ipv6_to_ipv4_hdr(struct dp_flow *df, struct rte_mbuf *m, uint32_t
 			icmp_hdr->icmp_type = RTE_IP_ICMP_ECHO_REPLY;
 		else
 			return DP_ERROR; //Drop unsupported ICMP Types for the time being
-		dp_calculate_icmp_checksum(icmp_hdr, rte_be_to_cpu_16(ipv4_hdr->total_length) - ((ipv4_hdr->version_ihl & 0x0F) * 4));
+		// no need to sum the whole message, only the type and the pseudo-header changed
+		icmp_hdr->icmp_cksum = dp_cksum_update16(icmp_hdr->icmp_cksum, icmp_old_type_code, *icmp_type_code);
+		icmp_hdr->icmp_cksum = dp_cksum_sub(icmp_hdr->icmp_cksum, icmp_phdr_cksum);
 	break;
 	default:
 		return DP_ERROR;
@@ -407,6 +418,8 @@ int dp_nat_chg_ipv4_to_ipv6_hdr(struct dp_flow *df, struct rte_mbuf *m, const ui
 	struct rte_icmp_hdr *icmp_hdr;
 	struct rte_udp_hdr *udp_hdr;
 	struct rte_tcp_hdr *tcp_hdr;
+	unaligned_uint16_t *icmp_type_code;
+	uint16_t icmp_old_type_code;
 	uint32_t src_ipv4;
 	uint8_t l4_proto;
 
@@ -461,8 +474,9 @@ int dp_nat_chg_ipv4_to_ipv6_hdr(struct dp_flow *df, struct rte_mbuf *m, const ui
 		m->l4_len = sizeof(struct rte_icmp_hdr);
 		ipv6_hdr->proto = IPPROTO_ICMPV6;
 		icmp_hdr = (struct rte_icmp_hdr *)(ipv6_hdr + 1);
+		icmp_type_code = (unaligned_uint16_t *)icmp_hdr;
+		icmp_old_type_code = *icmp_type_code;
 		icmp_hdr->icmp_code = 0;
-		icmp_hdr->icmp_cksum = 0;
 
 		if (icmp_hdr->icmp_type == RTE_IP_ICMP_ECHO_REQUEST)
 			icmp_hdr->icmp_type = DP_ICMPV6_ECHO_REQUEST;
@@ -470,7 +484,9 @@ int dp_nat_chg_ipv4_to_ipv6_hdr(struct dp_flow *df, struct rte_mbuf *m, const ui
 			icmp_hdr->icmp_type = DP_ICMPV6_ECHO_REPLY;
 		else
 			return DP_ERROR; //Drop unsupported ICMP Types for the time being
-		icmp_hdr->icmp_cksum = rte_ipv6_udptcp_cksum(ipv6_hdr, icmp_hdr);
+		// no need to sum the whole message, only the type and the pseudo-header changed
+		icmp_hdr->icmp_cksum = dp_cksum_update16(icmp_hdr->icmp_cksum, icmp_old_type_code, *icmp_type_code);
+		icmp_hdr->icmp_cksum = dp_cksum_add(icmp_hdr->icmp_cksum, rte_ipv6_phdr_cksum(ipv6_hdr, 0));
 		break;
 	default:
 		return DP_ERROR;
@@ -696,7 +712,7 @@ int dp_allocate_network_snat_port(struct snat_data *snat_data, struct dp_flow *d
 								DP_LOG_VNI(vni), DP_LOG_SRC_IPV4(iface_src_ip),
 								DP_LOG_SRC_PORT(iface_src_port));
 			}
-			return DP_ERROR;
+			return -ENOSPC;
 		}
 
 	}
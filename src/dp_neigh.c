@@ -0,0 +1,192 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dp_neigh.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <rte_ethdev.h>
+#include <rte_thread.h>
+#include "dp_error.h"
+#include "dp_log.h"
+#include "dp_netlink.h"
+#include "dp_port.h"
+#include "dp_util.h"
+#include "monitoring/dp_event.h"
+
+// how often the thread checks for shutdown when there are no neighbor events
+#define DP_NEIGH_RECV_TIMEOUT_S 1
+
+struct dp_neigh_pf {
+	int						if_index;
+	uint16_t				port_id;
+	struct rte_ether_addr	own_mac;
+	struct rte_ether_addr	router_mac;  // last value sent to the worker
+	uint8_t					router_ipv6[DP_IPV6_ADDR_SIZE];  // only this entry is followed (zero until known)
+};
+
+static struct dp_neigh_pf neigh_pfs[DP_MAX_PF_PORTS];
+static int neigh_pf_count = 0;
+
+static int neigh_socket = -1;
+static rte_thread_t neigh_thread_id;
+static bool neigh_thread_started = false;
+static volatile bool neigh_thread_running = false;
+
+
+static struct dp_neigh_pf *dp_neigh_get_pf(int if_index)
+{
+	for (int i = 0; i < neigh_pf_count; ++i)
+		if (neigh_pfs[i].if_index == if_index)
+			return &neigh_pfs[i];
+	return NULL;
+}
+
+static void dp_neigh_process_msg(struct nlmsghdr *nh)
+{
+	struct dp_neigh_pf *pf;
+	struct rte_ether_addr mac;
+	uint8_t ipv6[DP_IPV6_ADDR_SIZE];
+	char mac_str[RTE_ETHER_ADDR_FMT_SIZE];
+
+	// removed entries are ignored, the last known router is better than none
+	if (nh->nlmsg_type != RTM_NEWNEIGH)
+		return;
+
+	pf = dp_neigh_get_pf(((struct ndmsg *)NLMSG_DATA(nh))->ndm_ifindex);
+	if (!pf || !dp_netlink_get_router(nh, &mac, ipv6)
+		|| DP_MAC_EQUAL(&mac, &pf->own_mac))
+		return;
+
+	// other routers on the link must not take over, the first one seen is used if there was none at init
+	if (dp_is_ipv6_addr_zero(pf->router_ipv6))
+		memcpy(pf->router_ipv6, ipv6, sizeof(pf->router_ipv6));
+	else if (memcmp(ipv6, pf->router_ipv6, sizeof(pf->router_ipv6)))
+		return;
+
+	if (DP_MAC_EQUAL(&mac, &pf->router_mac))
+		return;
+
+	rte_ether_format_addr(mac_str, sizeof(mac_str), &mac);
+	if (DP_FAILED(dp_send_event_neigh_msg(pf->port_id, &mac))) {
+		DPS_LOG_ERR("Cannot pass new underlay router MAC to worker", DP_LOG_PORTID(pf->port_id), DP_LOG_MAC(mac_str));
+		return;
+	}
+
+	DPS_LOG_INFO("Underlay router MAC changed", DP_LOG_PORTID(pf->port_id), DP_LOG_MAC(mac_str));
+	rte_ether_addr_copy(&mac, &pf->router_mac);
+}
+
+static uint32_t dp_neigh_main_loop(__rte_unused void *arg)
+{
+	char buf[DP_NLINK_BUF_SIZE];
+	struct nlmsghdr *nh;
+	ssize_t len;
+	uint32_t nll;
+
+	dp_log_set_thread_name("neigh");
+
+	while (neigh_thread_running) {
+		len = recv(neigh_socket, buf, sizeof(buf), 0);
+		if (len < 0) {
+			// socket overrun means lost events, but the next change will still be picked up
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+				DPS_LOG_WARNING("Cannot receive neighbor events from netlink", DP_LOG_NETLINK(strerror(errno)));
+			continue;
+		}
+		nll = (uint32_t)len;
+		for (nh = (struct nlmsghdr *)buf; NLMSG_OK(nh, nll); nh = NLMSG_NEXT(nh, nll))
+			dp_neigh_process_msg(nh);
+	}
+
+	return 0;
+}
+
+static int dp_neigh_open_socket(void)
+{
+	struct sockaddr_nl sa = {
+		.nl_family = AF_NETLINK,
+		.nl_groups = RTMGRP_NEIGH,
+	};
+	struct timeval timeout = {
+		.tv_sec = DP_NEIGH_RECV_TIMEOUT_S,
+	};
+
+	neigh_socket = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+	if (neigh_socket < 0) {
+		DPS_LOG_ERR("Cannot open netlink socket", DP_LOG_NETLINK(strerror(errno)));
+		return DP_ERROR;
+	}
+
+	if (setsockopt(neigh_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0) {
+		DPS_LOG_ERR("Cannot set netlink socket timeout", DP_LOG_NETLINK(strerror(errno)));
+		return DP_ERROR;
+	}
+
+	if (bind(neigh_socket, (struct sockaddr *)&sa, sizeof(sa)) < 0) {
+		DPS_LOG_ERR("Cannot bind to netlink", DP_LOG_NETLINK(strerror(errno)));
+		return DP_ERROR;
+	}
+
+	return DP_OK;
+}
+
+int dp_neigh_init(void)
+{
+	struct rte_eth_dev_info dev_info;
+	const struct dp_port *port;
+	int ret;
+
+	for (uint16_t i = 0; i < DP_MAX_PF_PORTS; ++i) {
+		port = dp_get_port_by_pf_index(i);
+		if (!port)
+			continue;
+		ret = rte_eth_dev_info_get(port->port_id, &dev_info);
+		if (DP_FAILED(ret)) {
+			DPS_LOG_ERR("Cannot get device info", DP_LOG_PORT(port), DP_LOG_RET(ret));
+			return DP_ERROR;
+		}
+		// without a kernel interface there is no neighbor table to watch (software devices for benchmarking)
+		if (dev_info.if_index == 0)
+			continue;
+		neigh_pfs[neigh_pf_count].if_index = (int)dev_info.if_index;
+		neigh_pfs[neigh_pf_count].port_id = port->port_id;
+		rte_ether_addr_copy(&port->own_mac, &neigh_pfs[neigh_pf_count].own_mac);
+		rte_ether_addr_copy(&port->neigh_mac, &neigh_pfs[neigh_pf_count].router_mac);
+		memcpy(neigh_pfs[neigh_pf_count].router_ipv6, port->neigh_ipv6, sizeof(neigh_pfs[neigh_pf_count].router_ipv6));
+		neigh_pf_count++;
+	}
+
+	if (!neigh_pf_count)
+		return DP_OK;
+
+	if (DP_FAILED(dp_neigh_open_socket()))
+		return DP_ERROR;
+
+	neigh_thread_running = true;
+	ret = rte_thread_create_control(&neigh_thread_id, "neigh-thread", dp_neigh_main_loop, NULL);
+	if (DP_FAILED(ret)) {
+		DPS_LOG_ERR("Cannot create neighbor thread", DP_LOG_RET(ret));
+		neigh_thread_running = false;
+		return ret;
+	}
+	neigh_thread_started = true;
+
+	return DP_OK;
+}
+
+void dp_neigh_free(void)
+{
+	if (neigh_thread_started) {
+		neigh_thread_running = false;
+		rte_thread_join(neigh_thread_id, NULL);
+		neigh_thread_started = false;
+	}
+	if (neigh_socket >= 0) {
+		close(neigh_socket);
+		neigh_socket = -1;
+	}
+	neigh_pf_count = 0;
+}
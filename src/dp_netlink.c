@@ -14,27 +14,42 @@
 #include "dp_netlink.h"
 #include "dp_util.h"
 
-static int dp_read_neigh(struct nlmsghdr *nh, __u32 nll, struct rte_ether_addr *neigh,
+bool dp_netlink_get_router(struct nlmsghdr *nh, struct rte_ether_addr *mac, uint8_t ipv6[DP_IPV6_ADDR_SIZE])
+{
+	struct ndmsg *rt_msg = (struct ndmsg *)NLMSG_DATA(nh);
+	struct rtattr *rt_attr = (struct rtattr *)RTM_RTA(rt_msg);
+	size_t rtl = RTM_PAYLOAD(nh);
+	bool has_mac = false;
+	bool has_ipv6 = false;
+
+	if (rt_msg->ndm_family != AF_INET6
+		|| rt_msg->ndm_state == NUD_NOARP
+		|| !(rt_msg->ndm_flags & NTF_ROUTER))
+		return false;
+
+	for (; RTA_OK(rt_attr, rtl); rt_attr = RTA_NEXT(rt_attr, rtl)) {
+		if (rt_attr->rta_type == NDA_LLADDR && RTA_PAYLOAD(rt_attr) == sizeof(mac->addr_bytes)) {
+			memcpy(&mac->addr_bytes, RTA_DATA(rt_attr), sizeof(mac->addr_bytes));
+			has_mac = true;
+		} else if (rt_attr->rta_type == NDA_DST && RTA_PAYLOAD(rt_attr) == DP_IPV6_ADDR_SIZE) {
+			memcpy(ipv6, RTA_DATA(rt_attr), DP_IPV6_ADDR_SIZE);
+			has_ipv6 = true;
+		}
+	}
+	return has_mac && has_ipv6;
+}
+
+static int dp_read_neigh(struct nlmsghdr *nh, __u32 nll, struct rte_ether_addr *neigh, uint8_t neigh_ipv6[DP_IPV6_ADDR_SIZE],
 						 const struct rte_ether_addr *own_mac)
 {
-	struct rtattr *rt_attr;
-	struct ndmsg *rt_msg;
-	size_t rtl, ndm_family;
+	struct rte_ether_addr mac;
+	uint8_t ipv6[DP_IPV6_ADDR_SIZE];
 
 	for (; NLMSG_OK(nh, nll); nh = NLMSG_NEXT(nh, nll)) {
-		rt_msg = (struct ndmsg *)NLMSG_DATA(nh);
-		rt_attr = (struct rtattr *)RTM_RTA(rt_msg);
-		ndm_family = rt_msg->ndm_family;
-		if ((ndm_family != AF_INET6) || (rt_msg->ndm_state == NUD_NOARP))
-			continue;
-		if (rt_msg->ndm_flags & NTF_ROUTER) {
-			rtl = RTM_PAYLOAD(nh);
-			for (; RTA_OK(rt_attr, rtl); rt_attr = RTA_NEXT(rt_attr, rtl)) {
-				if (rt_attr->rta_type == NDA_LLADDR)
-					memcpy(&neigh->addr_bytes, RTA_DATA(rt_attr), sizeof(neigh->addr_bytes));
-			}
-			if (!DP_MAC_EQUAL(own_mac, neigh))
-				return DP_OK;
+		if (dp_netlink_get_router(nh, &mac, ipv6) && !DP_MAC_EQUAL(own_mac, &mac)) {
+			rte_ether_addr_copy(&mac, neigh);
+			memcpy(neigh_ipv6, ipv6, DP_IPV6_ADDR_SIZE);
+			return DP_OK;
 		}
 	}
 	return DP_ERROR;
@@ -66,7 +81,8 @@ static int dp_recv_msg(struct sockaddr_nl sock_addr, int sock, char *buf, int bu
 	return (int)msg_len;
 }
 
-int dp_get_pf_neigh_mac(int if_idx, struct rte_ether_addr *neigh, const struct rte_ether_addr *own_mac)
+int dp_get_pf_neigh_mac(int if_idx, struct rte_ether_addr *neigh, uint8_t neigh_ipv6[DP_IPV6_ADDR_SIZE],
+						const struct rte_ether_addr *own_mac)
 {
 	struct sockaddr_nl sa = {
 		.nl_family = AF_NETLINK,
@@ -120,7 +136,7 @@ int dp_get_pf_neigh_mac(int if_idx, struct rte_ether_addr *neigh, const struct r
 	}
 
 	// TODO this should be an error in production
-	if (DP_FAILED(dp_read_neigh((struct nlmsghdr *)reply, reply_len, neigh, own_mac)))
+	if (DP_FAILED(dp_read_neigh((struct nlmsghdr *)reply, reply_len, neigh, neigh_ipv6, own_mac)))
 		DPS_LOG_WARNING("No neighboring router found");
 
 	ret = DP_OK;
@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dp_numa.h"
+#include <rte_lcore.h>
+#include <rte_memory.h>
+#include <rte_memzone.h>
+#include <rte_spinlock.h>
+#include "dp_error.h"
+#include "dp_log.h"
+#include "dp_port.h"
+
+// pools, rings and tables, including flow tables prepared for growth
+#define DP_NUMA_MAX_OBJECTS 64
+
+struct dp_numa_object {
+	const void *addr;
+	int socket_id;
+	char name[RTE_MEMZONE_NAMESIZE];
+};
+
+// objects can be added by the worker (flow table growth) and read by telemetry
+static struct dp_numa_object numa_objects[DP_NUMA_MAX_OBJECTS];
+static rte_spinlock_t numa_objects_lock = RTE_SPINLOCK_INITIALIZER;
+
+int dp_numa_get_worker_socket_id(void)
+{
+	unsigned int lcore_id = rte_get_next_lcore(-1, 1, 0);
+
+	if (lcore_id >= RTE_MAX_LCORE)
+		lcore_id = rte_get_main_lcore();
+
+	return (int)rte_lcore_to_socket_id(lcore_id);
+}
+
+// where the memory actually is, not where it was requested to be
+static int dp_numa_get_memory_socket_id(const void *addr)
+{
+	const struct rte_memseg *ms = rte_mem_virt2memseg(addr, NULL);
+
+	return ms ? ms->socket_id : SOCKET_ID_ANY;
+}
+
+void dp_numa_register(const char *name, const void *addr, int socket_id)
+{
+	int actual_socket_id = dp_numa_get_memory_socket_id(addr);
+
+	if (socket_id != SOCKET_ID_ANY && actual_socket_id != SOCKET_ID_ANY && socket_id != actual_socket_id)
+		DPS_LOG_WARNING("Memory object is not on the requested NUMA node",
+						DP_LOG_NAME(name), DP_LOG_SOCKID(socket_id), _DP_LOG_INT("actual_socket_id", actual_socket_id));
+
+	rte_spinlock_lock(&numa_objects_lock);
+	for (int i = 0; i < DP_NUMA_MAX_OBJECTS; ++i) {
+		if (!numa_objects[i].addr) {
+			numa_objects[i].addr = addr;
+			numa_objects[i].socket_id = actual_socket_id;
+			snprintf(numa_objects[i].name, sizeof(numa_objects[i].name), "%s", name);
+			rte_spinlock_unlock(&numa_objects_lock);
+			return;
+		}
+	}
+	rte_spinlock_unlock(&numa_objects_lock);
+
+	// not fatal, only reporting is affected
+	DPS_LOG_WARNING("Too many memory objects to track NUMA placement", DP_LOG_NAME(name), DP_LOG_MAX(DP_NUMA_MAX_OBJECTS));
+}
+
+void dp_numa_unregister(const void *addr)
+{
+	if (!addr)
+		return;
+
+	rte_spinlock_lock(&numa_objects_lock);
+	for (int i = 0; i < DP_NUMA_MAX_OBJECTS; ++i) {
+		if (numa_objects[i].addr == addr) {
+			numa_objects[i].addr = NULL;
+			break;
+		}
+	}
+	rte_spinlock_unlock(&numa_objects_lock);
+}
+
+void dp_numa_check_placement(void)
+{
+	int worker_socket_id = dp_numa_get_worker_socket_id();
+
+	if (rte_socket_count() <= 1)
+		return;
+
+	// VFs are functions of the same device, no need to warn about each one of them
+	DP_FOREACH_PORT(dp_get_ports(), port) {
+		if (port->is_pf && port->socket_id != SOCKET_ID_ANY && port->socket_id != worker_socket_id)
+			DPS_LOG_WARNING("Port is attached to a different NUMA node than the worker, packets will cross sockets",
+							DP_LOG_PORT(port), _DP_LOG_INT("worker_socket_id", worker_socket_id));
+	}
+
+	rte_spinlock_lock(&numa_objects_lock);
+	for (int i = 0; i < DP_NUMA_MAX_OBJECTS; ++i) {
+		if (numa_objects[i].addr && numa_objects[i].socket_id != worker_socket_id)
+			DPS_LOG_WARNING("Memory object is not on the worker's NUMA node",
+							DP_LOG_NAME(numa_objects[i].name), DP_LOG_SOCKID(numa_objects[i].socket_id),
+							_DP_LOG_INT("worker_socket_id", worker_socket_id));
+	}
+	rte_spinlock_unlock(&numa_objects_lock);
+}
+
+static int dp_numa_add_ports_telemetry(struct rte_tel_data *dict)
+{
+	struct rte_tel_data *ports;
+	int ret;
+
+	ports = rte_tel_data_alloc();
+	if (!ports) {
+		DPS_LOG_ERR("Failed to allocate port placement telemetry data");
+		return DP_ERROR;
+	}
+
+	ret = rte_tel_data_start_dict(ports);
+	if (DP_FAILED(ret))
+		goto error;
+
+	DP_FOREACH_PORT(dp_get_ports(), port) {
+		ret = rte_tel_data_add_dict_int(ports, port->dev_name, port->socket_id);
+		if (DP_FAILED(ret))
+			goto error;
+	}
+
+	ret = rte_tel_data_add_dict_container(dict, "ports", ports, 0);
+	if (DP_FAILED(ret))
+		goto error;
+
+	return DP_OK;
+
+error:
+	DPS_LOG_ERR("Failed to add port placement telemetry data", DP_LOG_RET(ret));
+	rte_tel_data_free(ports);
+	return ret;
+}
+
+static int dp_numa_add_objects_telemetry(struct rte_tel_data *dict)
+{
+	struct rte_tel_data *objects;
+	int ret;
+
+	objects = rte_tel_data_alloc();
+	if (!objects) {
+		DPS_LOG_ERR("Failed to allocate memory placement telemetry data");
+		return DP_ERROR;
+	}
+
+	ret = rte_tel_data_start_dict(objects);
+	if (DP_FAILED(ret))
+		goto error;
+
+	rte_spinlock_lock(&numa_objects_lock);
+	for (int i = 0; i < DP_NUMA_MAX_OBJECTS; ++i) {
+		if (numa_objects[i].addr) {
+			ret = rte_tel_data_add_dict_int(objects, numa_objects[i].name, numa_objects[i].socket_id);
+			if (DP_FAILED(ret))
+				break;
+		}
+	}
+	rte_spinlock_unlock(&numa_objects_lock);
+	if (DP_FAILED(ret))
+		goto error;
+
+	ret = rte_tel_data_add_dict_container(dict, "objects", objects, 0);
+	if (DP_FAILED(ret))
+		goto error;
+
+	return DP_OK;
+
+error:
+	DPS_LOG_ERR("Failed to add memory placement telemetry data", DP_LOG_RET(ret));
+	rte_tel_data_free(objects);
+	return ret;
+}
+
+int dp_numa_get_placement_telemetry(struct rte_tel_data *dict)
+{
+	int ret;
+
+	ret = rte_tel_data_add_dict_int(dict, "worker_socket", dp_numa_get_worker_socket_id());
+	if (DP_FAILED(ret)) {
+		DPS_LOG_ERR("Failed to add worker placement telemetry data", DP_LOG_RET(ret));
+		return ret;
+	}
+
+	if (DP_FAILED(dp_numa_add_ports_telemetry(dict))
+		|| DP_FAILED(dp_numa_add_objects_telemetry(dict)))
+		return DP_ERROR;
+
+	return DP_OK;
+}
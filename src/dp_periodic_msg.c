@@ -12,95 +12,62 @@
 #include "nodes/arp_node.h"
 #include "nodes/ipv6_nd_node.h"
 
+enum dp_periodic_msg_type {
+	DP_PERIODIC_MSG_GARP,
+	DP_PERIODIC_MSG_ND_NA,
+	DP_PERIODIC_MSG_ND_RA,
+	DP_PERIODIC_MSG_COUNT,
+};
+
+// everything the announcement packets depend on, templates are only rebuilt when this changes
+struct dp_periodic_msg_key {
+	struct rte_ether_addr	own_mac;
+	uint32_t				own_ip;
+	uint8_t					dhcp_ipv6[DP_IPV6_ADDR_SIZE];
+	bool					arp_cycle;
+	bool					ipv6_enabled;
+};
+
+struct dp_periodic_msg_templates {
+	struct dp_periodic_msg_key	key;
+	struct rte_mbuf				*pkts[DP_PERIODIC_MSG_COUNT];
+};
+
+static struct dp_periodic_msg_templates templates[DP_MAX_PORTS];
+
 static uint8_t dp_mc_ipv6[16] = { 0xff, 0x02, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01 };
 static uint8_t dp_mc_mac[6] = { 0x33, 0x33, 0x00, 0x00, 0x00, 0x01 };
 
-static __rte_always_inline bool dp_is_ip_set(struct dp_port *port, uint16_t eth_type)
-{
-	return (eth_type == RTE_ETHER_TYPE_IPV6 && !dp_is_ipv6_addr_zero(port->iface.cfg.dhcp_ipv6)) ||
-		   (eth_type == RTE_ETHER_TYPE_ARP && port->iface.cfg.own_ip != 0);
-}
 
-void send_to_all_vfs(const struct rte_mbuf *pkt, uint16_t eth_type)
+static struct rte_mbuf *dp_periodic_msg_alloc(const struct dp_port *port, uint32_t packet_type)
 {
-	struct nd_opt_source_link_layer *src_ll_addr;
-	struct dp_flow *df;
-	struct rte_ether_hdr *eth_hdr;
-	struct rte_arp_hdr *arp_hdr;
-	struct dp_dpdk_layer *dp_layer = get_dpdk_layer();
-	const struct dp_ports *ports = dp_get_ports();
-	struct rte_mbuf *clone_buf;
-	struct rte_ipv6_hdr *ipv6_hdr;
-	struct ra_msg *ra_msg;
-	struct icmp6hdr *icmp6_hdr;
-	int ret;
-
-	DP_FOREACH_PORT(ports, port) {
-		if (port->is_pf || !port->allocated)
-			continue;
-
-		if (!dp_is_ip_set(port, eth_type))
-			continue;
-
-		clone_buf = rte_pktmbuf_copy(pkt, dp_layer->rte_mempool, 0, UINT32_MAX);
-		if (!clone_buf) {
-			DPS_LOG_ERR("Cannot clone periodic packet");
-			return;
-		}
-
-		clone_buf->port = port->port_id;
-		eth_hdr = rte_pktmbuf_mtod(clone_buf, struct rte_ether_hdr *);
-
-		rte_ether_addr_copy(&port->own_mac, &eth_hdr->src_addr);
-
-		if (eth_type == RTE_ETHER_TYPE_ARP) {
-			arp_hdr = (struct rte_arp_hdr *)(eth_hdr + 1);
-			rte_ether_addr_copy(&port->own_mac, &arp_hdr->arp_data.arp_sha);
-			if (dp_arp_cycle_needed(port))
-				arp_hdr->arp_data.arp_tip = htonl(port->iface.cfg.own_ip);
-		}
-
-		if (eth_type == RTE_ETHER_TYPE_IPV6) {
-			ipv6_hdr = (struct rte_ipv6_hdr *)(eth_hdr + 1);
-			ra_msg = (struct ra_msg *)(ipv6_hdr + 1);
-			icmp6_hdr = &(ra_msg->icmph);
-			if (icmp6_hdr->icmp6_type == NDISC_ROUTER_ADVERTISEMENT) {
-				src_ll_addr = (struct nd_opt_source_link_layer *)(ra_msg + 1);
-				rte_memcpy(src_ll_addr->addr, port->own_mac.addr_bytes, sizeof(src_ll_addr->addr));
-				icmp6_hdr->icmp6_cksum = 0;
-				icmp6_hdr->icmp6_cksum = rte_ipv6_udptcp_cksum(ipv6_hdr, icmp6_hdr);
-			}
-		}
-
-		dp_init_pkt_mark(clone_buf);
-		df = dp_init_flow_ptr(clone_buf);
-		df->l3_type = eth_type;
+	struct rte_mbuf *pkt;
 
-		ret = rte_ring_sp_enqueue(dp_layer->periodic_msg_queue, clone_buf);
-		if (DP_FAILED(ret)) {
-			DPS_LOG_WARNING("Cannot enqueue message to a VM", DP_LOG_PORTID(clone_buf->port), DP_LOG_RET(ret));
-			rte_pktmbuf_free(clone_buf);
-		}
+	pkt = rte_pktmbuf_alloc(get_dpdk_layer()->rte_mempool);
+	if (!pkt) {
+		DPS_LOG_ERR("Periodic message packet allocation failed", DP_LOG_PORTID(port->port_id));
+		return NULL;
 	}
+
+	pkt->port = port->port_id;
+	pkt->packet_type = packet_type;
+	return pkt;
 }
 
-void trigger_garp(void)
+static struct rte_mbuf *dp_create_garp(const struct dp_port *port, const struct dp_periodic_msg_key *key)
 {
 	struct rte_ether_hdr *eth_hdr;
 	struct rte_arp_hdr *arp_hdr;
 	struct rte_mbuf *pkt;
 
-	pkt = rte_pktmbuf_alloc(get_dpdk_layer()->rte_mempool);
-	if (!pkt) {
-		DPS_LOG_ERR("GARP packet allocation failed");
-		return;
-	}
+	pkt = dp_periodic_msg_alloc(port, RTE_PTYPE_L2_ETHER_ARP);
+	if (!pkt)
+		return NULL;
 
-	pkt->packet_type = RTE_PTYPE_L2_ETHER_ARP;
 	eth_hdr = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
 	eth_hdr->ether_type = htons(RTE_ETHER_TYPE_ARP);
-
 	memset(eth_hdr->dst_addr.addr_bytes, 0xff, RTE_ETHER_ADDR_LEN);
+	rte_ether_addr_copy(&key->own_mac, &eth_hdr->src_addr);
 
 	arp_hdr = (struct rte_arp_hdr *)(eth_hdr + 1);
 	arp_hdr->arp_opcode = htons(DP_ARP_REQUEST);
@@ -108,38 +75,35 @@ void trigger_garp(void)
 	arp_hdr->arp_protocol = htons(RTE_ETHER_TYPE_IPV4);
 	arp_hdr->arp_hlen = 6;
 	arp_hdr->arp_plen = 4;
-	arp_hdr->arp_data.arp_sip = arp_hdr->arp_data.arp_tip = htonl(dp_get_gw_ip4());
+	rte_ether_addr_copy(&key->own_mac, &arp_hdr->arp_data.arp_sha);
+	arp_hdr->arp_data.arp_sip = htonl(dp_get_gw_ip4());
+	arp_hdr->arp_data.arp_tip = key->arp_cycle ? htonl(key->own_ip) : arp_hdr->arp_data.arp_sip;
 	memset(arp_hdr->arp_data.arp_tha.addr_bytes, 0, RTE_ETHER_ADDR_LEN);
 
 	pkt->data_len = sizeof(struct rte_ether_hdr) + sizeof(struct rte_arp_hdr);
 	pkt->pkt_len = pkt->data_len;
-
-	send_to_all_vfs(pkt, RTE_ETHER_TYPE_ARP);
-	rte_pktmbuf_free(pkt);
+	return pkt;
 }
 
-void trigger_nd_unsol_adv(void)
+static struct rte_mbuf *dp_create_nd_unsol_adv(const struct dp_port *port, const struct dp_periodic_msg_key *key)
 {
 	struct rte_ether_hdr *eth_hdr;
 	struct rte_ipv6_hdr *ipv6_hdr;
 	struct nd_msg *ns_msg;
 	struct icmp6hdr *icmp6_hdr;
-	uint16_t pkt_size;
 	struct rte_mbuf *pkt;
 	const uint8_t *rt_ip = dp_get_gw_ip6();
 
-	pkt = rte_pktmbuf_alloc(get_dpdk_layer()->rte_mempool);
-	if (!pkt) {
-		DPS_LOG_ERR("ND-NA packet allocation failed");
-		return;
-	}
+	pkt = dp_periodic_msg_alloc(port, RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 | RTE_PTYPE_L4_ICMP);
+	if (!pkt)
+		return NULL;
 
-	pkt->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 | RTE_PTYPE_L4_ICMP;
 	eth_hdr = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
 	ipv6_hdr = (struct rte_ipv6_hdr *)(eth_hdr + 1);
 	ns_msg = (struct nd_msg *)(ipv6_hdr + 1);
 
 	rte_memcpy(eth_hdr->dst_addr.addr_bytes, dp_mc_mac, sizeof(eth_hdr->dst_addr.addr_bytes));
+	rte_ether_addr_copy(&key->own_mac, &eth_hdr->src_addr);
 	eth_hdr->ether_type = htons(RTE_ETHER_TYPE_IPV6);
 
 	ipv6_hdr->proto = IPPROTO_ICMPV6;
@@ -158,51 +122,153 @@ void trigger_nd_unsol_adv(void)
 	icmp6_hdr->icmp6_hop_limit = 255;
 
 	rte_memcpy(&ns_msg->target, rt_ip, sizeof(ns_msg->target));
-	pkt_size = sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv6_hdr) +
-			   sizeof(struct icmp6hdr) + sizeof(struct in6_addr);
-	pkt->data_len = pkt_size;
-	pkt->pkt_len = pkt_size;
+	pkt->data_len = sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv6_hdr)
+					+ sizeof(struct icmp6hdr) + sizeof(struct in6_addr);
+	pkt->pkt_len = pkt->data_len;
 
 	// L4 cksum calculation
 	icmp6_hdr->icmp6_cksum = 0;
 	icmp6_hdr->icmp6_cksum = rte_ipv6_udptcp_cksum(ipv6_hdr, icmp6_hdr);
-
-	send_to_all_vfs(pkt, RTE_ETHER_TYPE_IPV6);
-	rte_pktmbuf_free(pkt);
+	return pkt;
 }
 
-void trigger_nd_ra(void)
+static struct rte_mbuf *dp_create_nd_ra(const struct dp_port *port, const struct dp_periodic_msg_key *key)
 {
 	struct rte_ether_hdr *eth_hdr;
 	struct rte_ipv6_hdr *ipv6_hdr;
 	struct ra_msg *ra_msg;
+	struct icmp6hdr *icmp6_hdr;
 	struct rte_mbuf *pkt;
-	const uint8_t *rt_ip = dp_get_gw_ip6();
 
-	pkt = rte_pktmbuf_alloc(get_dpdk_layer()->rte_mempool);
-	if (!pkt) {
-		DPS_LOG_ERR("ND-RA packet allocation failed");
-		return;
-	}
+	pkt = dp_periodic_msg_alloc(port, RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 | RTE_PTYPE_L4_ICMP);
+	if (!pkt)
+		return NULL;
 
-	pkt->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 | RTE_PTYPE_L4_ICMP;
 	eth_hdr = rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *);
 	ipv6_hdr = (struct rte_ipv6_hdr *)(eth_hdr + 1);
 	ra_msg = (struct ra_msg *)(ipv6_hdr + 1);
 
-	memset(&eth_hdr->src_addr, 0xff, RTE_ETHER_ADDR_LEN);
 	rte_memcpy(eth_hdr->dst_addr.addr_bytes, dp_mc_mac, sizeof(eth_hdr->dst_addr.addr_bytes));
+	rte_ether_addr_copy(&key->own_mac, &eth_hdr->src_addr);
 	eth_hdr->ether_type = htons(RTE_ETHER_TYPE_IPV6);
 
 	ipv6_hdr->proto = IPPROTO_ICMPV6;
 	ipv6_hdr->vtc_flow = htonl(0x60000000);
 	ipv6_hdr->hop_limits = 255;
-	rte_memcpy(ipv6_hdr->src_addr, rt_ip, sizeof(ipv6_hdr->src_addr));
+	rte_memcpy(ipv6_hdr->src_addr, dp_get_gw_ip6(), sizeof(ipv6_hdr->src_addr));
 	rte_memcpy(ipv6_hdr->dst_addr, dp_mc_ipv6, sizeof(ipv6_hdr->dst_addr));
 
-	pkt->data_len = dp_ipv6_fill_ra(ipv6_hdr, ra_msg, NULL);
+	pkt->data_len = dp_ipv6_fill_ra(ipv6_hdr, ra_msg, key->own_mac.addr_bytes);
 	pkt->pkt_len = pkt->data_len;
 
-	send_to_all_vfs(pkt, RTE_ETHER_TYPE_IPV6);
-	rte_pktmbuf_free(pkt);
+	// L4 cksum calculation
+	icmp6_hdr = &(ra_msg->icmph);
+	icmp6_hdr->icmp6_cksum = 0;
+	icmp6_hdr->icmp6_cksum = rte_ipv6_udptcp_cksum(ipv6_hdr, icmp6_hdr);
+	return pkt;
+}
+
+static void dp_release_templates(struct dp_periodic_msg_templates *tmpl)
+{
+	// packets still being transmitted hold their own reference, so this is safe at any time
+	for (int i = 0; i < DP_PERIODIC_MSG_COUNT; ++i) {
+		rte_pktmbuf_free(tmpl->pkts[i]);
+		tmpl->pkts[i] = NULL;
+	}
+	memset(&tmpl->key, 0, sizeof(tmpl->key));
+}
+
+static void dp_fill_template_key(const struct dp_port *port, bool ipv6_enabled, struct dp_periodic_msg_key *key)
+{
+	// zeroed for memcmp() to work over padding
+	memset(key, 0, sizeof(*key));
+	rte_ether_addr_copy(&port->own_mac, &key->own_mac);
+	key->own_ip = port->iface.cfg.own_ip;
+	key->arp_cycle = dp_arp_cycle_needed(port);
+	key->ipv6_enabled = ipv6_enabled;
+	if (ipv6_enabled)
+		rte_memcpy(key->dhcp_ipv6, port->iface.cfg.dhcp_ipv6, sizeof(key->dhcp_ipv6));
+}
+
+static void dp_refresh_templates(const struct dp_port *port, struct dp_periodic_msg_templates *tmpl, bool ipv6_enabled)
+{
+	struct dp_periodic_msg_key key;
+
+	dp_fill_template_key(port, ipv6_enabled, &key);
+	if (!memcmp(&key, &tmpl->key, sizeof(key)))
+		return;
+
+	// templates are never modified in place, a packet from the previous round can still be in a Tx queue
+	dp_release_templates(tmpl);
+	tmpl->key = key;
+
+	if (key.own_ip != 0)
+		tmpl->pkts[DP_PERIODIC_MSG_GARP] = dp_create_garp(port, &key);
+
+	if (ipv6_enabled && !dp_is_ipv6_addr_zero(key.dhcp_ipv6)) {
+		tmpl->pkts[DP_PERIODIC_MSG_ND_NA] = dp_create_nd_unsol_adv(port, &key);
+		tmpl->pkts[DP_PERIODIC_MSG_ND_RA] = dp_create_nd_ra(port, &key);
+	}
+}
+
+static void dp_send_templates(const struct dp_port *port, struct dp_periodic_msg_templates *tmpl)
+{
+	struct rte_mbuf *pkts[DP_PERIODIC_MSG_COUNT];
+	struct rte_mbuf *pkt;
+	struct dp_flow *df;
+	unsigned int count = 0;
+	unsigned int sent;
+
+	for (int i = 0; i < DP_PERIODIC_MSG_COUNT; ++i) {
+		pkt = tmpl->pkts[i];
+		// if the previous round is still waiting in a Tx queue, do not touch the metadata
+		if (!pkt || rte_mbuf_refcnt_read(pkt) != 1)
+			continue;
+
+		dp_init_pkt_mark(pkt);
+		df = dp_init_flow_ptr(pkt);
+		df->l3_type = i == DP_PERIODIC_MSG_GARP ? RTE_ETHER_TYPE_ARP : RTE_ETHER_TYPE_IPV6;
+
+		// the reference is released by the PMD after transmission, template stays here
+		rte_mbuf_refcnt_update(pkt, 1);
+		pkts[count++] = pkt;
+	}
+
+	if (!count)
+		return;
+
+	sent = rte_ring_sp_enqueue_burst(get_dpdk_layer()->periodic_msg_queue, (void **)pkts, count, NULL);
+	if (sent != count) {
+		DPS_LOG_WARNING("Cannot enqueue message to a VM", DP_LOG_PORTID(port->port_id), DP_LOG_VALUE(count - sent));
+		for (unsigned int i = sent; i < count; ++i)
+			rte_mbuf_refcnt_update(pkts[i], -1);
+	}
+}
+
+void dp_periodic_msg_send(unsigned int slot, unsigned int slot_count, bool ipv6_enabled)
+{
+	const struct dp_ports *ports = dp_get_ports();
+	struct dp_periodic_msg_templates *tmpl;
+
+	DP_FOREACH_PORT(ports, port) {
+		// ports are spread over all slots of the interval to prevent bursts towards all VMs at once
+		if (port->port_id % slot_count != slot)
+			continue;
+
+		tmpl = &templates[port->port_id];
+
+		if (port->is_pf || !port->allocated) {
+			dp_release_templates(tmpl);
+			continue;
+		}
+
+		dp_refresh_templates(port, tmpl, ipv6_enabled);
+		dp_send_templates(port, tmpl);
+	}
+}
+
+void dp_periodic_msg_free(void)
+{
+	for (size_t i = 0; i < RTE_DIM(templates); ++i)
+		dp_release_templates(&templates[i]);
 }
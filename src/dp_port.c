@@ -3,11 +3,13 @@
 
 #include "dp_error.h"
 #include <rte_bus_pci.h>
+#include "dp_cksum.h"
 #include "dp_conf.h"
 #include "dp_hairpin.h"
 #include "dp_log.h"
 #include "dp_lpm.h"
 #include "dp_netlink.h"
+#include "dp_numa.h"
 #include "dp_port.h"
 #ifdef ENABLE_VIRTSVC
 #	include "dp_virtsvc.h"
@@ -35,7 +37,8 @@ static const struct rte_eth_conf port_conf_default = {
 			RTE_ETH_TX_OFFLOAD_IPV4_CKSUM |
 			RTE_ETH_TX_OFFLOAD_UDP_CKSUM |
 			RTE_ETH_TX_OFFLOAD_TCP_CKSUM |
-			RTE_ETH_TX_OFFLOAD_IP_TNL_TSO
+			RTE_ETH_TX_OFFLOAD_IP_TNL_TSO |
+			RTE_ETH_TX_OFFLOAD_MULTI_SEGS
 	},
 	.rx_adv_conf = {
 		.rss_conf = {
@@ -90,15 +93,22 @@ struct dp_port *dp_get_port_by_name(const char *pci_name)
 static int dp_port_init_ethdev(struct dp_port *port, struct rte_eth_dev_info *dev_info)
 {
 	struct dp_dpdk_layer *dp_layer = get_dpdk_layer();
-	struct rte_ether_addr pf_neigh_mac;
 	struct rte_eth_txconf txq_conf;
 	struct rte_eth_rxconf rxq_conf;
 	struct rte_eth_conf port_conf = port_conf_default;
 	uint16_t nr_hairpin_queues;
+	int worker_socket_id;
 	int ret;
 
 	/* Default config */
 	port_conf.txmode.offloads &= dev_info->tx_offload_capa;
+#ifdef ENABLE_PYTEST
+	// pretend checksums cannot be offloaded to test the software fallback
+	if (!dp_conf_is_tx_cksum_offload_enabled())
+		port_conf.txmode.offloads &= ~DP_CKSUM_PORT_OFFLOADS;
+#endif
+	if (!(*dev_info->dev_flags & RTE_ETH_DEV_INTR_LSC))
+		port_conf.intr_conf.lsc = 0;
 
 	if (dp_conf_get_nic_type() == DP_CONF_NIC_TYPE_TAP)
 		nr_hairpin_queues = 0;
@@ -107,6 +117,12 @@ static int dp_port_init_ethdev(struct dp_port *port, struct rte_eth_dev_info *de
 			? (uint16_t)(DP_NR_PF_HAIRPIN_RX_TX_QUEUES + DP_NR_VF_HAIRPIN_RX_TX_QUEUES * dp_layer->num_of_vfs)
 			: DP_NR_VF_HAIRPIN_RX_TX_QUEUES;
 
+	// the datapath requests checksum offloads regardless of the port, missing ones are done in software on Tx
+	port->tx_offloads = port_conf.txmode.offloads;
+	port->tx_cksum_fallback = (port->tx_offloads & DP_CKSUM_PORT_OFFLOADS) != DP_CKSUM_PORT_OFFLOADS;
+	if (port->tx_cksum_fallback)
+		DPS_LOG_WARNING("Port cannot offload all checksums, falling back to software", DP_LOG_PORT(port));
+
 	ret = rte_eth_dev_configure(port->port_id,
 								DP_NR_STD_RX_QUEUES + nr_hairpin_queues,
 								DP_NR_STD_TX_QUEUES + nr_hairpin_queues,
@@ -119,10 +135,14 @@ static int dp_port_init_ethdev(struct dp_port *port, struct rte_eth_dev_info *de
 	rxq_conf = dev_info->default_rxconf;
 	rxq_conf.offloads = port_conf.rxmode.offloads;
 
+	// descriptor rings are polled by the worker, keep them (and the mbufs) local to it
+	// (hairpin queues take no socket, their memory is managed by the PMD)
+	worker_socket_id = dp_numa_get_worker_socket_id();
+
 	/* RX and TX queues config */
 	for (uint16_t i = 0; i < DP_NR_STD_RX_QUEUES; ++i) {
 		ret = rte_eth_rx_queue_setup(port->port_id, i, 1024,
-									 port->socket_id,
+									 worker_socket_id,
 									 &rxq_conf,
 									 dp_layer->rte_mempool);
 		if (DP_FAILED(ret)) {
@@ -136,7 +156,7 @@ static int dp_port_init_ethdev(struct dp_port *port, struct rte_eth_dev_info *de
 
 	for (uint16_t i = 0; i < DP_NR_STD_TX_QUEUES; ++i) {
 		ret = rte_eth_tx_queue_setup(port->port_id, i, 2048,
-									 port->socket_id,
+									 worker_socket_id,
 									 &txq_conf);
 		if (DP_FAILED(ret)) {
 			DPS_LOG_ERR("Tx queue setup failed", DP_LOG_PORT(port), DP_LOG_RET(ret));
@@ -162,10 +182,27 @@ static int dp_port_init_ethdev(struct dp_port *port, struct rte_eth_dev_info *de
 	static_assert(sizeof(port->dev_name) == RTE_ETH_NAME_MAX_LEN, "Incompatible port dev_name size");
 	rte_eth_dev_get_name_by_port(port->port_id, port->dev_name);
 
+	// VMs are told to use the MTU via DHCP, PFs use whatever is set for the uplink
+	// (unless the underlay network is known to have a lower MTU)
 	if (port->is_pf) {
-		if (DP_FAILED(dp_get_pf_neigh_mac(dev_info->if_index, &pf_neigh_mac, &port->own_mac)))
+		ret = rte_eth_dev_get_mtu(port->port_id, &port->mtu);
+		if (DP_FAILED(ret)) {
+			DPS_LOG_ERR("Cannot get port MTU", DP_LOG_PORT(port), DP_LOG_RET(ret));
+			return DP_ERROR;
+		}
+		if (dp_conf_get_underlay_mtu() && dp_conf_get_underlay_mtu() < port->mtu)
+			port->mtu = (uint16_t)dp_conf_get_underlay_mtu();
+	} else
+		port->mtu = (uint16_t)dp_conf_get_dhcp_mtu();
+
+	// rte_gro cannot parse the IPv6 underlay, only packets from VMs can be merged
+	// (the merged packets are split again on Tx of any port)
+	port->rx_gro = !port->is_pf && dp_conf_is_gro_enabled();
+
+	// without a kernel interface there is no neighbor table to ask (software devices for benchmarking)
+	if (port->is_pf && dev_info->if_index != 0) {
+		if (DP_FAILED(dp_get_pf_neigh_mac(dev_info->if_index, &port->neigh_mac, port->neigh_ipv6, &port->own_mac)))
 			return DP_ERROR;
-		rte_ether_addr_copy(&pf_neigh_mac, &port->neigh_mac);
 	}
 
 	return DP_OK;
@@ -15,8 +15,11 @@
 #include "dp_lb.h"
 #include "dp_log.h"
 #include "dp_iface.h"
+#include "dp_ipfrag.h"
 #include "dp_multi_path.h"
 #include "dp_nat.h"
+#include "dp_neigh.h"
+#include "dp_numa.h"
 #include "dp_port.h"
 #include "dp_telemetry.h"
 #include "dp_internal_stats.h"
@@ -28,6 +31,7 @@
 #endif
 #include "dpdk_layer.h"
 #include "grpc/dp_grpc_thread.h"
+#include "monitoring/dp_ipfix.h"
 
 static char **dp_argv;
 static int dp_argc;
@@ -136,18 +140,15 @@ static int setup_sighandlers(void)
 
 static int init_interfaces(void)
 {
-	int pf0_socket_id;
+	int worker_socket_id = dp_numa_get_worker_socket_id();
 
 	dp_multipath_init();
 
 	if (DP_FAILED(dp_ports_init()))
 		return DP_ERROR;
 
-	// only now (after init) this is valid
-	pf0_socket_id = dp_get_pf0()->socket_id;
-
 #ifdef ENABLE_VIRTSVC
-	if (DP_FAILED(dp_virtsvc_init(pf0_socket_id)))
+	if (DP_FAILED(dp_virtsvc_init(worker_socket_id)))
 		return DP_ERROR;
 #endif
 	if (DP_FAILED(dp_graph_init())
@@ -167,19 +168,31 @@ static int init_interfaces(void)
 
 	// VFs are started by GRPC later
 
-	if (DP_FAILED(dp_flow_init(pf0_socket_id))
-		|| DP_FAILED(dp_ifaces_init(pf0_socket_id))
-		|| DP_FAILED(dp_nat_init(pf0_socket_id))
-		|| DP_FAILED(dp_lb_init(pf0_socket_id))
-		|| DP_FAILED(dp_vni_init(pf0_socket_id))
-		|| DP_FAILED(dp_vnf_init(pf0_socket_id)))
+	// tables are (almost) only accessed by the worker
+	if (DP_FAILED(dp_flow_init(worker_socket_id))
+		|| DP_FAILED(dp_ifaces_init(worker_socket_id))
+		|| DP_FAILED(dp_nat_init(worker_socket_id))
+		|| DP_FAILED(dp_lb_init(worker_socket_id))
+		|| DP_FAILED(dp_vni_init(worker_socket_id))
+		|| DP_FAILED(dp_vnf_init(worker_socket_id))
+		|| DP_FAILED(dp_ipfrag_init(worker_socket_id))
+		|| DP_FAILED(dp_ipfix_init(worker_socket_id)))
+		return DP_ERROR;
+
+	// PF neighbor MACs are already known at this point, only changes are watched
+	if (DP_FAILED(dp_neigh_init()))
 		return DP_ERROR;
 
+	dp_numa_check_placement();
+
 	return DP_OK;
 }
 
 static void free_interfaces(void)
 {
+	dp_neigh_free();
+	dp_ipfix_free();
+	dp_ipfrag_free();
 	dp_vnf_free();
 	dp_vni_free();
 	dp_lb_free();
@@ -236,12 +249,18 @@ static int run_service(void)
 	// from this point on, only DPS_LOG should be used
 
 	if (DP_FAILED(setup_sighandlers())
-		|| DP_FAILED(dp_dpdk_layer_init()))
+		|| DP_FAILED(dp_log_async_init()))
 		return DP_ERROR;
 
+	if (DP_FAILED(dp_dpdk_layer_init())) {
+		dp_log_async_free();
+		return DP_ERROR;
+	}
+
 	result = run_dpdk_service();
 
 	dp_dpdk_layer_free();
+	dp_log_async_free();
 
 	return result;
 }
@@ -8,12 +8,22 @@
 #include <string.h>
 
 #include "dp_error.h"
+#include "dp_flow.h"
 #include "dp_graph.h"
+#include "dp_idle.h"
+#include "dp_ipfrag.h"
+#include "dp_lb.h"
 #include "dp_log.h"
+#include "dp_nat.h"
+#include "dp_numa.h"
+#include "dp_vnf.h"
+#include "dp_vni.h"
 #ifdef ENABLE_VIRTSVC
 #	include "dp_virtsvc.h"
 #endif
 #include "dpdk_layer.h"
+#include "monitoring/dp_ipfix.h"
+#include "monitoring/dp_latency.h"
 #include "dp_internal_stats.h"
 
 
@@ -172,6 +182,154 @@ static int dp_telemetry_handle_nat_used_port_count(const char *cmd,
 	return DP_OK;
 }
 
+static int dp_telemetry_handle_table_occupancy(const char *cmd,
+											   __rte_unused const char *params,
+											   struct rte_tel_data *data)
+{
+	if (DP_FAILED(dp_telemetry_start_dict(data, cmd))
+		|| DP_FAILED(dp_flow_get_tables_telemetry(data))
+		|| DP_FAILED(dp_nat_get_tables_telemetry(data))
+		|| DP_FAILED(dp_lb_get_tables_telemetry(data))
+		|| DP_FAILED(dp_vnf_get_tables_telemetry(data))
+		|| DP_FAILED(dp_vni_get_tables_telemetry(data)))
+		return DP_ERROR;
+#ifdef ENABLE_VIRTSVC
+	if (DP_FAILED(dp_virtsvc_get_tables_telemetry(data)))
+		return DP_ERROR;
+#endif
+	return DP_OK;
+}
+
+static int dp_telemetry_handle_conntrack_flow_count(const char *cmd,
+													 __rte_unused const char *params,
+													 struct rte_tel_data *data)
+{
+	if (DP_FAILED(dp_telemetry_start_dict(data, cmd))
+		|| DP_FAILED(dp_cntrack_get_flow_count_telemetry(data)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
+static int dp_telemetry_handle_conntrack_limit_drop_count(const char *cmd,
+														  __rte_unused const char *params,
+														  struct rte_tel_data *data)
+{
+	if (DP_FAILED(dp_telemetry_start_dict(data, cmd))
+		|| DP_FAILED(dp_cntrack_get_limit_drops_telemetry(data)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
+static int dp_telemetry_handle_tx_stats(const char *cmd,
+										 __rte_unused const char *params,
+										 struct rte_tel_data *data)
+{
+	if (DP_FAILED(dp_telemetry_start_dict(data, cmd))
+		|| DP_FAILED(dp_tx_get_stats_telemetry(data)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
+static int dp_telemetry_handle_iface_stats(const char *cmd,
+											__rte_unused const char *params,
+											struct rte_tel_data *data)
+{
+	if (DP_FAILED(dp_telemetry_start_dict(data, cmd))
+		|| DP_FAILED(dp_iface_get_stats_telemetry(data)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
+static int dp_telemetry_handle_mtu_stats(const char *cmd,
+										 __rte_unused const char *params,
+										 struct rte_tel_data *data)
+{
+	if (DP_FAILED(dp_telemetry_start_dict(data, cmd))
+		|| DP_FAILED(dp_mtu_get_stats_telemetry(data)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
+static int dp_telemetry_handle_worker_stats(const char *cmd,
+											 __rte_unused const char *params,
+											 struct rte_tel_data *data)
+{
+	if (DP_FAILED(dp_telemetry_start_dict(data, cmd))
+		|| DP_FAILED(dp_idle_get_stats_telemetry(data)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
+static int dp_telemetry_handle_numa_placement(const char *cmd,
+											   __rte_unused const char *params,
+											   struct rte_tel_data *data)
+{
+	if (DP_FAILED(dp_telemetry_start_dict(data, cmd))
+		|| DP_FAILED(dp_numa_get_placement_telemetry(data)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
+static int dp_telemetry_handle_vni_stats(const char *cmd,
+										  __rte_unused const char *params,
+										  struct rte_tel_data *data)
+{
+	if (DP_FAILED(dp_telemetry_start_dict(data, cmd))
+		|| DP_FAILED(dp_vni_get_stats_telemetry(data)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
+static int dp_telemetry_handle_drop_stats(const char *cmd,
+										   __rte_unused const char *params,
+										   struct rte_tel_data *data)
+{
+	if (DP_FAILED(dp_telemetry_start_dict(data, cmd))
+		|| DP_FAILED(dp_drop_get_stats_telemetry(data)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
+static int dp_telemetry_handle_ipfix_stats(const char *cmd,
+											__rte_unused const char *params,
+											struct rte_tel_data *data)
+{
+	if (DP_FAILED(dp_telemetry_start_dict(data, cmd))
+		|| DP_FAILED(dp_ipfix_get_stats_telemetry(data)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
+static int dp_telemetry_handle_ipfrag_stats(const char *cmd,
+											 __rte_unused const char *params,
+											 struct rte_tel_data *data)
+{
+	if (DP_FAILED(dp_telemetry_start_dict(data, cmd))
+		|| DP_FAILED(dp_ipfrag_get_stats_telemetry(data)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
+static int dp_telemetry_handle_latency_graph(const char *cmd,
+											  __rte_unused const char *params,
+											  struct rte_tel_data *data)
+{
+	if (DP_FAILED(dp_telemetry_start_dict(data, cmd))
+		|| DP_FAILED(dp_latency_get_graph_telemetry(data)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
+static int dp_telemetry_handle_latency_handlers(const char *cmd,
+												 __rte_unused const char *params,
+												 struct rte_tel_data *data)
+{
+	if (DP_FAILED(dp_telemetry_start_dict(data, cmd))
+		|| DP_FAILED(dp_latency_get_handlers_telemetry(data)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
 //
 // Entrypoints
 //
@@ -189,6 +347,20 @@ int dp_telemetry_init(void)
 		DP_TELEMETRY_REGISTER_COMMAND(graph, cycle_count, "Returns total number of cycles used by each graph node."),
 		DP_TELEMETRY_REGISTER_COMMAND(graph, realloc_count, "Returns total number of reallocations done by each graph node."),
 		DP_TELEMETRY_REGISTER_COMMAND(nat, used_port_count, "Returns the number of nat ports in use by each VF interface (attached VM)."),
+		DP_TELEMETRY_REGISTER_COMMAND(conntrack, flow_count, "Returns the number of tracked flows accounted to each VF interface (attached VM)."),
+		DP_TELEMETRY_REGISTER_COMMAND(conntrack, limit_drop_count, "Returns the number of new flows over limits for each VF interface (attached VM)."),
+		DP_TELEMETRY_REGISTER_COMMAND(table, occupancy, "Returns the number of used entries and the capacity of internal tables."),
+		DP_TELEMETRY_REGISTER_COMMAND(iface, stats, "Returns packet and byte counters (Rx, Tx, dropped) for each port."),
+		DP_TELEMETRY_REGISTER_COMMAND(vni, stats, "Returns packet and byte counters (Rx, Tx, dropped) of all interfaces in each VNI."),
+		DP_TELEMETRY_REGISTER_COMMAND(drop, stats, "Returns the number of dropped packets for each port and in total, divided by drop reason."),
+		DP_TELEMETRY_REGISTER_COMMAND(ipfix, stats, "Returns the number of queued, lost and exported IPFIX flow records."),
+		DP_TELEMETRY_REGISTER_COMMAND(ipfrag, stats, "Returns the number of reassembled and fragmented IP packets and of dropped fragments."),
+		DP_TELEMETRY_REGISTER_COMMAND(latency, graph, "Returns cycle percentiles of sampled graph walks and of each graph node in them."),
+		DP_TELEMETRY_REGISTER_COMMAND(latency, handlers, "Returns cycle percentiles of heavy control-plane handlers run by the worker."),
+		DP_TELEMETRY_REGISTER_COMMAND(tx, stats, "Returns the number of Tx buffer flushes, retries and drops for each port."),
+		DP_TELEMETRY_REGISTER_COMMAND(mtu, stats, "Returns the number of ICMP errors sent and rate-limited due to MTU, and of clamped TCP MSS values for each port."),
+		DP_TELEMETRY_REGISTER_COMMAND(worker, stats, "Returns busy and idle cycles of each worker lcore and how often it waited when idle."),
+		DP_TELEMETRY_REGISTER_COMMAND(numa, placement, "Returns the NUMA node of the worker, of each port and of pools, rings and tables."),
 #ifdef ENABLE_VIRTSVC
 		DP_TELEMETRY_REGISTER_COMMAND(virtsvc, used_port_count, "Returns the number of ports in use by each virtual service."),
 #endif
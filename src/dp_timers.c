@@ -6,6 +6,7 @@
 #include <rte_cycles.h>
 #include "dp_conf.h"
 #include "dp_error.h"
+#include "dp_flow.h"
 #include "dp_log.h"
 #include "dp_periodic_msg.h"
 #include "dp_timers.h"
@@ -22,11 +23,13 @@
 #define TIMER_DP_MAINTENANCE_INTERVAL 30
 #define TIMER_DP_MAINTENANCE_STARTUP_INTERVAL 5
 #define TIMER_DP_MAINTENANCE_STARTUP_CYCLES 5
+// maintenance work is spread over the interval in slots of this length (intervals must be divisible by it)
+#define TIMER_DP_MAINTENANCE_SLOT 1
 
 // timer for stats printing
 #define TIMER_STATS_INTERVAL 1
 
-static int dp_maintenance_interval = TIMER_DP_MAINTENANCE_STARTUP_INTERVAL;
+static unsigned int dp_maintenance_interval = TIMER_DP_MAINTENANCE_STARTUP_INTERVAL;
 
 static struct rte_timer dp_flow_aging_timer;
 static struct rte_timer dp_maintenance_timer;
@@ -35,44 +38,37 @@ static uint64_t dp_timer_manage_interval_cycles;
 
 static void dp_flow_aging_timer_cb(__rte_unused struct rte_timer *timer, __rte_unused void *arg)
 {
-	int ret = dp_send_event_flow_aging_msg();
+	int ret;
+
+	// allocation of a bigger flow table is done here to not block the worker
+	dp_flow_prepare_table_growth();
+
+	ret = dp_send_event_flow_aging_msg();
 
 	if (DP_FAILED(ret))
 		DPS_LOG_WARNING("Cannot send flow aging event", DP_LOG_RET(ret));
 }
 
-static inline void dp_maintenance_timer_cb_core(void)
-{
-	if (dp_conf_is_ipv6_overlay_enabled()) {
-		trigger_nd_ra();
-		trigger_nd_unsol_adv();
-	}
-	trigger_garp();
-}
-
 static void dp_maintenance_timer_cb(__rte_unused struct rte_timer *timer, __rte_unused void *arg)
 {
-	dp_maintenance_timer_cb_core();
-}
-
-static void dp_maintenance_startup_timer_cb(struct rte_timer *timer, __rte_unused void *arg)
-{
+	static unsigned int interval = TIMER_DP_MAINTENANCE_STARTUP_INTERVAL;
 	static unsigned int counter = 0;
-	uint64_t cycles;
+	static unsigned int slot = 0;
+
+	// The timer fires every TIMER_DP_MAINTENANCE_SLOT seconds, each time only handling a part of VFs,
+	// so that every VF gets its messages once per interval, but not all VFs at the same moment.
+	dp_periodic_msg_send(slot, interval / TIMER_DP_MAINTENANCE_SLOT, dp_conf_is_ipv6_overlay_enabled());
 
-	dp_maintenance_timer_cb_core();
+	if (++slot < interval / TIMER_DP_MAINTENANCE_SLOT)
+		return;
+	slot = 0;
 
-	// This is a simple back-off of the maintenance timer. Only at the beginning of the timer life time,
+	// This is a simple back-off of the maintenance interval. Only at the beginning of the timer life time,
 	// do it every TIMER_DP_MAINTENANCE_STARTUP_INTERVAL seconds. After TIMER_DP_MAINTENANCE_STARTUP_CYCLES times
-	// and dp_maintenance_interval is set to a greater value, reset the timer with the greater value.
-	if ((dp_maintenance_interval > TIMER_DP_MAINTENANCE_STARTUP_INTERVAL) && (counter <= TIMER_DP_MAINTENANCE_STARTUP_CYCLES)) {
-		counter++;
-		if (counter == TIMER_DP_MAINTENANCE_STARTUP_CYCLES) {
-			cycles = dp_maintenance_interval * rte_get_timer_hz();
-			if (DP_FAILED(rte_timer_reset(timer, cycles, PERIODICAL, rte_lcore_id(), dp_maintenance_timer_cb, NULL)))
-				DPS_LOG_ERR("Cannot start maintenance timer");
-		}
-	}
+	// and dp_maintenance_interval is set to a greater value, switch to the greater value.
+	if (dp_maintenance_interval > TIMER_DP_MAINTENANCE_STARTUP_INTERVAL && counter < TIMER_DP_MAINTENANCE_STARTUP_CYCLES)
+		if (++counter == TIMER_DP_MAINTENANCE_STARTUP_CYCLES)
+			interval = dp_maintenance_interval;
 }
 
 uint64_t dp_timers_get_manage_interval_cycles(void)
@@ -125,8 +121,8 @@ int dp_timers_init(void)
 		return DP_ERROR;
 	}
 
-	if (DP_FAILED(dp_timers_add(&dp_maintenance_timer, dp_maintenance_interval, dp_maintenance_startup_timer_cb))) {
-		DPS_LOG_ERR("Cannot start maintenance startup timer");
+	if (DP_FAILED(dp_timers_add(&dp_maintenance_timer, TIMER_DP_MAINTENANCE_SLOT, dp_maintenance_timer_cb))) {
+		DPS_LOG_ERR("Cannot start maintenance timer");
 		return DP_ERROR;
 	}
 
@@ -8,6 +8,7 @@
 #include "dp_conf.h"
 #include "dp_error.h"
 #include "dp_log.h"
+#include "dp_numa.h"
 #include "dp_port.h"
 #include "rte_flow/dp_rte_flow.h"
 
@@ -32,6 +33,18 @@ int dp_get_dev_info(uint16_t port_id, struct rte_eth_dev_info *dev_info, char if
 		DPS_LOG_ERR("Cannot get device info", DP_LOG_PORTID(port_id), DP_LOG_RET(ret));
 		return DP_ERROR;
 	}
+	// software devices (net_pcap, net_ring, ...) have no kernel interface, use the DPDK device name instead
+	if (dev_info->if_index == 0) {
+		char dev_name[RTE_ETH_NAME_MAX_LEN];
+
+		ret = rte_eth_dev_get_name_by_port(port_id, dev_name);
+		if (DP_FAILED(ret)) {
+			DPS_LOG_ERR("Cannot get device name", DP_LOG_PORTID(port_id), DP_LOG_RET(ret));
+			return DP_ERROR;
+		}
+		snprintf(ifname, IF_NAMESIZE, "%s", dev_name);
+		return DP_OK;
+	}
 	if (!if_indextoname(dev_info->if_index, ifname)) {
 		DPS_LOG_ERR("Cannot get device name", DP_LOG_PORTID(port_id), DP_LOG_RET(errno));
 		return DP_ERROR;
@@ -156,15 +169,19 @@ struct rte_hash *dp_create_jhash_table(int entries, size_t key_len, const char *
 	};
 
 	result = rte_hash_create(&params);
-	if (!result)
+	if (!result) {
 		DPS_LOG_ERR("Cannot create jhash table",
 					DP_LOG_NAME(name), DP_LOG_SOCKID(socket_id), DP_LOG_RET(rte_errno));
+		return NULL;
+	}
 
+	dp_numa_register(full_name, result, socket_id);
 	return result;
 }
 
 void dp_free_jhash_table(struct rte_hash *table)
 {
+	dp_numa_unregister(table);
 	rte_hash_free(table);
 }
 
@@ -3,13 +3,13 @@
 
 #include "dp_virtsvc.h"
 
-#include <stdlib.h>
 #include <rte_cycles.h>
 #include <rte_malloc.h>
 
 #include "dp_conf.h"
 #include "dp_error.h"
 #include "dp_flow.h"
+#include "dp_internal_stats.h"
 #include "dp_log.h"
 #include "dp_multi_path.h"
 #include "dp_util.h"
@@ -30,8 +30,11 @@
 	_DP_LOG_UINT("service_port", ntohs((SERVICE)->service_port)), \
 	DP_LOG_PROTO((SERVICE)->proto)
 
+#define DP_VIRTSVC_FREE_PORT_SCAN 8
+
 // packed, because hashing would include padding otherwise
 struct dp_virtsvc_conn_key {
+	uint32_t virtsvc_idx;
 	uint16_t vf_port_id;
 	rte_be16_t vf_l4_port;
 	rte_be32_t vf_ip;
@@ -51,94 +54,65 @@ static uint64_t established_port_timeout = DP_FLOW_TCP_EXTENDED_TIMEOUT;
 static bool fast_timeout = false;
 #endif
 
-static struct dp_virtsvc_lookup_entry *dp_virtsvc_ipv4_tree = NULL;
-static struct dp_virtsvc_lookup_entry *dp_virtsvc_ipv6_tree = NULL;
-
-const struct dp_virtsvc_lookup_entry *dp_virtsvc_get_ipv4_tree(void)
-{
-	return dp_virtsvc_ipv4_tree;
-}
+static struct rte_hash *dp_virtsvc_ipv4_table = NULL;
+static struct rte_hash *dp_virtsvc_ipv6_table = NULL;
+// connections of all services share one table, sized for all ports of all services
+// so that it cannot get full before a service runs out of ports
+static struct rte_hash *dp_virtsvc_conn_table = NULL;
+static int dp_virtsvc_conn_table_size;
+static int dp_virtsvc_socket_id;
 
-const struct dp_virtsvc_lookup_entry *dp_virtsvc_get_ipv6_tree(void)
+const struct rte_hash *dp_virtsvc_get_ipv4_table(void)
 {
-	return dp_virtsvc_ipv6_tree;
+	return dp_virtsvc_ipv4_table;
 }
 
-static int dp_virtsvc_array_to_tree(struct dp_virtsvc_lookup_entry **dst, struct dp_virtsvc **array, int start, int end)
+const struct rte_hash *dp_virtsvc_get_ipv6_table(void)
 {
-	struct dp_virtsvc_lookup_entry *entry;
-	int mid;
-
-	*dst = NULL;
-
-	if (start > end)
-		return DP_OK;
-
-	entry = (struct dp_virtsvc_lookup_entry *)malloc(sizeof(struct dp_virtsvc_lookup_entry));
-	if (!entry)
-		return DP_ERROR;
-
-	mid = (start + end) / 2;
-	entry->virtsvc = array[mid];
-
-	if (DP_FAILED(dp_virtsvc_array_to_tree(&entry->left, array, start, mid-1))
-		|| DP_FAILED(dp_virtsvc_array_to_tree(&entry->right, array, mid+1, end)))
-		return DP_ERROR;
-
-	*dst = entry;
-	return DP_OK;
+	return dp_virtsvc_ipv6_table;
 }
 
-static int dp_virtsvc_ipv4_comparator(const void *p1, const void *p2)
+static int dp_virtsvc_create_lookup_tables(void)
 {
-	const struct dp_virtsvc *l = *(const struct dp_virtsvc * const *)p1;
-	const struct dp_virtsvc *r = *(const struct dp_virtsvc * const *)p2;
-
-	return dp_virtsvc_ipv4_cmp(l->proto, l->virtual_addr, l->virtual_port,
-							   r->proto, r->virtual_addr, r->virtual_port);
-}
-
-static int dp_virtsvc_ipv6_comparator(const void *p1, const void *p2)
-{
-	const struct dp_virtsvc *l = *(const struct dp_virtsvc * const *)p1;
-	const struct dp_virtsvc *r = *(const struct dp_virtsvc * const *)p2;
-
-	return dp_virtsvc_ipv6_cmp(l->proto, l->service_addr, l->service_port,
-							   r->proto, r->service_addr, r->service_port);
-}
-
-static int dp_virtsvc_create_trees(void)
-{
-	int service_count = dp_virtsvc_get_count();
-	struct dp_virtsvc **array;
-
-	if (service_count <= 0)
-		return DP_ERROR;
+	struct dp_virtsvc_ipv4_key ipv4_key;
+	struct dp_virtsvc_ipv6_key ipv6_key;
+	int ret;
 
-	// create an array of virtsvc pointers, sort it by IPv4, and create a balanced binary search tree from it
-	array = (struct dp_virtsvc **)malloc(sizeof(struct dp_virtsvc *) * service_count);
-	if (!array)
+	dp_virtsvc_ipv4_table = dp_create_jhash_table(DP_VIRTSVC_MAX, sizeof(struct dp_virtsvc_ipv4_key),
+												  "virtsvc_ipv4_table", dp_virtsvc_socket_id);
+	if (!dp_virtsvc_ipv4_table)
 		return DP_ERROR;
 
-	for (int i = 0; i < service_count; ++i)
-		array[i] = &dp_virtservices[i];
-
-	qsort(array, service_count, sizeof(struct dp_virtsvc *), dp_virtsvc_ipv4_comparator);
-
-	if (DP_FAILED(dp_virtsvc_array_to_tree(&dp_virtsvc_ipv4_tree, array, 0, service_count-1))) {
-		free(array);
+	dp_virtsvc_ipv6_table = dp_create_jhash_table(DP_VIRTSVC_MAX, sizeof(struct dp_virtsvc_ipv6_key),
+												  "virtsvc_ipv6_table", dp_virtsvc_socket_id);
+	if (!dp_virtsvc_ipv6_table)
 		return DP_ERROR;
-	}
 
-	// re-sort by IPv6 and create the other tree
-	qsort(array, service_count, sizeof(struct dp_virtsvc *), dp_virtsvc_ipv6_comparator);
+	DP_FOREACH_VIRTSVC(&dp_virtservices, service) {
+		ipv4_key.addr = service->virtual_addr;
+		ipv4_key.port = service->virtual_port;
+		ipv4_key.proto = service->proto;
+		ipv6_key.port = service->service_port;
+		ipv6_key.proto = service->proto;
+		rte_memcpy(ipv6_key.addr, service->service_addr, sizeof(ipv6_key.addr));
+
+		// both directions need to be unambiguous
+		if (rte_hash_lookup(dp_virtsvc_ipv4_table, &ipv4_key) >= 0
+			|| rte_hash_lookup(dp_virtsvc_ipv6_table, &ipv6_key) >= 0
+		) {
+			DPS_LOG_ERR("Duplicate virtual service", DP_LOG_VIRTSVC(service));
+			return DP_ERROR;
+		}
 
-	if (DP_FAILED(dp_virtsvc_array_to_tree(&dp_virtsvc_ipv6_tree, array, 0, service_count-1))) {
-		free(array);
-		return DP_ERROR;
+		ret = rte_hash_add_key_data(dp_virtsvc_ipv4_table, &ipv4_key, service);
+		if (!DP_FAILED(ret))
+			ret = rte_hash_add_key_data(dp_virtsvc_ipv6_table, &ipv6_key, service);
+		if (DP_FAILED(ret)) {
+			DPS_LOG_ERR("Cannot add virtual service to lookup table", DP_LOG_VIRTSVC(service), DP_LOG_RET(ret));
+			return DP_ERROR;
+		}
 	}
 
-	free(array);
 	return DP_OK;
 }
 
@@ -146,11 +120,12 @@ int dp_virtsvc_init(int socket_id)
 {
 	const struct dp_conf_virtual_services *rules = dp_conf_get_virtual_services();
 	struct dp_conf_virtsvc *rule;
-	char hashtable_name[32];  // max is 'virtsvc_table_4294967295'
 
 	if (!rules->nb_entries)
 		return DP_OK;
 
+	dp_virtsvc_socket_id = socket_id;
+
 	dp_virtservices = (struct dp_virtsvc *)rte_zmalloc("virtual_services",
 													   sizeof(struct dp_virtsvc) * rules->nb_entries,
 													   RTE_CACHE_LINE_SIZE);
@@ -167,22 +142,26 @@ int dp_virtsvc_init(int socket_id)
 		dp_virtservices_end->virtual_port = rule->virtual_port;
 		dp_virtservices_end->service_port = rule->service_port;
 		rte_memcpy(dp_virtservices_end->service_addr, rule->service_addr, sizeof(rule->service_addr));
-		// last_assigned_port is 0 due to zmalloc()
-		snprintf(hashtable_name, sizeof(hashtable_name), "virtsvc_table_%u", i);
-		dp_virtservices_end->open_ports = dp_create_jhash_table(DP_VIRTSVC_PORTCOUNT,
-																sizeof(struct dp_virtsvc_conn_key),
-																hashtable_name,
-																socket_id);
-		if (!dp_virtservices_end->open_ports) {
-			DPS_LOG_ERR("Cannot allocate connection table", _DP_LOG_INT("virtsvc_entry", i));
-			dp_virtsvc_free();
-			return DP_ERROR;
-		}
+		// next_unused_conn is 0 and connection chunks are NULL due to zmalloc()
+		dp_virtservices_end->free_head = DP_VIRTSVC_CONN_NONE;
+		dp_virtservices_end->lru_head = DP_VIRTSVC_CONN_NONE;
+		dp_virtservices_end->lru_tail = DP_VIRTSVC_CONN_NONE;
 		dp_virtservices_end++;
 	}
 
-	if (DP_FAILED(dp_virtsvc_create_trees())) {
-		DPS_LOG_ERR("Failed to build lookup trees");
+	dp_virtsvc_conn_table_size = rules->nb_entries * DP_VIRTSVC_PORTCOUNT;
+	dp_virtsvc_conn_table = dp_create_jhash_table(dp_virtsvc_conn_table_size,
+												  sizeof(struct dp_virtsvc_conn_key),
+												  "virtsvc_conn_table",
+												  socket_id);
+	if (!dp_virtsvc_conn_table) {
+		DPS_LOG_ERR("Cannot allocate connection table");
+		dp_virtsvc_free();
+		return DP_ERROR;
+	}
+
+	if (DP_FAILED(dp_virtsvc_create_lookup_tables())) {
+		DPS_LOG_ERR("Failed to build lookup tables");
 		dp_virtsvc_free();
 		return DP_ERROR;
 	}
@@ -197,21 +176,14 @@ int dp_virtsvc_init(int socket_id)
 	return DP_OK;
 }
 
-static void dp_virtsvc_free_tree(struct dp_virtsvc_lookup_entry *tree)
-{
-	if (!tree)
-		return;
-	dp_virtsvc_free_tree(tree->left);
-	dp_virtsvc_free_tree(tree->right);
-	free(tree);
-}
-
 void dp_virtsvc_free(void)
 {
-	dp_virtsvc_free_tree(dp_virtsvc_ipv4_tree);
-	dp_virtsvc_free_tree(dp_virtsvc_ipv6_tree);
+	dp_free_jhash_table(dp_virtsvc_ipv6_table);
+	dp_free_jhash_table(dp_virtsvc_ipv4_table);
+	dp_free_jhash_table(dp_virtsvc_conn_table);
 	DP_FOREACH_VIRTSVC(&dp_virtservices, service)
-		dp_free_jhash_table(service->open_ports);
+		for (size_t i = 0; i < RTE_DIM(service->conn_chunks); ++i)
+			rte_free(service->conn_chunks[i]);
 	rte_free(dp_virtservices);
 }
 
@@ -249,23 +221,131 @@ static __rte_always_inline bool dp_virtsvc_is_connection_old(struct dp_virtsvc_c
 	return current_tsc > timeout;
 }
 
-static __rte_always_inline int dp_virtsvc_get_free_port(struct dp_virtsvc *virtsvc)
+static __rte_always_inline void dp_virtsvc_fill_conn_key(struct dp_virtsvc *virtsvc,
+														 struct dp_virtsvc_conn *conn,
+														 struct dp_virtsvc_conn_key *key)
+{
+	key->virtsvc_idx = (uint32_t)(virtsvc - dp_virtservices);
+	key->vf_port_id = conn->vf_port_id;
+	key->vf_l4_port = conn->vf_l4_port;
+	key->vf_ip = conn->vf_ip;
+}
+
+static __rte_always_inline void dp_virtsvc_lru_unlink(struct dp_virtsvc *virtsvc, uint16_t conn_idx)
+{
+	struct dp_virtsvc_conn *conn = dp_virtsvc_get_conn(virtsvc, conn_idx);
+
+	if (conn->prev == DP_VIRTSVC_CONN_NONE)
+		virtsvc->lru_head = conn->next;
+	else
+		dp_virtsvc_get_conn(virtsvc, conn->prev)->next = conn->next;
+
+	if (conn->next == DP_VIRTSVC_CONN_NONE)
+		virtsvc->lru_tail = conn->prev;
+	else
+		dp_virtsvc_get_conn(virtsvc, conn->next)->prev = conn->prev;
+}
+
+static __rte_always_inline void dp_virtsvc_lru_append(struct dp_virtsvc *virtsvc, uint16_t conn_idx)
+{
+	struct dp_virtsvc_conn *conn = dp_virtsvc_get_conn(virtsvc, conn_idx);
+
+	conn->prev = virtsvc->lru_tail;
+	conn->next = DP_VIRTSVC_CONN_NONE;
+
+	if (virtsvc->lru_tail == DP_VIRTSVC_CONN_NONE)
+		virtsvc->lru_head = conn_idx;
+	else
+		dp_virtsvc_get_conn(virtsvc, virtsvc->lru_tail)->next = conn_idx;
+
+	virtsvc->lru_tail = conn_idx;
+}
+
+// mark the connection as just used
+static __rte_always_inline void dp_virtsvc_touch_connection(struct dp_virtsvc *virtsvc, uint16_t conn_idx)
+{
+	dp_virtsvc_get_conn(virtsvc, conn_idx)->last_pkt_timestamp = rte_get_timer_cycles();
+
+	if (virtsvc->lru_tail != conn_idx) {
+		dp_virtsvc_lru_unlink(virtsvc, conn_idx);
+		dp_virtsvc_lru_append(virtsvc, conn_idx);
+	}
+}
+
+static void dp_virtsvc_release_connection(struct dp_virtsvc *virtsvc, uint16_t conn_idx)
+{
+	struct dp_virtsvc_conn *conn = dp_virtsvc_get_conn(virtsvc, conn_idx);
+	struct dp_virtsvc_conn_key delete_key;
+	int ret;
+
+	dp_virtsvc_fill_conn_key(virtsvc, conn, &delete_key);
+	ret = rte_hash_del_key(dp_virtsvc_conn_table, &delete_key);
+	if (DP_FAILED(ret))
+		DPS_LOG_WARNING("Cannot delete virtual service NAT entry", DP_LOG_RET(ret),
+						DP_LOG_PORTID(conn->vf_port_id), DP_LOG_L4PORT(conn->vf_l4_port));
+
+	dp_virtsvc_lru_unlink(virtsvc, conn_idx);
+	conn->last_pkt_timestamp = 0;
+}
+
+static int dp_virtsvc_reuse_old_port(struct dp_virtsvc *virtsvc)
 {
 	uint64_t current_tsc = rte_get_timer_cycles();
+	uint16_t conn_idx = virtsvc->lru_head;
+
+	// established connections have longer timeout, so the oldest one is not always the expired one
+	for (int i = 0; i < DP_VIRTSVC_FREE_PORT_SCAN && conn_idx != DP_VIRTSVC_CONN_NONE; ++i) {
+		if (dp_virtsvc_is_connection_old(dp_virtsvc_get_conn(virtsvc, conn_idx), current_tsc)) {
+			dp_virtsvc_release_connection(virtsvc, conn_idx);
+			return conn_idx;
+		}
+		conn_idx = dp_virtsvc_get_conn(virtsvc, conn_idx)->next;
+	}
+	return DP_ERROR;
+}
+
+static int dp_virtsvc_get_free_port(struct dp_virtsvc *virtsvc)
+{
+	uint16_t chunk_idx;
+	int ret;
 
 #ifdef ENABLE_PYTEST
 	// flow timeout is being tested, try to revisit already used ports
-	if (fast_timeout)
-		virtsvc->last_assigned_port = 0;
+	if (fast_timeout) {
+		ret = dp_virtsvc_reuse_old_port(virtsvc);
+		if (!DP_FAILED(ret))
+			return ret;
+	}
 #endif
 
-	for (uint16_t port = virtsvc->last_assigned_port+1; port < DP_VIRTSVC_PORTCOUNT; ++port)
-		if (dp_virtsvc_is_connection_old(&virtsvc->connections[port], current_tsc))
-			return virtsvc->last_assigned_port = port;
+	// ports released by interface removal
+	if (virtsvc->free_head != DP_VIRTSVC_CONN_NONE) {
+		ret = virtsvc->free_head;
+		virtsvc->free_head = dp_virtsvc_get_conn(virtsvc, virtsvc->free_head)->next;
+		return ret;
+	}
 
-	for (uint16_t port = 0; port <= virtsvc->last_assigned_port; ++port)
-		if (dp_virtsvc_is_connection_old(&virtsvc->connections[port], current_tsc))
-			return virtsvc->last_assigned_port = port;
+	if (virtsvc->next_unused_conn < DP_VIRTSVC_PORTCOUNT) {
+		chunk_idx = virtsvc->next_unused_conn >> DP_VIRTSVC_CONN_CHUNK_SHIFT;
+		// use all ports already allocated
+		if (virtsvc->conn_chunks[chunk_idx])
+			return virtsvc->next_unused_conn++;
+		// only allocate more if there are no timed-out connections to use
+		ret = dp_virtsvc_reuse_old_port(virtsvc);
+		if (!DP_FAILED(ret))
+			return ret;
+		virtsvc->conn_chunks[chunk_idx] = (struct dp_virtsvc_conn *)rte_zmalloc_socket("virtsvc_connections",
+															sizeof(struct dp_virtsvc_conn) * DP_VIRTSVC_CONN_CHUNK_SIZE,
+															RTE_CACHE_LINE_SIZE,
+															dp_virtsvc_socket_id);
+		if (virtsvc->conn_chunks[chunk_idx])
+			return virtsvc->next_unused_conn++;
+		DPS_LOG_WARNING("Cannot allocate more virtsvc connections", DP_LOG_VIRTSVC(virtsvc));
+	}
+
+	ret = dp_virtsvc_reuse_old_port(virtsvc);
+	if (!DP_FAILED(ret))
+		return ret;
 
 	DPS_LOG_WARNING("Out of virtsvc ports", DP_LOG_VIRTSVC(virtsvc));
 	return DP_ERROR;
@@ -275,7 +355,6 @@ static __rte_always_inline int dp_virtsvc_create_connection(struct dp_virtsvc *v
 															struct dp_virtsvc_conn_key *key,
 															hash_sig_t sig)
 {
-	struct dp_virtsvc_conn_key delete_key;
 	struct dp_virtsvc_conn *conn;
 	uint16_t free_port;
 	int ret;
@@ -285,38 +364,31 @@ static __rte_always_inline int dp_virtsvc_create_connection(struct dp_virtsvc *v
 		return ret;
 
 	free_port = (uint16_t)ret;
-	conn = &virtsvc->connections[free_port];
-
-	if (conn->last_pkt_timestamp) {
-		delete_key.vf_port_id = conn->vf_port_id;
-		delete_key.vf_l4_port = conn->vf_l4_port;
-		delete_key.vf_ip = conn->vf_ip;
-		ret = rte_hash_del_key(virtsvc->open_ports, &delete_key);
-		if (DP_FAILED(ret))
-			DPS_LOG_WARNING("Cannot delete virtual service NAT entry", DP_LOG_RET(ret),
-							DP_LOG_PORTID(conn->vf_port_id), DP_LOG_L4PORT(conn->vf_l4_port));
-	}
+	conn = dp_virtsvc_get_conn(virtsvc, free_port);
 
-	ret = rte_hash_add_key_with_hash_data(virtsvc->open_ports, key, sig, (void *)(intptr_t)free_port);
-	if (DP_FAILED(ret))
+	ret = rte_hash_add_key_with_hash_data(dp_virtsvc_conn_table, key, sig, (void *)(intptr_t)free_port);
+	if (DP_FAILED(ret)) {
+		// return the port for later use
+		conn->next = virtsvc->free_head;
+		virtsvc->free_head = free_port;
 		return ret;
+	}
 
 	conn->vf_ip = key->vf_ip;
 	conn->vf_l4_port = key->vf_l4_port;
 	conn->vf_port_id = key->vf_port_id;
 	conn->state = DP_VIRTSVC_CONN_TRANSIENT;
+	dp_virtsvc_lru_append(virtsvc, free_port);
 
 	return free_port;
 }
 
-static __rte_always_inline int dp_virstvc_get_connection(struct dp_virtsvc *virtsvc,
-														 struct dp_virtsvc_conn_key *key,
-														 hash_sig_t sig)
+static __rte_always_inline int dp_virstvc_get_connection(struct dp_virtsvc_conn_key *key, hash_sig_t sig)
 {
 	void *data;
 	int ret;
 
-	ret = rte_hash_lookup_with_hash_data(virtsvc->open_ports, key, sig, &data);
+	ret = rte_hash_lookup_with_hash_data(dp_virtsvc_conn_table, key, sig, &data);
 	if (DP_FAILED(ret))
 		return ret;
 
@@ -332,14 +404,15 @@ int dp_virtsvc_get_pf_route(struct dp_virtsvc *virtsvc,
 							 int *conn_idx)
 {
 	struct dp_virtsvc_conn_key key = {
+		.virtsvc_idx = (uint32_t)(virtsvc - dp_virtservices),
 		.vf_port_id = vf_port_id,
 		.vf_l4_port = vf_l4_port,
 		.vf_ip = vf_ip,
 	};
-	hash_sig_t key_hash = rte_hash_hash(virtsvc->open_ports, &key);
+	hash_sig_t key_hash = rte_hash_hash(dp_virtsvc_conn_table, &key);
 	int ret;
 
-	ret = dp_virstvc_get_connection(virtsvc, &key, key_hash);
+	ret = dp_virstvc_get_connection(&key, key_hash);
 	if (ret == -ENOENT)
 		ret = dp_virtsvc_create_connection(virtsvc, &key, key_hash);
 	if (DP_FAILED(ret)) {
@@ -347,6 +420,7 @@ int dp_virtsvc_get_pf_route(struct dp_virtsvc *virtsvc,
 		return ret;
 	}
 
+	dp_virtsvc_touch_connection(virtsvc, (uint16_t)ret);
 	*conn_idx = ret;
 
 	static_assert(sizeof(key_hash) == sizeof(uint32_t), "Virtsvc key is not 32b integer");
@@ -355,29 +429,35 @@ int dp_virtsvc_get_pf_route(struct dp_virtsvc *virtsvc,
 	return DP_OK;
 }
 
+struct dp_virtsvc_conn *dp_virtsvc_get_reply_conn(struct dp_virtsvc *virtsvc, rte_be16_t l4_port)
+{
+	// system ports underflow to high values, thus also get rejected here
+	uint16_t conn_idx = (uint16_t)(ntohs(l4_port) - DP_NB_SYSTEM_PORTS);
+	struct dp_virtsvc_conn *conn;
+
+	if (conn_idx >= virtsvc->next_unused_conn)
+		return NULL;
+
+	conn = dp_virtsvc_get_conn(virtsvc, conn_idx);
+	if (!conn->last_pkt_timestamp)
+		return NULL;
+
+	dp_virtsvc_touch_connection(virtsvc, conn_idx);
+	return conn;
+}
+
 
 void dp_virtsvc_del_iface(uint16_t port_id)
 {
-	struct dp_virtsvc_conn_key delete_key;
 	struct dp_virtsvc_conn *conn;
-	int ret;
 
 	DP_FOREACH_VIRTSVC(&dp_virtservices, service) {
-		// This seems sub-optimal as it always checks *all* ports.
-		// But in practice, the port table is always full anyway
-		// as timed-out connections get replaced with new ones on-demand
-		// (i.e. the table is constantly full after the first 64k connections)
-		for (size_t i = 0; i < RTE_DIM(service->connections); ++i) {
-			conn = &service->connections[i];
+		for (uint16_t i = 0; i < service->next_unused_conn; ++i) {
+			conn = dp_virtsvc_get_conn(service, i);
 			if (conn->vf_port_id == port_id && conn->last_pkt_timestamp) {
-				conn->last_pkt_timestamp = 0;
-				delete_key.vf_port_id = conn->vf_port_id;
-				delete_key.vf_l4_port = conn->vf_l4_port;
-				delete_key.vf_ip = conn->vf_ip;
-				ret = rte_hash_del_key(service->open_ports, &delete_key);
-				if (DP_FAILED(ret))
-					DPS_LOG_WARNING("Cannot delete virtual service NAT entry", DP_LOG_RET(ret),
-							DP_LOG_PORTID(conn->vf_port_id), DP_LOG_L4PORT(conn->vf_l4_port));
+				dp_virtsvc_release_connection(service, i);
+				conn->next = service->free_head;
+				service->free_head = i;
 			}
 		}
 	}
@@ -387,9 +467,12 @@ static inline uint64_t dp_virtsvc_get_used_port_count(struct dp_virtsvc *virtsvc
 {
 	uint64_t used_ports = 0;
 	uint64_t current_tsc = rte_get_timer_cycles();
+	struct dp_virtsvc_conn *conn;
 
-	for (int port = 0; port < DP_VIRTSVC_PORTCOUNT; ++port) {
-		if (!dp_virtsvc_is_connection_old(&virtsvc->connections[port], current_tsc))
+	// not walking the LRU list, as that is being changed by the worker thread
+	for (uint16_t i = 0; i < virtsvc->next_unused_conn; ++i) {
+		conn = dp_virtsvc_get_conn(virtsvc, i);
+		if (conn->last_pkt_timestamp && !dp_virtsvc_is_connection_old(conn, current_tsc))
 			++used_ports;
 	}
 	return used_ports;
@@ -414,3 +497,12 @@ int dp_virtsvc_get_used_ports_telemetry(struct rte_tel_data *dict)
 	}
 	return DP_OK;
 }
+
+int dp_virtsvc_get_tables_telemetry(struct rte_tel_data *dict)
+{
+	if (!dp_virtsvc_conn_table)
+		return DP_OK;
+
+	return dp_add_table_telemetry(dict, "virtsvc_conn_table",
+								  (uint32_t)rte_hash_count(dp_virtsvc_conn_table), (uint32_t)dp_virtsvc_conn_table_size);
+}
@@ -3,27 +3,30 @@
 
 #include "dp_vnf.h"
 #include <rte_malloc.h>
+#include "dp_conf.h"
 #include "dp_error.h"
+#include "dp_internal_stats.h"
 #include "dp_log.h"
 #include "dp_lpm.h"
 #include "grpc/dp_grpc_responder.h"
 
-#define DP_VNF_MAX_TABLE_SIZE 1000
-
 #define DPS_LOG_VNF_WARNING(MESSAGE, VNF) \
 	dp_vnf_log_warning(MESSAGE, (VNF)->type, (VNF)->vni, (VNF)->port_id, &(VNF)->alias_pfx.ol, (VNF)->alias_pfx.length)
 
 static struct rte_hash *vnf_handle_tbl = NULL;
 static struct rte_hash *vnf_value_tbl = NULL;
+static int vnf_table_size = DP_VNF_TABLE_MAX;
 
 int dp_vnf_init(int socket_id)
 {
-	vnf_handle_tbl = dp_create_jhash_table(DP_VNF_MAX_TABLE_SIZE, DP_IPV6_ADDR_SIZE,
+	vnf_table_size = dp_conf_get_vnf_table_size();
+
+	vnf_handle_tbl = dp_create_jhash_table(vnf_table_size, DP_IPV6_ADDR_SIZE,
 										   "vnf_handle_table", socket_id);
 	if (!vnf_handle_tbl)
 		return DP_ERROR;
 
-	vnf_value_tbl = dp_create_jhash_table(DP_VNF_MAX_TABLE_SIZE, sizeof(struct dp_vnf),
+	vnf_value_tbl = dp_create_jhash_table(vnf_table_size, sizeof(struct dp_vnf),
 										  "vnf_value_table", socket_id);
 	if (!vnf_value_tbl) {
 		dp_free_jhash_table(vnf_handle_tbl);
@@ -38,6 +41,14 @@ void dp_vnf_free(void)
 	dp_free_jhash_table(vnf_handle_tbl);
 }
 
+int dp_vnf_get_tables_telemetry(struct rte_tel_data *dict)
+{
+	if (DP_FAILED(dp_add_table_telemetry(dict, "vnf_handle_table", (uint32_t)rte_hash_count(vnf_handle_tbl), (uint32_t)vnf_table_size))
+		|| DP_FAILED(dp_add_table_telemetry(dict, "vnf_value_table", (uint32_t)rte_hash_count(vnf_value_tbl), (uint32_t)vnf_table_size)))
+		return DP_ERROR;
+	return DP_OK;
+}
+
 static inline void dp_vnf_log_warning(const char *message,
 									  enum dp_vnf_type type, uint32_t vni, uint16_t port_id,
 									  const struct dp_ip_address *prefix, uint8_t length)
@@ -4,6 +4,7 @@
 #include "dp_vni.h"
 #include <rte_malloc.h>
 #include "dp_error.h"
+#include "dp_internal_stats.h"
 #include "dp_nat.h"
 
 struct rte_hash *vni_handle_tbl = NULL;
@@ -23,6 +24,11 @@ void dp_vni_free(void)
 	dp_free_jhash_table(vni_handle_tbl);
 }
 
+int dp_vni_get_tables_telemetry(struct rte_tel_data *dict)
+{
+	return dp_add_table_telemetry(dict, "vni_handle_table", (uint32_t)rte_hash_count(vni_handle_tbl), DP_VNI_MAX_TABLE_SIZE);
+}
+
 bool dp_is_vni_route_table_available(uint32_t vni, int type)
 {
 	struct dp_vni_data *vni_data;
@@ -114,7 +120,7 @@ static __rte_always_inline int dp_allocate_vni_route_tables(const struct dp_vni_
 	uint32_t vni = vni_key->vni;
 	int ret;
 
-	vni_data = rte_zmalloc("vni_handle_table", sizeof(struct dp_vni_data), RTE_CACHE_LINE_SIZE);
+	vni_data = rte_zmalloc_socket("vni_handle_table", sizeof(struct dp_vni_data), RTE_CACHE_LINE_SIZE, socket_id);
 	if (!vni_data) {
 		DPS_LOG_ERR("VNI allocation failed", DP_LOG_VNI(vni));
 		goto err_alloc;
@@ -3,54 +3,101 @@
 
 #include "dpdk_layer.h"
 #include <rte_graph_worker.h>
+#include <rte_lcore.h>
+#include "dp_conf.h"
 #include "dp_error.h"
 #include "dp_graph.h"
+#include "dp_idle.h"
 #include "dp_log.h"
 #include "dp_mbuf_dyn.h"
+#include "dp_numa.h"
+#include "dp_periodic_msg.h"
 #include "dp_timers.h"
 #include "dp_util.h"
 #include "grpc/dp_grpc_thread.h"
+#include "monitoring/dp_latency.h"
+#include "nodes/tx_node.h"
 
 static volatile bool force_quit;
 
 static struct dp_dpdk_layer dp_layer;
 
-static inline int ring_init(const char *name, struct rte_ring **p_ring, uint32_t capacity)
+// the worker is on one end of every ring
+static inline int ring_init(const char *name, struct rte_ring **p_ring, uint32_t capacity, bool multi_producer)
 {
-	*p_ring = rte_ring_create(name, rte_align32pow2(capacity), rte_socket_id(), RING_F_SC_DEQ | RING_F_SP_ENQ);
+	int socket_id = dp_numa_get_worker_socket_id();
+	unsigned int flags = multi_producer ? RING_F_SC_DEQ : RING_F_SC_DEQ | RING_F_SP_ENQ;
+
+	*p_ring = rte_ring_create(name, rte_align32pow2(capacity), socket_id, flags);
 	if (!*p_ring) {
-		DPS_LOG_ERR("Error creating ring buffer", DP_LOG_NAME(name), DP_LOG_RET(rte_errno));
+		DPS_LOG_ERR("Error creating ring buffer", DP_LOG_NAME(name), DP_LOG_SOCKID(socket_id), DP_LOG_RET(rte_errno));
 		return DP_ERROR;
 	}
+	dp_numa_register(name, *p_ring, socket_id);
 	return DP_OK;
 }
 
 static inline void ring_free(struct rte_ring *ring)
 {
+	dp_numa_unregister(ring);
 	rte_ring_free(ring);
 }
 
+static int mempool_init(int socket_id)
+{
+	struct rte_mempool *mempool;
+	char name[RTE_MEMPOOL_NAMESIZE];
+
+	if (dp_layer.rte_mempools[socket_id])
+		return DP_OK;
+
+	snprintf(name, sizeof(name), "mbuf_pool_%d", socket_id);
+	mempool = rte_pktmbuf_pool_create(name, DP_MBUF_POOL_SIZE,
+									  DP_MEMPOOL_CACHE_SIZE, DP_MBUF_PRIV_DATA_SIZE,
+									  RTE_MBUF_DEFAULT_BUF_SIZE,
+									  socket_id);
+	if (!mempool) {
+		DPS_LOG_ERR("Cannot create mbuf pool", DP_LOG_SOCKID(socket_id), DP_LOG_RET(rte_errno));
+		return DP_ERROR;
+	}
+	dp_numa_register(name, mempool, socket_id);
+
+	dp_layer.rte_mempools[socket_id] = mempool;
+	return DP_OK;
+}
+
+static void mempools_free(void)
+{
+	for (int i = 0; i < RTE_MAX_NUMA_NODES; ++i) {
+		dp_numa_unregister(dp_layer.rte_mempools[i]);
+		rte_mempool_free(dp_layer.rte_mempools[i]);
+	}
+}
+
 /** unsafe - does not do cleanup on failure */
 static int dp_dpdk_layer_init_unsafe(void)
 {
-	dp_layer.rte_mempool = rte_pktmbuf_pool_create("mbuf_pool", DP_MBUF_POOL_SIZE,
-												   DP_MEMPOOL_CACHE_SIZE, DP_MBUF_PRIV_DATA_SIZE,
-												   RTE_MBUF_DEFAULT_BUF_SIZE,
-												   rte_socket_id());
-	if (!dp_layer.rte_mempool) {
-		DPS_LOG_ERR("Cannot create mbuf pool", DP_LOG_RET(rte_errno));
+	unsigned int lcore_id;
+	int worker_socket_id = dp_numa_get_worker_socket_id();
+
+	// every worker allocates packets (Rx, gRPC, timers) from a pool on its own NUMA node
+	if (DP_FAILED(mempool_init(worker_socket_id)))
 		return DP_ERROR;
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (DP_FAILED(mempool_init((int)rte_lcore_to_socket_id(lcore_id))))
+			return DP_ERROR;
 	}
+	dp_layer.rte_mempool = dp_layer.rte_mempools[worker_socket_id];
 
 	dp_layer.num_of_vfs = dp_get_num_of_vfs();
 	if (DP_FAILED(dp_layer.num_of_vfs))
 		return DP_ERROR;
 
-	/* TODO monitoring_rx_queue queue needs to be multiproducer, single consumer */
-	if (DP_FAILED(ring_init("grpc_tx_queue", &dp_layer.grpc_tx_queue, DP_GRPC_Q_SIZE))
-		|| DP_FAILED(ring_init("grpc_rx_queue", &dp_layer.grpc_rx_queue, DP_GRPC_Q_SIZE))
-		|| DP_FAILED(ring_init("periodic_msg_queue", &dp_layer.periodic_msg_queue, DP_PERIODIC_Q_SIZE))
-		|| DP_FAILED(ring_init("monitoring_rx_queue", &dp_layer.monitoring_rx_queue, DP_INTERNAL_Q_SIZE)))
+	// events come from the interrupt thread, timers and the neighbor watcher
+	if (DP_FAILED(ring_init("grpc_tx_queue", &dp_layer.grpc_tx_queue, DP_GRPC_Q_SIZE, false))
+		|| DP_FAILED(ring_init("grpc_rx_queue", &dp_layer.grpc_rx_queue, DP_GRPC_Q_SIZE, false))
+		|| DP_FAILED(ring_init("periodic_msg_queue", &dp_layer.periodic_msg_queue, DP_PERIODIC_Q_SIZE, false))
+		|| DP_FAILED(ring_init("monitoring_rx_queue", &dp_layer.monitoring_rx_queue, DP_INTERNAL_Q_SIZE, true)))
 		return DP_ERROR;
 
 	if (DP_FAILED(dp_timers_init()))
@@ -76,11 +123,12 @@ void dp_dpdk_layer_free(void)
 {
 	// all functions are safe to call before init
 	dp_timers_free();
+	dp_periodic_msg_free();
 	ring_free(dp_layer.monitoring_rx_queue);
 	ring_free(dp_layer.periodic_msg_queue);
 	ring_free(dp_layer.grpc_rx_queue);
 	ring_free(dp_layer.grpc_tx_queue);
-	rte_mempool_free(dp_layer.rte_mempool);
+	mempools_free();
 }
 
 void dp_force_quit(void)
@@ -93,11 +141,23 @@ void dp_force_quit(void)
 static int graph_main_loop(__rte_unused void *arg)
 {
 	struct rte_graph *graph = dp_graph_get();
+	uint32_t latency_sampling = (uint32_t)dp_conf_get_latency_sampling();
+	uint32_t walks_to_sample = latency_sampling;
 
 	dp_log_set_thread_name("worker");
 
-	while (!force_quit)
-		rte_graph_walk(graph);
+	while (!force_quit) {
+		// only every N-th walk is measured to keep the overhead negligible
+		if (latency_sampling && --walks_to_sample == 0) {
+			dp_latency_walk_sampled(graph);
+			walks_to_sample = latency_sampling;
+		} else
+			rte_graph_walk(graph);
+		tx_node_flush_pending(false);
+		dp_idle_walk_done();
+	}
+
+	tx_node_flush_pending(true);
 
 	return 0;
 }
@@ -165,7 +225,12 @@ int dp_dpdk_main_loop(void)
 	}
 
 	/* Launch timer loop on main core */
-	return main_core_loop();
+	ret = main_core_loop();
+
+	// nothing used by workers (including their log rings) can be freed before they stop
+	rte_eal_mp_wait_lcore();
+
+	return ret;
 }
 
 struct dp_dpdk_layer *get_dpdk_layer(void)
@@ -4,12 +4,14 @@
 #include "grpc/dp_grpc_impl.h"
 #include <time.h>
 #include "dp_conf.h"
+#include "dp_decap_cache.h"
 #include "dp_error.h"
 #include "dp_flow.h"
 #include "dp_lb.h"
 #include "dp_log.h"
 #include "dp_lpm.h"
 #include "dp_nat.h"
+#include "dp_numa.h"
 #include "dp_version.h"
 #ifdef ENABLE_VIRTSVC
 #	include "dp_virtsvc.h"
@@ -21,6 +23,7 @@
 #include "grpc/dp_grpc_api.h"
 #include "grpc/dp_grpc_responder.h"
 #include "monitoring/dp_monitoring.h"
+#include "nodes/ipip_encap_node.h"
 #include "rte_flow/dp_rte_flow_capture.h"
 
 static uint32_t pfx_counter = 0;
@@ -102,7 +105,7 @@ static int dp_process_create_lb(struct dp_grpc_responder *responder)
 	ret = dp_create_lb(request, ul_addr6);
 	if (DP_FAILED(ret))
 		goto err_vnf;
-	if (DP_FAILED(dp_create_vni_route_tables(request->vni, dp_get_pf0()->socket_id))) {
+	if (DP_FAILED(dp_create_vni_route_tables(request->vni, dp_numa_get_worker_socket_id()))) {
 		ret = DP_GRPC_ERR_VNI_INIT4;
 		goto err_lb;
 	}
@@ -980,6 +983,37 @@ static int dp_process_capture_status(struct dp_grpc_responder *responder)
 	return DP_GRPC_OK;
 }
 
+static __rte_always_inline bool dp_is_config_change(enum dpgrpc_request_type request_type)
+{
+	switch (request_type) {
+	case DP_REQ_TYPE_Initialize:
+	case DP_REQ_TYPE_CreateInterface:
+	case DP_REQ_TYPE_DeleteInterface:
+	case DP_REQ_TYPE_CreatePrefix:
+	case DP_REQ_TYPE_DeletePrefix:
+	case DP_REQ_TYPE_CreateRoute:
+	case DP_REQ_TYPE_DeleteRoute:
+	case DP_REQ_TYPE_CreateVip:
+	case DP_REQ_TYPE_DeleteVip:
+	case DP_REQ_TYPE_CreateNat:
+	case DP_REQ_TYPE_DeleteNat:
+	case DP_REQ_TYPE_CreateNeighborNat:
+	case DP_REQ_TYPE_DeleteNeighborNat:
+	case DP_REQ_TYPE_CreateLoadBalancer:
+	case DP_REQ_TYPE_DeleteLoadBalancer:
+	case DP_REQ_TYPE_CreateLoadBalancerTarget:
+	case DP_REQ_TYPE_DeleteLoadBalancerTarget:
+	case DP_REQ_TYPE_CreateLoadBalancerPrefix:
+	case DP_REQ_TYPE_DeleteLoadBalancerPrefix:
+	case DP_REQ_TYPE_CreateFirewallRule:
+	case DP_REQ_TYPE_DeleteFirewallRule:
+	case DP_REQ_TYPE_ResetVni:
+		return true;
+	default:
+		// queries and packet capture do not affect forwarding
+		return false;
+	}
+}
 
 void dp_process_request(struct rte_mbuf *m)
 {
@@ -1116,6 +1150,13 @@ void dp_process_request(struct rte_mbuf *m)
 		break;
 	}
 
+	// caches of the worker are only valid for the configuration they were created with
+	// (also for failed requests, they can leave a partial change behind)
+	if (dp_is_config_change(request_type)) {
+		dp_decap_cache_invalidate();
+		ipip_encap_node_invalidate_templates();
+	}
+
 	if (DP_FAILED(ret)) {
 		// as gRPC errors are explicitly defined due to API reasons
 		// extract the proper value from the standard (negative) retvals
@@ -7,7 +7,9 @@
 #include "dp_flow.h"
 #include "dp_log.h"
 #include "dp_port.h"
+#include "monitoring/dp_latency.h"
 #include "monitoring/dp_monitoring.h"
+#include "nodes/ipip_encap_node.h"
 #include "rte_flow/dp_rte_flow_init.h"
 
 
@@ -26,7 +28,7 @@ static int dp_send_event_msg(const struct dp_event_msg *msg)
 	mbuf_msg = rte_pktmbuf_mtod(m, struct dp_event_msg *);
 	memcpy(mbuf_msg, msg, sizeof(struct dp_event_msg));
 
-	ret = rte_ring_sp_enqueue(get_dpdk_layer()->monitoring_rx_queue, m);
+	ret = rte_ring_enqueue(get_dpdk_layer()->monitoring_rx_queue, m);
 	if (DP_FAILED(ret)) {
 		DPS_LOG_ERR("Cannot enqueue monitoring event message", DP_LOG_VALUE(msg->msg_head.type), DP_LOG_RET(ret));
 		rte_pktmbuf_free(m);
@@ -104,18 +106,60 @@ int dp_send_event_flow_aging_msg(void)
 
 void dp_process_event_flow_aging_msg(__rte_unused struct rte_mbuf *m)
 {
+	uint64_t start;
+
 	if (dp_conf_is_offload_enabled()) {
 		const struct dp_ports *ports = dp_get_ports();
 
+		start = dp_latency_start();
 		DP_FOREACH_PORT(ports, port) {
 			if (port->allocated)
 				dp_process_aged_flows(port->port_id);
 		}
+		dp_latency_end(DP_LATENCY_HANDLER_AGED_FLOWS, start);
 	}
 
 	// software aged flow and hardware aged flow are bound to a same cntrack obj via shared refcount
 	// this cntrack obj gets deleted when the last reference is removed
 	// dp_process_aged_flows_non_offload() also takes care of expired tcp hw rte flow rules via the query mechanism,
 	// which enables fully control of hw rules' lifecycle from the software path for tcp flows.
+	start = dp_latency_start();
 	dp_process_aged_flows_non_offload();
+	dp_latency_end(DP_LATENCY_HANDLER_AGED_FLOWS_NON_OFFLOAD, start);
+}
+
+// Neighbor-change message - sent when the underlay router of a PF changes its MAC address
+
+int dp_send_event_neigh_msg(uint16_t port_id, const struct rte_ether_addr *mac)
+{
+	struct dp_event_msg neigh_msg = {
+		.msg_head = {
+			.type = DP_EVENT_TYPE_NEIGH_CHANGE,
+		},
+		.event_entry = {
+			.neigh_change = {
+				.port_id = port_id,
+				.mac = *mac,
+			},
+		},
+	};
+	return dp_send_event_msg(&neigh_msg);
+}
+
+void dp_process_event_neigh_msg(struct rte_mbuf *m)
+{
+	struct dp_event_msg *neigh_msg = rte_pktmbuf_mtod(m, struct dp_event_msg *);
+	uint16_t port_id = neigh_msg->event_entry.neigh_change.port_id;
+	struct dp_port *port;
+
+	port = dp_get_port_by_id(port_id);
+	if (!port || !port->is_pf) {
+		DPS_LOG_WARNING("Cannot set neighbor MAC, port invalid", DP_LOG_PORTID(port_id));
+		return;
+	}
+
+	// software Tx reads the MAC from here, only prepared headers need rebuilding
+	// (already offloaded flows keep using the old MAC until they age out)
+	rte_ether_addr_copy(&neigh_msg->event_entry.neigh_change.mac, &port->neigh_mac);
+	ipip_encap_node_invalidate_templates();
 }
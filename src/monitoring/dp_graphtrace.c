@@ -9,6 +9,7 @@
 #include "dp_conf.h"
 #include "dp_error.h"
 #include "dp_log.h"
+#include "dp_numa.h"
 #include "dpdk_layer.h"
 #include "monitoring/dp_graphtrace_shared.h"
 #include "monitoring/dp_pcap.h"
@@ -31,23 +32,29 @@ static bool nodename_filtered;
 static regex_t nodename_re;
 static bool bpf_filtered;
 static struct bpf_program bpf;
+static uint64_t drop_reasons;
+static uint32_t drop_sample;
+static uint32_t drop_sample_counter;
 
 static int dp_graphtrace_init_memory(void)
 {
+	// the worker is the producer, dpservice-dump only reads the copies
+	int socket_id = dp_numa_get_worker_socket_id();
+
 	// DPDK recommendation for mempool size: power of 2 minus one for best memory utilization
 	// So using ringbuffer size minus one, when the ring buffer is (almost) full, allocation will start failing
 	// (this is intentional, see below)
 	graphtrace.mempool = rte_pktmbuf_pool_create(DP_GRAPHTRACE_MEMPOOL_NAME, DP_GRAPHTRACE_RINGBUF_SIZE-1,
 											 DP_MEMPOOL_CACHE_SIZE, DP_MBUF_PRIV_DATA_SIZE + sizeof(struct dp_graphtrace_pktinfo),
 											 RTE_MBUF_DEFAULT_BUF_SIZE,
-											 rte_socket_id());
+											 socket_id);
 	if (!graphtrace.mempool) {
 		DPS_LOG_ERR("Cannot allocate graphtrace pool", DP_LOG_RET(rte_errno));
 		return DP_ERROR;
 	}
 
 	graphtrace.ringbuf = rte_ring_create(DP_GRAPHTRACE_RINGBUF_NAME, DP_GRAPHTRACE_RINGBUF_SIZE,
-										 rte_socket_id(), RING_F_SC_DEQ | RING_F_SP_ENQ);
+										 socket_id, RING_F_SC_DEQ | RING_F_SP_ENQ);
 	if (!graphtrace.ringbuf) {
 		DPS_LOG_ERR("Cannot create graphtrace ring buffer", DP_LOG_RET(rte_errno));
 		rte_mempool_free(graphtrace.mempool);
@@ -55,7 +62,7 @@ static int dp_graphtrace_init_memory(void)
 	}
 
 	graphtrace.filters = rte_memzone_reserve(DP_GRAPHTRACE_FILTERS_NAME, sizeof(struct dp_graphtrace_params),
-											 rte_socket_id(), 0);
+											 socket_id, 0);
 	if (!graphtrace.filters) {
 		DPS_LOG_ERR("Cannot create graphtrace filter definition memory", DP_LOG_RET(rte_errno));
 		rte_mempool_free(graphtrace.mempool);
@@ -100,6 +107,10 @@ static int dp_handle_graphtrace_start(const struct dp_graphtrace_mp_request *req
 		}
 	}
 
+	drop_reasons = request->params.start.drop_reasons;
+	drop_sample = request->params.start.drop_sample;
+	drop_sample_counter = 0;
+
 	_dp_graphtrace_flags = 0;
 	if (request->params.start.drops)
 		_dp_graphtrace_flags |= DP_GRAPHTRACE_FLAG_DROPS;
@@ -211,6 +222,22 @@ bool dp_is_node_match(regex_t *re, const struct rte_node *node, const struct rte
 		return false;
 }
 
+static __rte_always_inline
+bool dp_is_drop_match(uint8_t reason)
+{
+	if (!(drop_reasons & DP_DROP_REASON_MASK(reason)))
+		return false;
+
+	// sampling is done after reason-filtering, so rare reasons are still visible
+	if (drop_sample > 1) {
+		if (++drop_sample_counter < drop_sample)
+			return false;
+		drop_sample_counter = 0;
+	}
+
+	return true;
+}
+
 void _dp_graphtrace_send(const struct rte_node *node,
 						 const struct rte_node *next_node,
 						 void **objs, uint16_t nb_objs,
@@ -220,6 +247,8 @@ void _dp_graphtrace_send(const struct rte_node *node,
 	struct rte_mbuf *dups[nb_objs];
 	struct rte_mbuf *dup;
 	struct dp_graphtrace_pktinfo *pktinfo;
+	bool is_drop = !next_node && dst_port_id == (uint16_t)-1;
+	uint8_t drop_reason = DP_DROP_REASON_UNKNOWN;
 	uint32_t sent;
 
 	for (uint32_t i = 0; i < nb_objs; ++i) {
@@ -227,6 +256,13 @@ void _dp_graphtrace_send(const struct rte_node *node,
 			continue;
 		if (bpf_filtered && !dp_is_bpf_match(&bpf, objs[i]))
 			continue;
+		if (is_drop) {
+			drop_reason = dp_get_pkt_mark(objs[i])->drop_reason;
+			if (unlikely(drop_reason >= DP_DROP_REASON_COUNT))
+				drop_reason = DP_DROP_REASON_UNKNOWN;
+			if (!dp_is_drop_match(drop_reason))
+				continue;
+		}
 		dup = rte_pktmbuf_copy(objs[i], graphtrace.mempool, 0, UINT32_MAX);
 		if (likely(!dup)) {
 			// allocation (pool size) is designed to fail when the ringbuffer is (almost) full
@@ -239,6 +275,7 @@ void _dp_graphtrace_send(const struct rte_node *node,
 		pktinfo->node = node;
 		pktinfo->next_node = next_node;
 		pktinfo->dst_port_id = dst_port_id;
+		pktinfo->drop_reason = drop_reason;
 	}
 
 	if (likely(nb_dups == 0))
@@ -268,7 +305,8 @@ static void dp_graphtrace_log(const void *obj, const char *format, ...)
 
 	dp_graphtrace_sprint(obj, buf + pos, sizeof(buf) - pos);
 
-	DP_STRUCTURED_LOG(DEBUG, GRAPH, buf);
+	// the message is stored by reference, dynamic text must be a value; tracing must not be rate-limited
+	_DP_STRUCTURED_LOG(true, DEBUG, GRAPH, "Graph trace", _DP_LOG_STR("trace", buf));
 }
 
 void _dp_graphtrace_log_node(const struct rte_node *node, void *obj)
@@ -322,6 +360,7 @@ void _dp_graphtrace_log_drop_burst(const struct rte_node *node, void **objs, uin
 	if (graphtrace_loglevel >= DP_GRAPHTRACE_LOGLEVEL_NEXT)
 		for (uint32_t i = 0; i < nb_objs; ++i)
 			dp_graphtrace_log(objs[i], "%-11s #%u: %3u >> DROP %-9s: ",
-						   node->name, i, dp_get_pkt_mark(objs[i])->id, "");
+						   node->name, i, dp_get_pkt_mark(objs[i])->id,
+						   dp_get_drop_reason_name(dp_get_pkt_mark(objs[i])->drop_reason));
 }
 #endif  // ENABLE_PYTEST
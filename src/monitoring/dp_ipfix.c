@@ -0,0 +1,527 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "monitoring/dp_ipfix.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <rte_byteorder.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_ring.h>
+#include <rte_thread.h>
+#include "dp_conf.h"
+#include "dp_error.h"
+#include "dp_log.h"
+#include "dp_numa.h"
+
+#define DP_IPFIX_VERSION			10
+#define DP_IPFIX_TEMPLATE_SET_ID	2
+#define DP_IPFIX_TEMPLATE_ID_IPV4	256
+#define DP_IPFIX_TEMPLATE_ID_IPV6	257
+#define DP_IPFIX_OBSERVATION_DOMAIN	1
+
+#define DP_IPFIX_IDLE_SLEEP_US		10000
+
+// Information Element identifiers (RFC 5102 and IANA registry)
+enum dp_ipfix_ie {
+	DP_IPFIX_IE_PROTOCOL_IDENTIFIER			= 4,
+	DP_IPFIX_IE_SOURCE_TRANSPORT_PORT		= 7,
+	DP_IPFIX_IE_SOURCE_IPV4_ADDRESS			= 8,
+	DP_IPFIX_IE_INGRESS_INTERFACE			= 10,
+	DP_IPFIX_IE_DESTINATION_TRANSPORT_PORT	= 11,
+	DP_IPFIX_IE_DESTINATION_IPV4_ADDRESS	= 12,
+	DP_IPFIX_IE_SOURCE_IPV6_ADDRESS			= 27,
+	DP_IPFIX_IE_DESTINATION_IPV6_ADDRESS	= 28,
+	DP_IPFIX_IE_FLOW_END_REASON				= 136,
+	DP_IPFIX_IE_FLOW_START_MILLISECONDS		= 152,
+	DP_IPFIX_IE_FLOW_END_MILLISECONDS		= 153,
+	DP_IPFIX_IE_POST_NAT_SOURCE_IPV4		= 225,
+	DP_IPFIX_IE_POST_NAT_DESTINATION_IPV4	= 226,
+	DP_IPFIX_IE_POST_NAPT_SOURCE_PORT		= 227,
+	DP_IPFIX_IE_POST_NAPT_DESTINATION_PORT	= 228,
+	DP_IPFIX_IE_INITIATOR_OCTETS			= 231,
+	DP_IPFIX_IE_RESPONDER_OCTETS			= 232,
+	DP_IPFIX_IE_INITIATOR_PACKETS			= 298,
+	DP_IPFIX_IE_RESPONDER_PACKETS			= 299,
+	DP_IPFIX_IE_LAYER2_SEGMENT_ID			= 351,
+};
+
+struct dp_ipfix_field {
+	uint16_t	id;
+	uint16_t	length;
+};
+
+// the order here must match dp_ipfix_put_record()
+#define DP_IPFIX_TEMPLATE_FIELDS(SRC_ADDR_IE, DST_ADDR_IE, ADDR_LEN) { \
+	{ SRC_ADDR_IE, ADDR_LEN }, \
+	{ DST_ADDR_IE, ADDR_LEN }, \
+	{ DP_IPFIX_IE_SOURCE_TRANSPORT_PORT, 2 }, \
+	{ DP_IPFIX_IE_DESTINATION_TRANSPORT_PORT, 2 }, \
+	{ DP_IPFIX_IE_PROTOCOL_IDENTIFIER, 1 }, \
+	{ DP_IPFIX_IE_POST_NAT_SOURCE_IPV4, 4 }, \
+	{ DP_IPFIX_IE_POST_NAT_DESTINATION_IPV4, 4 }, \
+	{ DP_IPFIX_IE_POST_NAPT_SOURCE_PORT, 2 }, \
+	{ DP_IPFIX_IE_POST_NAPT_DESTINATION_PORT, 2 }, \
+	{ DP_IPFIX_IE_LAYER2_SEGMENT_ID, 8 }, \
+	{ DP_IPFIX_IE_INGRESS_INTERFACE, 4 }, \
+	{ DP_IPFIX_IE_INITIATOR_PACKETS, 8 }, \
+	{ DP_IPFIX_IE_INITIATOR_OCTETS, 8 }, \
+	{ DP_IPFIX_IE_RESPONDER_PACKETS, 8 }, \
+	{ DP_IPFIX_IE_RESPONDER_OCTETS, 8 }, \
+	{ DP_IPFIX_IE_FLOW_START_MILLISECONDS, 8 }, \
+	{ DP_IPFIX_IE_FLOW_END_MILLISECONDS, 8 }, \
+	{ DP_IPFIX_IE_FLOW_END_REASON, 1 }, \
+}
+
+static const struct dp_ipfix_field template_fields_ipv4[] =
+	DP_IPFIX_TEMPLATE_FIELDS(DP_IPFIX_IE_SOURCE_IPV4_ADDRESS, DP_IPFIX_IE_DESTINATION_IPV4_ADDRESS, 4);
+static const struct dp_ipfix_field template_fields_ipv6[] =
+	DP_IPFIX_TEMPLATE_FIELDS(DP_IPFIX_IE_SOURCE_IPV6_ADDRESS, DP_IPFIX_IE_DESTINATION_IPV6_ADDRESS, 16);
+
+#define DP_IPFIX_MSG_HEADER_SIZE	16
+#define DP_IPFIX_SET_HEADER_SIZE	4
+
+struct dp_ipfix_msg {
+	uint8_t		data[DP_IPFIX_MAX_MSG_SIZE];
+	uint16_t	len;
+	uint16_t	set_start;		// offset of the currently open data set (0 = none)
+	uint16_t	set_template;	// template of the currently open data set
+	uint32_t	nb_records;
+	uint64_t	first_record_ms;
+};
+
+static bool ipfix_enabled = false;
+static struct rte_ring *ipfix_ring = NULL;
+static struct dp_ipfix_stats ipfix_stats = {0};
+
+// exporter thread state
+static rte_thread_t ipfix_thread_id;
+static bool ipfix_thread_started = false;
+static volatile bool ipfix_thread_running = false;
+static int ipfix_socket = -1;
+static FILE *ipfix_file = NULL;
+static struct dp_ipfix_msg ipfix_msg;
+static uint32_t ipfix_sequence = 0;
+static time_t ipfix_template_sent = 0;
+
+// wall-clock reference for converting TSC timestamps
+static uint64_t ipfix_base_tsc;
+static uint64_t ipfix_base_ms;
+static uint64_t ipfix_tsc_hz;
+
+
+bool dp_ipfix_is_enabled(void)
+{
+	return ipfix_enabled;
+}
+
+static uint64_t dp_ipfix_get_wallclock_ms(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+static uint64_t dp_ipfix_tsc_to_ms(uint64_t tsc)
+{
+	uint64_t delta = tsc - ipfix_base_tsc;
+
+	// split to prevent overflow of (delta * 1000) for long-running processes
+	return ipfix_base_ms + delta / ipfix_tsc_hz * 1000 + (delta % ipfix_tsc_hz) * 1000 / ipfix_tsc_hz;
+}
+
+//
+// Worker side
+//
+void dp_ipfix_export_flow(const struct flow_value *cntrack)
+{
+	struct dp_ipfix_record record;
+	bool offloaded = cntrack->offload_state.orig == DP_FLOW_OFFLOADED
+					 || cntrack->offload_state.reply == DP_FLOW_OFFLOADED;
+
+	record.orig = cntrack->flow_key[DP_FLOW_DIR_ORG];
+	record.reply = cntrack->flow_key[DP_FLOW_DIR_REPLY];
+	record.start_tsc = cntrack->created;
+	// offloaded packets do not update the timestamp, the flow has been active until now
+	record.end_tsc = offloaded ? rte_rdtsc() : cntrack->timestamp;
+	for (int i = 0; i < DP_FLOW_DIR_CAPACITY; ++i) {
+		record.packets[i] = cntrack->counters[i].packets;
+		record.bytes[i] = cntrack->counters[i].bytes;
+	}
+	record.port_id = cntrack->created_port_id;
+	record.end_reason = cntrack->end_reason == DP_FLOW_END_NONE ? DP_FLOW_END_FORCED : cntrack->end_reason;
+
+	if (unlikely(rte_ring_sp_enqueue_elem(ipfix_ring, &record, sizeof(record)) != 0)) {
+		// cannot block the worker, the record is lost
+		ipfix_stats.ring_full++;
+		return;
+	}
+	ipfix_stats.queued++;
+}
+
+//
+// Message encoding
+//
+static __rte_always_inline void dp_ipfix_put_u8(struct dp_ipfix_msg *msg, uint8_t value)
+{
+	msg->data[msg->len++] = value;
+}
+
+static __rte_always_inline void dp_ipfix_put_u16(struct dp_ipfix_msg *msg, uint16_t value)
+{
+	rte_be16_t be = rte_cpu_to_be_16(value);
+
+	memcpy(&msg->data[msg->len], &be, sizeof(be));
+	msg->len += sizeof(be);
+}
+
+static __rte_always_inline void dp_ipfix_put_u32(struct dp_ipfix_msg *msg, uint32_t value)
+{
+	rte_be32_t be = rte_cpu_to_be_32(value);
+
+	memcpy(&msg->data[msg->len], &be, sizeof(be));
+	msg->len += sizeof(be);
+}
+
+static __rte_always_inline void dp_ipfix_put_u64(struct dp_ipfix_msg *msg, uint64_t value)
+{
+	rte_be64_t be = rte_cpu_to_be_64(value);
+
+	memcpy(&msg->data[msg->len], &be, sizeof(be));
+	msg->len += sizeof(be);
+}
+
+static __rte_always_inline void dp_ipfix_put_addr(struct dp_ipfix_msg *msg, const struct dp_ip_address *addr)
+{
+	if (addr->is_v6) {
+		memcpy(&msg->data[msg->len], addr->ipv6, DP_IPV6_ADDR_SIZE);
+		msg->len += DP_IPV6_ADDR_SIZE;
+	} else
+		dp_ipfix_put_u32(msg, addr->ipv4);  // flow keys use host byte order
+}
+
+static __rte_always_inline void dp_ipfix_set_u16(struct dp_ipfix_msg *msg, uint16_t offset, uint16_t value)
+{
+	rte_be16_t be = rte_cpu_to_be_16(value);
+
+	memcpy(&msg->data[offset], &be, sizeof(be));
+}
+
+static uint16_t dp_ipfix_get_record_size(const struct dp_ipfix_field *fields, size_t nb_fields)
+{
+	uint16_t size = 0;
+
+	for (size_t i = 0; i < nb_fields; ++i)
+		size += fields[i].length;
+	return size;
+}
+
+static void dp_ipfix_put_template(struct dp_ipfix_msg *msg, uint16_t template_id,
+								  const struct dp_ipfix_field *fields, size_t nb_fields)
+{
+	dp_ipfix_put_u16(msg, template_id);
+	dp_ipfix_put_u16(msg, (uint16_t)nb_fields);
+	for (size_t i = 0; i < nb_fields; ++i) {
+		dp_ipfix_put_u16(msg, fields[i].id);
+		dp_ipfix_put_u16(msg, fields[i].length);
+	}
+}
+
+static void dp_ipfix_msg_init(struct dp_ipfix_msg *msg, bool with_templates)
+{
+	uint16_t set_start;
+
+	msg->len = DP_IPFIX_MSG_HEADER_SIZE;  // filled in when sending
+	msg->set_start = 0;
+	msg->nb_records = 0;
+
+	if (!with_templates)
+		return;
+
+	set_start = msg->len;
+	dp_ipfix_put_u16(msg, DP_IPFIX_TEMPLATE_SET_ID);
+	dp_ipfix_put_u16(msg, 0);
+	dp_ipfix_put_template(msg, DP_IPFIX_TEMPLATE_ID_IPV4, template_fields_ipv4, RTE_DIM(template_fields_ipv4));
+	dp_ipfix_put_template(msg, DP_IPFIX_TEMPLATE_ID_IPV6, template_fields_ipv6, RTE_DIM(template_fields_ipv6));
+	dp_ipfix_set_u16(msg, set_start + 2, msg->len - set_start);
+}
+
+static void dp_ipfix_close_set(struct dp_ipfix_msg *msg)
+{
+	if (!msg->set_start)
+		return;
+	dp_ipfix_set_u16(msg, msg->set_start + 2, msg->len - msg->set_start);
+	msg->set_start = 0;
+}
+
+static void dp_ipfix_put_record(struct dp_ipfix_msg *msg, const struct dp_ipfix_record *record)
+{
+	const struct flow_key *orig = &record->orig;
+	const struct flow_key *reply = &record->reply;
+
+	dp_ipfix_put_addr(msg, &orig->l3_src);
+	dp_ipfix_put_addr(msg, &orig->l3_dst);
+	dp_ipfix_put_u16(msg, orig->src.port_src);
+	dp_ipfix_put_u16(msg, orig->port_dst);
+	dp_ipfix_put_u8(msg, orig->proto);
+	// translated addresses come from the reply direction, all NAT variants end up in IPv4
+	if (!reply->l3_dst.is_v6) {
+		dp_ipfix_put_u32(msg, reply->l3_dst.ipv4);
+		dp_ipfix_put_u32(msg, reply->l3_src.ipv4);
+		dp_ipfix_put_u16(msg, reply->port_dst);
+		dp_ipfix_put_u16(msg, reply->src.port_src);
+	} else {
+		dp_ipfix_put_u32(msg, 0);
+		dp_ipfix_put_u32(msg, 0);
+		dp_ipfix_put_u16(msg, 0);
+		dp_ipfix_put_u16(msg, 0);
+	}
+	dp_ipfix_put_u64(msg, orig->vni);
+	dp_ipfix_put_u32(msg, record->port_id);
+	dp_ipfix_put_u64(msg, record->packets[DP_FLOW_DIR_ORG]);
+	dp_ipfix_put_u64(msg, record->bytes[DP_FLOW_DIR_ORG]);
+	dp_ipfix_put_u64(msg, record->packets[DP_FLOW_DIR_REPLY]);
+	dp_ipfix_put_u64(msg, record->bytes[DP_FLOW_DIR_REPLY]);
+	dp_ipfix_put_u64(msg, dp_ipfix_tsc_to_ms(record->start_tsc));
+	dp_ipfix_put_u64(msg, dp_ipfix_tsc_to_ms(record->end_tsc));
+	dp_ipfix_put_u8(msg, record->end_reason);
+}
+
+//
+// Exporter thread
+//
+static void dp_ipfix_send(struct dp_ipfix_msg *msg)
+{
+	const struct dp_conf_ipfix_collector *collector = dp_conf_get_ipfix_collector();
+	uint16_t len;
+
+	if (!msg->nb_records)
+		return;
+
+	dp_ipfix_close_set(msg);
+
+	len = msg->len;
+	msg->len = 0;
+	dp_ipfix_put_u16(msg, DP_IPFIX_VERSION);
+	dp_ipfix_put_u16(msg, len);
+	dp_ipfix_put_u32(msg, (uint32_t)time(NULL));
+	dp_ipfix_put_u32(msg, ipfix_sequence);
+	dp_ipfix_put_u32(msg, DP_IPFIX_OBSERVATION_DOMAIN);
+	msg->len = len;
+
+	if (ipfix_socket >= 0
+		&& sendto(ipfix_socket, msg->data, len, 0, (const struct sockaddr *)&collector->addr, collector->addrlen) < 0
+	) {
+		DPS_LOG_WARNING("Failed to send IPFIX message", DP_LOG_RET(errno));
+		ipfix_stats.errors++;
+	}
+
+	if (ipfix_file && (fwrite(msg->data, len, 1, ipfix_file) != 1 || fflush(ipfix_file))) {
+		DPS_LOG_WARNING("Failed to write IPFIX message", DP_LOG_RET(errno));
+		ipfix_stats.errors++;
+	}
+
+	ipfix_sequence += msg->nb_records;
+	ipfix_stats.exported += msg->nb_records;
+	ipfix_stats.messages++;
+
+	dp_ipfix_msg_init(msg, false);
+}
+
+static void dp_ipfix_add_record(struct dp_ipfix_msg *msg, const struct dp_ipfix_record *record)
+{
+	uint16_t template_id;
+	uint16_t record_size;
+	uint16_t needed;
+	time_t now;
+
+	if (record->orig.l3_src.is_v6) {
+		template_id = DP_IPFIX_TEMPLATE_ID_IPV6;
+		record_size = dp_ipfix_get_record_size(template_fields_ipv6, RTE_DIM(template_fields_ipv6));
+	} else {
+		template_id = DP_IPFIX_TEMPLATE_ID_IPV4;
+		record_size = dp_ipfix_get_record_size(template_fields_ipv4, RTE_DIM(template_fields_ipv4));
+	}
+
+	needed = record_size;
+	if (!msg->set_start || msg->set_template != template_id)
+		needed += DP_IPFIX_SET_HEADER_SIZE;
+	if (msg->len + needed > DP_IPFIX_MAX_MSG_SIZE)
+		dp_ipfix_send(msg);
+
+	// the first message and then periodically carry templates
+	if (!msg->nb_records) {
+		now = time(NULL);
+		if (now - ipfix_template_sent >= DP_IPFIX_TEMPLATE_INTERVAL_S) {
+			dp_ipfix_msg_init(msg, true);
+			ipfix_template_sent = now;
+		}
+		msg->first_record_ms = dp_ipfix_get_wallclock_ms();
+	}
+
+	if (!msg->set_start || msg->set_template != template_id) {
+		dp_ipfix_close_set(msg);
+		msg->set_start = msg->len;
+		msg->set_template = template_id;
+		dp_ipfix_put_u16(msg, template_id);
+		dp_ipfix_put_u16(msg, 0);
+	}
+
+	dp_ipfix_put_record(msg, record);
+	msg->nb_records++;
+}
+
+static void dp_ipfix_drain_ring(void)
+{
+	struct dp_ipfix_record records[32];
+	unsigned int count;
+
+	do {
+		count = rte_ring_sc_dequeue_burst_elem(ipfix_ring, records, sizeof(records[0]), RTE_DIM(records), NULL);
+		for (unsigned int i = 0; i < count; ++i)
+			dp_ipfix_add_record(&ipfix_msg, &records[i]);
+	} while (count);
+}
+
+static uint32_t dp_ipfix_main_loop(__rte_unused void *arg)
+{
+	dp_log_set_thread_name("ipfix");
+
+	dp_ipfix_msg_init(&ipfix_msg, false);
+
+	while (ipfix_thread_running) {
+		dp_ipfix_drain_ring();
+		if (ipfix_msg.nb_records
+			&& dp_ipfix_get_wallclock_ms() - ipfix_msg.first_record_ms >= DP_IPFIX_FLUSH_INTERVAL_MS)
+			dp_ipfix_send(&ipfix_msg);
+		usleep(DP_IPFIX_IDLE_SLEEP_US);
+	}
+
+	// the worker is already stopped, export everything that is left
+	dp_ipfix_drain_ring();
+	dp_ipfix_send(&ipfix_msg);
+	return 0;
+}
+
+static int dp_ipfix_open_outputs(void)
+{
+	const struct dp_conf_ipfix_collector *collector = dp_conf_get_ipfix_collector();
+	const char *filename = dp_conf_get_ipfix_file();
+
+	if (collector->addrlen) {
+		ipfix_socket = socket(collector->addr.ss_family, SOCK_DGRAM, 0);
+		if (ipfix_socket < 0) {
+			DPS_LOG_ERR("Cannot create IPFIX socket", DP_LOG_RET(errno));
+			return DP_ERROR;
+		}
+	}
+
+	if (*filename) {
+		ipfix_file = fopen(filename, "ab");
+		if (!ipfix_file) {
+			DPS_LOG_ERR("Cannot open IPFIX file", DP_LOG_NAME(filename), DP_LOG_RET(errno));
+			return DP_ERROR;
+		}
+	}
+
+	return DP_OK;
+}
+
+static void dp_ipfix_close_outputs(void)
+{
+	if (ipfix_socket >= 0) {
+		close(ipfix_socket);
+		ipfix_socket = -1;
+	}
+	if (ipfix_file) {
+		fclose(ipfix_file);
+		ipfix_file = NULL;
+	}
+}
+
+int dp_ipfix_init(int socket_id)
+{
+	int ret;
+
+	static_assert(sizeof(struct dp_ipfix_record) % 4 == 0, "IPFIX record cannot be used as a ring element");
+
+	if (!dp_conf_get_ipfix_collector()->addrlen && !*dp_conf_get_ipfix_file())
+		return DP_OK;
+
+	ipfix_tsc_hz = rte_get_tsc_hz();
+	ipfix_base_tsc = rte_rdtsc();
+	ipfix_base_ms = dp_ipfix_get_wallclock_ms();
+
+	ipfix_ring = rte_ring_create_elem("ipfix_ring", sizeof(struct dp_ipfix_record), DP_IPFIX_RING_SIZE,
+									  socket_id, RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (!ipfix_ring) {
+		DPS_LOG_ERR("Cannot create IPFIX ring", DP_LOG_RET(rte_errno));
+		return DP_ERROR;
+	}
+	dp_numa_register("ipfix_ring", ipfix_ring, socket_id);
+
+	if (DP_FAILED(dp_ipfix_open_outputs()))
+		return DP_ERROR;
+
+	ipfix_thread_running = true;
+	ret = rte_thread_create_control(&ipfix_thread_id, "ipfix-thread", dp_ipfix_main_loop, NULL);
+	if (DP_FAILED(ret)) {
+		DPS_LOG_ERR("Cannot create IPFIX thread", DP_LOG_RET(ret));
+		ipfix_thread_running = false;
+		return ret;
+	}
+	ipfix_thread_started = true;
+
+	ipfix_enabled = true;
+	return DP_OK;
+}
+
+void dp_ipfix_free(void)
+{
+	ipfix_enabled = false;
+	if (ipfix_thread_started) {
+		ipfix_thread_running = false;
+		rte_thread_join(ipfix_thread_id, NULL);
+		ipfix_thread_started = false;
+	}
+	dp_ipfix_close_outputs();
+	dp_numa_unregister(ipfix_ring);
+	rte_ring_free(ipfix_ring);
+	ipfix_ring = NULL;
+}
+
+int dp_ipfix_get_stats_telemetry(struct rte_tel_data *dict)
+{
+	int ret;
+
+	ret = rte_tel_data_add_dict_u64(dict, "queued", ipfix_stats.queued);
+	if (DP_FAILED(ret))
+		goto error;
+
+	ret = rte_tel_data_add_dict_u64(dict, "ring_full", ipfix_stats.ring_full);
+	if (DP_FAILED(ret))
+		goto error;
+
+	ret = rte_tel_data_add_dict_u64(dict, "exported", ipfix_stats.exported);
+	if (DP_FAILED(ret))
+		goto error;
+
+	ret = rte_tel_data_add_dict_u64(dict, "messages", ipfix_stats.messages);
+	if (DP_FAILED(ret))
+		goto error;
+
+	ret = rte_tel_data_add_dict_u64(dict, "errors", ipfix_stats.errors);
+	if (DP_FAILED(ret))
+		goto error;
+
+	return DP_OK;
+
+error:
+	DPS_LOG_ERR("Failed to add IPFIX telemetry data", DP_LOG_RET(ret));
+	return ret;
+}
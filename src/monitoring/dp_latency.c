@@ -0,0 +1,203 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "monitoring/dp_latency.h"
+#include <rte_graph_worker.h>
+#include <rte_malloc.h>
+#include "dp_conf.h"
+#include "dp_error.h"
+#include "dp_log.h"
+
+struct dp_latency_node {
+	const char *name;
+	uint64_t prev_cycles;
+	uint64_t prev_calls;
+	struct dp_latency_hist hist;
+};
+
+bool _dp_latency_enabled = false;
+struct dp_latency_hist _dp_latency_handlers[DP_LATENCY_HANDLER_COUNT];
+
+static const char *handler_names[DP_LATENCY_HANDLER_COUNT] = {
+	[DP_LATENCY_HANDLER_GRPC_REQUEST] = "grpc_request",
+	[DP_LATENCY_HANDLER_AGED_FLOWS] = "aged_flows",
+	[DP_LATENCY_HANDLER_AGED_FLOWS_NON_OFFLOAD] = "aged_flows_non_offload",
+	[DP_LATENCY_HANDLER_OFFLOAD] = "offload",
+};
+
+static const struct {
+	const char *name;
+	uint64_t permille;
+} percentiles[] = {
+	{ "p50", 500 },
+	{ "p90", 900 },
+	{ "p99", 990 },
+	{ "p999", 999 },
+};
+
+static struct dp_latency_hist walk_hist;
+static struct dp_latency_node *nodes = NULL;
+static uint32_t nb_nodes = 0;
+
+int dp_latency_init(struct rte_graph *graph)
+{
+	if (!dp_conf_get_latency_sampling())
+		return DP_OK;
+
+	// per-node cycles are only available with graph statistics, the whole walk can still be measured
+	if (!rte_graph_has_stats_feature()) {
+		DPS_LOG_WARNING("Graph statistics are not available, per-node latency will not be measured");
+	} else {
+		nodes = rte_zmalloc("latency_nodes", sizeof(*nodes) * graph->nb_nodes, RTE_CACHE_LINE_SIZE);
+		if (!nodes) {
+			DPS_LOG_ERR("Cannot allocate latency node histograms", DP_LOG_VALUE(graph->nb_nodes));
+			return DP_ERROR;
+		}
+		nb_nodes = graph->nb_nodes;
+	}
+
+	_dp_latency_enabled = true;
+	return DP_OK;
+}
+
+void dp_latency_free(void)
+{
+	_dp_latency_enabled = false;
+	rte_free(nodes);
+	nodes = NULL;
+	nb_nodes = 0;
+}
+
+static __rte_always_inline void dp_latency_snapshot_nodes(struct rte_graph *graph)
+{
+	struct rte_node *node;
+	rte_graph_off_t off;
+	rte_node_t count;
+
+	rte_graph_foreach_node(count, off, graph, node) {
+		nodes[count].prev_cycles = node->total_cycles;
+		nodes[count].prev_calls = node->total_calls;
+	}
+}
+
+static __rte_always_inline void dp_latency_update_nodes(struct rte_graph *graph)
+{
+	struct dp_latency_node *latency_node;
+	struct rte_node *node;
+	rte_graph_off_t off;
+	rte_node_t count;
+
+	rte_graph_foreach_node(count, off, graph, node) {
+		latency_node = &nodes[count];
+		// only nodes that actually processed something during this walk
+		if (node->total_calls == latency_node->prev_calls)
+			continue;
+		latency_node->name = node->name;
+		dp_latency_hist_add(&latency_node->hist, node->total_cycles - latency_node->prev_cycles);
+	}
+}
+
+void dp_latency_walk_sampled(struct rte_graph *graph)
+{
+	uint64_t start;
+
+	if (nodes)
+		dp_latency_snapshot_nodes(graph);
+
+	start = rte_rdtsc();
+	rte_graph_walk(graph);
+	dp_latency_hist_add(&walk_hist, rte_rdtsc() - start);
+
+	if (nodes)
+		dp_latency_update_nodes(graph);
+}
+
+
+static uint64_t dp_latency_get_percentile(const struct dp_latency_hist *hist, uint64_t permille)
+{
+	uint64_t threshold = (hist->count * permille + 999) / 1000;
+	uint64_t sum = 0;
+
+	for (unsigned int i = 0; i < DP_LATENCY_BUCKETS; ++i) {
+		sum += hist->buckets[i];
+		if (sum >= threshold) {
+			// report the upper bound of the bucket, but never above the real maximum
+			if (i == 0)
+				return 0;
+			return i >= 64 ? hist->max : RTE_MIN((UINT64_C(1) << i) - 1, hist->max);
+		}
+	}
+	return hist->max;
+}
+
+static int dp_latency_add_hist_telemetry(struct rte_tel_data *dict, const char *name, const struct dp_latency_hist *hist)
+{
+	struct rte_tel_data *values;
+	int ret;
+
+	values = rte_tel_data_alloc();
+	if (!values) {
+		DPS_LOG_ERR("Failed to allocate latency telemetry data", DP_LOG_NAME(name));
+		return DP_ERROR;
+	}
+
+	ret = rte_tel_data_start_dict(values);
+	if (DP_FAILED(ret))
+		goto error;
+
+	ret = rte_tel_data_add_dict_u64(values, "count", hist->count);
+	if (DP_FAILED(ret))
+		goto error;
+
+	ret = rte_tel_data_add_dict_u64(values, "max", hist->max);
+	if (DP_FAILED(ret))
+		goto error;
+
+	for (unsigned int i = 0; i < RTE_DIM(percentiles); ++i) {
+		ret = rte_tel_data_add_dict_u64(values, percentiles[i].name, dp_latency_get_percentile(hist, percentiles[i].permille));
+		if (DP_FAILED(ret))
+			goto error;
+	}
+
+	ret = rte_tel_data_add_dict_container(dict, name, values, 0);
+	if (DP_FAILED(ret))
+		goto error;
+
+	return DP_OK;
+
+error:
+	DPS_LOG_ERR("Failed to add latency telemetry data", DP_LOG_NAME(name), DP_LOG_RET(ret));
+	rte_tel_data_free(values);
+	return ret;
+}
+
+int dp_latency_get_graph_telemetry(struct rte_tel_data *dict)
+{
+	if (!_dp_latency_enabled)
+		return DP_OK;
+
+	if (DP_FAILED(dp_latency_add_hist_telemetry(dict, "graph_walk", &walk_hist)))
+		return DP_ERROR;
+
+	for (uint32_t i = 0; i < nb_nodes; ++i) {
+		// nodes are named once they are first sampled
+		if (!nodes[i].name)
+			continue;
+		if (DP_FAILED(dp_latency_add_hist_telemetry(dict, nodes[i].name, &nodes[i].hist)))
+			return DP_ERROR;
+	}
+
+	return DP_OK;
+}
+
+int dp_latency_get_handlers_telemetry(struct rte_tel_data *dict)
+{
+	if (!_dp_latency_enabled)
+		return DP_OK;
+
+	for (unsigned int i = 0; i < RTE_DIM(_dp_latency_handlers); ++i)
+		if (DP_FAILED(dp_latency_add_hist_telemetry(dict, handler_names[i], &_dp_latency_handlers[i])))
+			return DP_ERROR;
+
+	return DP_OK;
+}
@@ -68,7 +68,7 @@ static __rte_always_inline bool arp_handled(struct rte_mbuf *m)
 static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_node *node, struct rte_mbuf *m)
 {
 	if (!arp_handled(m))
-		return ARP_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_IGNORED, ARP_NEXT_DROP);
 
 	return next_tx_index[m->port];
 }
@@ -6,6 +6,7 @@
 #include <rte_graph.h>
 #include <rte_arp.h>
 #include <rte_graph_worker.h>
+#include <rte_ip_frag.h>
 #include <rte_mbuf.h>
 #include "dp_error.h"
 #include "dp_mbuf_dyn.h"
@@ -16,8 +17,8 @@
 #ifdef ENABLE_VIRTSVC
 #	include "dp_virtsvc.h"
 	static bool virtsvc_present = false;
-	static const struct dp_virtsvc_lookup_entry *virtsvc_ipv4_tree;
-	static const struct dp_virtsvc_lookup_entry *virtsvc_ipv6_tree;
+	static const struct rte_hash *virtsvc_ipv4_table;
+	static const struct rte_hash *virtsvc_ipv6_table;
 #	define VIRTSVC_NEXT(NEXT) NEXT(CLS_NEXT_VIRTSVC, "virtsvc")
 #else
 #	define VIRTSVC_NEXT(NEXT)
@@ -28,20 +29,74 @@
 	NEXT(CLS_NEXT_IPV6_ND, "ipv6_nd") \
 	NEXT(CLS_NEXT_CONNTRACK, "conntrack") \
 	NEXT(CLS_NEXT_IPIP_DECAP, "ipip_decap") \
+	NEXT(CLS_NEXT_REASSEMBLY, "reassembly") \
 	VIRTSVC_NEXT(NEXT)
 
-#ifdef ENABLE_VIRTSVC
 DP_NODE_REGISTER(CLS, cls, NEXT_NODES);
+
+// Packets are classified using lookup tables, first by the packet type as parsed by the NIC,
+// then (for IPv6) by the next header and port type; only packets that need a closer look
+// (control protocols, virtual services) go through the exception path
+enum cls_l3_class {
+	CLS_L3_UNSUPPORTED = 0,
+	CLS_L3_NONE,
+	CLS_L3_IPV4,
+	CLS_L3_IPV6,
+};
+
+enum cls_ipv6_class {
+	CLS_IPV6_CONNTRACK = 0,
+	CLS_IPV6_REASSEMBLY,
+	CLS_IPV6_DECAP_IPV4,
+	CLS_IPV6_DECAP_IPV6,
+	CLS_IPV6_EXCEPTION,
+};
+
+static uint8_t l3_class_table[(RTE_PTYPE_L2_MASK | RTE_PTYPE_L3_MASK) + 1];
+// indexed by [is_pf][next header]
+static uint8_t ipv6_class_table[2][UINT8_MAX + 1];
+
 static int cls_node_init(__rte_unused const struct rte_graph *graph, __rte_unused struct rte_node *node)
 {
+	uint32_t l3_type;
+	bool virtsvc_lookup = false;
+
+#ifdef ENABLE_VIRTSVC
 	virtsvc_present = dp_virtsvc_get_count() > 0;
-	virtsvc_ipv4_tree = dp_virtsvc_get_ipv4_tree();
-	virtsvc_ipv6_tree = dp_virtsvc_get_ipv6_tree();
+	virtsvc_ipv4_table = dp_virtsvc_get_ipv4_table();
+	virtsvc_ipv6_table = dp_virtsvc_get_ipv6_table();
+	virtsvc_lookup = virtsvc_present;
+#endif
+
+	for (uint32_t ptype = 0; ptype < RTE_DIM(l3_class_table); ++ptype) {
+		l3_type = ptype & RTE_PTYPE_L3_MASK;
+		if ((ptype & RTE_PTYPE_L2_MASK) != RTE_PTYPE_L2_ETHER)
+			l3_class_table[ptype] = CLS_L3_UNSUPPORTED;
+		else if (l3_type == 0)
+			l3_class_table[ptype] = CLS_L3_NONE;
+		else if (RTE_ETH_IS_IPV4_HDR(l3_type))
+			l3_class_table[ptype] = CLS_L3_IPV4;
+		else if (RTE_ETH_IS_IPV6_HDR(l3_type))
+			l3_class_table[ptype] = CLS_L3_IPV6;
+		else
+			l3_class_table[ptype] = CLS_L3_UNSUPPORTED;
+	}
+
+	// VFs: neighbor discovery needs to be checked, fragments are reassembled first
+	memset(ipv6_class_table, CLS_IPV6_CONNTRACK, sizeof(ipv6_class_table));
+	ipv6_class_table[false][IPPROTO_ICMPV6] = CLS_IPV6_EXCEPTION;
+	ipv6_class_table[false][IPPROTO_FRAGMENT] = CLS_IPV6_REASSEMBLY;
+	// PFs: neighbor discovery is not allowed, tunneled packets are decapsulated, virtual services are looked up
+	ipv6_class_table[true][IPPROTO_ICMPV6] = CLS_IPV6_EXCEPTION;
+	ipv6_class_table[true][IPPROTO_IPIP] = CLS_IPV6_DECAP_IPV4;
+	ipv6_class_table[true][IPPROTO_IPV6] = CLS_IPV6_DECAP_IPV6;
+	if (virtsvc_lookup) {
+		ipv6_class_table[true][IPPROTO_TCP] = CLS_IPV6_EXCEPTION;
+		ipv6_class_table[true][IPPROTO_UDP] = CLS_IPV6_EXCEPTION;
+	}
+
 	return DP_OK;
 }
-#else
-DP_NODE_REGISTER_NOINIT(CLS, cls, NEXT_NODES);
-#endif
 
 static __rte_always_inline int is_arp(const struct rte_ether_hdr *ether_hdr)
 {
@@ -71,8 +126,6 @@ static __rte_always_inline struct dp_virtsvc *get_outgoing_virtsvc(const struct
 	rte_be32_t addr = ipv4_hdr->dst_addr;
 	uint8_t proto = ipv4_hdr->next_proto_id;
 	rte_be16_t port;
-	const struct dp_virtsvc_lookup_entry *entry;
-	int diff;
 
 	if (proto == IPPROTO_TCP)
 		port = ((const struct rte_tcp_hdr *)(ipv4_hdr + 1))->dst_port;
@@ -81,15 +134,7 @@ static __rte_always_inline struct dp_virtsvc *get_outgoing_virtsvc(const struct
 	else
 		return NULL;
 
-	entry = virtsvc_ipv4_tree;
-	while (entry) {
-		diff = dp_virtsvc_ipv4_cmp(proto, addr, port,
-								   entry->virtsvc->proto, entry->virtsvc->virtual_addr, entry->virtsvc->virtual_port);
-		if (!diff)
-			return entry->virtsvc;
-		entry = diff < 0 ? entry->left : entry->right;
-	}
-	return NULL;
+	return dp_virtsvc_ipv4_lookup(virtsvc_ipv4_table, proto, addr, port);
 }
 
 static __rte_always_inline struct dp_virtsvc *get_incoming_virtsvc(const struct rte_ipv6_hdr *ipv6_hdr)
@@ -97,8 +142,6 @@ static __rte_always_inline struct dp_virtsvc *get_incoming_virtsvc(const struct
 	const uint8_t *addr = ipv6_hdr->src_addr;
 	uint8_t proto = ipv6_hdr->proto;
 	rte_be16_t port;
-	const struct dp_virtsvc_lookup_entry *entry;
-	int diff;
 
 	if (proto == IPPROTO_TCP)
 		port = ((const struct rte_tcp_hdr *)(ipv6_hdr + 1))->src_port;
@@ -107,40 +150,114 @@ static __rte_always_inline struct dp_virtsvc *get_incoming_virtsvc(const struct
 	else
 		return NULL;
 
-	entry = virtsvc_ipv6_tree;
-	while (entry) {
-		diff = dp_virtsvc_ipv6_cmp(proto, addr, port,
-								   entry->virtsvc->proto, entry->virtsvc->service_addr, entry->virtsvc->service_port);
-		if (!diff)
-			return entry->virtsvc;
-		entry = diff < 0 ? entry->left : entry->right;
+	return dp_virtsvc_ipv6_lookup(virtsvc_ipv6_table, proto, addr, port);
+}
+#endif
+
+static __rte_noinline rte_edge_t get_ipv6_exception_next_index(struct rte_mbuf *m, struct dp_flow *df,
+																const struct dp_port *port,
+																const struct rte_ipv6_hdr *ipv6_hdr)
+{
+#ifdef ENABLE_VIRTSVC
+	struct dp_virtsvc *virtsvc;
+#endif
+
+	if (is_ipv6_nd(ipv6_hdr)) {
+		if (port->is_pf)
+			return dp_node_drop(m, DP_DROP_REASON_NOT_ALLOWED, CLS_NEXT_DROP);
+		return CLS_NEXT_IPV6_ND;
+	}
+
+#ifdef ENABLE_VIRTSVC
+	if (port->is_pf && virtsvc_present) {
+		virtsvc = get_incoming_virtsvc(ipv6_hdr);
+		if (virtsvc) {
+			df->virtsvc = virtsvc;
+			return CLS_NEXT_VIRTSVC;
+		}
+	}
+#endif
+
+	df->l3_type = RTE_ETHER_TYPE_IPV6;
+	return CLS_NEXT_CONNTRACK;
+}
+
+static __rte_always_inline rte_edge_t get_ipv6_next_index(struct rte_mbuf *m, struct dp_flow *df,
+														  const struct dp_port *port,
+														  const struct rte_ether_hdr *ether_hdr)
+{
+	const struct rte_ipv6_hdr *ipv6_hdr = (const struct rte_ipv6_hdr *)(ether_hdr + 1);
+
+	switch ((enum cls_ipv6_class)ipv6_class_table[port->is_pf][ipv6_hdr->proto]) {
+	case CLS_IPV6_CONNTRACK:
+		df->l3_type = RTE_ETHER_TYPE_IPV6;
+		return CLS_NEXT_CONNTRACK;
+	case CLS_IPV6_REASSEMBLY:
+		df->l3_type = RTE_ETHER_TYPE_IPV6;
+		return CLS_NEXT_REASSEMBLY;
+	case CLS_IPV6_DECAP_IPV4:
+		df->l3_type = RTE_ETHER_TYPE_IPV4;
+		break;
+	case CLS_IPV6_DECAP_IPV6:
+		df->l3_type = RTE_ETHER_TYPE_IPV6;
+		break;
+	case CLS_IPV6_EXCEPTION:
+		return get_ipv6_exception_next_index(m, df, port, ipv6_hdr);
 	}
-	return NULL;
+
+	df->tun_info.l3_type = RTE_ETHER_TYPE_IPV6;
+	dp_extract_underlay_header(df, ipv6_hdr);
+	return CLS_NEXT_IPIP_DECAP;
 }
+
+static __rte_always_inline rte_edge_t get_ipv4_next_index(struct rte_mbuf *m, struct dp_flow *df,
+														  const struct dp_port *port,
+														  const struct rte_ether_hdr *ether_hdr)
+{
+#ifdef ENABLE_VIRTSVC
+	struct dp_virtsvc *virtsvc;
+#endif
+
+	if (port->is_pf)
+		return dp_node_drop(m, DP_DROP_REASON_NOT_ALLOWED, CLS_NEXT_DROP);
+
+	df->l3_type = RTE_ETHER_TYPE_IPV4;
+
+	// fragments are reassembled first, virtual services do not support them
+	if (unlikely(rte_ipv4_frag_pkt_is_fragmented((const struct rte_ipv4_hdr *)(ether_hdr + 1))))
+		return CLS_NEXT_REASSEMBLY;
+
+#ifdef ENABLE_VIRTSVC
+	if (virtsvc_present) {
+		virtsvc = get_outgoing_virtsvc(ether_hdr);
+		if (virtsvc) {
+			df->virtsvc = virtsvc;
+			return CLS_NEXT_VIRTSVC;
+		}
+	}
 #endif
 
+	df->l3_payload_length = rte_pktmbuf_pkt_len(m) - (uint32_t)sizeof(struct rte_ether_hdr);
+	return CLS_NEXT_CONNTRACK;
+}
+
 static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_node *node, struct rte_mbuf *m)
 {
-	const struct rte_ether_hdr *ether_hdr;
-	const struct rte_ipv6_hdr *ipv6_hdr;
-	uint32_t l3_type;
+	const struct rte_ether_hdr *ether_hdr = rte_pktmbuf_mtod(m, const struct rte_ether_hdr *);
+	enum cls_l3_class l3_class;
 	struct dp_flow *df;
 	struct dp_port *port;
-#ifdef ENABLE_VIRTSVC
-	struct dp_virtsvc *virtsvc;
-#endif
 
-	if (unlikely((m->packet_type & RTE_PTYPE_L2_MASK) != RTE_PTYPE_L2_ETHER))
-		return CLS_NEXT_DROP;
+	l3_class = (enum cls_l3_class)l3_class_table[m->packet_type & (RTE_PTYPE_L2_MASK | RTE_PTYPE_L3_MASK)];
 
-	l3_type = m->packet_type & RTE_PTYPE_L3_MASK;
-	ether_hdr = rte_pktmbuf_mtod(m, struct rte_ether_hdr *);
+	if (unlikely(l3_class == CLS_L3_UNSUPPORTED))
+		return dp_node_drop(m, DP_DROP_REASON_UNSUPPORTED_PROTOCOL, CLS_NEXT_DROP);
 
-	if (unlikely(l3_type == 0)) {
+	if (unlikely(l3_class == CLS_L3_NONE)) {
 		// Manual test, because Mellanox PMD drivers do not set detailed L2 packet_type in mbuf
 		if (is_arp(ether_hdr))
 			return CLS_NEXT_ARP;
-		return CLS_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_UNSUPPORTED_PROTOCOL, CLS_NEXT_DROP);
 	}
 
 	// L3-aware nodes need dp_flow structure (call cannot fail)
@@ -149,62 +266,12 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 	// this is validating the port-id for all subsequent uses of dp_get_port(m)
 	port = dp_get_port_by_id(m->port);
 	if (unlikely(!port))
-		return CLS_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_INVALID_PORT, CLS_NEXT_DROP);
 
-	if (RTE_ETH_IS_IPV4_HDR(l3_type)) {
-		if (port->is_pf)
-			return CLS_NEXT_DROP;
-#ifdef ENABLE_VIRTSVC
-		if (virtsvc_present) {
-			virtsvc = get_outgoing_virtsvc(ether_hdr);
-			if (virtsvc) {
-				df->virtsvc = virtsvc;
-				return CLS_NEXT_VIRTSVC;
-			}
-		}
-#endif
-		df->l3_type = ntohs(ether_hdr->ether_type);
-		df->l3_payload_length = rte_pktmbuf_pkt_len(m) - (uint32_t)sizeof(struct rte_ether_hdr);
-		return CLS_NEXT_CONNTRACK;
-	}
-
-	if (RTE_ETH_IS_IPV6_HDR(l3_type)) {
-		ipv6_hdr = (const struct rte_ipv6_hdr *)(ether_hdr + 1);
-		if (port->is_pf) {
-			if (unlikely(is_ipv6_nd(ipv6_hdr)))
-				return CLS_NEXT_DROP;
-#ifdef ENABLE_VIRTSVC
-			if (virtsvc_present) {
-				virtsvc = get_incoming_virtsvc(ipv6_hdr);
-				if (virtsvc) {
-					df->virtsvc = virtsvc;
-					return CLS_NEXT_VIRTSVC;
-				}
-			}
-#endif
-			switch (ipv6_hdr->proto) {
-			case IPPROTO_IPIP:
-				df->l3_type = RTE_ETHER_TYPE_IPV4;
-				break;
-			case IPPROTO_IPV6:
-				df->l3_type = RTE_ETHER_TYPE_IPV6;
-				break;
-			default:
-				df->l3_type = ntohs(ether_hdr->ether_type);
-				return CLS_NEXT_CONNTRACK;
-			}
-			df->tun_info.l3_type = ntohs(ether_hdr->ether_type);
-			dp_extract_underlay_header(df, ipv6_hdr);
-			return CLS_NEXT_IPIP_DECAP;
-		} else {
-			if (is_ipv6_nd(ipv6_hdr))
-				return CLS_NEXT_IPV6_ND;
-			df->l3_type = ntohs(ether_hdr->ether_type);
-			return CLS_NEXT_CONNTRACK;
-		}
-	}
+	if (l3_class == CLS_L3_IPV4)
+		return get_ipv4_next_index(m, df, port, ether_hdr);
 
-	return CLS_NEXT_DROP;
+	return get_ipv6_next_index(m, df, port, ether_hdr);
 }
 
 static uint16_t cls_node_process(struct rte_graph *graph,
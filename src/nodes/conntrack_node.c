@@ -40,13 +40,13 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 	if (df->l3_type == RTE_ETHER_TYPE_IPV4) {
 		dp_extract_ipv4_header(df, ipv4_hdr);
 		if (DP_FAILED(dp_extract_l4_header(df, ipv4_hdr + 1)))
-			return CONNTRACK_NEXT_DROP;
+			return dp_node_drop(m, DP_DROP_REASON_INVALID_PACKET, CONNTRACK_NEXT_DROP);
 		if (df->l4_type == IPPROTO_UDP && df->l4_info.trans_port.dst_port == htons(DP_BOOTP_SRV_PORT))
 			return CONNTRACK_NEXT_DNAT;
 	} else if (df->l3_type == RTE_ETHER_TYPE_IPV6) {
 		dp_extract_ipv6_header(df, ipv6_hdr);
 		if (DP_FAILED(dp_extract_l4_header(df, ipv6_hdr + 1)))
-			return CONNTRACK_NEXT_DROP;
+			return dp_node_drop(m, DP_DROP_REASON_INVALID_PACKET, CONNTRACK_NEXT_DROP);
 		if (df->l4_type == IPPROTO_UDP && df->l4_info.trans_port.dst_port == htons(DHCPV6_SERVER_PORT))
 			return CONNTRACK_NEXT_DHCPV6;
 	}
@@ -59,10 +59,11 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 		|| df->l4_type == IPPROTO_ICMP
 		|| df->l4_type == IPPROTO_ICMPV6
 	) {
+		// drop reason is set by conntrack itself
 		if (DP_FAILED(dp_cntrack_handle(m, df)))
 			return CONNTRACK_NEXT_DROP;
 	} else {
-		return CONNTRACK_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_UNSUPPORTED_PROTOCOL, CONNTRACK_NEXT_DROP);
 	}
 
 	// VFs packets have no VNF information (no tunnel/underlay)
@@ -80,10 +81,10 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 	case DP_VNF_TYPE_ALIAS_PFX:
 		return CONNTRACK_NEXT_FIREWALL;
 	case DP_VNF_TYPE_UNDEFINED:
-		return CONNTRACK_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_UNKNOWN_VNF, CONNTRACK_NEXT_DROP);
 	}
 
-	return CONNTRACK_NEXT_DROP;
+	return dp_node_drop(m, DP_DROP_REASON_UNKNOWN_VNF, CONNTRACK_NEXT_DROP);
 }
 
 static uint16_t conntrack_node_process(struct rte_graph *graph,
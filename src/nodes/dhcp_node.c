@@ -190,19 +190,19 @@ static __rte_always_inline rte_edge_t get_next_index(struct rte_node *node, stru
 					- (int)offsetof(struct dp_dhcp_header, options);
 
 	if (options_len < 0)
-		return DHCP_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_INVALID_PACKET, DHCP_NEXT_DROP);
 
 	if (port->iface.cfg.own_ip == 0)
-		return DHCP_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_IGNORED, DHCP_NEXT_DROP);
 
 	if (dhcp_hdr->op != DP_BOOTP_REQUEST) {
 		DPNODE_LOG_WARNING(node, "Not a DHCP request", DP_LOG_VALUE(dhcp_hdr->op));
-		return DHCP_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_IGNORED, DHCP_NEXT_DROP);
 	}
 
 	if (DP_FAILED(parse_options(dhcp_hdr, options_len, &msg_type, &pxe_mode))) {
 		DPNODE_LOG_WARNING(node, "Invalid DHCP packet received");
-		return DHCP_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_INVALID_PACKET, DHCP_NEXT_DROP);
 	}
 
 	if (msg_type == DHCPDISCOVER) {
@@ -212,7 +212,7 @@ static __rte_always_inline rte_edge_t get_next_index(struct rte_node *node, stru
 	} else {
 		// unhandled by design
 		DPNODE_LOG_DEBUG(node, "Unhandled DHCP message type", DP_LOG_VALUE(msg_type));
-		return DHCP_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_IGNORED, DHCP_NEXT_DROP);
 	}
 
 	/* rewrite the packet and send it back as a response */
@@ -252,7 +252,7 @@ static __rte_always_inline rte_edge_t get_next_index(struct rte_node *node, stru
 			if (!inet_ntop(AF_INET, &pxe_srv_ip, pxe_srv_ip_str, INET_ADDRSTRLEN)) {
 				DPNODE_LOG_WARNING(node, "Cannot convert PXE server IP",
 								   DP_LOG_IPV4(ntohl(pxe_srv_ip)), DP_LOG_RET(errno));
-				return DHCP_NEXT_DROP;
+				return dp_node_drop(m, DP_DROP_REASON_REPLY_FAILED, DHCP_NEXT_DROP);
 			}
 			snprintf(dhcp_hdr->file, sizeof(dhcp_hdr->file), "%s%s%s",
 					"http://", pxe_srv_ip_str, port->iface.cfg.pxe_str);
@@ -268,7 +268,7 @@ static __rte_always_inline rte_edge_t get_next_index(struct rte_node *node, stru
 	options_len = add_dhcp_options(dhcp_hdr, response_type, pxe_mode);
 	if (DP_FAILED(options_len)) {
 		DPNODE_LOG_WARNING(node, "DHCP response options too large for a packet");
-		return DHCP_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_REPLY_FAILED, DHCP_NEXT_DROP);
 	}
 
 	// packet length changed because of new options, recompute envelopes
@@ -278,7 +278,7 @@ static __rte_always_inline rte_edge_t get_next_index(struct rte_node *node, stru
 							+ sizeof(struct rte_udp_hdr)
 							+ header_size);
 	if (unlikely(m->pkt_len > UINT16_MAX))
-		return DHCP_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_REPLY_FAILED, DHCP_NEXT_DROP);
 
 	incoming_ipv4_hdr->hdr_checksum = 0;
 	incoming_ipv4_hdr->total_length = htons((uint16_t)(sizeof(struct rte_ipv4_hdr)
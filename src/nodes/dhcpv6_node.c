@@ -271,12 +271,12 @@ static __rte_always_inline rte_edge_t get_next_index(struct rte_node *node, stru
 	size_t payload_len;
 
 	if (dp_is_ipv6_addr_zero(dp_get_in_port(m)->iface.cfg.dhcp_ipv6))
-		return DHCPV6_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_IGNORED, DHCPV6_NEXT_DROP);
 
 	// packet length is uint16_t, negative value means it's less than the required length
 	if (req_options_len < 0) {
 		DPNODE_LOG_WARNING(node, "Invalid DHCPv6 packet length", DP_LOG_VALUE(req_options_len));
-		return DHCPV6_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_INVALID_PACKET, DHCPV6_NEXT_DROP);
 	}
 
 	req_eth_hdr = rte_pktmbuf_mtod(m, struct rte_ether_hdr *);
@@ -309,14 +309,14 @@ static __rte_always_inline rte_edge_t get_next_index(struct rte_node *node, stru
 		reply_options_len = strip_options(m, req_options_len);
 		break;
 	default:
-		return DHCPV6_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_IGNORED, DHCPV6_NEXT_DROP);
 	}
 	if (DP_FAILED(reply_options_len))
-		return DHCPV6_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_REPLY_FAILED, DHCPV6_NEXT_DROP);
 
 	payload_len = reply_options_len + DP_DHCPV6_HDR_FIXED_LEN + sizeof(struct rte_udp_hdr);
 	if (payload_len > UINT16_MAX)
-		return DHCPV6_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_REPLY_FAILED, DHCPV6_NEXT_DROP);
 
 	// recompute checksums (offloaded)
 	req_ipv6_hdr->payload_len = req_udp_hdr->dgram_len = htons((uint16_t)payload_len);
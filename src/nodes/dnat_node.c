@@ -65,7 +65,7 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 				// then it is a premature dnat pkt for network nat (sent before any outgoing traffic from VM,
 				// and it cannot be a standalone new incoming flow for network NAT),
 				// silently drop it now.
-				return DNAT_NEXT_DROP;
+				return dp_node_drop(m, DP_DROP_REASON_NOT_ALLOWED, DNAT_NEXT_DROP);
 			}
 
 			ipv4_hdr = dp_get_ipv4_hdr(m);
@@ -81,7 +81,7 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 			dp_delete_flow(&cntrack->flow_key[DP_FLOW_DIR_REPLY]);
 			DP_SET_IPADDR4(cntrack->flow_key[DP_FLOW_DIR_REPLY].l3_src, ntohl(ipv4_hdr->dst_addr));
 			if (DP_FAILED(dp_add_flow(&cntrack->flow_key[DP_FLOW_DIR_REPLY], cntrack)))
-				return DNAT_NEXT_DROP;
+				return dp_node_drop(m, DP_DROP_REASON_FLOW_INSERT, DNAT_NEXT_DROP);
 		}
 		return DNAT_NEXT_IPV4_LOOKUP;
 	}
@@ -98,7 +98,7 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 
 	if (DP_FLOW_HAS_FLAG_DST_NAT(cntrack->flow_flags) && df->flow_dir == DP_FLOW_DIR_ORG) {
 		if (cntrack->flow_key[DP_FLOW_DIR_REPLY].l3_src.is_v6)
-			return DNAT_NEXT_DROP;
+			return dp_node_drop(m, DP_DROP_REASON_NAT_FAILED, DNAT_NEXT_DROP);
 		ipv4_hdr = dp_get_ipv4_hdr(m);
 		ipv4_hdr->dst_addr = htonl(cntrack->flow_key[DP_FLOW_DIR_REPLY].l3_src.ipv4);
 		df->nat_type = DP_NAT_CHG_DST_IP;
@@ -110,7 +110,7 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 	/* We already know what to do */
 	if (DP_FLOW_HAS_FLAG_SRC_NAT(cntrack->flow_flags) && df->flow_dir == DP_FLOW_DIR_REPLY) {
 		if (cntrack->flow_key[DP_FLOW_DIR_ORG].l3_src.is_v6)
-			return DNAT_NEXT_DROP;
+			return dp_node_drop(m, DP_DROP_REASON_NAT_FAILED, DNAT_NEXT_DROP);
 		ipv4_hdr = dp_get_ipv4_hdr(m);
 		ipv4_hdr->dst_addr = htonl(cntrack->flow_key[DP_FLOW_DIR_ORG].l3_src.ipv4);
 		if (cntrack->nf_info.nat_type == DP_FLOW_NAT_TYPE_NETWORK_LOCAL) {
@@ -121,7 +121,7 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 					memset(&icmp_err_ip_info, 0, sizeof(icmp_err_ip_info));
 					dp_get_icmp_err_ip_hdr(m, &icmp_err_ip_info);
 					if (!icmp_err_ip_info.err_ipv4_hdr || !icmp_err_ip_info.l4_src_port || !icmp_err_ip_info.l4_dst_port)
-						return DNAT_NEXT_DROP;
+						return dp_node_drop(m, DP_DROP_REASON_INVALID_PACKET, DNAT_NEXT_DROP);
 					icmp_err_ip_info.err_ipv4_hdr->src_addr = htonl(cntrack->flow_key[DP_FLOW_DIR_ORG].l3_src.ipv4);
 					icmp_err_ip_info.err_ipv4_hdr->hdr_checksum = cntrack->nf_info.icmp_err_ip_cksum;
 					dp_change_icmp_err_l4_src_port(m, &icmp_err_ip_info, cntrack->flow_key[DP_FLOW_DIR_ORG].src.port_src);
@@ -150,7 +150,7 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 		}
 		if (!cntrack->flow_key[DP_FLOW_DIR_ORG].l3_src.is_v6
 			|| DP_FAILED(dp_nat_chg_ipv4_to_ipv6_hdr(df, m, cntrack->flow_key[DP_FLOW_DIR_ORG].l3_src.ipv6)))
-			return DNAT_NEXT_DROP;
+			return dp_node_drop(m, DP_DROP_REASON_NAT_FAILED, DNAT_NEXT_DROP);
 
 		return DNAT_NEXT_IPV6_LOOKUP;
 	}
@@ -161,7 +161,7 @@ out:
 	else if (df->l3_type == RTE_ETHER_TYPE_IPV6)
 		return DNAT_NEXT_IPV6_LOOKUP;
 	else
-		return DNAT_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_UNSUPPORTED_PROTOCOL, DNAT_NEXT_DROP);
 }
 
 static uint16_t dnat_node_process(struct rte_graph *graph,
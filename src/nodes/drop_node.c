@@ -17,6 +17,8 @@ static uint16_t drop_node_process(struct rte_graph *graph,
 
 	dp_graphtrace_drop_burst(node, objs, nb_objs);
 
+	dp_count_dropped_packets(objs, nb_objs);
+
 	rte_pktmbuf_free_bulk((struct rte_mbuf **)objs, nb_objs);
 	return nb_objs;
 }
@@ -42,7 +42,7 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 			action = DP_FWALL_DROP;
 		/* Ignore the drop actions till we have the metalnet ready to set the firewall rules */
 		// if (action == DP_FWALL_DROP)
-		// 	return FIREWALL_NEXT_DROP;
+		// 	return dp_node_drop(m, DP_DROP_REASON_FIREWALL, FIREWALL_NEXT_DROP);
 	}
 
 	if (out_port->is_pf)
@@ -4,7 +4,10 @@
 #include <rte_common.h>
 #include <rte_graph.h>
 #include <rte_graph_worker.h>
+#include <rte_ip_frag.h>
 #include <rte_mbuf.h>
+#include <rte_udp.h>
+#include "dp_decap_cache.h"
 #include "dp_mbuf_dyn.h"
 #include "dp_nat.h"
 #include "dp_vnf.h"
@@ -12,28 +15,78 @@
 #include "rte_flow/dp_rte_flow.h"
 
 #define NEXT_NODES(NEXT) \
-	NEXT(IPIP_DECAP_NEXT_CONNTRACK, "conntrack")
+	NEXT(IPIP_DECAP_NEXT_CONNTRACK, "conntrack") \
+	NEXT(IPIP_DECAP_NEXT_REASSEMBLY, "reassembly")
 DP_NODE_REGISTER_NOINIT(IPIP_DECAP, ipip_decap, NEXT_NODES);
 
+#define IPIP_DECAP_INNER_OFFSET (sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv6_hdr))
+
+// Only simple TCP/UDP packets are cached, conntrack creates the same key from dp_flow once the packet is known
+static __rte_always_inline bool get_cache_key(struct rte_mbuf *m, const struct dp_flow *df, struct dp_decap_cache_key *key)
+{
+	const struct rte_ipv4_hdr *ipv4_hdr;
+	const struct rte_ipv6_hdr *ipv6_hdr;
+	const struct rte_udp_hdr *l4_hdr;  // TCP has ports at the same place
+
+	if (df->l3_type == RTE_ETHER_TYPE_IPV4) {
+		ipv4_hdr = rte_pktmbuf_mtod_offset(m, const struct rte_ipv4_hdr *, IPIP_DECAP_INNER_OFFSET);
+		if ((ipv4_hdr->next_proto_id != IPPROTO_TCP && ipv4_hdr->next_proto_id != IPPROTO_UDP)
+			|| ipv4_hdr->version_ihl != RTE_IPV4_VHL_DEF
+			|| rte_ipv4_frag_pkt_is_fragmented(ipv4_hdr))
+			return false;
+		l4_hdr = (const struct rte_udp_hdr *)(ipv4_hdr + 1);
+		dp_decap_cache_set_key(key, df->tun_info.ul_dst_addr6,
+							   &ipv4_hdr->src_addr, &ipv4_hdr->dst_addr, sizeof(ipv4_hdr->src_addr),
+							   ipv4_hdr->next_proto_id, l4_hdr->src_port, l4_hdr->dst_port);
+	} else if (df->l3_type == RTE_ETHER_TYPE_IPV6) {
+		ipv6_hdr = rte_pktmbuf_mtod_offset(m, const struct rte_ipv6_hdr *, IPIP_DECAP_INNER_OFFSET);
+		if (ipv6_hdr->proto != IPPROTO_TCP && ipv6_hdr->proto != IPPROTO_UDP)
+			return false;
+		l4_hdr = (const struct rte_udp_hdr *)(ipv6_hdr + 1);
+		dp_decap_cache_set_key(key, df->tun_info.ul_dst_addr6,
+							   ipv6_hdr->src_addr, ipv6_hdr->dst_addr, sizeof(ipv6_hdr->src_addr),
+							   ipv6_hdr->proto, l4_hdr->src_port, l4_hdr->dst_port);
+	} else {
+		return false;
+	}
+
+	return true;
+}
+
 static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_node *node, struct rte_mbuf *m)
 {
 	struct dp_flow *df = dp_get_flow_ptr(m);
 	struct rte_ether_hdr *ether_hdr;
+	struct dp_decap_cache_key cache_key;
+	const struct dp_decap_cache_entry *cached;
 	const struct dp_vnf *vnf;
 	struct dp_port *dst_port;
 	uint32_t l3_type;
 
-	vnf = dp_get_vnf(df->tun_info.ul_dst_addr6);
-	if (!vnf)
-		return IPIP_DECAP_NEXT_DROP;
+	// established flows skip the VNF lookup here and the flow table lookup in conntrack
+	if (get_cache_key(m, df, &cache_key) && (cached = dp_decap_cache_lookup(&cache_key))) {
+		dst_port = dp_get_port_by_id(cached->port_id);  // validated when cached, configuration did not change since
+		df->tun_info.dst_vni = cached->vni;
+		df->vnf_type = cached->vnf_type;
+		df->nxt_hop = cached->port_id;
+		df->conntrack = cached->conntrack;
+		df->decap_cached = true;
+	} else {
+		vnf = dp_get_vnf(df->tun_info.ul_dst_addr6);
+		if (!vnf)
+			return dp_node_drop(m, DP_DROP_REASON_UNKNOWN_VNF, IPIP_DECAP_NEXT_DROP);
 
-	dst_port = dp_get_port_by_id(vnf->port_id);
-	if (!dst_port)
-		return IPIP_DECAP_NEXT_DROP;
+		dst_port = dp_get_port_by_id(vnf->port_id);
+		if (!dst_port)
+			return dp_node_drop(m, DP_DROP_REASON_INVALID_PORT, IPIP_DECAP_NEXT_DROP);
 
-	df->tun_info.dst_vni = vnf->vni;
-	df->vnf_type = vnf->type;
-	df->nxt_hop = vnf->port_id;  // already validated above
+		df->tun_info.dst_vni = vnf->vni;
+		df->vnf_type = vnf->type;
+		df->nxt_hop = vnf->port_id;  // already validated above
+	}
+
+	if (!dst_port->is_pf)
+		dp_get_pkt_mark(m)->stats_port_id = dst_port->port_id;
 
 	switch (df->tun_info.proto_id) {
 	case IPPROTO_IPIP:
@@ -43,7 +96,7 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 		l3_type = RTE_PTYPE_L3_IPV6;
 		break;
 	default:
-		return IPIP_DECAP_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_UNSUPPORTED_PROTOCOL, IPIP_DECAP_NEXT_DROP);
 	}
 
 	rte_pktmbuf_adj(m, sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv6_hdr));
@@ -54,6 +107,11 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 	// this shift is non-standard as the actual values of PTYPE should be opaque
 	m->packet_type = ((m->packet_type & RTE_PTYPE_INNER_L4_MASK) >> 16) | l3_type | RTE_PTYPE_L2_ETHER;
 
+	if (unlikely(df->l3_type == RTE_ETHER_TYPE_IPV4
+					? rte_ipv4_frag_pkt_is_fragmented((const struct rte_ipv4_hdr *)(ether_hdr + 1))
+					: ((const struct rte_ipv6_hdr *)(ether_hdr + 1))->proto == IPPROTO_FRAGMENT))
+		return IPIP_DECAP_NEXT_REASSEMBLY;
+
 	return IPIP_DECAP_NEXT_CONNTRACK;
 }
 
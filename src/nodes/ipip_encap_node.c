@@ -23,11 +23,50 @@ int ipip_encap_node_append_pf_tx(uint16_t port_id, const char *tx_node_name)
 	return dp_node_append_pf_tx(DP_NODE_GET_SELF(ipip_encap), next_tx_index, port_id, tx_node_name);
 }
 
+struct ipip_encap_hdr {
+	struct rte_ether_hdr	ether;
+	struct rte_ipv6_hdr		ipv6;
+} __rte_packed;
+
+// Outer headers of packets from the same port leaving through the same PF only differ
+// in the underlay destination, payload length and protocol, the rest is prepared in advance
+struct ipip_encap_template {
+	struct ipip_encap_hdr	hdr;
+	uint64_t				generation;
+} __rte_cache_aligned;
+
+static struct ipip_encap_template templates[DP_MAX_PORTS][DP_MAX_PF_PORTS];
+// zeroed templates must never be valid
+static uint64_t template_generation = 1;
+
+void ipip_encap_node_invalidate_templates(void)
+{
+	template_generation++;
+}
+
+static __rte_always_inline const struct ipip_encap_hdr *get_template(const struct dp_port *in_port, const struct dp_port *out_port)
+{
+	struct ipip_encap_template *entry = &templates[in_port->port_id][out_port == dp_get_pf1() ? 1 : 0];
+	struct rte_ipv6_hdr *ipv6_hdr = &entry->hdr.ipv6;
+
+	if (unlikely(entry->generation != template_generation)) {
+		dp_fill_ether_hdr(&entry->hdr.ether, out_port, RTE_ETHER_TYPE_IPV6);
+		ipv6_hdr->vtc_flow = htonl(DP_IP6_VTC_FLOW);
+		ipv6_hdr->payload_len = 0;
+		ipv6_hdr->proto = 0;
+		ipv6_hdr->hop_limits = DP_IP6_HOP_LIMIT;
+		rte_memcpy(ipv6_hdr->src_addr, dp_get_port_ul_ipv6(in_port), sizeof(ipv6_hdr->src_addr));
+		memset(ipv6_hdr->dst_addr, 0, sizeof(ipv6_hdr->dst_addr));
+		entry->generation = template_generation;
+	}
+
+	return &entry->hdr;
+}
+
 static __rte_always_inline rte_edge_t get_next_index(struct rte_node *node, struct rte_mbuf *m)
 {
 	struct dp_flow *df = dp_get_flow_ptr(m);
-	struct rte_ether_hdr *ether_hdr;
-	struct rte_ipv6_hdr *ipv6_hdr;
+	struct ipip_encap_hdr *encap_hdr;
 	rte_be16_t payload_len;
 	uint32_t packet_type;
 
@@ -41,7 +80,7 @@ static __rte_always_inline rte_edge_t get_next_index(struct rte_node *node, stru
 		packet_type = RTE_PTYPE_L3_IPV6 | RTE_PTYPE_TUNNEL_IP | RTE_PTYPE_INNER_L3_IPV6 | RTE_PTYPE_L2_ETHER;
 	} else {
 		DPNODE_LOG_WARNING(node, "Invalid tunnel type", DP_LOG_VALUE(df->l3_type));
-		return IPIP_ENCAP_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_UNSUPPORTED_PROTOCOL, IPIP_ENCAP_NEXT_DROP);
 	}
 
 	m->outer_l2_len = sizeof(struct rte_ether_hdr);
@@ -49,27 +88,20 @@ static __rte_always_inline rte_edge_t get_next_index(struct rte_node *node, stru
 	m->l2_len = 0; /* We dont have inner l2, when we encapsulate */
 
 	rte_pktmbuf_adj(m, sizeof(struct rte_ether_hdr));
-	ether_hdr = (struct rte_ether_hdr *)rte_pktmbuf_prepend(m, sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv6_hdr));
-	if (unlikely(!ether_hdr)) {
+	encap_hdr = (struct ipip_encap_hdr *)rte_pktmbuf_prepend(m, sizeof(struct ipip_encap_hdr));
+	if (unlikely(!encap_hdr)) {
 		DPNODE_LOG_WARNING(node, "No space in mbuf for IPv6 header");
-		return IPIP_ENCAP_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_NO_HEADROOM, IPIP_ENCAP_NEXT_DROP);
 	}
 
-	dp_fill_ether_hdr(ether_hdr, dp_get_out_port(df), RTE_ETHER_TYPE_IPV6);
-
-	ipv6_hdr = (struct rte_ipv6_hdr *)(ether_hdr + 1);
-	ipv6_hdr->hop_limits = DP_IP6_HOP_LIMIT;
-	ipv6_hdr->payload_len = payload_len;
-	ipv6_hdr->vtc_flow = htonl(DP_IP6_VTC_FLOW);
+	rte_memcpy(encap_hdr, get_template(dp_get_in_port(m), dp_get_out_port(df)), sizeof(*encap_hdr));
+	encap_hdr->ipv6.payload_len = payload_len;
+	encap_hdr->ipv6.proto = df->tun_info.proto_id;
+	rte_memcpy(encap_hdr->ipv6.dst_addr, df->tun_info.ul_dst_addr6, sizeof(encap_hdr->ipv6.dst_addr));
 
 	if (df->nat_type == DP_LB_RECIRC)
 		// store the original ipv6 dst address in the packet
-		rte_memcpy(ipv6_hdr->src_addr, df->tun_info.ul_src_addr6, sizeof(ipv6_hdr->src_addr));
-	else
-		rte_memcpy(ipv6_hdr->src_addr, dp_get_port_ul_ipv6(dp_get_in_port(m)), sizeof(ipv6_hdr->src_addr));
-
-	rte_memcpy(ipv6_hdr->dst_addr, df->tun_info.ul_dst_addr6, sizeof(ipv6_hdr->dst_addr));
-	ipv6_hdr->proto = df->tun_info.proto_id;
+		rte_memcpy(encap_hdr->ipv6.src_addr, df->tun_info.ul_src_addr6, sizeof(encap_hdr->ipv6.src_addr));
 
 	m->packet_type = packet_type;
 	m->ol_flags |= RTE_MBUF_F_TX_OUTER_IPV6;
@@ -9,15 +9,27 @@
 #include "dp_conf.h"
 #include "dp_util.h"
 #include "dp_error.h"
+#include "dp_flow.h"
 #include "dp_mbuf_dyn.h"
 #include "dp_iface.h"
+#include "dp_vni.h"
 #include "nodes/common_node.h"
+#include "nodes/pmtu_node.h"
 #include "rte_flow/dp_rte_flow.h"
 
 #define NEXT_NODES(NEXT) \
-	NEXT(IPV6_LOOKUP_NEXT_SNAT, "snat")
+	NEXT(IPV6_LOOKUP_NEXT_SNAT, "snat") \
+	NEXT(IPV6_LOOKUP_NEXT_PMTU, "pmtu")
 DP_NODE_REGISTER_NOINIT(IPV6_LOOKUP, ipv6_lookup, NEXT_NODES);
 
+static __rte_always_inline enum dp_drop_reason get_no_route_reason(const struct dp_port *in_port, uint32_t t_vni)
+{
+	// only called for dropped packets, so the second lookup does not hurt
+	return dp_get_vni_route6_table(t_vni ? t_vni : in_port->iface.vni)
+		? DP_DROP_REASON_NO_ROUTE
+		: DP_DROP_REASON_UNKNOWN_VNI;
+}
+
 static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_node *node, struct rte_mbuf *m)
 {
 	struct dp_flow *df = dp_get_flow_ptr(m);
@@ -25,20 +37,36 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 	struct dp_iface_route route;
 	const struct dp_port *in_port = dp_get_in_port(m);
 	const struct dp_port *out_port;
+	enum dp_flow_type flow_type;
+	uint16_t port_id;
 	uint8_t route_key[DP_IPV6_ADDR_SIZE] = {0};
 	uint8_t cmp_key[DP_IPV6_ADDR_SIZE] = {0};
 	int t_vni;
 
+	// established flows from the underlay do not need another route lookup
+	if (in_port->is_pf && df->conntrack
+		&& dp_flow_get_cached_route(df->conntrack, df->flow_dir, &port_id, &flow_type)
+	) {
+		dp_fill_ether_hdr(ether_hdr, dp_get_port_by_id(port_id), RTE_ETHER_TYPE_IPV6);
+		df->flow_type = flow_type;
+		df->nxt_hop = port_id;
+		return IPV6_LOOKUP_NEXT_SNAT;
+	}
+
 	t_vni = in_port->is_pf ? df->tun_info.dst_vni : 0;
 
 	out_port = dp_get_ip6_out_port(in_port, t_vni, df, &route, route_key);
 	if (!out_port)
-		return IPV6_LOOKUP_NEXT_DROP;
+		return dp_node_drop(m, get_no_route_reason(in_port, t_vni), IPV6_LOOKUP_NEXT_DROP);
 
 	if (out_port->is_pf) {
 		if (in_port->is_pf)
-			return IPV6_LOOKUP_NEXT_DROP;
+			return dp_node_drop(m, DP_DROP_REASON_NOT_ALLOWED, IPV6_LOOKUP_NEXT_DROP);
 		rte_memcpy(df->tun_info.ul_dst_addr6, route.nh_ipv6, sizeof(df->tun_info.ul_dst_addr6));
+		if (unlikely(dp_pmtu_is_exceeded(m, df, out_port))) {
+			df->nxt_hop = out_port->port_id;
+			return IPV6_LOOKUP_NEXT_PMTU;
+		}
 	} else {
 		// next hop is known, fill in Ether header
 		// (PF egress goes through a tunnel that destroys Ether header)
@@ -51,6 +79,10 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 	df->flow_type = rte_rib6_is_equal(route_key, cmp_key) ? DP_FLOW_SOUTH_NORTH : DP_FLOW_WEST_EAST;
 	df->nxt_hop = out_port->port_id;  // always valid since coming from struct dp_port
 
+	// PF-to-PF is not allowed, so this is always a VF
+	if (in_port->is_pf && df->conntrack)
+		dp_flow_cache_route(df->conntrack, df->flow_dir, out_port->port_id, df->flow_type);
+
 	return IPV6_LOOKUP_NEXT_SNAT;
 }
 
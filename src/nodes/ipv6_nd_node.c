@@ -71,12 +71,12 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 	rte_memcpy(req_ipv6_hdr->src_addr, rt_ip, sizeof(req_ipv6_hdr->src_addr));
 
 	if (icmp_type != NDISC_NEIGHBOUR_SOLICITATION && icmp_type != NDISC_ROUTER_SOLICITATION)
-		return IPV6_ND_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_IGNORED, IPV6_ND_NEXT_DROP);
 
 	if (icmp_type == NDISC_NEIGHBOUR_SOLICITATION) {
 		nd_msg = (struct nd_msg *)(req_ipv6_hdr + 1);
 		if (memcmp(&nd_msg->target, rt_ip, sizeof(nd_msg->target)))
-			return IPV6_ND_NEXT_DROP;
+			return dp_node_drop(m, DP_DROP_REASON_IGNORED, IPV6_ND_NEXT_DROP);
 		rte_ether_addr_copy(&req_eth_hdr->dst_addr, &port->neigh_mac);
 		rte_memcpy(port->iface.cfg.own_ipv6, req_ipv6_hdr->dst_addr, sizeof(port->iface.cfg.own_ipv6));
 		req_icmp6_hdr->icmp6_type = NDISC_NEIGHBOUR_ADVERTISEMENT;
@@ -103,10 +103,13 @@ static uint16_t ipv6_nd_node_process(struct rte_graph *graph,
 									 void **objs,
 									 uint16_t nb_objs)
 {
-	if (dp_conf_is_ipv6_overlay_enabled())
+	if (dp_conf_is_ipv6_overlay_enabled()) {
 		dp_foreach_graph_packet(graph, node, objs, nb_objs, DP_GRAPH_NO_SPECULATED_NODE, get_next_index);
-	else
+	} else {
+		for (uint16_t i = 0; i < nb_objs; ++i)
+			dp_set_drop_reason((struct rte_mbuf *)objs[i], DP_DROP_REASON_IGNORED);
 		dp_forward_graph_packets(graph, node, objs, nb_objs, IPV6_ND_NEXT_DROP);
+	}
 
 	return nb_objs;
 }
@@ -5,6 +5,7 @@
 #include <rte_graph.h>
 #include <rte_graph_worker.h>
 #include <rte_mbuf.h>
+#include "dp_cksum.h"
 #include "dp_mbuf_dyn.h"
 #include "dp_nat.h"
 #include "dp_util.h"
@@ -21,20 +22,16 @@ static __rte_always_inline rte_edge_t lb_nnat_icmp_reply(struct dp_flow *df, str
 	struct rte_ipv4_hdr *ipv4_hdr = dp_get_ipv4_hdr(m);
 	struct rte_icmp_hdr *icmp_hdr = (struct rte_icmp_hdr *)(ipv4_hdr + 1);
 	uint32_t temp_ip;
-	uint32_t cksum;
 
 	if (icmp_hdr->icmp_type != RTE_IP_ICMP_ECHO_REQUEST)
-		return PACKET_RELAY_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_IGNORED, PACKET_RELAY_NEXT_DROP);
 
 	// rewrite the packet and send it back
 	icmp_hdr->icmp_type = RTE_IP_ICMP_ECHO_REPLY;
 
-	cksum = ~icmp_hdr->icmp_cksum & 0xffff;
-	cksum += ~RTE_BE16(RTE_IP_ICMP_ECHO_REQUEST << 8) & 0xffff;
-	cksum += RTE_BE16(RTE_IP_ICMP_ECHO_REPLY << 8);
-	cksum = (cksum & 0xffff) + (cksum >> 16);
-	cksum = (cksum & 0xffff) + (cksum >> 16);
-	icmp_hdr->icmp_cksum = (uint16_t)~cksum;
+	icmp_hdr->icmp_cksum = dp_cksum_update16(icmp_hdr->icmp_cksum,
+											 RTE_BE16(RTE_IP_ICMP_ECHO_REQUEST << 8),
+											 RTE_BE16(RTE_IP_ICMP_ECHO_REPLY << 8));
 
 	temp_ip = ipv4_hdr->dst_addr;
 	ipv4_hdr->dst_addr = ipv4_hdr->src_addr;
@@ -53,7 +50,7 @@ static __rte_always_inline rte_edge_t lb_nnat_icmpv6_reply(struct dp_flow *df, s
 	uint8_t temp_addr[DP_IPV6_ADDR_SIZE];
 
 	if (icmp6_hdr->icmp_type != DP_ICMPV6_ECHO_REQUEST)
-		return PACKET_RELAY_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_IGNORED, PACKET_RELAY_NEXT_DROP);
 
 	icmp6_hdr->icmp_type = DP_ICMPV6_ECHO_REPLY;
 
@@ -76,7 +73,7 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 	struct flow_value *cntrack = df->conntrack;
 
 	if (!cntrack)
-		return PACKET_RELAY_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_CONNTRACK_ERROR, PACKET_RELAY_NEXT_DROP);
 
 	if (cntrack->nf_info.nat_type == DP_FLOW_NAT_TYPE_NETWORK_NEIGH) {
 		df->nxt_hop = m->port;
@@ -92,7 +89,7 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 	if (df->l4_type == IPPROTO_ICMPV6)
 		return lb_nnat_icmpv6_reply(df, m);
 
-	return PACKET_RELAY_NEXT_DROP;
+	return dp_node_drop(m, DP_DROP_REASON_UNSUPPORTED_PROTOCOL, PACKET_RELAY_NEXT_DROP);
 }
 
 static uint16_t packet_relay_node_process(struct rte_graph *graph,
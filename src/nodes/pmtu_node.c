@@ -0,0 +1,195 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "nodes/pmtu_node.h"
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_icmp.h>
+#include <rte_mbuf.h>
+#include "dp_conf.h"
+#include "dp_iface.h"
+#include "dp_lpm.h"
+#include "dp_mbuf_dyn.h"
+#include "dp_port.h"
+#include "nodes/common_node.h"
+#include "protocols/dp_icmpv6.h"
+#include "rte_flow/dp_rte_flow.h"
+
+// RFC 1812 (ICMPv4 errors should not exceed 576B), RFC 4443 (ICMPv6 errors must not exceed 1280B)
+#define DP_PMTU_ICMP_MAX_LEN	576
+#define DP_PMTU_ICMPV6_MAX_LEN	1280
+#define DP_PMTU_IPV6_MIN_MTU	1280
+#define DP_PMTU_IPV4_TTL		64
+
+DP_NODE_REGISTER(PMTU, pmtu, DP_NODE_DEFAULT_NEXT_ONLY);
+
+static uint16_t next_tx_index[DP_MAX_PORTS];
+
+int pmtu_node_append_vf_tx(uint16_t port_id, const char *tx_node_name)
+{
+	return dp_node_append_vf_tx(DP_NODE_GET_SELF(pmtu), next_tx_index, port_id, tx_node_name);
+}
+
+// constant after init, precompute them
+static uint32_t icmp_rate_limit;
+static uint64_t icmp_rate_window;
+static rte_be32_t gw_ip4;
+static const uint8_t *gw_ip6;
+
+static int pmtu_node_init(__rte_unused const struct rte_graph *graph, __rte_unused struct rte_node *node)
+{
+	icmp_rate_limit = (uint32_t)dp_conf_get_icmp_error_rate_limit();
+	icmp_rate_window = rte_get_timer_hz();
+	gw_ip4 = htonl(dp_get_gw_ip4());
+	gw_ip6 = dp_get_gw_ip6();
+	return DP_OK;
+}
+
+static __rte_always_inline bool pmtu_rate_limit_exceeded(struct dp_port *port)
+{
+	struct dp_port_icmp_limiter *limiter = &port->icmp_limiter;
+	uint64_t timestamp;
+
+	if (!icmp_rate_limit)
+		return false;
+
+	timestamp = rte_rdtsc();
+	if (timestamp - limiter->window_start >= icmp_rate_window) {
+		limiter->window_start = timestamp;
+		limiter->window_cnt = 0;
+	}
+	if (limiter->window_cnt >= icmp_rate_limit)
+		return true;
+	limiter->window_cnt++;
+	return false;
+}
+
+// Turns the original packet (stripped of Ether header) into the payload of an ICMP error
+static __rte_always_inline void *pmtu_prepend_headers(struct rte_mbuf *m, uint16_t hdr_len, uint16_t max_len)
+{
+	uint32_t max_payload_len = (uint32_t)(max_len - hdr_len);
+
+	rte_pktmbuf_adj(m, sizeof(struct rte_ether_hdr));
+	if (rte_pktmbuf_pkt_len(m) > max_payload_len)
+		rte_pktmbuf_trim(m, (uint16_t)(rte_pktmbuf_pkt_len(m) - max_payload_len));
+	return rte_pktmbuf_prepend(m, (uint16_t)(sizeof(struct rte_ether_hdr) + hdr_len));
+}
+
+static __rte_always_inline rte_edge_t pmtu_icmp_reply(struct rte_mbuf *m, const struct dp_port *in_port, uint16_t mtu)
+{
+	rte_be32_t orig_src = dp_get_ipv4_hdr(m)->src_addr;
+	struct rte_ether_hdr *ether_hdr;
+	struct rte_ipv4_hdr *ipv4_hdr;
+	struct rte_icmp_hdr *icmp_hdr;
+
+	ether_hdr = pmtu_prepend_headers(m, sizeof(struct rte_ipv4_hdr) + sizeof(struct rte_icmp_hdr), DP_PMTU_ICMP_MAX_LEN);
+	if (!ether_hdr)
+		return dp_node_drop(m, DP_DROP_REASON_NO_HEADROOM, PMTU_NEXT_DROP);
+
+	ipv4_hdr = (struct rte_ipv4_hdr *)(ether_hdr + 1);
+	ipv4_hdr->version_ihl = RTE_IPV4_VHL_DEF;
+	ipv4_hdr->type_of_service = 0;
+	ipv4_hdr->total_length = htons((uint16_t)(rte_pktmbuf_pkt_len(m) - sizeof(struct rte_ether_hdr)));
+	ipv4_hdr->packet_id = 0;
+	ipv4_hdr->fragment_offset = 0;
+	ipv4_hdr->time_to_live = DP_PMTU_IPV4_TTL;
+	ipv4_hdr->next_proto_id = IPPROTO_ICMP;
+	ipv4_hdr->src_addr = gw_ip4;
+	ipv4_hdr->dst_addr = orig_src;
+	ipv4_hdr->hdr_checksum = 0;
+	ipv4_hdr->hdr_checksum = rte_ipv4_cksum(ipv4_hdr);
+
+	// RFC 1191: unused 16 bits followed by the next-hop MTU
+	icmp_hdr = (struct rte_icmp_hdr *)(ipv4_hdr + 1);
+	icmp_hdr->icmp_type = DP_IP_ICMP_TYPE_ERROR;
+	icmp_hdr->icmp_code = DP_IP_ICMP_CODE_FRAGMENT_NEEDED;
+	icmp_hdr->icmp_ident = 0;
+	icmp_hdr->icmp_seq_nb = htons(mtu);
+	icmp_hdr->icmp_cksum = 0;
+	icmp_hdr->icmp_cksum = (uint16_t)~rte_raw_cksum(icmp_hdr, ntohs(ipv4_hdr->total_length) - sizeof(struct rte_ipv4_hdr));
+
+	dp_fill_ether_hdr(ether_hdr, in_port, RTE_ETHER_TYPE_IPV4);
+	m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_ICMP;
+	return next_tx_index[m->port];
+}
+
+static __rte_always_inline rte_edge_t pmtu_icmpv6_reply(struct rte_mbuf *m, const struct dp_port *in_port, uint16_t mtu)
+{
+	uint8_t orig_src[DP_IPV6_ADDR_SIZE];
+	struct rte_ether_hdr *ether_hdr;
+	struct rte_ipv6_hdr *ipv6_hdr;
+	struct rte_icmp_hdr *icmp6_hdr;
+
+	rte_memcpy(orig_src, dp_get_ipv6_hdr(m)->src_addr, sizeof(orig_src));
+
+	ether_hdr = pmtu_prepend_headers(m, sizeof(struct rte_ipv6_hdr) + sizeof(struct rte_icmp_hdr), DP_PMTU_ICMPV6_MAX_LEN);
+	if (!ether_hdr)
+		return dp_node_drop(m, DP_DROP_REASON_NO_HEADROOM, PMTU_NEXT_DROP);
+
+	ipv6_hdr = (struct rte_ipv6_hdr *)(ether_hdr + 1);
+	ipv6_hdr->vtc_flow = htonl(DP_IP6_VTC_FLOW);
+	ipv6_hdr->payload_len = htons((uint16_t)(rte_pktmbuf_pkt_len(m) - sizeof(struct rte_ether_hdr) - sizeof(struct rte_ipv6_hdr)));
+	ipv6_hdr->proto = IPPROTO_ICMPV6;
+	ipv6_hdr->hop_limits = DP_IP6_HOP_LIMIT;
+	rte_memcpy(ipv6_hdr->src_addr, gw_ip6, sizeof(ipv6_hdr->src_addr));
+	rte_memcpy(ipv6_hdr->dst_addr, orig_src, sizeof(ipv6_hdr->dst_addr));
+
+	// RFC 4443: 32-bit MTU field, never lower than the IPv6 minimum
+	icmp6_hdr = (struct rte_icmp_hdr *)(ipv6_hdr + 1);
+	icmp6_hdr->icmp_type = DP_ICMPV6_PACKET_TOO_BIG;
+	icmp6_hdr->icmp_code = 0;
+	icmp6_hdr->icmp_ident = 0;
+	icmp6_hdr->icmp_seq_nb = htons((uint16_t)RTE_MAX(mtu, DP_PMTU_IPV6_MIN_MTU));
+	icmp6_hdr->icmp_cksum = 0;
+	icmp6_hdr->icmp_cksum = rte_ipv6_udptcp_cksum(ipv6_hdr, icmp6_hdr);
+
+	dp_fill_ether_hdr(ether_hdr, in_port, RTE_ETHER_TYPE_IPV6);
+	m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 | RTE_PTYPE_L4_ICMP;
+	return next_tx_index[m->port];
+}
+
+static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_node *node, struct rte_mbuf *m)
+{
+	struct dp_flow *df = dp_get_flow_ptr(m);
+	struct dp_port *in_port = dp_get_in_port(m);
+	const struct dp_port *out_port = dp_get_out_port(df);
+	// the sender only sees the inner packet, tunnel overhead needs to be accounted for
+	uint16_t mtu = (uint16_t)(out_port->mtu - sizeof(struct rte_ipv6_hdr));
+	rte_edge_t next;
+
+	if (pmtu_rate_limit_exceeded(in_port)) {
+		DP_STATS_MTU_INC_ICMP_LIMITED_CNT(in_port);
+		return dp_node_drop(m, DP_DROP_REASON_PMTU_RATE_LIMIT, PMTU_NEXT_DROP);
+	}
+
+	// the original packet is only read from its beginning, but keep it simple
+	if (unlikely(!rte_pktmbuf_is_contiguous(m)))
+		return dp_node_drop(m, DP_DROP_REASON_REPLY_FAILED, PMTU_NEXT_DROP);
+
+	// the reply is not part of the original flow, it must not get offloaded as such
+	df->conntrack = NULL;
+	df->offload_state = DP_FLOW_NON_OFFLOAD;
+	m->ol_flags &= ~RTE_MBUF_F_TX_OFFLOAD_MASK;
+	m->tx_offload = 0;
+
+	if (df->l3_type == RTE_ETHER_TYPE_IPV4)
+		next = pmtu_icmp_reply(m, in_port, mtu);
+	else
+		next = pmtu_icmpv6_reply(m, in_port, mtu);
+
+	if (next != PMTU_NEXT_DROP)
+		DP_STATS_MTU_INC_ICMP_SENT_CNT(in_port);
+
+	return next;
+}
+
+static uint16_t pmtu_node_process(struct rte_graph *graph,
+								  struct rte_node *node,
+								  void **objs,
+								  uint16_t nb_objs)
+{
+	dp_foreach_graph_packet(graph, node, objs, nb_objs, DP_GRAPH_NO_SPECULATED_NODE, get_next_index);
+	return nb_objs;
+}
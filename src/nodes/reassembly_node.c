@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_mbuf.h>
+#include "dp_ipfrag.h"
+#include "dp_mbuf_dyn.h"
+#include "nodes/common_node.h"
+
+#define NEXT_NODES(NEXT) \
+	NEXT(REASSEMBLY_NEXT_CONNTRACK, "conntrack")
+DP_NODE_REGISTER_NOINIT(REASSEMBLY, reassembly, NEXT_NODES);
+
+// Fragments are held here until the whole packet arrives, only then it continues to conntrack,
+// thus NAT and firewall always see L4 headers. Incomplete packets are dropped on timeout
+// (lazily, only when new fragments are coming) or when the reassembly table is full.
+static uint16_t reassembly_node_process(struct rte_graph *graph,
+										struct rte_node *node,
+										void **objs,
+										uint16_t nb_objs)
+{
+	uint64_t tsc = rte_rdtsc();
+	struct rte_mbuf *m;
+	struct dp_flow *df;
+
+	for (uint16_t i = 0; i < nb_objs; ++i) {
+		m = (struct rte_mbuf *)objs[i];
+		dp_graphtrace_node(node, m);
+		df = dp_get_flow_ptr(m);
+		m = dp_ipfrag_reassemble(m, df->l3_type, tsc);
+		if (!m)
+			continue;
+		// the first fragment carries the packet now, its metadata is used
+		df = dp_get_flow_ptr(m);
+		df->reassembled = true;
+		df->l3_payload_length = rte_pktmbuf_pkt_len(m) - (uint32_t)sizeof(struct rte_ether_hdr);
+		dp_graphtrace_next(node, m, REASSEMBLY_NEXT_CONNTRACK);
+		rte_node_enqueue_x1(graph, node, REASSEMBLY_NEXT_CONNTRACK, m);
+	}
+
+	dp_ipfrag_free_dropped();
+
+	return nb_objs;
+}
@@ -8,6 +8,8 @@
 #include <rte_graph_worker.h>
 #include <rte_mbuf.h>
 #include "dp_error.h"
+#include "dp_gro.h"
+#include "dp_idle.h"
 #include "dp_log.h"
 #include "dp_port.h"
 #include "dp_mbuf_dyn.h"
@@ -84,7 +86,9 @@ static uint16_t rx_node_process(struct rte_graph *graph,
 								uint16_t cnt)
 {
 	struct rx_node_ctx *ctx = (struct rx_node_ctx *)node->ctx;
+	uint64_t n_bytes = 0;
 	uint16_t n_pkts;
+	struct rte_mbuf *pkt;
 
 	RTE_SET_USED(cnt);  // this is a source node, input data is not present yet
 
@@ -98,13 +102,25 @@ static uint16_t rx_node_process(struct rte_graph *graph,
 	if (unlikely(!n_pkts))
 		return 0;
 
+	dp_idle_mark_active();
+
+	// statistics are for packets actually received
+	for (uint16_t i = 0; i < n_pkts; ++i)
+		n_bytes += ((struct rte_mbuf *)objs[i])->pkt_len;
+	DP_STATS_TRAFFIC_ADD_RX(ctx->port, n_pkts, n_bytes);
+
+	if (ctx->port->rx_gro)
+		n_pkts = dp_gro_reassemble_burst(ctx->port, (struct rte_mbuf **)objs, n_pkts);
+
 	node->idx = n_pkts;
 
 	// Rx node only ever leads to CLS node (can move all packets at once)
 	// also packet tracing in Rx node needs to also cover the ingress itself
 	// thus not using dp_foreach_graph_packet() here
-	for (uint16_t i = 0; i < n_pkts; ++i)
-		dp_init_pkt_mark((struct rte_mbuf *)objs[i]);
+	for (uint16_t i = 0; i < n_pkts; ++i) {
+		pkt = (struct rte_mbuf *)objs[i];
+		dp_init_pkt_mark(pkt);
+	}
 
 	dp_graphtrace_rx_burst(node, objs, n_pkts);
 
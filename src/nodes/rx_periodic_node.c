@@ -8,8 +8,10 @@
 #include <rte_mbuf.h>
 #include "dp_error.h"
 #include "dp_flow.h"
+#include "dp_idle.h"
 #include "dp_mbuf_dyn.h"
 #include "grpc/dp_grpc_impl.h"
+#include "monitoring/dp_latency.h"
 #include "monitoring/dp_monitoring.h"
 #include "nodes/common_node.h"
 
@@ -42,14 +44,22 @@ static __rte_always_inline void handle_nongraph_queues(void)
 {
 	struct rte_mbuf *mbufs[RTE_MAX(DP_INTERNAL_Q_SIZE, DP_GRPC_Q_SIZE)];
 	unsigned int count, i;
+	uint64_t start;
 
 	count = rte_ring_sc_dequeue_burst(monitoring_rx_queue, (void **)mbufs, (unsigned int)RTE_DIM(mbufs), NULL);
+	if (count)
+		dp_idle_mark_active();
 	for (i = 0; i < count; ++i)
 		dp_process_event_msg(mbufs[i]);
 
 	count = rte_ring_sc_dequeue_burst(grpc_tx_queue, (void **)mbufs, (unsigned int)RTE_DIM(mbufs), NULL);
-	for (i = 0; i < count; ++i)
+	if (count)
+		dp_idle_mark_active();
+	for (i = 0; i < count; ++i) {
+		start = dp_latency_start();
 		dp_process_request(mbufs[i]);
+		dp_latency_end(DP_LATENCY_HANDLER_GRPC_REQUEST, start);
+	}
 }
 
 static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_node *node, struct rte_mbuf *m)
@@ -80,6 +90,8 @@ static uint16_t rx_periodic_node_process(struct rte_graph *graph,
 	if (likely(!n_pkts))
 		return 0;
 
+	dp_idle_mark_active();
+
 	node->idx = n_pkts;
 	dp_foreach_graph_packet(graph, node, objs, n_pkts, DP_GRAPH_NO_SPECULATED_NODE, get_next_index);
 	return n_pkts;
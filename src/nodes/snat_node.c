@@ -36,8 +36,10 @@ static __rte_always_inline int dp_process_ipv4_snat(struct rte_mbuf *m, struct d
 	}
 	if (snat_data->nat_ip != 0) {
 		ret = dp_allocate_network_snat_port(snat_data, df, port->iface.vni);
-		if (DP_FAILED(ret))
+		if (DP_FAILED(ret)) {
+			dp_set_drop_reason(m, ret == -ENOSPC ? DP_DROP_REASON_NAT_NO_PORTS : DP_DROP_REASON_NAT_FAILED);
 			return DP_ERROR;
+		}
 		nat_port = (uint16_t)ret;
 		ipv4_hdr->src_addr = htonl(snat_data->nat_ip);
 
@@ -69,8 +71,10 @@ static __rte_always_inline int dp_process_ipv4_snat(struct rte_mbuf *m, struct d
 	if (snat_data->nat_ip != 0)
 		cntrack->flow_key[DP_FLOW_DIR_REPLY].port_dst = df->nat_port;
 
-	if (DP_FAILED(dp_add_flow(&cntrack->flow_key[DP_FLOW_DIR_REPLY], cntrack)))
+	if (DP_FAILED(dp_add_flow(&cntrack->flow_key[DP_FLOW_DIR_REPLY], cntrack))) {
+		dp_set_drop_reason(m, DP_DROP_REASON_FLOW_INSERT);
 		return DP_ERROR;
+	}
 
 	return DP_OK;
 }
@@ -88,8 +92,10 @@ static __rte_always_inline int dp_process_ipv6_nat64(struct rte_mbuf *m, struct
 	snat64_data.nat_port_range[0] = port->iface.nat_port_range[0];
 	snat64_data.nat_port_range[1] = port->iface.nat_port_range[1];
 	ret = dp_allocate_network_snat_port(&snat64_data, df, port->iface.vni);
-	if (DP_FAILED(ret))
+	if (DP_FAILED(ret)) {
+		dp_set_drop_reason(m, ret == -ENOSPC ? DP_DROP_REASON_NAT_NO_PORTS : DP_DROP_REASON_NAT_FAILED);
 		return DP_ERROR;
+	}
 	nat_port = (uint16_t)ret;
 
 	DP_STATS_NAT_INC_USED_PORT_CNT(port);
@@ -100,6 +106,7 @@ static __rte_always_inline int dp_process_ipv6_nat64(struct rte_mbuf *m, struct
 	if (DP_FAILED(dp_nat_chg_ipv6_to_ipv4_hdr(df, m, snat64_data.nat_ip, &dest_ip4))) {
 		dp_remove_network_snat_port(cntrack);
 		DP_STATS_NAT_DEC_USED_PORT_CNT(port);
+		dp_set_drop_reason(m, DP_DROP_REASON_NAT_FAILED);
 		return DP_ERROR;
 	}
 
@@ -132,8 +139,10 @@ static __rte_always_inline int dp_process_ipv6_nat64(struct rte_mbuf *m, struct
 	cntrack->flow_key[DP_FLOW_DIR_REPLY].port_dst = df->nat_port;
 	cntrack->flow_key[DP_FLOW_DIR_REPLY].proto = df->l4_type;
 
-	if (DP_FAILED(dp_add_flow(&cntrack->flow_key[DP_FLOW_DIR_REPLY], cntrack)))
+	if (DP_FAILED(dp_add_flow(&cntrack->flow_key[DP_FLOW_DIR_REPLY], cntrack))) {
+		dp_set_drop_reason(m, DP_DROP_REASON_FLOW_INSERT);
 		return DP_ERROR;
+	}
 
 	return DP_OK;
 }
@@ -154,7 +163,7 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 		&& (df->l3_type == RTE_ETHER_TYPE_IPV4 || df->l3_type == RTE_ETHER_TYPE_IPV6)) {
 		color = rte_meter_srtcm_color_blind_check(&in_port->port_srtcm, &in_port->port_srtcm_profile, rte_rdtsc(), df->l3_payload_length);
 		if (color == RTE_COLOR_RED)
-			return SNAT_NEXT_DROP;
+			return dp_node_drop(m, DP_DROP_REASON_METER, SNAT_NEXT_DROP);
 	}
 
 	if (!cntrack)
@@ -170,12 +179,14 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 
 		if (snat_data && (snat_data->vip_ip != 0 || snat_data->nat_ip != 0)
 			&& df->flow_type == DP_FLOW_SOUTH_NORTH) {
+			// drop reason is set by the function itself
 			if (DP_FAILED(dp_process_ipv4_snat(m, df, cntrack, port, snat_data)))
 				return SNAT_NEXT_DROP;
 		}
 
 		if (df->l3_type == RTE_ETHER_TYPE_IPV6 && port->iface.nat_ip && dp_is_ip6_in_nat64_range(df->dst.dst_addr6)
 		    && df->flow_type == DP_FLOW_SOUTH_NORTH) {
+			// drop reason is set by the function itself
 			if (DP_FAILED(dp_process_ipv6_nat64(m, df, cntrack, port)))
 				return SNAT_NEXT_DROP;
 
@@ -186,7 +197,7 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 	/* We already know what to do */
 	if (DP_FLOW_HAS_FLAG_SRC_NAT(cntrack->flow_flags) && df->flow_dir == DP_FLOW_DIR_ORG) {
 		if (cntrack->flow_key[DP_FLOW_DIR_REPLY].l3_dst.is_v6)
-			return SNAT_NEXT_DROP;
+			return dp_node_drop(m, DP_DROP_REASON_NAT_FAILED, SNAT_NEXT_DROP);
 		ipv4_hdr = dp_get_ipv4_hdr(m);
 		ipv4_hdr->src_addr = htonl(cntrack->flow_key[DP_FLOW_DIR_REPLY].l3_dst.ipv4);
 
@@ -207,7 +218,7 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 		&& (df->flow_dir == DP_FLOW_DIR_REPLY)
 	) {
 		if (cntrack->flow_key[DP_FLOW_DIR_ORG].l3_dst.is_v6)
-			return SNAT_NEXT_DROP;
+			return dp_node_drop(m, DP_DROP_REASON_NAT_FAILED, SNAT_NEXT_DROP);
 		ipv4_hdr = dp_get_ipv4_hdr(m);
 		df->src.src_addr = ipv4_hdr->src_addr;
 		ipv4_hdr->src_addr = htonl(cntrack->flow_key[DP_FLOW_DIR_ORG].l3_dst.ipv4);
@@ -218,7 +229,7 @@ static __rte_always_inline rte_edge_t get_next_index(__rte_unused struct rte_nod
 
 	if (DP_FLOW_HAS_FLAG_SRC_NAT64(cntrack->flow_flags) && df->flow_dir == DP_FLOW_DIR_ORG) {
 		if (DP_FAILED(dp_nat_chg_ipv6_to_ipv4_hdr(df, m, port->iface.nat_ip, &dest_ip4)))
-			return SNAT_NEXT_DROP;
+			return dp_node_drop(m, DP_DROP_REASON_NAT_FAILED, SNAT_NEXT_DROP);
 
 		if (cntrack->nf_info.nat_type == DP_FLOW_NAT_TYPE_NETWORK_LOCAL) {
 			df->nat_port = cntrack->flow_key[DP_FLOW_DIR_REPLY].port_dst;
@@ -3,22 +3,55 @@
 
 #include "nodes/tx_node.h"
 #include <rte_common.h>
+#include <rte_cycles.h>
 #include <rte_ethdev.h>
 #include <rte_ether.h>
 #include <rte_graph.h>
 #include <rte_graph_worker.h>
 #include <rte_mbuf.h>
+#include "dp_cksum.h"
 #include "dp_error.h"
+#include "dp_gso.h"
+#include "dp_ipfrag.h"
 #include "dp_log.h"
 #include "dp_mbuf_dyn.h"
 #include "dp_nat.h"
 #include "dp_port.h"
+#include "monitoring/dp_latency.h"
 #include "nodes/common_node.h"
 #include "rte_flow/dp_rte_flow.h"
 #include "rte_flow/dp_rte_flow_traffic_forward.h"
 
 DP_NODE_REGISTER(TX, tx, DP_NODE_DEFAULT_NEXT_ONLY);
 
+// packets are buffered per-port and sent once there is enough of them,
+// or when no more packets came during the last graph walk, or after a short timeout
+#define DP_TX_BUFFER_SIZE 128
+#define DP_TX_BURST_THRESHOLD 32
+#define DP_TX_DRAIN_TIMEOUT_US 20
+// how many times to try sending packets again (when the Tx ring is full) before dropping them
+#define DP_TX_MAX_RETRIES 4
+
+struct dp_tx_buffer {
+	struct rte_node *node;
+	struct dp_port *port;
+	uint16_t queue_id;
+	uint16_t count;
+	uint8_t retries;
+	bool fresh;
+	bool pending;
+	uint64_t first_tsc;
+	struct rte_mbuf *pkts[DP_TX_BUFFER_SIZE];
+} __rte_cache_aligned;
+
+static struct dp_tx_buffer tx_buffers[DP_MAX_PORTS];
+
+// only buffers holding packets are checked after every graph walk
+static struct dp_tx_buffer *pending_buffers[DP_MAX_PORTS];
+static uint16_t pending_count;
+
+static uint64_t drain_timeout_cycles;
+
 // there are multiple Tx nodes, one per port, node context is needed
 struct tx_node_ctx {
 	uint16_t port_id;
@@ -69,20 +102,195 @@ static int tx_node_init(const struct rte_graph *graph, struct rte_node *node)
 
 	ctx->port_id = port_id;
 	ctx->queue_id = graph->id;
+
+	tx_buffers[port_id].node = node;
+	tx_buffers[port_id].port = dp_get_port_by_id(port_id);
+	tx_buffers[port_id].queue_id = graph->id;
+	if (!tx_buffers[port_id].port)
+		return DP_ERROR;
+
+	drain_timeout_cycles = DP_TX_DRAIN_TIMEOUT_US * rte_get_timer_hz() / US_PER_S;
 	return DP_OK;
 }
 
+static void tx_buffer_drop(struct dp_tx_buffer *buf, struct rte_mbuf **pkts, uint16_t count)
+{
+	for (uint16_t i = 0; i < count; ++i)
+		dp_set_drop_reason(pkts[i], DP_DROP_REASON_TX_FULL);
+	dp_graphtrace_drop_burst(buf->node, (void **)pkts, count);
+	dp_count_dropped_packets((void **)pkts, count);
+	rte_pktmbuf_free_bulk(pkts, count);
+	DP_STATS_TX_ADD_DROP_CNT(buf->port, count);
+}
+
+static void tx_buffer_flush(struct dp_tx_buffer *buf)
+{
+	uint16_t port_id = buf->port->port_id;
+	uint16_t sent_count;
+	uint64_t sent_bytes = 0;
+
+	// sent packets cannot be accessed after Tx, count all now, then subtract the rest
+	for (uint16_t i = 0; i < buf->count; ++i)
+		sent_bytes += buf->pkts[i]->pkt_len;
+
+	sent_count = rte_eth_tx_burst(port_id, buf->queue_id, buf->pkts, buf->count);
+	dp_graphtrace_tx_burst(buf->node, (void **)buf->pkts, sent_count, port_id);
+	DP_STATS_TX_INC_FLUSH_CNT(buf->port);
+
+	for (uint16_t i = sent_count; i < buf->count; ++i)
+		sent_bytes -= buf->pkts[i]->pkt_len;
+	DP_STATS_TRAFFIC_ADD_TX(buf->port, sent_count, sent_bytes);
+
+	if (likely(sent_count == buf->count)) {
+		buf->count = 0;
+		buf->retries = 0;
+		return;
+	}
+
+	// Tx ring is full, keep the rest for later, unless there is no progress for too long
+	if (sent_count)
+		buf->retries = 0;
+	if (++buf->retries > DP_TX_MAX_RETRIES) {
+		DPNODE_LOG_WARNING(buf->node, "Not all packets transmitted successfully", DP_LOG_VALUE(sent_count), DP_LOG_MAX(buf->count));
+		tx_buffer_drop(buf, buf->pkts + sent_count, buf->count - sent_count);
+		buf->count = 0;
+		buf->retries = 0;
+		return;
+	}
+
+	DP_STATS_TX_INC_RETRY_CNT(buf->port);
+	memmove(buf->pkts, buf->pkts + sent_count, (buf->count - sent_count) * sizeof(buf->pkts[0]));
+	buf->count -= sent_count;
+	buf->first_tsc = rte_get_timer_cycles();
+}
+
+void tx_node_flush_pending(bool force)
+{
+	uint64_t drain_tsc = rte_get_timer_cycles() - drain_timeout_cycles;
+	struct dp_tx_buffer *buf;
+
+	for (uint16_t i = 0; i < pending_count;) {
+		buf = pending_buffers[i];
+		// no new packets means there is no point in waiting for more,
+		// but when retrying, give the Tx ring some time to drain
+		if (force || buf->first_tsc <= drain_tsc || (!buf->fresh && !buf->retries))
+			tx_buffer_flush(buf);
+		buf->fresh = false;
+		if (buf->count) {
+			++i;
+			continue;
+		}
+		buf->pending = false;
+		pending_buffers[i] = pending_buffers[--pending_count];
+	}
+}
+
+bool tx_node_is_pending(void)
+{
+	return pending_count > 0;
+}
+
+static __rte_always_inline void tx_buffer_add(struct dp_tx_buffer *buf, struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	uint16_t room;
+
+	if (!buf->count)
+		buf->first_tsc = rte_get_timer_cycles();
+
+	while (nb_pkts) {
+		room = DP_TX_BUFFER_SIZE - buf->count;
+		if (unlikely(!room)) {
+			// Tx ring is still full, no space for new packets
+			tx_buffer_drop(buf, pkts, nb_pkts);
+			break;
+		}
+		if (room > nb_pkts)
+			room = nb_pkts;
+		rte_memcpy(&buf->pkts[buf->count], pkts, room * sizeof(pkts[0]));
+		buf->count += room;
+		pkts += room;
+		nb_pkts -= room;
+		if (buf->count >= DP_TX_BURST_THRESHOLD)
+			tx_buffer_flush(buf);
+	}
+
+	buf->fresh = true;
+	if (buf->count && !buf->pending) {
+		buf->pending = true;
+		pending_buffers[pending_count++] = buf;
+	}
+}
+
+// reassembled packets can be bigger than what the destination accepts, they need to be split again,
+// same for IPv4 packets that allow it (others are either handled by sending ICMP errors or sent as-is)
+static __rte_always_inline bool tx_needs_fragmenting(const struct dp_tx_buffer *buf, struct rte_mbuf *m, const struct dp_flow *df)
+{
+	if (likely(rte_pktmbuf_pkt_len(m) - sizeof(struct rte_ether_hdr) <= buf->port->mtu))
+		return false;
+
+	return df->reassembled || dp_ipfrag_is_allowed(m, buf->port->is_pf);
+}
+
+static void tx_packet_drop(struct dp_tx_buffer *buf, struct rte_mbuf *m, enum dp_drop_reason reason)
+{
+	dp_set_drop_reason(m, reason);
+	dp_graphtrace_drop_burst(buf->node, (void **)&m, 1);
+	dp_count_dropped_packets((void **)&m, 1);
+	rte_pktmbuf_free(m);
+	DP_STATS_TX_ADD_DROP_CNT(buf->port, 1);
+}
+
+static void tx_buffer_add_fragmented(struct dp_tx_buffer *buf, struct rte_mbuf *m)
+{
+	struct rte_mbuf *frags[DP_IPFRAG_MAX_FRAGS];
+	int nb_frags;
+
+	nb_frags = dp_ipfrag_fragment(m, buf->port->is_pf, buf->port->mtu, frags, RTE_DIM(frags));
+	if (DP_FAILED(nb_frags)) {
+		tx_packet_drop(buf, m, DP_DROP_REASON_FRAGMENTATION);
+		return;
+	}
+
+	tx_buffer_add(buf, frags, (uint16_t)nb_frags);
+}
+
+// packets merged on Rx (GRO) are split to fit into MTU again, segments still need their checksums
+static void tx_buffer_add_segmented(struct dp_tx_buffer *buf, struct rte_mbuf *m)
+{
+	struct rte_mbuf *segs[DP_GSO_MAX_SEGS];
+	int nb_segs;
+
+	nb_segs = dp_gso_segment(m, buf->port->mtu, segs, RTE_DIM(segs));
+	if (DP_FAILED(nb_segs)) {
+		tx_packet_drop(buf, m, DP_DROP_REASON_SEGMENTATION);
+		return;
+	}
+	if (!nb_segs) {
+		dp_gso_clear(m);
+		segs[0] = m;
+		nb_segs = 1;
+	} else
+		DP_STATS_MTU_ADD_GSO_SEGMENTS_CNT(buf->port, nb_segs);
+
+	for (int i = 0; i < nb_segs; ++i)
+		dp_cksum_tx_prepare(segs[i], buf->port->tx_cksum_fallback, buf->port->tx_offloads);
+
+	tx_buffer_add(buf, segs, (uint16_t)nb_segs);
+}
+
 static uint16_t tx_node_process(struct rte_graph *graph,
 								struct rte_node *node,
 								void **objs,
 								uint16_t nb_objs)
 {
 	struct tx_node_ctx *ctx = (struct tx_node_ctx *)node->ctx;
-	uint16_t port_id = ctx->port_id;
-	uint16_t queue = ctx->queue_id;
-	uint16_t sent_count;
+	struct dp_tx_buffer *buf = &tx_buffers[ctx->port_id];
+	uint16_t nb_ready = 0;
 	struct rte_mbuf *m;
 	struct dp_flow *df;
+	uint64_t start;
+
+	RTE_SET_USED(graph);
 
 	// since this node is emitting packets, dp_forward_* wrapper functions cannot be used
 	// this code should closely resemble the one inside those functions
@@ -95,21 +303,32 @@ static uint16_t tx_node_process(struct rte_graph *graph,
 			if (!DP_FLOW_HAS_FLAG_NF(df->conntrack->flow_flags))
 				df->conntrack->flow_flags |= DP_FLOW_FLAG_DEFAULT;
 			// offload this flow from now on
-			if (df->offload_state == DP_FLOW_OFFLOAD_INSTALL)
+			if (df->offload_state == DP_FLOW_OFFLOAD_INSTALL) {
+				start = dp_latency_start();
 				if (DP_FAILED(dp_offload_handler(m, df)))
 					DPNODE_LOG_WARNING(node, "Offloading handler failed");
+				dp_latency_end(DP_LATENCY_HANDLER_OFFLOAD, start);
+			}
+		}
+		if (unlikely(dp_gso_is_needed(m, buf->port->mtu))) {
+			// keep the original packet order
+			tx_buffer_add(buf, (struct rte_mbuf **)objs + nb_ready, (uint16_t)(i - nb_ready));
+			tx_buffer_add_segmented(buf, m);
+			nb_ready = (uint16_t)(i + 1);
+			continue;
+		}
+		dp_gso_clear(m);
+		dp_cksum_tx_prepare(m, buf->port->tx_cksum_fallback, buf->port->tx_offloads);
+		if (unlikely(tx_needs_fragmenting(buf, m, df))) {
+			// keep the original packet order
+			tx_buffer_add(buf, (struct rte_mbuf **)objs + nb_ready, (uint16_t)(i - nb_ready));
+			tx_buffer_add_fragmented(buf, m);
+			nb_ready = (uint16_t)(i + 1);
 		}
 	}
 
-	sent_count = rte_eth_tx_burst(port_id, queue, (struct rte_mbuf **)objs, nb_objs);
-	dp_graphtrace_tx_burst(node, objs, sent_count, port_id);
-
-	if (unlikely(sent_count != nb_objs)) {
-		DPNODE_LOG_WARNING(node, "Not all packets transmitted successfully", DP_LOG_VALUE(sent_count), DP_LOG_MAX(nb_objs));
-		dp_graphtrace_next_burst(node, objs + sent_count, nb_objs - sent_count, TX_NEXT_DROP);
-		rte_node_enqueue(graph, node, TX_NEXT_DROP, objs + sent_count, nb_objs - sent_count);
-	}
+	tx_buffer_add(buf, (struct rte_mbuf **)objs + nb_ready, (uint16_t)(nb_objs - nb_ready));
 
-	// maybe sent_count makes more sense, but cnt is the real number of processed packets by this node
+	// packets are not necessarily sent yet, but they are all processed by this node
 	return nb_objs;
 }
@@ -86,14 +86,14 @@ static __rte_always_inline uint16_t virtsvc_request_next(struct rte_node *node,
 	int conn_idx;
 
 	if (hdr_total_len < sizeof(struct rte_ipv4_hdr))
-		return VIRTSVC_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_INVALID_PACKET, VIRTSVC_NEXT_DROP);
 
 	// replace IPv4 header with IPv6 header
 	rte_pktmbuf_adj(m, sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv4_hdr));
 	ether_hdr = (struct rte_ether_hdr *)rte_pktmbuf_prepend(m, sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv6_hdr));
 	if (unlikely(!ether_hdr)) {
 		DPNODE_LOG_WARNING(node, "No more space in the packet for IPv6 header");
-		return VIRTSVC_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_NO_HEADROOM, VIRTSVC_NEXT_DROP);
 	}
 	m->packet_type = (m->packet_type & RTE_PTYPE_L4_MASK) | RTE_PTYPE_L3_IPV6 | RTE_PTYPE_L2_ETHER;
 
@@ -104,6 +104,8 @@ static __rte_always_inline uint16_t virtsvc_request_next(struct rte_node *node,
 	ipv6_hdr->hop_limits = ttl;
 	rte_memcpy(ipv6_hdr->src_addr, service_ul_ip, sizeof(ipv6_hdr->src_addr));
 	rte_memcpy(ipv6_hdr->dst_addr, virtsvc->service_addr, sizeof(virtsvc->service_addr));
+	// offloads requested for the original IPv4 packet do not apply anymore
+	m->ol_flags &= ~(RTE_MBUF_F_TX_IPV4 | RTE_MBUF_F_TX_IP_CKSUM | RTE_MBUF_F_TX_L4_MASK | RTE_MBUF_F_TX_TCP_SEG);
 	m->ol_flags |= RTE_MBUF_F_TX_IPV6;
 	m->tx_offload = 0;
 	m->l2_len = sizeof(struct rte_ether_hdr);
@@ -117,10 +119,9 @@ static __rte_always_inline uint16_t virtsvc_request_next(struct rte_node *node,
 											  &pf_port_id, &conn_idx))
 		) {
 			DPNODE_LOG_WARNING(node, "Cannot establish outgoing connection");
-			return VIRTSVC_NEXT_DROP;
+			return dp_node_drop(m, DP_DROP_REASON_VIRTSVC_CONN, VIRTSVC_NEXT_DROP);
 		}
-		conn = &virtsvc->connections[conn_idx];
-		conn->last_pkt_timestamp = rte_get_timer_cycles();
+		conn = dp_virtsvc_get_conn(virtsvc, (uint16_t)conn_idx);
 		virtsvc_tcp_state_change(conn, tcp_hdr->tcp_flags);
 
 		tcp_hdr->src_port = virtsvc_get_port_for_conn(conn_idx);
@@ -136,10 +137,8 @@ static __rte_always_inline uint16_t virtsvc_request_next(struct rte_node *node,
 											  &pf_port_id, &conn_idx))
 		) {
 			DPNODE_LOG_WARNING(node, "Cannot establish outgoing connection");
-			return VIRTSVC_NEXT_DROP;
+			return dp_node_drop(m, DP_DROP_REASON_VIRTSVC_CONN, VIRTSVC_NEXT_DROP);
 		}
-		conn = &virtsvc->connections[conn_idx];
-		conn->last_pkt_timestamp = rte_get_timer_cycles();
 
 		udp_hdr->src_port = virtsvc_get_port_for_conn(conn_idx);
 		udp_hdr->dst_port = virtsvc->service_port;
@@ -150,20 +149,13 @@ static __rte_always_inline uint16_t virtsvc_request_next(struct rte_node *node,
 
 	pf_port = dp_get_port_by_id(pf_port_id);
 	if (!pf_port)
-		return VIRTSVC_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_INVALID_PORT, VIRTSVC_NEXT_DROP);
 
 	dp_fill_ether_hdr(ether_hdr, pf_port, RTE_ETHER_TYPE_IPV6);
 
 	return next_tx_index[pf_port_id];
 }
 
-static __rte_always_inline struct dp_virtsvc_conn *virtsvc_get_conn_on_port(struct dp_virtsvc *virtsvc, rte_be16_t l4_port)
-{
-	uint16_t port_idx = ntohs(l4_port) - DP_NB_SYSTEM_PORTS;
-
-	return &virtsvc->connections[port_idx];
-}
-
 static __rte_always_inline uint16_t virtsvc_reply_next(struct rte_node *node,
 													   struct rte_mbuf *m,
 													   struct dp_flow *df)
@@ -187,7 +179,7 @@ static __rte_always_inline uint16_t virtsvc_reply_next(struct rte_node *node,
 	ether_hdr = (struct rte_ether_hdr *)rte_pktmbuf_prepend(m, sizeof(struct rte_ether_hdr) + sizeof(struct rte_ipv4_hdr));
 	if (unlikely(!ether_hdr)) {
 		DPNODE_LOG_WARNING(node, "No more space in the packet for IPv4 header");
-		return VIRTSVC_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_NO_HEADROOM, VIRTSVC_NEXT_DROP);
 	}
 	m->packet_type = (m->packet_type & ~RTE_PTYPE_L3_MASK) | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L2_ETHER;
 
@@ -209,10 +201,9 @@ static __rte_always_inline uint16_t virtsvc_reply_next(struct rte_node *node,
 	if (proto == IPPROTO_TCP) {
 		tcp_hdr = (struct rte_tcp_hdr *)(ipv4_hdr + 1);
 
-		conn = virtsvc_get_conn_on_port(df->virtsvc, tcp_hdr->dst_port);
-		if (!conn->last_pkt_timestamp)
-			return VIRTSVC_NEXT_DROP;
-		conn->last_pkt_timestamp = rte_get_timer_cycles();
+		conn = dp_virtsvc_get_reply_conn(df->virtsvc, tcp_hdr->dst_port);
+		if (!conn)
+			return dp_node_drop(m, DP_DROP_REASON_VIRTSVC_CONN, VIRTSVC_NEXT_DROP);
 		virtsvc_tcp_state_change(conn, tcp_hdr->tcp_flags);
 
 		tcp_hdr->dst_port = conn->vf_l4_port;
@@ -223,10 +214,9 @@ static __rte_always_inline uint16_t virtsvc_reply_next(struct rte_node *node,
 	} else {
 		udp_hdr = (struct rte_udp_hdr *)(ipv4_hdr + 1);
 
-		conn = virtsvc_get_conn_on_port(df->virtsvc, udp_hdr->dst_port);
-		if (!conn->last_pkt_timestamp)
-			return VIRTSVC_NEXT_DROP;
-		conn->last_pkt_timestamp = rte_get_timer_cycles();
+		conn = dp_virtsvc_get_reply_conn(df->virtsvc, udp_hdr->dst_port);
+		if (!conn)
+			return dp_node_drop(m, DP_DROP_REASON_VIRTSVC_CONN, VIRTSVC_NEXT_DROP);
 
 		udp_hdr->dst_port = conn->vf_l4_port;
 		udp_hdr->src_port = df->virtsvc->virtual_port;
@@ -240,7 +230,7 @@ static __rte_always_inline uint16_t virtsvc_reply_next(struct rte_node *node,
 
 	vf_port = dp_get_port_by_id(vf_port_id);
 	if (!vf_port)
-		return VIRTSVC_NEXT_DROP;
+		return dp_node_drop(m, DP_DROP_REASON_INVALID_PORT, VIRTSVC_NEXT_DROP);
 
 	dp_fill_ether_hdr(ether_hdr, vf_port, RTE_ETHER_TYPE_IPV4);
 
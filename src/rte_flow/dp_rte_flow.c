@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "rte_flow/dp_rte_flow.h"
+#include "dp_cksum.h"
 #include "dp_error.h"
 #include "dp_flow.h"
 #include "dp_lpm.h"
@@ -83,7 +84,6 @@ void dp_change_icmp_identifier(struct rte_mbuf *m, uint16_t new_val)
 {
 	struct rte_icmp_hdr *icmp_hdr;
 	rte_be16_t old_identifier;
-	uint32_t cksum;
 
 	icmp_hdr = (struct rte_icmp_hdr *)(dp_get_ipv4_hdr(m) + 1);
 	old_identifier = icmp_hdr->icmp_ident;
@@ -91,13 +91,7 @@ void dp_change_icmp_identifier(struct rte_mbuf *m, uint16_t new_val)
 
 	// the approach of adding up vectors from icmp_hdr one by one is not durable since data field is not
 	// provided in struct rte_icmp_hdr
-	cksum = (~(icmp_hdr->icmp_cksum)) & 0xffff;
-	cksum += (~old_identifier) & 0xffff;
-	cksum += icmp_hdr->icmp_ident & 0xffff;
-	cksum = (cksum & 0xffff) + (cksum >> 16);
-	cksum = (cksum & 0xffff) + (cksum >> 16);
-
-	icmp_hdr->icmp_cksum = (~cksum) & 0xffff;
+	icmp_hdr->icmp_cksum = dp_cksum_update16(icmp_hdr->icmp_cksum, old_identifier, icmp_hdr->icmp_ident);
 }
 
 
@@ -8,6 +8,7 @@
 #include "dp_lpm.h"
 #include "dp_nat.h"
 #include "dp_port.h"
+#include "monitoring/dp_ipfix.h"
 #include "nodes/ipv6_nd_node.h"
 #include "rte_flow/dp_rte_flow_helpers.h"
 
@@ -80,6 +81,17 @@ static __rte_always_inline struct flow_age_ctx *allocate_agectx(void)
 	return agectx;
 }
 
+// only the main rule of an offloaded flow is counted, auxiliary rules (hairpin, capture) see the same packets
+static __rte_always_inline void dp_set_flow_counter(struct rte_flow_action *action,
+													struct rte_flow_action_count *flow_count_action,
+													const struct dp_flow *df,
+													struct flow_age_ctx *agectx)
+{
+	dp_set_flow_count_action(action, flow_count_action);
+	agectx->counted = true;
+	agectx->flow_dir = df->flow_dir;
+}
+
 static __rte_always_inline int dp_install_rte_flow_with_age(uint16_t port_id,
 															const struct rte_flow_attr *attr,
 															const struct rte_flow_item pattern[],
@@ -205,8 +217,9 @@ int dp_offload_handle_tunnel_encap_traffic(struct dp_flow *df,
 	struct rte_flow_action_raw_decap raw_decap;  // #3
 	struct rte_flow_action_raw_encap raw_encap;  // #4
 	struct rte_flow_action_age flow_age;         // #5
-	struct rte_flow_action_port_id send_to_port; // #6 (optional)
-	struct rte_flow_action actions[7];            // + end
+	struct rte_flow_action_count flow_count;     // #6 (optional)
+	struct rte_flow_action_port_id send_to_port; // #7 (optional)
+	struct rte_flow_action actions[8];            // + end
 	int action_cnt = 0;
 
 	// hairpin action is different - redirects the flow
@@ -304,6 +317,10 @@ int dp_offload_handle_tunnel_encap_traffic(struct dp_flow *df,
 	age_action = &actions[action_cnt++];
 	dp_set_flow_age_action(age_action, &flow_age, df->conntrack->timeout_value, agectx);
 
+	// count offloaded packets for flow export
+	if (dp_ipfix_is_enabled())
+		dp_set_flow_counter(&actions[action_cnt++], &flow_count, df, agectx);
+
 	// send to the right port (unless already handled by the hairpin)
 	if (!cross_pf_port)
 		dp_set_send_to_port_action(&actions[action_cnt++], &send_to_port, outgoing_port->port_id);
@@ -359,9 +376,10 @@ int dp_offload_handle_tunnel_decap_traffic(struct dp_flow *df,
 	struct rte_flow_action_set_ipv4 set_ipv4;    // #3 (optional)
 	struct rte_flow_action_set_tp set_tp;        // #4 (optional)
 	struct rte_flow_action_age flow_age;         // #5
-	struct rte_flow_action_queue redirect_queue; // #6 (choose one)
-	struct rte_flow_action_port_id send_to_port; // #6 (choose one)
-	struct rte_flow_action actions[7];           // + end
+	struct rte_flow_action_count flow_count;     // #6 (optional)
+	struct rte_flow_action_queue redirect_queue; // #7 (choose one)
+	struct rte_flow_action_port_id send_to_port; // #7 (choose one)
+	struct rte_flow_action actions[8];           // + end
 	int action_cnt = 0;
 
 	struct rte_flow_action_jump jump_action;       // #1
@@ -460,6 +478,10 @@ int dp_offload_handle_tunnel_decap_traffic(struct dp_flow *df,
 	age_action = &actions[action_cnt++];
 	dp_set_flow_age_action(age_action, &flow_age, df->conntrack->timeout_value, agectx);
 
+	// count offloaded packets for flow export
+	if (dp_ipfix_is_enabled())
+		dp_set_flow_counter(&actions[action_cnt++], &flow_count, df, agectx);
+
 	if (cross_pf_port) {
 		// move this packet to the right hairpin rx queue of pf, so as to be moved to vf
 		if (unlikely(outgoing_port->is_pf)) {
@@ -515,8 +537,9 @@ int dp_offload_handle_local_traffic(struct dp_flow *df,
 	struct rte_flow_action_set_mac set_src_mac;  // #2
 	struct rte_flow_action_set_ipv4 set_ipv4;    // #3 (optional)
 	struct rte_flow_action_age flow_age;         // #4
-	struct rte_flow_action_port_id send_to_port; // #5
-	struct rte_flow_action actions[6];           // + end
+	struct rte_flow_action_count flow_count;     // #5 (optional)
+	struct rte_flow_action_port_id send_to_port; // #6
+	struct rte_flow_action actions[7];           // + end
 	int action_cnt = 0;
 
 	// misc variables needed to create the flow
@@ -567,6 +590,10 @@ int dp_offload_handle_local_traffic(struct dp_flow *df,
 	age_action = &actions[action_cnt++];
 	dp_set_flow_age_action(age_action, &flow_age, df->conntrack->timeout_value, agectx);
 
+	// count offloaded packets for flow export
+	if (dp_ipfix_is_enabled())
+		dp_set_flow_counter(&actions[action_cnt++], &flow_count, df, agectx);
+
 	// send to the right port
 	dp_set_send_to_port_action(&actions[action_cnt++], &send_to_port, outgoing_port->port_id);
 
@@ -606,8 +633,9 @@ int dp_offload_handle_in_network_traffic(struct dp_flow *df,
 	struct rte_flow_action_set_mac set_dst_mac;  // #2
 	struct rte_flow_action_set_ipv6 set_ipv6;    // #3
 	struct rte_flow_action_age flow_age;         // #4
-	struct rte_flow_action_queue redirect_queue; // #5
-	struct rte_flow_action actions[6];           // + end
+	struct rte_flow_action_count flow_count;     // #5 (optional)
+	struct rte_flow_action_queue redirect_queue; // #6
+	struct rte_flow_action actions[7];           // + end
 	int action_cnt = 0;
 
 	// misc variables needed to create the flow
@@ -655,6 +683,10 @@ int dp_offload_handle_in_network_traffic(struct dp_flow *df,
 #endif
 						   agectx);
 
+	// count offloaded packets for flow export
+	if (dp_ipfix_is_enabled())
+		dp_set_flow_counter(&actions[action_cnt++], &flow_count, df, agectx);
+
 	// move this packet to the right hairpin rx queue of pf, so as to be moved to vf
 	// queue_index is the 1st hairpin rx queue of pf, which is paired with another hairpin tx queue of pf
 	dp_set_redirect_queue_action(&actions[action_cnt++], &redirect_queue, DP_NR_STD_RX_QUEUES);
@@ -0,0 +1,473 @@
+#!/usr/bin/env python3
+
+# SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+# SPDX-License-Identifier: Apache-2.0
+
+# Synthetic traffic benchmark
+#
+# Runs dpservice on software (net_pcap) ports, configures it via gRPC and replays a pre-generated
+# traffic mix in an infinite loop from one of the ports. Throughput is read from dpservice's own
+# telemetry, cycles per packet from graph statistics. Results are printed as JSON and can be compared
+# to a previous result to detect regressions.
+
+import argparse
+import contextlib
+import json
+import os
+import shlex
+import socket
+import statistics
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+from scapy.layers.inet import Ether, IP, TCP, UDP
+from scapy.layers.inet6 import IPv6
+from scapy.packet import Raw
+from scapy.utils import wrpcap
+
+from grpc_client import GrpcClient
+
+# Port names double as interface names for software devices
+PF0 = "net_pcap_pf0"
+PF1 = "net_pcap_pf1"
+VF0 = "net_pcap_vf0"
+VF1 = "net_pcap_vf1"
+VF_PATTERN = "net_pcap_vf"
+# MACs are not checked by dpservice on ingress, these only make packet dumps readable
+PF0_MAC = "22:22:22:22:22:00"
+ROUTER_MAC = "22:22:22:22:22:ff"
+VF0_MAC = "66:66:66:66:66:00"
+VF1_MAC = "66:66:66:66:66:01"
+
+VNI = 100
+VM1 = { 'name': "bench-vm1", 'port': VF0, 'ip': "10.100.1.1", 'ipv6': "2000:100:1::1" }
+VM2 = { 'name': "bench-vm2", 'port': VF1, 'ip': "10.100.1.2", 'ipv6': "2000:100:1::2" }
+local_ul_ipv6 = "fc00:1::1"
+router_ul_ipv6 = "fc00::ffff"
+neigh_ul_ipv6 = "fc00:2::64:0:1"
+neigh_ov_ip_route = "10.100.2.0/24"
+neigh_ov_ip_prefix = "10.100.2."
+public_ip = "45.86.6.6"
+nat_vip = "172.21.1.1"
+lb_name = "bench-lb"
+lb_ip = "172.22.2.1"
+lb_target_ul_ipv6 = "fc00:2::1"
+# TCP bulk transfer, segments of a flow follow each other so they can be merged by GRO
+tcp_segments_per_flow = 16
+tcp_segment_len = 1360
+
+TELEMETRY_SOCKET = "/var/run/dpdk/rte/dpdk_telemetry.v2"
+TELEMETRY_BUFSIZE = 65536
+
+# Graph nodes that are polled on every walk, their cycles are not tied to processed packets
+SOURCE_NODE_PREFIXES = ("rx-", "rx_periodic")
+
+# Metrics compared to the baseline and whether higher values are better
+METRICS = {
+	'rx_mpps': True,
+	'cycles_per_packet': False,
+	'flow_setup_cycles': False,
+}
+
+
+class Telemetry:
+
+	def __init__(self):
+		self.client = socket.socket(socket.AF_UNIX, socket.SOCK_SEQPACKET)
+		self.client.connect(TELEMETRY_SOCKET)
+		self.client.recv(TELEMETRY_BUFSIZE)
+
+	def close(self):
+		self.client.close()
+
+	def get(self, request):
+		self.client.send(f"{request},0\n".encode())
+		return json.loads(self.client.recv(TELEMETRY_BUFSIZE).decode())[request]
+
+	def get_graph(self, key):
+		# graph telemetry is split into blocks of nodes
+		nodes = {}
+		for block in self.get(f"/dp_service/graph/{key}").values():
+			nodes.update(block)
+		return nodes
+
+	def snapshot(self):
+		return {
+			'time': time.monotonic(),
+			'iface': self.get("/dp_service/iface/stats"),
+			'cycles': self.get_graph("cycle_count"),
+			'objs': self.get_graph("obj_count"),
+		}
+
+	def wait_for_flows(self, iface, count, timeout):
+		# Returns (time, flows) samples until the requested number of flows is reached
+		samples = []
+		end = time.monotonic() + timeout
+		while time.monotonic() < end:
+			flows = self.get("/dp_service/conntrack/flow_count").get(iface, 0)
+			samples.append((time.monotonic(), flows))
+			if flows >= count:
+				return samples
+		raise TimeoutError(f"Only {flows} out of {count} flows created")
+
+
+def is_source_node(name):
+	return name.startswith(SOURCE_NODE_PREFIXES)
+
+def node_deltas(before, after):
+	deltas = {}
+	for node, cycles in after['cycles'].items():
+		objs = after['objs'][node] - before['objs'].get(node, 0)
+		deltas[node] = (cycles - before['cycles'].get(node, 0), objs)
+	return deltas
+
+def traffic_delta(before, after, iface, key):
+	return after['iface'].get(iface, {}).get(key, 0) - before['iface'].get(iface, {}).get(key, 0)
+
+def total_delta(before, after, key):
+	return sum(traffic_delta(before, after, iface, key) for iface in after['iface'])
+
+
+def write_empty_pcap(filename):
+	with open(filename, 'wb') as f:
+		# libpcap global header, Ethernet linktype
+		f.write(struct.pack("<IHHiIII", 0xa1b2c3d4, 2, 4, 0, 0, 65535, 1))
+
+def pad(pkt, size):
+	# frame size without FCS
+	missing = size - 4 - len(pkt)
+	return pkt / Raw(b"\x00" * missing) if missing > 0 else pkt
+
+def flow_ports(flows):
+	# distinct 5-tuples via source and destination ports
+	for i in range(flows):
+		yield 1024 + i % 60000, 5000 + i // 60000
+
+
+class Scenario:
+	name = None
+	description = None
+	# traffic is generated from this port
+	traffic_port = VF0
+	traffic_iface = VM1['name']
+	# packets depend on underlay addresses assigned at runtime
+	needs_underlay = False
+	churn = False
+	# additional dpservice options
+	service_args = ""
+
+	def configure(self, grpc_client, args):
+		# The generating VM needs to be added last, because its port starts receiving once created
+		grpc_client.init()
+		VM2['ul_ipv6'] = grpc_client.addinterface(VM2['name'], VM2['port'], VNI, VM2['ip'], VM2['ipv6'])
+		grpc_client.addroute(VNI, neigh_ov_ip_route, 0, neigh_ul_ipv6)
+		grpc_client.addroute(VNI, "0.0.0.0/0", VNI, router_ul_ipv6)
+		return {}
+
+	def start_traffic(self, grpc_client, args, ctx):
+		VM1['ul_ipv6'] = grpc_client.addinterface(VM1['name'], VM1['port'], VNI, VM1['ip'], VM1['ipv6'])
+
+	def packets(self, args, ctx):
+		raise NotImplementedError
+
+
+class VfToVf(Scenario):
+	name = "vf-vf"
+	description = "UDP between two VMs on the same host"
+
+	def packets(self, args, ctx):
+		return [pad(Ether(dst=VF1_MAC, src=VF0_MAC) /
+					IP(src=VM1['ip'], dst=VM2['ip']) /
+					UDP(sport=sport, dport=dport), args.frame_size)
+				for sport, dport in flow_ports(args.flows)]
+
+class VfToPf(Scenario):
+	name = "vf-pf"
+	description = "UDP from a VM to a VM on another host (IPIP encapsulation)"
+
+	def packets(self, args, ctx):
+		return [pad(Ether(dst=VF1_MAC, src=VF0_MAC) /
+					IP(src=VM1['ip'], dst=f"{neigh_ov_ip_prefix}{1 + i % 254}") /
+					UDP(sport=sport, dport=dport), args.frame_size)
+				for i, (sport, dport) in enumerate(flow_ports(args.flows))]
+
+class Snat(Scenario):
+	name = "snat"
+	description = "UDP from a VM to the internet via NAT"
+
+	def start_traffic(self, grpc_client, args, ctx):
+		super().start_traffic(grpc_client, args, ctx)
+		# flows created before this call use a different flow key and do not interfere
+		grpc_client.addnat(VM1['name'], nat_vip, 1024, 1024 + args.flows)
+
+	def packets(self, args, ctx):
+		return [pad(Ether(dst=VF1_MAC, src=VF0_MAC) /
+					IP(src=VM1['ip'], dst=public_ip) /
+					UDP(sport=sport, dport=dport), args.frame_size)
+				for sport, dport in flow_ports(args.flows)]
+
+class Loadbalancer(Scenario):
+	name = "lb"
+	description = "UDP from the internet to a loadbalancer relayed to another host"
+	traffic_port = PF0
+	traffic_iface = PF0
+	needs_underlay = True
+
+	def configure(self, grpc_client, args):
+		super().configure(grpc_client, args)
+		super().start_traffic(grpc_client, args, None)
+		lb_ul_ipv6 = grpc_client.createlb(lb_name, VNI, lb_ip, "udp/80")
+		grpc_client.addlbtarget(lb_name, lb_target_ul_ipv6)
+		return { 'lb_ul_ipv6': lb_ul_ipv6 }
+
+	def start_traffic(self, grpc_client, args, ctx):
+		# PF is receiving all the time, traffic starts being processed once the loadbalancer exists
+		pass
+
+	def packets(self, args, ctx):
+		return [pad(Ether(dst=PF0_MAC, src=ROUTER_MAC) /
+					IPv6(src=router_ul_ipv6, dst=ctx['lb_ul_ipv6'], nh=4) /
+					IP(src=public_ip, dst=lb_ip) /
+					UDP(sport=sport, dport=80), args.frame_size)
+				for sport, _ in flow_ports(args.flows)]
+
+class Churn(Scenario):
+	name = "churn"
+	description = "Many new UDP flows from a VM to the internet"
+	churn = True
+
+	def packets(self, args, ctx):
+		return [pad(Ether(dst=VF1_MAC, src=VF0_MAC) /
+					IP(src=VM1['ip'], dst=public_ip) /
+					UDP(sport=sport, dport=dport), args.frame_size)
+				for sport, dport in flow_ports(args.churn_flows)]
+
+class TcpVfToPf(Scenario):
+	name = "tcp-vf-pf"
+	description = "TCP bulk transfer from a VM to a VM on another host"
+
+	def packets(self, args, ctx):
+		payload = b"\x00" * tcp_segment_len
+		return [Ether(dst=VF1_MAC, src=VF0_MAC) /
+				IP(src=VM1['ip'], dst=f"{neigh_ov_ip_prefix}{1 + i % 254}", flags="DF") /
+				TCP(sport=sport, dport=dport, flags="A", seq=1 + seg * tcp_segment_len) /
+				Raw(payload)
+				for i, (sport, dport) in enumerate(flow_ports(args.flows))
+				for seg in range(tcp_segments_per_flow)]
+
+class TcpVfToPfGro(TcpVfToPf):
+	name = "tcp-vf-pf-gro"
+	description = "TCP bulk transfer from a VM to a VM on another host, with software GRO/GSO"
+	service_args = "--enable-gro"
+
+SCENARIOS = { s.name: s for s in (VfToVf(), VfToPf(), Snat(), Loadbalancer(), Churn(), TcpVfToPf(), TcpVfToPfGro()) }
+
+
+class BenchService:
+
+	def __init__(self, args, workdir, scenario, pcap):
+		self.args = args
+		self.log = open(f"{workdir}/dpservice.log", 'a')
+		idle_pcap = f"{workdir}/idle.pcap"
+		if not os.path.exists(idle_pcap):
+			write_empty_pcap(idle_pcap)
+		self.cmd = f"{args.build_path}/src/dpservice-bin -l {args.lcores} --huge-unlink --no-pci"
+		for port in (PF0, PF1, VF0, VF1):
+			if port == scenario.traffic_port and pcap:
+				self.cmd += f" --vdev={port},rx_pcap={pcap},infinite_rx=1"
+			else:
+				self.cmd += f" --vdev={port},rx_pcap={idle_pcap}"
+		self.cmd += (f" -- --pf0={PF0} --pf1={PF1} --vf-pattern={VF_PATTERN} --nic-type=tap --no-offload"
+					 f" --ipv6={local_ul_ipv6} --no-stats --color=never")
+		if args.flow_table_size:
+			self.cmd += f" --flow-table-size={args.flow_table_size}"
+		if scenario.service_args:
+			self.cmd += f" {scenario.service_args}"
+
+	def __enter__(self):
+		self.log.write(f"{self.cmd}\n")
+		self.log.flush()
+		# command-line arguments are used instead of a config file
+		self.process = subprocess.Popen(shlex.split(self.cmd), env={"DP_CONF": ""},
+										stdout=self.log, stderr=subprocess.STDOUT)
+		GrpcClient.wait_for_port()
+		return self
+
+	def __exit__(self, *exc):
+		self.process.terminate()
+		try:
+			self.process.wait(5)
+		except subprocess.TimeoutExpired:
+			self.process.kill()
+			self.process.wait()
+		self.log.close()
+
+
+def measure(scenario, args, grpc_client, workdir, pcap, ctx):
+	with BenchService(args, workdir, scenario, pcap):
+		new_ctx = scenario.configure(grpc_client, args)
+		if new_ctx != ctx:
+			return None
+		tel = Telemetry()
+		try:
+			result = {}
+			if scenario.churn:
+				before = tel.snapshot()
+				scenario.start_traffic(grpc_client, args, ctx)
+				samples = tel.wait_for_flows(scenario.traffic_iface, args.churn_flows, args.warmup + args.duration)
+				filled = tel.snapshot()
+			else:
+				scenario.start_traffic(grpc_client, args, ctx)
+			time.sleep(args.warmup)
+			start = tel.snapshot()
+			time.sleep(args.duration)
+			end = tel.snapshot()
+		finally:
+			tel.close()
+
+	elapsed = end['time'] - start['time']
+	rx = traffic_delta(start, end, scenario.traffic_iface, 'rx_packets')
+	if rx == 0:
+		raise RuntimeError(f"No traffic received by {scenario.traffic_iface}, see {workdir}/dpservice.log")
+	result['rx_mpps'] = rx / elapsed / 1e6
+	result['tx_mpps'] = total_delta(start, end, 'tx_packets') / elapsed / 1e6
+	result['drop_ratio'] = total_delta(start, end, 'drop_packets') / rx
+
+	deltas = node_deltas(start, end)
+	result['nodes'] = { node: cycles / objs for node, (cycles, objs) in deltas.items() if objs > 0 }
+	result['cycles_per_packet'] = sum(cycles for cycles, objs in deltas.values() if objs > 0) / rx
+
+	if scenario.churn:
+		# cycles spent over the steady state (forwarding of known flows) divided among new flows
+		extra = 0
+		for node, (cycles, objs) in node_deltas(before, filled).items():
+			if objs > 0 and not is_source_node(node):
+				extra += cycles - objs * result['nodes'].get(node, 0)
+		flows = samples[-1][1] - samples[0][1]
+		result['flow_setup_cycles'] = extra / args.churn_flows
+		# wall-clock rate is only informative, the sampling is too coarse for small flow counts
+		if flows > 0 and samples[-1][0] > samples[0][0]:
+			result['flow_setup_rate'] = flows / (samples[-1][0] - samples[0][0])
+
+	return result
+
+
+def summarize(runs):
+	summary = {}
+	for key in ('rx_mpps', 'tx_mpps', 'drop_ratio', 'cycles_per_packet', 'flow_setup_cycles', 'flow_setup_rate'):
+		values = [run[key] for run in runs if key in run]
+		if not values:
+			continue
+		median = statistics.median(values)
+		summary[key] = {
+			'median': median,
+			'min': min(values),
+			'max': max(values),
+			'rsd': statistics.pstdev(values) / median if median else 0,
+		}
+	nodes = {}
+	for node in runs[0]['nodes']:
+		values = [run['nodes'][node] for run in runs if node in run['nodes']]
+		nodes[node] = statistics.median(values)
+	summary['nodes'] = nodes
+	return summary
+
+def run_scenario(scenario, args, grpc_client, workdir):
+	pcap = f"{workdir}/{scenario.name}.pcap"
+	ctx = {}
+	if scenario.needs_underlay:
+		# Underlay addresses are only known once configured, first run without traffic to get them
+		with BenchService(args, workdir, scenario, None):
+			ctx = scenario.configure(grpc_client, args)
+	wrpcap(pcap, scenario.packets(args, ctx))
+
+	runs = []
+	for i in range(args.repeat):
+		result = measure(scenario, args, grpc_client, workdir, pcap, ctx)
+		if result is None:
+			return { 'skipped': "Underlay addresses differ between runs (build with -Denable_static_underlay_ip=true)" }
+		print(f"{scenario.name} #{i}: {result['rx_mpps']:.3f} Mpps, {result['cycles_per_packet']:.1f} cycles/packet",
+			  file=sys.stderr)
+		runs.append(result)
+	return { 'description': scenario.description, 'runs': runs, 'summary': summarize(runs) }
+
+def compare(results, baseline, threshold):
+	regressions = []
+	for name, result in results.items():
+		base = baseline.get('scenarios', {}).get(name, {}).get('summary')
+		if not base or 'summary' not in result:
+			continue
+		for metric, higher_is_better in METRICS.items():
+			if metric not in base or metric not in result['summary']:
+				continue
+			old = base[metric]['median']
+			new = result['summary'][metric]['median']
+			if not old:
+				continue
+			change = (new - old) / old * 100
+			if (change < -threshold) if higher_is_better else (change > threshold):
+				regressions.append({ 'scenario': name, 'metric': metric, 'baseline': old, 'current': new, 'change_percent': change })
+		# per-node cost shows which node regressed, even if the total is within the threshold
+		for node, old in base.get('nodes', {}).items():
+			new = result['summary']['nodes'].get(node)
+			if not old or new is None or is_source_node(node):
+				continue
+			change = (new - old) / old * 100
+			if change > threshold:
+				regressions.append({ 'scenario': name, 'metric': f"nodes.{node}", 'baseline': old, 'current': new, 'change_percent': change })
+	return regressions
+
+
+if __name__ == '__main__':
+	script_path = os.path.dirname(os.path.abspath(__file__))
+	parser = argparse.ArgumentParser(description="Synthetic traffic benchmark of dpservice using software ports")
+	parser.add_argument("--build-path", action="store", default=f"{script_path}/../build", help="Path to the root build directory")
+	parser.add_argument("--scenario", action="append", choices=SCENARIOS.keys(), help="Scenario to run (can be used multiple times, default: all)")
+	parser.add_argument("--lcores", action="store", default="0,1", help="EAL lcore list (main lcore, worker lcore), pin for reproducible results")
+	parser.add_argument("--frame-size", type=int, default=64, help="Size of generated frames including FCS")
+	parser.add_argument("--flows", type=int, default=256, help="Number of flows in the traffic mix")
+	parser.add_argument("--churn-flows", type=int, default=16384, help="Number of new flows in the churn scenario")
+	parser.add_argument("--flow-table-size", type=int, help="Flow table capacity to use")
+	parser.add_argument("--warmup", type=float, default=2, help="Seconds of traffic before measuring")
+	parser.add_argument("--duration", type=float, default=5, help="Seconds of traffic to measure")
+	parser.add_argument("--repeat", type=int, default=3, help="Number of runs of each scenario (dpservice is restarted for every run)")
+	parser.add_argument("--output", action="store", help="Write results to this file instead of standard output")
+	parser.add_argument("--baseline", action="store", help="Compare results to a previous output and fail on regressions")
+	parser.add_argument("--threshold", type=float, default=5, help="Allowed change in percent when comparing to the baseline")
+	args = parser.parse_args()
+
+	if not os.access(f"{args.build_path}/src/dpservice-bin", os.X_OK):
+		print(f"No runnable dpservice binary in {args.build_path}", file=sys.stderr)
+		sys.exit(1)
+
+	grpc_client = GrpcClient(args.build_path)
+	results = {}
+	with tempfile.TemporaryDirectory(prefix="dp_benchmark_") as workdir:
+		# gRPC client is verbose, keep standard output machine-readable
+		with contextlib.redirect_stdout(sys.stderr):
+			for name in args.scenario or SCENARIOS.keys():
+				results[name] = run_scenario(SCENARIOS[name], args, grpc_client, workdir)
+
+	output = {
+		'config': { key: value for key, value in vars(args).items() if key not in ('output', 'baseline') },
+		'scenarios': results,
+	}
+	if args.baseline:
+		with open(args.baseline) as f:
+			output['regressions'] = compare(results, json.load(f), args.threshold)
+
+	if args.output:
+		with open(args.output, 'w') as f:
+			json.dump(output, f, indent=2)
+	else:
+		json.dump(output, sys.stdout, indent=2)
+		print()
+
+	if output.get('regressions'):
+		for regression in output['regressions']:
+			print(f"Regression in {regression['scenario']}: {regression['metric']} {regression['baseline']:.3f} -> "
+				  f"{regression['current']:.3f} ({regression['change_percent']:+.1f}%)", file=sys.stderr)
+		sys.exit(1)
@@ -102,9 +102,21 @@ virtsvc_tcp_virtual_port = 4443
 sniff_timeout = 2
 sniff_short_timeout = 1
 grpc_port = 1337
+telemetry_bufsize = 10240
+ipfix_port = 4739
+# must match TIMER_DP_MAINTENANCE_INTERVAL in dp_timers.c, every VM gets GARP/ND messages this often
+periodic_msg_interval = 30
 
 # Extra testing options
 flow_timeout = 1
+flow_table_size = 64
+flow_table_max_size = 256
+flow_limit = 12
+flow_rate_limit = 8
+syn_limit = 2
+idle_sleep_max = 100
+# generous, this is measured by scapy via TAP devices
+idle_wakeup_max_latency = 0.02
 
 
 class PFSpec:
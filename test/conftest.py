@@ -22,6 +22,18 @@ def pytest_addoption(parser):
 	parser.addoption(
 		"--fast-flow-timeout", action="store_true", help="Test with fast flow timeout"
 	)
+	parser.addoption(
+		"--adaptive-polling", action="store_true", help="Test with adaptive idle polling of the worker"
+	)
+	parser.addoption(
+		"--small-flow-table", action="store_true", help="Test with a small flow table that needs to grow"
+	)
+	parser.addoption(
+		"--no-tx-cksum-offload", action="store_true", help="Test with all Tx checksums computed in software"
+	)
+	parser.addoption(
+		"--flow-limits", action="store", choices=["drop", "monitor"], help="Test with low per-interface flow limits using this policy"
+	)
 	parser.addoption(
 		"--virtsvc", action="store_true", help="Include virtual services tests"
 	)
@@ -53,6 +65,18 @@ def port_redundancy(request):
 def fast_flow_timeout(request):
 	return request.config.getoption("--fast-flow-timeout")
 
+@pytest.fixture(scope="package")
+def adaptive_polling(request):
+	return request.config.getoption("--adaptive-polling")
+
+@pytest.fixture(scope="package")
+def small_flow_table(request):
+	return request.config.getoption("--small-flow-table")
+
+@pytest.fixture(scope="package")
+def flow_limit_policy(request):
+	return request.config.getoption("--flow-limits")
+
 @pytest.fixture(scope="package")
 def grpc_client(request, build_path):
 	if request.config.getoption("--dpgrpc"):
@@ -62,9 +86,14 @@ def grpc_client(request, build_path):
 
 # All tests require dp_service to be running
 @pytest.fixture(scope="package")
-def dp_service(request, build_path, port_redundancy, fast_flow_timeout):
+def dp_service(request, build_path, port_redundancy, fast_flow_timeout, adaptive_polling, small_flow_table,
+			   flow_limit_policy):
 
 	dp_service = DpService(build_path, port_redundancy, fast_flow_timeout,
+						   adaptive_polling = adaptive_polling,
+						   small_flow_table = small_flow_table,
+						   flow_limit_policy = flow_limit_policy,
+						   no_tx_cksum_offload = request.config.getoption("--no-tx-cksum-offload"),
 						   test_virtsvc = request.config.getoption("--virtsvc"),
 						   hardware = request.config.getoption("--hw"),
 						   offloading = request.config.getoption("--offloading"),
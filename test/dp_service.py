@@ -17,8 +17,9 @@ class DpService:
 
 	DP_SERVICE_CONF = "/tmp/dp_service.conf"
 
-	def __init__(self, build_path, port_redundancy, fast_flow_timeout,
-				 gdb=False, test_virtsvc=False, hardware=False, offloading=False, graphtrace=False):
+	def __init__(self, build_path, port_redundancy, fast_flow_timeout, adaptive_polling=False,
+				 gdb=False, test_virtsvc=False, hardware=False, offloading=False, graphtrace=False,
+				 small_flow_table=False, flow_limit_policy=None, no_tx_cksum_offload=False):
 		self.build_path = build_path
 		self.port_redundancy = port_redundancy
 		self.hardware = hardware
@@ -49,11 +50,13 @@ class DpService:
 		if not self.hardware:
 			self.cmd +=  f' --pf0={PF0.tap} --pf1={PF1.tap} --vf-pattern={vf_tap_pattern} --nic-type=tap'
 		self.cmd +=	(f' --ipv6={local_ul_ipv6} --enable-ipv6-overlay'
-					 f' --dhcp-mtu={dhcp_mtu}'
+					 f' --dhcp-mtu={dhcp_mtu} --enable-mss-clamp --enable-gro'
 					 f' --dhcp-dns="{dhcp_dns1}" --dhcp-dns="{dhcp_dns2}"'
 					 f' --dhcpv6-dns="{dhcpv6_dns1}" --dhcpv6-dns="{dhcpv6_dns2}"'
 					 f' --grpc-port={grpc_port}'
+					 f' --ipfix-collector=127.0.0.1,{ipfix_port}'
 					  ' --no-stats'
+					  ' --latency-sampling=100'
 					  ' --color=auto')
 		if graphtrace:
 			self.cmd += ' --graphtrace-loglevel=1'
@@ -64,6 +67,15 @@ class DpService:
 			self.cmd += ' --wcmp=50'
 		if fast_flow_timeout:
 			self.cmd += f' --flow-timeout={flow_timeout}'
+		if adaptive_polling:
+			self.cmd += f' --idle-poll=adaptive --idle-sleep-max={idle_sleep_max}'
+		if small_flow_table:
+			self.cmd += f' --flow-table-size={flow_table_size} --flow-table-max-size={flow_table_max_size}'
+		if no_tx_cksum_offload:
+			self.cmd += ' --no-tx-cksum-offload'
+		if flow_limit_policy:
+			self.cmd += (f' --flow-limit={flow_limit} --flow-rate-limit={flow_rate_limit} --syn-limit={syn_limit}'
+						 f' --flow-limit-policy={flow_limit_policy}')
 		if test_virtsvc:
 			self.cmd += (f' --udp-virtsvc="{virtsvc_udp_virtual_ip},{virtsvc_udp_virtual_port},{virtsvc_udp_svc_ipv6},{virtsvc_udp_svc_port}"'
 						 f' --tcp-virtsvc="{virtsvc_tcp_virtual_ip},{virtsvc_tcp_virtual_port},{virtsvc_tcp_svc_ipv6},{virtsvc_tcp_svc_port}"')
@@ -158,6 +170,10 @@ if __name__ == '__main__':
 	parser.add_argument("--build-path", action="store", default=f"{script_path}/../build", help="Path to the root build directory")
 	parser.add_argument("--port-redundancy", action="store_true", help="Set up two physical ports")
 	parser.add_argument("--fast-flow-timeout", action="store_true", help="Test with fast flow timeout value")
+	parser.add_argument("--adaptive-polling", action="store_true", help="Let the idle worker back off instead of busy polling")
+	parser.add_argument("--small-flow-table", action="store_true", help="Start with a small flow table that needs to grow")
+	parser.add_argument("--no-tx-cksum-offload", action="store_true", help="Compute all Tx checksums in software")
+	parser.add_argument("--flow-limits", choices=["drop", "monitor"], help="Set low per-interface flow limits with this policy")
 	parser.add_argument("--virtsvc", action="store_true", help="Enable virtual service tests")
 	parser.add_argument("--no-init", action="store_true", help="Do not set interfaces up automatically")
 	parser.add_argument("--init-only", action="store_true", help="Only init interfaces of a running service")
@@ -168,6 +184,10 @@ if __name__ == '__main__':
 	dp_service = DpService(args.build_path,
 						   args.port_redundancy,
 						   args.fast_flow_timeout,
+						   adaptive_polling=args.adaptive_polling,
+						   small_flow_table=args.small_flow_table,
+						   flow_limit_policy=args.flow_limits,
+						   no_tx_cksum_offload=args.no_tx_cksum_offload,
 						   gdb=args.gdb,
 						   test_virtsvc=args.virtsvc,
 						   hardware=args.hw)
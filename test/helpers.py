@@ -1,6 +1,7 @@
 # SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
 # SPDX-License-Identifier: Apache-2.0
 
+import json
 import shlex
 import time
 
@@ -77,7 +78,7 @@ def delayed_sendp(packet, interface):
 
 def run_command(cmd):
 	print(cmd)
-	subprocess.check_output(shlex.split(cmd))
+	return subprocess.check_output(shlex.split(cmd)).decode()
 
 def interface_init(interface, enabled=True):
 	if enabled:
@@ -165,3 +166,11 @@ def age_out_flows():
 	delay = flow_timeout+1  # timers run every 1s, this should always work
 	print(f"Waiting {delay}s for flows to age-out...")
 	time.sleep(delay)
+
+
+def get_telemetry(request):
+	with socket.socket(socket.AF_UNIX, socket.SOCK_SEQPACKET) as client:
+		client.connect("/var/run/dpdk/rte/dpdk_telemetry.v2")
+		client.recv(telemetry_bufsize)
+		client.send(f"{request},0\n".encode())
+		return json.loads(client.recv(telemetry_bufsize).decode())[request]
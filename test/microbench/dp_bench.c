@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dp_bench.h"
+#include <errno.h>
+#include <inttypes.h>
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
+#include "dp_error.h"
+#include "dp_log.h"
+
+#define DP_BENCH_NAME_FMT "%-24s"
+
+static int cache_misses_fd = -1;
+static volatile uintptr_t bench_sink;
+
+static int dp_bench_open_cache_misses(void)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = PERF_COUNT_HW_CACHE_MISSES;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	// this thread only, any CPU
+	return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t dp_bench_read_cache_misses(void)
+{
+	uint64_t value;
+
+	if (cache_misses_fd < 0 || read(cache_misses_fd, &value, sizeof(value)) != sizeof(value))
+		return 0;
+
+	return value;
+}
+
+int dp_bench_init(void)
+{
+	cache_misses_fd = dp_bench_open_cache_misses();
+	if (cache_misses_fd < 0)
+		// common in containers and VMs, timing is still useful on its own
+		DPS_LOG_WARNING("Cache miss counter not available", DP_LOG_RET(-errno));
+	else
+		ioctl(cache_misses_fd, PERF_EVENT_IOC_ENABLE, 0);
+
+	printf(DP_BENCH_NAME_FMT " %10s %10s %12s %16s\n", "benchmark", "ops", "ns/op", "cycles/op", "cache-misses/op");
+	return DP_OK;
+}
+
+void dp_bench_free(void)
+{
+	if (cache_misses_fd >= 0) {
+		close(cache_misses_fd);
+		cache_misses_fd = -1;
+	}
+}
+
+void dp_bench_start(struct dp_bench *bench, const char *name, uint64_t ops)
+{
+	bench->name = name;
+	bench->ops = ops;
+	bench->start_misses = dp_bench_read_cache_misses();
+	bench->start_tsc = rte_rdtsc_precise();
+}
+
+void dp_bench_stop(struct dp_bench *bench)
+{
+	uint64_t cycles = rte_rdtsc_precise() - bench->start_tsc;
+	uint64_t misses = dp_bench_read_cache_misses() - bench->start_misses;
+	double ops = bench->ops ? (double)bench->ops : 1.0;
+	double cycles_per_op = (double)cycles / ops;
+	double ns_per_op = cycles_per_op * 1e9 / (double)rte_get_tsc_hz();
+
+	if (cache_misses_fd >= 0)
+		printf(DP_BENCH_NAME_FMT " %10" PRIu64 " %10.1f %12.1f %16.3f\n",
+			   bench->name, bench->ops, ns_per_op, cycles_per_op, (double)misses / ops);
+	else
+		printf(DP_BENCH_NAME_FMT " %10" PRIu64 " %10.1f %12.1f %16s\n",
+			   bench->name, bench->ops, ns_per_op, cycles_per_op, "n/a");
+	fflush(stdout);
+}
+
+void dp_bench_consume(uintptr_t value)
+{
+	bench_sink += value;
+}
+
+uint32_t *dp_bench_shuffled_indices(uint32_t count)
+{
+	uint32_t *indices = rte_malloc("bench_indices", count * sizeof(*indices), 0);
+	uint32_t tmp;
+	uint32_t pos;
+
+	if (!indices) {
+		DPS_LOG_ERR("Cannot allocate benchmark indices", DP_LOG_VALUE(count));
+		return NULL;
+	}
+
+	for (uint32_t i = 0; i < count; ++i)
+		indices[i] = i;
+
+	// Fisher-Yates
+	for (uint32_t i = count ? count - 1 : 0; i > 0; --i) {
+		pos = (uint32_t)rte_rand_max(i + 1);
+		tmp = indices[i];
+		indices[i] = indices[pos];
+		indices[pos] = tmp;
+	}
+
+	return indices;
+}
@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __DP_BENCH_H__
+#define __DP_BENCH_H__
+
+#include <stdint.h>
+#include "dp_port.h"
+
+// fixed seed so that all runs work on the same data
+#define DP_BENCH_SEED		0xdeadbeef
+
+struct dp_bench {
+	const char	*name;
+	uint64_t	ops;
+	uint64_t	start_tsc;
+	uint64_t	start_misses;
+};
+
+int dp_bench_init(void);
+void dp_bench_free(void);
+
+void dp_bench_start(struct dp_bench *bench, const char *name, uint64_t ops);
+void dp_bench_stop(struct dp_bench *bench);
+
+// prevent the compiler from optimizing measured calls away
+void dp_bench_consume(uintptr_t value);
+
+// returns a random permutation of 0..count-1 (to be freed via rte_free())
+uint32_t *dp_bench_shuffled_indices(uint32_t count);
+
+// individual suites, return DP_OK/DP_ERROR
+int dp_bench_flow(void);
+int dp_bench_lpm(const struct dp_port *pf, const struct dp_port *vf);
+int dp_bench_nat(const struct dp_port *vf);
+int dp_bench_firewall(struct dp_port *vf, const struct dp_port *pf);
+int dp_bench_lb(void);
+int dp_bench_vnf(const struct dp_port *vf);
+
+#endif
@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dp_bench.h"
+#include <stdio.h>
+#include <netinet/in.h>
+#include "dp_error.h"
+#include "dp_firewall.h"
+#include "dp_log.h"
+#include "dp_mbuf_dyn.h"
+
+#define DP_BENCH_FWALL_RULES	1000
+#define DP_BENCH_FWALL_LOOKUPS	(64 * 1024)
+
+static int dp_bench_add_fwall_rule(struct dp_port *port, uint32_t index, uint32_t dst_ip, uint32_t dst_mask)
+{
+	struct dp_fwall_rule rule = {
+		.priority = 1000,
+		.protocol = IPPROTO_UDP,
+		.filter.tcp_udp = {
+			.src_port = { .lower = DP_FWALL_MATCH_ANY_PORT, .upper = DP_FWALL_MATCH_ANY_PORT },
+			.dst_port = { .lower = DP_FWALL_MATCH_ANY_PORT, .upper = DP_FWALL_MATCH_ANY_PORT },
+		},
+		.action = DP_FWALL_ACCEPT,
+		.dir = DP_FWALL_EGRESS,
+	};
+
+	snprintf(rule.rule_id, sizeof(rule.rule_id), "bench-rule-%u", index);
+	DP_SET_IPADDR4(rule.src_ip, 0);
+	rule.src_mask.ip4 = 0;
+	DP_SET_IPADDR4(rule.dest_ip, dst_ip);
+	rule.dest_mask.ip4 = dst_mask;
+
+	return dp_add_firewall_rule(&rule, port);
+}
+
+int dp_bench_firewall(struct dp_port *vf, const struct dp_port *pf)
+{
+	struct dp_flow df = {0};
+	struct dp_bench bench;
+	int ret = DP_ERROR;
+
+	// none of these match the tested flow, only the last catch-all rule does (worst case)
+	for (uint32_t i = 0; i < DP_BENCH_FWALL_RULES - 1; ++i) {
+		if (DP_FAILED(dp_bench_add_fwall_rule(vf, i, RTE_IPV4(172, 16, 0, 0) + (i << 8), 0xFFFFFF00))) {
+			DPS_LOG_ERR("Cannot add firewall rule", DP_LOG_VALUE(i));
+			goto cleanup;
+		}
+	}
+	if (DP_FAILED(dp_bench_add_fwall_rule(vf, DP_BENCH_FWALL_RULES - 1, 0, 0))) {
+		DPS_LOG_ERR("Cannot add firewall rule", DP_LOG_VALUE(DP_BENCH_FWALL_RULES - 1));
+		goto cleanup;
+	}
+
+	df.l3_type = RTE_ETHER_TYPE_IPV4;
+	df.src.src_addr = htonl(RTE_IPV4(192, 168, 1, 1));
+	df.dst.dst_addr = htonl(RTE_IPV4(8, 8, 8, 8));
+	df.l4_type = IPPROTO_UDP;
+	df.l4_info.trans_port.src_port = htons(12345);
+	df.l4_info.trans_port.dst_port = htons(53);
+
+	dp_bench_start(&bench, "firewall_1000_rules", DP_BENCH_FWALL_LOOKUPS);
+	for (uint32_t i = 0; i < DP_BENCH_FWALL_LOOKUPS; ++i)
+		dp_bench_consume((uintptr_t)dp_get_firewall_action(&df, vf, pf));
+	dp_bench_stop(&bench);
+
+	ret = DP_OK;
+
+cleanup:
+	dp_del_all_firewall_rules(vf);
+	return ret;
+}
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dp_bench.h"
+#include <string.h>
+#include <netinet/in.h>
+#include <rte_malloc.h>
+#include "dp_error.h"
+#include "dp_flow.h"
+#include "dp_log.h"
+
+#define DP_BENCH_FLOW_COUNT		(1024 * 1024)
+#define DP_BENCH_FLOW_VNI		100
+#define DP_BENCH_FLOW_MISS_VNI	200
+
+static void dp_bench_fill_flow_key(struct flow_key *key, uint32_t index, uint32_t vni)
+{
+	memset(key, 0, sizeof(*key));
+	// 16k different sources, 64 ports each, all going to the same HTTPS server
+	DP_SET_IPADDR4(key->l3_src, RTE_IPV4(10, 0, 0, 0) + index / 64);
+	DP_SET_IPADDR4(key->l3_dst, RTE_IPV4(45, 86, 6, 6));
+	key->src.port_src = (uint16_t)(1024 + index % 64);
+	key->port_dst = 443;
+	key->proto = IPPROTO_TCP;
+	key->vni = vni;
+	key->vnf_type = DP_VNF_TYPE_UNDEFINED;
+}
+
+int dp_bench_flow(void)
+{
+	// the table only stores the pointer, all keys can share one value
+	static struct flow_value flow_val;
+	struct flow_value *found;
+	struct flow_key *keys;
+	struct flow_key miss_key;
+	uint32_t *order;
+	struct dp_bench bench;
+	int ret = DP_ERROR;
+
+	keys = rte_malloc("bench_flow_keys", DP_BENCH_FLOW_COUNT * sizeof(*keys), RTE_CACHE_LINE_SIZE);
+	if (!keys) {
+		DPS_LOG_ERR("Cannot allocate flow keys");
+		return DP_ERROR;
+	}
+
+	order = dp_bench_shuffled_indices(DP_BENCH_FLOW_COUNT);
+	if (!order)
+		goto free_keys;
+
+	for (uint32_t i = 0; i < DP_BENCH_FLOW_COUNT; ++i)
+		dp_bench_fill_flow_key(&keys[i], i, DP_BENCH_FLOW_VNI);
+
+	dp_bench_start(&bench, "flow_insert", DP_BENCH_FLOW_COUNT);
+	for (uint32_t i = 0; i < DP_BENCH_FLOW_COUNT; ++i) {
+		if (DP_FAILED(dp_add_flow(&keys[i], &flow_val))) {
+			DPS_LOG_ERR("Flow table full, increase --flow-table-size", DP_LOG_VALUE(i));
+			goto free_order;
+		}
+	}
+	dp_bench_stop(&bench);
+
+	dp_bench_start(&bench, "flow_lookup_hit", DP_BENCH_FLOW_COUNT);
+	for (uint32_t i = 0; i < DP_BENCH_FLOW_COUNT; ++i) {
+		dp_get_flow(&keys[order[i]], &found);
+		dp_bench_consume((uintptr_t)found);
+	}
+	dp_bench_stop(&bench);
+
+	// key construction is part of the measurement here, but is negligible compared to a miss
+	dp_bench_start(&bench, "flow_lookup_miss", DP_BENCH_FLOW_COUNT);
+	for (uint32_t i = 0; i < DP_BENCH_FLOW_COUNT; ++i) {
+		dp_bench_fill_flow_key(&miss_key, order[i], DP_BENCH_FLOW_MISS_VNI);
+		dp_bench_consume((uintptr_t)dp_get_flow(&miss_key, &found));
+	}
+	dp_bench_stop(&bench);
+
+	dp_bench_start(&bench, "flow_delete", DP_BENCH_FLOW_COUNT);
+	for (uint32_t i = 0; i < DP_BENCH_FLOW_COUNT; ++i)
+		dp_delete_flow(&keys[order[i]]);
+	dp_bench_stop(&bench);
+
+	ret = DP_OK;
+
+free_order:
+	rte_free(order);
+free_keys:
+	rte_free(keys);
+	return ret;
+}
@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dp_bench.h"
+#include <stdio.h>
+#include <string.h>
+#include <netinet/in.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
+#include "dp_error.h"
+#include "dp_flow.h"
+#include "dp_lb.h"
+#include "dp_log.h"
+#include "grpc/dp_grpc_api.h"
+
+// stays under the default --lb-table-size
+#define DP_BENCH_LB_COUNT		200
+#define DP_BENCH_LB_VNI			100
+#define DP_BENCH_LB_LOOKUPS		(1024 * 1024)
+
+static const uint8_t bench_lb_ul_ipv6[DP_IPV6_ADDR_SIZE] = {
+	0x20, 0x01, 0x0d, 0xb8, 0xff, 0xff, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x03
+};
+
+static inline uint32_t dp_bench_lb_ip(uint32_t index)
+{
+	return RTE_IPV4(10, 200, 0, 0) + index;
+}
+
+static void dp_bench_lb_id(char lb_id[DP_LB_ID_MAX_LEN], uint32_t index)
+{
+	// the ID is used as a hash key, so the unused part needs to be zeroed
+	memset(lb_id, 0, DP_LB_ID_MAX_LEN);
+	snprintf(lb_id, DP_LB_ID_MAX_LEN, "bench-lb-%u", index);
+}
+
+static int dp_bench_lb_setup(void)
+{
+	struct dpgrpc_lb lb;
+	uint8_t back_ip[DP_IPV6_ADDR_SIZE] = { 0x20, 0x01, 0x0d, 0xb8, 0xbb, 0xbb };
+	int ret;
+
+	for (uint32_t i = 0; i < DP_BENCH_LB_COUNT; ++i) {
+		memset(&lb, 0, sizeof(lb));
+		dp_bench_lb_id(lb.lb_id, i);
+		DP_SET_IPADDR4(lb.addr, dp_bench_lb_ip(i));
+		lb.vni = DP_BENCH_LB_VNI;
+		lb.lbports[0].protocol = IPPROTO_TCP;
+		lb.lbports[0].port = 80;
+		ret = dp_create_lb(&lb, bench_lb_ul_ipv6);
+		if (DP_FAILED(ret)) {
+			DPS_LOG_ERR("Cannot create loadbalancer", DP_LOG_VALUE(i), DP_LOG_RET(ret));
+			return DP_ERROR;
+		}
+		for (uint32_t b = 0; b < DP_LB_MAX_IPS_PER_VIP; ++b) {
+			back_ip[12] = (uint8_t)(i >> 8);
+			back_ip[13] = (uint8_t)i;
+			back_ip[15] = (uint8_t)b;
+			ret = dp_add_lb_back_ip(lb.lb_id, back_ip, DP_IPV6_ADDR_SIZE);
+			if (DP_FAILED(ret)) {
+				DPS_LOG_ERR("Cannot add loadbalancer target", DP_LOG_VALUE(b), DP_LOG_RET(ret));
+				return DP_ERROR;
+			}
+		}
+	}
+	return DP_OK;
+}
+
+static void dp_bench_lb_teardown(void)
+{
+	char lb_id[DP_LB_ID_MAX_LEN];
+
+	for (uint32_t i = 0; i < DP_BENCH_LB_COUNT; ++i) {
+		dp_bench_lb_id(lb_id, i);
+		dp_delete_lb(lb_id);
+	}
+}
+
+int dp_bench_lb(void)
+{
+	struct flow_key *keys;
+	struct dp_bench bench;
+	int ret = DP_ERROR;
+
+	keys = rte_zmalloc("bench_lb_keys", DP_BENCH_LB_LOOKUPS * sizeof(*keys), RTE_CACHE_LINE_SIZE);
+	if (!keys) {
+		DPS_LOG_ERR("Cannot allocate loadbalancer keys");
+		return DP_ERROR;
+	}
+
+	if (DP_FAILED(dp_bench_lb_setup()))
+		goto teardown;
+
+	for (uint32_t i = 0; i < DP_BENCH_LB_LOOKUPS; ++i) {
+		DP_SET_IPADDR4(keys[i].l3_dst, dp_bench_lb_ip((uint32_t)rte_rand_max(DP_BENCH_LB_COUNT)));
+		keys[i].port_dst = 80;
+		keys[i].proto = IPPROTO_TCP;
+	}
+
+	dp_bench_start(&bench, "lb_get_backend_ip", DP_BENCH_LB_LOOKUPS);
+	for (uint32_t i = 0; i < DP_BENCH_LB_LOOKUPS; ++i)
+		dp_bench_consume((uintptr_t)dp_lb_get_backend_ip(&keys[i], DP_BENCH_LB_VNI));
+	dp_bench_stop(&bench);
+
+	ret = DP_OK;
+
+teardown:
+	dp_bench_lb_teardown();
+	rte_free(keys);
+	return ret;
+}
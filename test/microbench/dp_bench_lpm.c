@@ -0,0 +1,104 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dp_bench.h"
+#include <netinet/in.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
+#include "dp_error.h"
+#include "dp_log.h"
+#include "dp_lpm.h"
+#include "dp_mbuf_dyn.h"
+#include "dp_vni.h"
+
+// Route tables are created with IPV4_DP_RIB_MAX_RULES nodes per VNI,
+// so 100k routes need to be spread over multiple VNIs
+#define DP_BENCH_LPM_VNI_COUNT		250
+#define DP_BENCH_LPM_ROUTES_PER_VNI	400
+#define DP_BENCH_LPM_FIRST_VNI		1000
+#define DP_BENCH_LPM_LOOKUPS		(1024 * 1024)
+
+static const uint8_t bench_route_nh_ipv6[DP_IPV6_ADDR_SIZE] = {
+	0x20, 0x01, 0x0d, 0xb8, 0xff, 0xff, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01
+};
+
+// /24 routes scattered over the 10.0.0.0/8 range
+static inline uint32_t dp_bench_lpm_route_ip(uint32_t index)
+{
+	return RTE_IPV4(10, 0, 0, 0) + ((index * 97) << 8);
+}
+
+struct dp_bench_lpm_query {
+	uint32_t vni;
+	uint32_t dst_ip;
+};
+
+static int dp_bench_lpm_setup(const struct dp_port *pf)
+{
+	uint32_t vni;
+	int ret;
+
+	for (uint32_t v = 0; v < DP_BENCH_LPM_VNI_COUNT; ++v) {
+		vni = DP_BENCH_LPM_FIRST_VNI + v;
+		if (DP_FAILED(dp_create_vni_route_tables(vni, (int)rte_socket_id()))) {
+			DPS_LOG_ERR("Cannot create route tables", DP_LOG_VNI(vni));
+			return DP_ERROR;
+		}
+		for (uint32_t r = 0; r < DP_BENCH_LPM_ROUTES_PER_VNI; ++r) {
+			ret = dp_add_route(pf, vni, vni, dp_bench_lpm_route_ip(r), bench_route_nh_ipv6, 24);
+			if (DP_FAILED(ret)) {
+				DPS_LOG_ERR("Cannot add route", DP_LOG_VNI(vni), DP_LOG_VALUE(r), DP_LOG_RET(ret));
+				return DP_ERROR;
+			}
+		}
+	}
+	return DP_OK;
+}
+
+static void dp_bench_lpm_teardown(void)
+{
+	for (uint32_t v = 0; v < DP_BENCH_LPM_VNI_COUNT; ++v)
+		dp_delete_vni_route_tables(DP_BENCH_LPM_FIRST_VNI + v);
+}
+
+int dp_bench_lpm(const struct dp_port *pf, const struct dp_port *vf)
+{
+	struct dp_bench_lpm_query *queries;
+	struct dp_iface_route route;
+	struct dp_flow df = {0};
+	uint32_t route_key;
+	uint32_t route_index;
+	struct dp_bench bench;
+	int ret = DP_ERROR;
+
+	queries = rte_malloc("bench_lpm_queries", DP_BENCH_LPM_LOOKUPS * sizeof(*queries), RTE_CACHE_LINE_SIZE);
+	if (!queries) {
+		DPS_LOG_ERR("Cannot allocate LPM queries");
+		return DP_ERROR;
+	}
+
+	if (DP_FAILED(dp_bench_lpm_setup(pf)))
+		goto teardown;
+
+	// every query hits one of the installed routes, in a random VNI
+	for (uint32_t i = 0; i < DP_BENCH_LPM_LOOKUPS; ++i) {
+		route_index = (uint32_t)rte_rand_max(DP_BENCH_LPM_ROUTES_PER_VNI);
+		queries[i].vni = DP_BENCH_LPM_FIRST_VNI + (uint32_t)rte_rand_max(DP_BENCH_LPM_VNI_COUNT);
+		queries[i].dst_ip = htonl(dp_bench_lpm_route_ip(route_index) + (uint32_t)rte_rand_max(256));
+	}
+
+	df.l3_type = RTE_ETHER_TYPE_IPV4;
+	dp_bench_start(&bench, "lpm_lookup", DP_BENCH_LPM_LOOKUPS);
+	for (uint32_t i = 0; i < DP_BENCH_LPM_LOOKUPS; ++i) {
+		df.dst.dst_addr = queries[i].dst_ip;
+		dp_bench_consume((uintptr_t)dp_get_ip4_out_port(vf, queries[i].vni, &df, &route, &route_key));
+	}
+	dp_bench_stop(&bench);
+
+	ret = DP_OK;
+
+teardown:
+	dp_bench_lpm_teardown();
+	rte_free(queries);
+	return ret;
+}
@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dp_bench.h"
+#include <string.h>
+#include <netinet/in.h>
+#include "dp_error.h"
+#include "dp_flow.h"
+#include "dp_log.h"
+#include "dp_mbuf_dyn.h"
+#include "dp_nat.h"
+
+#define DP_BENCH_NAT_VNI			100
+#define DP_BENCH_NAT_IFACE_IP		RTE_IPV4(192, 168, 1, 1)
+#define DP_BENCH_NAT_IP				RTE_IPV4(45, 86, 6, 1)
+#define DP_BENCH_NAT_DST_IP			RTE_IPV4(45, 86, 100, 100)
+#define DP_BENCH_NAT_MIN_PORT		1024
+#define DP_BENCH_NAT_RANGE			16384
+// allocation needs to probe further as the range fills up, this is the interesting case
+#define DP_BENCH_NAT_PREFILL		(DP_BENCH_NAT_RANGE * 95 / 100)
+#define DP_BENCH_NAT_PREFILL_SPORT	1024
+#define DP_BENCH_NAT_CHURN_SPORT	(DP_BENCH_NAT_PREFILL_SPORT + DP_BENCH_NAT_PREFILL)
+#define DP_BENCH_NAT_CHURN			(128 * 1024)
+
+static const uint8_t bench_nat_ul_ipv6[DP_IPV6_ADDR_SIZE] = {
+	0x20, 0x01, 0x0d, 0xb8, 0xff, 0xff, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02
+};
+
+static void dp_bench_nat_fill_df(struct dp_flow *df, uint16_t src_port)
+{
+	memset(df, 0, sizeof(*df));
+	df->l3_type = RTE_ETHER_TYPE_IPV4;
+	df->src.src_addr = htonl(DP_BENCH_NAT_IFACE_IP);
+	df->dst.dst_addr = htonl(DP_BENCH_NAT_DST_IP);
+	df->l4_type = IPPROTO_TCP;
+	df->l4_info.trans_port.src_port = htons(src_port);
+	df->l4_info.trans_port.dst_port = htons(443);
+}
+
+// only the fields dp_remove_network_snat_port() needs
+static void dp_bench_nat_fill_cntrack(struct flow_value *cntrack, uint16_t src_port, uint16_t nat_port, uint16_t port_id)
+{
+	struct flow_key *key_org = &cntrack->flow_key[DP_FLOW_DIR_ORG];
+	struct flow_key *key_reply = &cntrack->flow_key[DP_FLOW_DIR_REPLY];
+
+	memset(cntrack, 0, sizeof(*cntrack));
+	DP_SET_IPADDR4(key_org->l3_src, DP_BENCH_NAT_IFACE_IP);
+	DP_SET_IPADDR4(key_org->l3_dst, DP_BENCH_NAT_DST_IP);
+	key_org->src.port_src = src_port;
+	key_org->port_dst = 443;
+	key_org->proto = IPPROTO_TCP;
+	DP_SET_IPADDR4(key_reply->l3_dst, DP_BENCH_NAT_IP);
+	key_reply->port_dst = nat_port;
+	cntrack->nf_info.vni = DP_BENCH_NAT_VNI;
+	cntrack->created_port_id = port_id;
+}
+
+static uint16_t prefilled_ports[DP_BENCH_NAT_PREFILL];
+
+static void dp_bench_nat_release_prefilled(uint32_t count, uint16_t port_id)
+{
+	struct flow_value cntrack;
+
+	for (uint32_t i = 0; i < count; ++i) {
+		dp_bench_nat_fill_cntrack(&cntrack, (uint16_t)(DP_BENCH_NAT_PREFILL_SPORT + i), prefilled_ports[i], port_id);
+		dp_remove_network_snat_port(&cntrack);
+	}
+}
+
+int dp_bench_nat(const struct dp_port *vf)
+{
+	struct snat_data *snat_data;
+	struct flow_value cntrack;
+	struct dp_flow df;
+	struct dp_bench bench;
+	uint32_t prefilled = 0;
+	uint16_t src_port;
+	int nat_port;
+	int ret;
+
+	ret = dp_set_iface_nat_ip(DP_BENCH_NAT_IFACE_IP, DP_BENCH_NAT_IP, DP_BENCH_NAT_VNI,
+							  DP_BENCH_NAT_MIN_PORT, DP_BENCH_NAT_MIN_PORT + DP_BENCH_NAT_RANGE,
+							  bench_nat_ul_ipv6);
+	if (DP_FAILED(ret)) {
+		DPS_LOG_ERR("Cannot set NAT IP", DP_LOG_RET(ret));
+		return DP_ERROR;
+	}
+	snat_data = dp_get_iface_snat_data(DP_BENCH_NAT_IFACE_IP, DP_BENCH_NAT_VNI);
+	if (!snat_data) {
+		DPS_LOG_ERR("Cannot get SNAT data");
+		dp_del_iface_nat_ip(DP_BENCH_NAT_IFACE_IP, DP_BENCH_NAT_VNI);
+		return DP_ERROR;
+	}
+
+	// every flow goes to the same destination, so every flow needs its own NAT port
+	dp_bench_start(&bench, "nat_port_fill", DP_BENCH_NAT_PREFILL);
+	for (uint32_t i = 0; i < DP_BENCH_NAT_PREFILL; ++i) {
+		dp_bench_nat_fill_df(&df, (uint16_t)(DP_BENCH_NAT_PREFILL_SPORT + i));
+		nat_port = dp_allocate_network_snat_port(snat_data, &df, DP_BENCH_NAT_VNI);
+		if (DP_FAILED(nat_port)) {
+			DPS_LOG_ERR("Cannot allocate NAT port", DP_LOG_VALUE(i), DP_LOG_RET(nat_port));
+			ret = DP_ERROR;
+			goto cleanup;
+		}
+		prefilled_ports[prefilled++] = (uint16_t)nat_port;
+	}
+	dp_bench_stop(&bench);
+
+	dp_bench_start(&bench, "nat_port_alloc_free_95", DP_BENCH_NAT_CHURN);
+	for (uint32_t i = 0; i < DP_BENCH_NAT_CHURN; ++i) {
+		src_port = (uint16_t)(DP_BENCH_NAT_CHURN_SPORT + i % 1024);
+		dp_bench_nat_fill_df(&df, src_port);
+		nat_port = dp_allocate_network_snat_port(snat_data, &df, DP_BENCH_NAT_VNI);
+		if (DP_FAILED(nat_port)) {
+			DPS_LOG_ERR("Cannot allocate NAT port", DP_LOG_VALUE(i), DP_LOG_RET(nat_port));
+			ret = DP_ERROR;
+			goto cleanup;
+		}
+		dp_bench_nat_fill_cntrack(&cntrack, src_port, (uint16_t)nat_port, vf->port_id);
+		dp_remove_network_snat_port(&cntrack);
+	}
+	dp_bench_stop(&bench);
+
+	ret = DP_OK;
+
+cleanup:
+	dp_bench_nat_release_prefilled(prefilled, vf->port_id);
+	dp_del_iface_nat_ip(DP_BENCH_NAT_IFACE_IP, DP_BENCH_NAT_VNI);
+	return ret;
+}
@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include "dp_bench.h"
+#include <assert.h>
+#include <string.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
+#include "dp_conf.h"
+#include "dp_error.h"
+#include "dp_log.h"
+#include "dp_vnf.h"
+
+#define DP_BENCH_VNF_VNI		100
+#define DP_BENCH_VNF_LOOKUPS	(1024 * 1024)
+
+struct dp_bench_vnf_addr {
+	uint8_t addr[DP_IPV6_ADDR_SIZE];
+};
+
+// underlay addresses as generated by dpservice: common prefix, unique suffix
+static void dp_bench_vnf_addr(uint8_t ul_addr6[DP_IPV6_ADDR_SIZE], uint32_t index)
+{
+	static const uint8_t prefix[] = { 0x20, 0x01, 0x0d, 0xb8, 0xcc, 0xcc, 0, 0, 0, 0, 0, 0x64 };
+
+	static_assert(sizeof(prefix) == DP_IPV6_ADDR_SIZE - sizeof(index), "Invalid VNF address prefix");
+	memcpy(ul_addr6, prefix, sizeof(prefix));
+	memcpy(ul_addr6 + sizeof(prefix), &index, sizeof(index));
+}
+
+static void dp_bench_vnf_teardown(uint32_t count)
+{
+	uint8_t ul_addr6[DP_IPV6_ADDR_SIZE];
+
+	for (uint32_t i = 0; i < count; ++i) {
+		dp_bench_vnf_addr(ul_addr6, i);
+		dp_del_vnf(ul_addr6);
+	}
+}
+
+int dp_bench_vnf(const struct dp_port *vf)
+{
+	// do not fill the table completely, that is not a realistic state
+	uint32_t count = (uint32_t)dp_conf_get_vnf_table_size() * 9 / 10;
+	struct dp_bench_vnf_addr *queries;
+	struct dp_ip_address pfx_ip;
+	uint8_t ul_addr6[DP_IPV6_ADDR_SIZE];
+	struct dp_bench bench;
+	uint32_t added = 0;
+	int ret = DP_ERROR;
+
+	queries = rte_malloc("bench_vnf_queries", DP_BENCH_VNF_LOOKUPS * sizeof(*queries), RTE_CACHE_LINE_SIZE);
+	if (!queries) {
+		DPS_LOG_ERR("Cannot allocate VNF queries");
+		return DP_ERROR;
+	}
+
+	for (; added < count; ++added) {
+		dp_bench_vnf_addr(ul_addr6, added);
+		DP_SET_IPADDR4(pfx_ip, RTE_IPV4(10, 0, 0, 0) + added);
+		if (DP_FAILED(dp_add_vnf(ul_addr6, DP_VNF_TYPE_INTERFACE_IP, vf->port_id, DP_BENCH_VNF_VNI, &pfx_ip, 32))) {
+			DPS_LOG_ERR("Cannot add VNF", DP_LOG_VALUE(added));
+			goto teardown;
+		}
+	}
+
+	for (uint32_t i = 0; i < DP_BENCH_VNF_LOOKUPS; ++i)
+		dp_bench_vnf_addr(queries[i].addr, (uint32_t)rte_rand_max(count));
+
+	dp_bench_start(&bench, "vnf_lookup", DP_BENCH_VNF_LOOKUPS);
+	for (uint32_t i = 0; i < DP_BENCH_VNF_LOOKUPS; ++i)
+		dp_bench_consume((uintptr_t)dp_get_vnf(queries[i].addr));
+	dp_bench_stop(&bench);
+
+	ret = DP_OK;
+
+teardown:
+	dp_bench_vnf_teardown(added);
+	rte_free(queries);
+	return ret;
+}
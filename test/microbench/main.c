@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_random.h>
+#include "dp_bench.h"
+#include "dp_conf.h"
+#include "dp_error.h"
+#include "dp_firewall.h"
+#include "dp_flow.h"
+#include "dp_lb.h"
+#include "dp_log.h"
+#include "dp_nat.h"
+#include "dp_port.h"
+#include "dp_vnf.h"
+#include "dp_vni.h"
+
+// Lookup structures only need port metadata, no actual ethdev is used
+static struct dp_port bench_pf = {
+	.is_pf = true,
+	.port_id = 0,
+};
+static struct dp_port bench_vf = {
+	.is_pf = false,
+	.port_id = 1,
+	.iface.vni = 100,
+};
+
+static void bench_register_ports(void)
+{
+	_dp_port_table[bench_pf.port_id] = &bench_pf;
+	_dp_port_table[bench_vf.port_id] = &bench_vf;
+	dp_init_firewall_rules(&bench_vf);
+}
+
+static void bench_unregister_ports(void)
+{
+	_dp_port_table[bench_pf.port_id] = NULL;
+	_dp_port_table[bench_vf.port_id] = NULL;
+}
+
+static int bench_init_tables(void)
+{
+	int socket_id = (int)rte_socket_id();
+
+	if (DP_FAILED(dp_flow_init(socket_id))
+		|| DP_FAILED(dp_nat_init(socket_id))
+		|| DP_FAILED(dp_lb_init(socket_id))
+		|| DP_FAILED(dp_vni_init(socket_id))
+		|| DP_FAILED(dp_vnf_init(socket_id)))
+		return DP_ERROR;
+
+	return DP_OK;
+}
+
+static void bench_free_tables(void)
+{
+	dp_vnf_free();
+	dp_vni_free();
+	dp_lb_free();
+	dp_nat_free();
+	dp_flow_free();
+}
+
+static int run_benchmarks(void)
+{
+	int ret = DP_OK;
+
+	if (DP_FAILED(dp_log_init()))
+		return DP_ERROR;
+
+#ifdef ENABLE_PYTEST
+	DPS_LOG_WARNING("Built with tests enabled, flow table results are skewed by debug logging");
+#endif
+
+	rte_srand(DP_BENCH_SEED);
+	bench_register_ports();
+
+	if (DP_FAILED(bench_init_tables()) || DP_FAILED(dp_bench_init())) {
+		bench_free_tables();
+		bench_unregister_ports();
+		return DP_ERROR;
+	}
+
+	if (DP_FAILED(dp_bench_flow())
+		|| DP_FAILED(dp_bench_lpm(&bench_pf, &bench_vf))
+		|| DP_FAILED(dp_bench_nat(&bench_vf))
+		|| DP_FAILED(dp_bench_firewall(&bench_vf, &bench_pf))
+		|| DP_FAILED(dp_bench_lb())
+		|| DP_FAILED(dp_bench_vnf(&bench_vf)))
+		ret = DP_ERROR;
+
+	dp_bench_free();
+	bench_free_tables();
+	bench_unregister_ports();
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	int retval = EXIT_SUCCESS;
+	int eal_argcount;
+
+	eal_argcount = rte_eal_init(argc, argv);
+	if (DP_FAILED(eal_argcount)) {
+		fprintf(stderr, "Failed to initialize EAL\n");
+		return EXIT_FAILURE;
+	}
+
+	// dpservice options are accepted too, table sizes are taken into account
+	switch (dp_conf_parse_args(argc - eal_argcount, argv + eal_argcount)) {
+	case DP_CONF_RUNMODE_ERROR:
+		retval = EXIT_FAILURE;
+		break;
+	case DP_CONF_RUNMODE_EXIT:
+		retval = EXIT_SUCCESS;
+		break;
+	case DP_CONF_RUNMODE_NORMAL:
+		retval = DP_FAILED(run_benchmarks()) ? EXIT_FAILURE : EXIT_SUCCESS;
+		break;
+	}
+
+	rte_eal_cleanup();
+	dp_conf_free();
+
+	return retval;
+}
@@ -57,6 +57,21 @@ def testDpService(build_path, print_header):
 	if '--flow-timeout' in dpservice_help:
 		suites.append(TestSuite("flow", "Flow timeout tests with extremely fast flow timeout",
 			test_args + ['--fast-flow-timeout'], ['xtratest_flow_timeout.py']))
+	if '--no-tx-cksum-offload' in dpservice_help:
+		suites.append(TestSuite("cksum", "Checksum-validating tests with checksums computed in software",
+			test_args + ['--no-tx-cksum-offload'],
+			['test_nat.py', 'test_lb.py', 'test_vf_to_pf.py', 'test_vf_to_vf.py', 'test_encap.py', 'test_pmtu.py']))
+	if '--flow-table-max-size' in dpservice_help:
+		suites.append(TestSuite("table", "Flow table growth tests with a small initial flow table",
+			test_args + ['--small-flow-table'], ['xtratest_flow_table.py']))
+	if '--flow-limit' in dpservice_help:
+		suites.append(TestSuite("limits", "Per-interface flow limit tests with low limits",
+			test_args + ['--flow-limits=drop'], ['xtratest_flow_limits.py']))
+		suites.append(TestSuite("limits-monitor", "Per-interface flow limit tests with low limits only monitored",
+			test_args + ['--flow-limits=monitor'], ['xtratest_flow_limits.py']))
+	if '--idle-poll' in dpservice_help:
+		suites.append(TestSuite("idle", "Wake-up latency tests with adaptive idle polling",
+			test_args + ['--adaptive-polling'], ['xtratest_idle_poll.py']))
 
 	# --list-suites prints and terminates
 	if args.list_suites:
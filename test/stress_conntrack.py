@@ -0,0 +1,388 @@
+#!/usr/bin/env python3
+
+# SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+# SPDX-License-Identifier: Apache-2.0
+
+# Connection tracking stress test and soak mode
+#
+# Replays a pre-generated mix of short-lived TCP, UDP and ICMP connections (via NAT, to a loadbalancer,
+# to a local VM and to another host) in a loop, while interfaces, NAT and loadbalancer targets are
+# concurrently added and removed via gRPC. Traffic is stopped after every cycle and once dpservice
+# drains, its telemetry is checked for leaked flow values, NAT ports and table entries.
+# Runs on software ports (net_pcap) or on TAP devices (traffic replayed by tcpreplay).
+
+import argparse
+import contextlib
+import os
+import shlex
+import shutil
+import signal
+import statistics
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+from scapy.layers.inet import Ether, IP, ICMP, TCP, UDP
+from scapy.packet import Raw
+from scapy.utils import PcapWriter
+
+from benchmark import Telemetry, write_empty_pcap
+from grpc_client import GrpcClient
+
+VNI = 100
+VNI2 = 200
+VM1 = { 'name': "stress-vm1", 'ip': "10.100.1.1", 'ipv6': "2000:100:1::1" }
+VM2 = { 'name': "stress-vm2", 'ip': "10.100.1.2", 'ipv6': "2000:100:1::2" }
+VM3 = { 'name': "stress-vm3", 'ip': "10.200.1.3", 'ipv6': "2000:200:1::3" }
+local_ul_ipv6 = "fc00:1::1"
+router_ul_ipv6 = "fc00::ffff"
+neigh_ul_ipv6 = "fc00:2::64:0:1"
+neigh_ov_ip_route = "10.100.2.0/24"
+neigh_ov_ip_prefix = "10.100.2."
+public_ip_prefix = "45.86.6."
+nat_vip = "172.21.1.1"
+nat_vip2 = "172.21.1.2"
+lb_name = "stress-lb"
+lb_ip = "172.22.2.1"
+lb_targets = ("fc00:2::1", "fc00:2::2")
+# MACs are not checked by dpservice on ingress, these only make packet dumps readable
+VF_MAC = "66:66:66:66:66:00"
+ROUTER_MAC = "22:22:22:22:22:ff"
+
+# these must return to zero once all traffic is gone
+DRAINED_TABLES = ("ipv4_flow_table", "flow_values", "ipv4_netnat_portmap_table", "ipv4_netnat_portoverload_table")
+
+
+class Ports:
+
+	def __init__(self, tap):
+		self.tap = tap
+		if tap:
+			# gRPC uses DPDK device names, traffic is sent to interface names
+			self.devices = [ f"net_tap{i}" for i in range(5) ]
+			self.ifaces = [ "dtap0", "dtap1", "dtapvf_0", "dtapvf_1", "dtapvf_2" ]
+			self.vf_pattern = "dtapvf_"
+		else:
+			# software devices use the device name as the interface name
+			self.devices = [ "net_pcap_pf0", "net_pcap_pf1", "net_pcap_vf0", "net_pcap_vf1", "net_pcap_vf2" ]
+			self.ifaces = self.devices
+			self.vf_pattern = "net_pcap_vf"
+		self.pf0, self.pf1, self.vf0, self.vf1, self.vf2 = self.devices
+		self.traffic_iface = self.ifaces[2]
+
+
+def connection_packets(i):
+	# every connection has a distinct 5-tuple, destinations are spread to keep NAT ranges usable
+	kind = i % 6
+	n = i // 6
+	sport = 1024 + n % 60000
+	public_ip = f"{public_ip_prefix}{1 + n // 60000 % 250}"
+	eth = Ether(dst=ROUTER_MAC, src=VF_MAC)
+	if kind == 0:
+		# TCP to the internet via NAT, aborted
+		ip = IP(src=VM1['ip'], dst=public_ip)
+		return [ eth / ip / TCP(sport=sport, dport=443, flags="S", seq=1000),
+				 eth / ip / TCP(sport=sport, dport=443, flags="PA", seq=1001) / Raw(b"x" * 32),
+				 eth / ip / TCP(sport=sport, dport=443, flags="R", seq=1033) ]
+	if kind == 1:
+		# UDP to the internet via NAT
+		ip = IP(src=VM1['ip'], dst=public_ip)
+		return [ eth / ip / UDP(sport=sport, dport=53) / Raw(b"q" * 32) ] * 2
+	if kind == 2:
+		# ICMP echo to the internet via NAT
+		return [ eth / IP(src=VM1['ip'], dst=public_ip) / ICMP(type=8, id=n % 65536, seq=1) ]
+	if kind == 3:
+		# TCP to a local VM that is repeatedly added and removed
+		ip = IP(src=VM1['ip'], dst=VM2['ip'])
+		return [ eth / ip / TCP(sport=sport, dport=80, flags="S", seq=1000),
+				 eth / ip / TCP(sport=sport, dport=80, flags="FA", seq=1001) ]
+	if kind == 4:
+		# TCP to a loadbalancer in the same VNI, targets are repeatedly added and removed
+		ip = IP(src=VM1['ip'], dst=lb_ip)
+		return [ eth / ip / TCP(sport=sport, dport=80, flags="S", seq=1000),
+				 eth / ip / TCP(sport=sport, dport=80, flags="R", seq=1001) ]
+	# UDP to a VM on another host (IPIP encapsulation)
+	return [ eth / IP(src=VM1['ip'], dst=f"{neigh_ov_ip_prefix}{1 + n % 254}") / UDP(sport=sport, dport=5000) ]
+
+def write_traffic_pcap(filename, connections):
+	with PcapWriter(filename, linktype=1, sync=False) as writer:
+		for i in range(connections):
+			for pkt in connection_packets(i):
+				writer.write(pkt)
+
+
+class StressService:
+
+	def __init__(self, args, workdir, ports, pcap):
+		self.log = open(f"{workdir}/dpservice.log", 'a')
+		self.cmd = f"{args.build_path}/src/dpservice-bin -l {args.lcores} --huge-unlink --no-pci"
+		if ports.tap:
+			for device, iface in zip(ports.devices, ports.ifaces):
+				self.cmd += f" --vdev={device},iface={iface}"
+		else:
+			idle_pcap = f"{workdir}/idle.pcap"
+			write_empty_pcap(idle_pcap)
+			for device in ports.devices:
+				if device == ports.vf0:
+					self.cmd += f" --vdev={device},rx_pcap={pcap},infinite_rx=1"
+				else:
+					self.cmd += f" --vdev={device},rx_pcap={idle_pcap}"
+		self.cmd += (f" -- --pf0={ports.ifaces[0]} --pf1={ports.ifaces[1]} --vf-pattern={ports.vf_pattern}"
+					 f" --nic-type=tap --no-offload --ipv6={local_ul_ipv6} --no-stats --color=never"
+					 f" --flow-table-size={args.flow_table_size}")
+		if args.flow_timeout:
+			self.cmd += f" --flow-timeout={args.flow_timeout}"
+
+	def __enter__(self):
+		self.log.write(f"{self.cmd}\n")
+		self.log.flush()
+		# command-line arguments are used instead of a config file
+		self.process = subprocess.Popen(shlex.split(self.cmd), env={"DP_CONF": ""},
+										stdout=self.log, stderr=subprocess.STDOUT)
+		GrpcClient.wait_for_port()
+		return self
+
+	def __exit__(self, *exc):
+		self.process.terminate()
+		try:
+			self.process.wait(5)
+		except subprocess.TimeoutExpired:
+			self.process.kill()
+			self.process.wait()
+		self.log.close()
+
+	def alive(self):
+		return self.process.poll() is None
+
+
+class Traffic:
+	# software ports receive as soon as the interface exists (and stop when it is removed),
+	# TAP devices need an external generator
+
+	def __init__(self, args, ports, grpc_client, pcap):
+		self.ports = ports
+		self.grpc_client = grpc_client
+		self.pcap = pcap
+		self.nat_max_port = args.nat_max_port
+		self.replay = None
+
+	def add_vm1(self):
+		self.grpc_client.addinterface(VM1['name'], self.ports.vf0, VNI, VM1['ip'], VM1['ipv6'])
+		self.grpc_client.addnat(VM1['name'], nat_vip, 1024, self.nat_max_port)
+
+	def del_vm1(self):
+		self.grpc_client.delnat(VM1['name'])
+		self.grpc_client.delinterface(VM1['name'])
+
+	def start(self):
+		if self.ports.tap:
+			self.replay = subprocess.Popen(["tcpreplay", "--topspeed", "--loop=0", "-q",
+											f"--intf1={self.ports.traffic_iface}", self.pcap],
+										   stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+		else:
+			self.add_vm1()
+
+	def stop(self):
+		if self.ports.tap:
+			self.replay.send_signal(signal.SIGINT)
+			self.replay.wait()
+			self.replay = None
+		else:
+			# removes all flows of the VM forcefully
+			self.del_vm1()
+
+
+class Churn(threading.Thread):
+	# control-plane changes concurrent to the traffic
+
+	def __init__(self, args, ports):
+		super().__init__(daemon=True)
+		self.grpc_client = GrpcClient(args.build_path)
+		self.ports = ports
+		self.interval = args.churn_interval
+		self.stop_event = threading.Event()
+		self.error = None
+		self.rounds = 0
+
+	def run(self):
+		try:
+			while not self.stop_event.is_set():
+				self.grpc_client.addinterface(VM2['name'], self.ports.vf1, VNI, VM2['ip'], VM2['ipv6'])
+				self.grpc_client.addnat(VM2['name'], nat_vip2, 1024, 2048)
+				self.grpc_client.addlbtarget(lb_name, lb_targets[1])
+				# VM3 is alone in its VNI, so route tables are created and destroyed every time
+				self.grpc_client.addinterface(VM3['name'], self.ports.vf2, VNI2, VM3['ip'], VM3['ipv6'])
+				self.stop_event.wait(self.interval)
+				self.grpc_client.delinterface(VM3['name'])
+				self.grpc_client.dellbtarget(lb_name, lb_targets[1])
+				self.grpc_client.delnat(VM2['name'])
+				self.grpc_client.delinterface(VM2['name'])
+				self.rounds += 1
+				self.stop_event.wait(self.interval)
+		except Exception as e:
+			self.error = e
+
+	def stop(self):
+		self.stop_event.set()
+		self.join()
+		if self.error:
+			raise RuntimeError(f"Concurrent gRPC changes failed: {self.error}") from self.error
+
+
+def find_leaks(tel, tables):
+	leaks = []
+	occupancy = tel.get("/dp_service/table/occupancy")
+	for table in tables:
+		used = occupancy[table]['used']
+		if used:
+			leaks.append(f"{table} has {used} entries")
+	for vm, flows in tel.get("/dp_service/conntrack/flow_count").items():
+		if flows:
+			leaks.append(f"{vm} has {flows} flows accounted")
+	for vm, ports in tel.get("/dp_service/nat/used_port_count").items():
+		if ports:
+			leaks.append(f"{vm} has {ports} NAT ports in use")
+	return leaks
+
+def wait_for_drain(tel, tables, timeout):
+	# the flow table occupancy is only updated during periodic flow aging
+	end = time.monotonic() + timeout
+	while True:
+		leaks = find_leaks(tel, tables)
+		if not leaks or time.monotonic() > end:
+			return leaks
+		time.sleep(1)
+
+def run_cycle(args, service, traffic, tel, cycle):
+	samples = []
+	rx_last = None
+	rx_progress = time.monotonic()
+	churn = Churn(args, traffic.ports)
+	churn.start()
+	traffic.start()
+	try:
+		end = time.monotonic() + args.cycle
+		while time.monotonic() < end:
+			time.sleep(args.interval)
+			if not service.alive():
+				raise RuntimeError("dpservice died")
+			now = time.monotonic()
+			rx = tel.get("/dp_service/iface/stats").get(VM1['name'], {}).get('rx_packets', 0)
+			if rx != rx_last:
+				rx_last = rx
+				rx_progress = now
+			elif now - rx_progress > args.stall_timeout:
+				raise RuntimeError(f"No packets processed for {now - rx_progress:.1f}s")
+			samples.append(tel.get("/dp_service/table/occupancy")['ipv4_flow_table']['used'])
+	finally:
+		traffic.stop()
+		churn.stop()
+
+	leaks = wait_for_drain(tel, DRAINED_TABLES, args.drain_timeout)
+	# only the second half of the cycle is the steady state
+	steady = statistics.median(samples[len(samples)//2:]) if samples else 0
+	print(f"Cycle #{cycle}: {rx_last or 0} packets received, {steady:.0f} flow table entries in steady state,"
+		  f" {churn.rounds} gRPC churn rounds", file=sys.stderr)
+	return steady, leaks
+
+def setup(grpc_client, traffic, tap):
+	grpc_client.init()
+	# the loadbalancer keeps the VNI (and thus routes) alive even when no VM is attached
+	grpc_client.createlb(lb_name, VNI, lb_ip, "tcp/80")
+	grpc_client.addlbtarget(lb_name, lb_targets[0])
+	grpc_client.addroute(VNI, neigh_ov_ip_route, 0, neigh_ul_ipv6)
+	grpc_client.addroute(VNI, "0.0.0.0/0", VNI, router_ul_ipv6)
+	if tap:
+		traffic.add_vm1()
+
+def teardown(grpc_client, traffic, tap):
+	if tap:
+		traffic.del_vm1()
+	grpc_client.delroute(VNI, "0.0.0.0/0")
+	grpc_client.delroute(VNI, neigh_ov_ip_route)
+	grpc_client.dellbtarget(lb_name, lb_targets[0])
+	grpc_client.dellb(lb_name)
+
+def stress(args, workdir, ports, pcap):
+	failures = []
+	steady_states = []
+	with StressService(args, workdir, ports, pcap) as service:
+		grpc_client = GrpcClient(args.build_path)
+		traffic = Traffic(args, ports, grpc_client, pcap)
+		if ports.tap:
+			for iface in ports.ifaces:
+				subprocess.check_call(["ip", "link", "set", "dev", iface, "up"])
+		tel = Telemetry()
+		try:
+			setup(grpc_client, traffic, ports.tap)
+			end = time.monotonic() + args.soak if args.soak else None
+			cycle = 0
+			while (cycle < args.cycles) if not end else (time.monotonic() < end):
+				steady, leaks = run_cycle(args, service, traffic, tel, cycle)
+				steady_states.append(steady)
+				failures += [ f"cycle #{cycle}: {leak}" for leak in leaks ]
+				if failures and not args.keep_going:
+					break
+				cycle += 1
+			teardown(grpc_client, traffic, ports.tap)
+			# with no configuration left, every table must be empty
+			occupancy = tel.get("/dp_service/table/occupancy")
+			failures += [ f"teardown: {leak}" for leak in wait_for_drain(tel, occupancy.keys(), args.drain_timeout) ]
+		finally:
+			tel.close()
+
+	# flow table occupancy must not creep up over time
+	if len(steady_states) >= 4:
+		first = statistics.median(steady_states[:len(steady_states)//2])
+		last = statistics.median(steady_states[len(steady_states)//2:])
+		if first and (last - first) / first * 100 > args.tolerance:
+			failures.append(f"steady-state flow table occupancy grew from {first:.0f} to {last:.0f}")
+	return failures
+
+
+if __name__ == '__main__':
+	script_path = os.path.dirname(os.path.abspath(__file__))
+	parser = argparse.ArgumentParser(description="Connection tracking stress test of dpservice")
+	parser.add_argument("--build-path", action="store", default=f"{script_path}/../build", help="Path to the root build directory")
+	parser.add_argument("--tap", action="store_true", help="Use TAP devices and tcpreplay instead of software (net_pcap) ports")
+	parser.add_argument("--lcores", action="store", default="0,1", help="EAL lcore list (main lcore, worker lcore)")
+	parser.add_argument("--connections", type=int, default=60000, help="Number of distinct connections in the replayed traffic mix")
+	parser.add_argument("--flow-table-size", type=int, default=1024*1024, help="Flow table capacity to use")
+	parser.add_argument("--flow-timeout", type=int, help="Flow timeout to use (needs dpservice built with -Denable_tests=true)")
+	parser.add_argument("--nat-max-port", type=int, default=65535, help="Upper bound of the NAT port range of the traffic generating VM")
+	parser.add_argument("--cycle", type=float, default=30, help="Seconds of traffic in every cycle")
+	parser.add_argument("--cycles", type=int, default=5, help="Number of cycles to run")
+	parser.add_argument("--soak", type=float, help="Run cycles for this many seconds instead of a fixed number of cycles")
+	parser.add_argument("--churn-interval", type=float, default=0.5, help="Seconds between concurrent gRPC changes")
+	parser.add_argument("--interval", type=float, default=2, help="Seconds between telemetry samples")
+	parser.add_argument("--stall-timeout", type=float, default=10, help="Seconds without any processed packet to report a stall")
+	parser.add_argument("--drain-timeout", type=float, default=60, help="Seconds to wait for all flows to be gone after traffic stops")
+	parser.add_argument("--tolerance", type=float, default=10, help="Allowed growth of steady-state flow table occupancy in percent")
+	parser.add_argument("--keep-going", action="store_true", help="Do not stop at the first cycle with leaks")
+	args = parser.parse_args()
+
+	if not os.access(f"{args.build_path}/src/dpservice-bin", os.X_OK):
+		print(f"No runnable dpservice binary in {args.build_path}", file=sys.stderr)
+		sys.exit(1)
+	if args.tap and not shutil.which("tcpreplay"):
+		print("TAP mode needs tcpreplay to generate traffic", file=sys.stderr)
+		sys.exit(1)
+	if args.tap and not args.flow_timeout:
+		print("Without --flow-timeout, flows only age out after the default timeout, consider raising --drain-timeout",
+			  file=sys.stderr)
+
+	ports = Ports(args.tap)
+	with tempfile.TemporaryDirectory(prefix="dp_stress_") as workdir:
+		pcap = f"{workdir}/traffic.pcap"
+		write_traffic_pcap(pcap, args.connections)
+		# gRPC client is verbose, keep standard output for the result
+		with contextlib.redirect_stdout(sys.stderr):
+			failures = stress(args, workdir, ports, pcap)
+
+	if failures:
+		for failure in failures:
+			print(f"FAILED {failure}")
+		sys.exit(1)
+	print("PASSED")
@@ -0,0 +1,50 @@
+# SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+# SPDX-License-Identifier: Apache-2.0
+
+import re
+import signal
+import subprocess
+
+from helpers import *
+
+# must match DP_PKT_ID_SEQ_BITS in dp_mbuf_dyn.h
+pktid_seq_bits = 24
+
+egress_line = re.compile(r"^\d\d:\d\d:\d\d\.\d{3} (\d+): .* >> PORT \d+\s*:")
+
+def is_periodic_garp_pkt(pkt):
+	return ARP in pkt and pkt[ARP].op == 1 and pkt[ARP].psrc == gateway_ip
+
+def test_graphtrace_pktid(prepare_ifaces, build_path):
+	dump = subprocess.Popen([f"{build_path}/tools/dump/dpservice-dump"],
+							stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True)
+	time.sleep(1)
+
+	# GARP messages are generated by the main lcore, wait for one to be sure it is in the trace
+	garp_sniffer = AsyncSniffer(iface=VM1.tap, lfilter=is_periodic_garp_pkt, count=1,
+								timeout=periodic_msg_interval + sniff_timeout)
+	garp_sniffer.start()
+
+	# ARP replies are generated by the worker lcore
+	arp_packet = (Ether(dst="ff:ff:ff:ff:ff:ff", src=VM1.mac) /
+				  ARP(pdst=gateway_ip, hwdst=VM1.mac, psrc="0.0.0.0"))
+	for _ in range(5):
+		sendp([arp_packet] * 20, iface=VM1.tap)
+		time.sleep(1)
+
+	garp_sniffer.join()
+	assert len(garp_sniffer.results) == 1, \
+		"No periodic GARP message received"
+	time.sleep(0.5)
+
+	dump.send_signal(signal.SIGINT)
+	output = dump.communicate(timeout=5)[0]
+
+	pktids = [ int(match.group(1)) for match in map(egress_line.match, output.splitlines()) if match ]
+	assert len(pktids) >= 100, \
+		f"Missing packets in graphtrace ({len(pktids)})"
+	assert len(set(pktids)) == len(pktids), \
+		"Duplicate packet ids in graphtrace"
+	lcores = set(pktid >> pktid_seq_bits for pktid in pktids)
+	assert len(lcores) >= 2, \
+		f"Packet ids not generated by both main and worker lcores ({lcores})"
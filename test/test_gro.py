@@ -0,0 +1,78 @@
+# SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+# SPDX-License-Identifier: Apache-2.0
+
+import threading
+
+from helpers import *
+
+# Segments sent in one go can (but do not need to) be merged on Rx and split again on Tx,
+# either way, the stream needs to arrive complete, with valid checksums and fitting into the MTU
+gro_segment_len = 1200
+gro_segment_count = 8
+gro_payload = (bytes(range(256)) * 40)[:gro_segment_len * gro_segment_count]
+gro_sport = 4321
+gro_dport = 1236
+gro_seq = 1000
+# merging depends on segments arriving in one Rx burst, which cannot be forced from here
+gro_attempts = 10
+
+def is_gro_tcp_pkt(pkt):
+	return TCP in pkt and pkt[TCP].sport == gro_sport
+
+def send_tcp_segments(dst_mac, dst_ip, payload=gro_payload, segment_len=gro_segment_len):
+	segments = [ Ether(dst=dst_mac, src=VM1.mac) /
+				 IP(dst=dst_ip, src=VM1.ip, flags="DF") /
+				 TCP(sport=gro_sport, dport=gro_dport, flags="A", seq=gro_seq + offset) /
+				 Raw(payload[offset:offset+segment_len])
+				 for offset in range(0, len(payload), segment_len) ]
+	delayed_sendp(segments, VM1.tap)
+
+def sniff_tcp_stream(iface, get_l3_len, mtu, expected=gro_payload):
+	received = {}
+	def stream_complete(pkt):
+		received[pkt[TCP].seq] = bytes(pkt[TCP].payload)
+		return sum(len(data) for data in received.values()) >= len(expected)
+
+	pkt_list = sniff(iface=iface, lfilter=is_gro_tcp_pkt, stop_filter=stream_complete, timeout=sniff_timeout)
+	for pkt in pkt_list:
+		validate_checksums(pkt)
+		assert get_l3_len(pkt) <= mtu, \
+			f"Segment does not fit into the MTU of {iface} ({get_l3_len(pkt)})"
+
+	payload = b"".join(received[seq] for seq in sorted(received))
+	assert payload == expected, \
+		f"TCP stream not received correctly on {iface} ({len(payload)} of {len(expected)} bytes)"
+	assert min(received) == gro_seq, \
+		f"Bad TCP sequence number on {iface} ({min(received)})"
+
+
+def get_mtu_stats(port):
+	return get_telemetry("/dp_service/mtu/stats")[port]
+
+def test_vf_to_vf_gro(prepare_ipv4, grpc_client):
+	grpc_client.addfwallrule(VM2.name, "fw0-vm2", proto="tcp", dst_port_min=gro_dport, dst_port_max=gro_dport)
+	merged = get_mtu_stats(VM1.name)["gro_merged"]
+	segments = get_mtu_stats(VM2.name)["gso_segments"]
+	for _ in range(gro_attempts):
+		threading.Thread(target=send_tcp_segments, args=(VM2.mac, VM2.ip)).start()
+		sniff_tcp_stream(VM2.tap, lambda pkt: len(pkt[IP]), dhcp_mtu)
+		if get_mtu_stats(VM1.name)["gro_merged"] > merged:
+			break
+	grpc_client.delfwallrule(VM2.name, "fw0-vm2")
+
+	assert get_mtu_stats(VM1.name)["gro_merged"] > merged, \
+		"No segments merged on Rx"
+	# merged packet does not fit into the VM's MTU, it has to be split again
+	assert get_mtu_stats(VM2.name)["gso_segments"] > segments, \
+		"Merged packet not segmented on Tx"
+
+def test_vf_to_pf_gro(prepare_ipv4):
+	threading.Thread(target=send_tcp_segments, args=(PF0.mac, public_ip)).start()
+	# uplink (tap) MTU is 1500, encapsulated segments need to fit
+	sniff_tcp_stream(PF0.tap, lambda pkt: len(pkt[IPv6]), 1500)
+
+# merged packet fits into the MTU, it must be sent as-is and not as a TSO request
+def test_vf_to_pf_gro_small(prepare_ipv4):
+	payload = gro_payload[:1000]
+	threading.Thread(target=send_tcp_segments, args=(PF0.mac, public_ip, payload, 500)).start()
+	sniff_tcp_stream(PF0.tap, lambda pkt: len(pkt[IPv6]), 1500, payload)
@@ -0,0 +1,80 @@
+# SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+# SPDX-License-Identifier: Apache-2.0
+
+import pytest
+import threading
+
+from helpers import *
+
+frag_payload = bytes(range(256)) * 10
+frag_sport = 4321
+frag_dport = 1234
+
+def is_ip_fragment(pkt):
+	return IP in pkt and (pkt[IP].flags.MF or pkt[IP].frag > 0)
+
+def is_encaped_ip_fragment(pkt):
+	return is_ipip_pkt(pkt) and is_ip_fragment(pkt)
+
+def sniff_fragments(iface, lfilter, count):
+	pkt_list = sniff(count=count, lfilter=lfilter, iface=iface, timeout=sniff_timeout)
+	assert len(pkt_list) == count, \
+		f"Missing fragments on {iface} (got {len(pkt_list)}, expected {count})"
+	fragments = [ pkt[IP] for pkt in pkt_list ]
+	packets = defragment(fragments)
+	assert len(packets) == 1, \
+		f"Fragments on {iface} cannot be reassembled"
+	pkt = packets[0]
+	validate_checksums(pkt)
+	assert UDP in pkt and bytes(pkt[UDP].payload) == frag_payload, \
+		f"Invalid reassembled payload on {iface}"
+	return pkt_list, pkt
+
+def reply_fragmented_udp(nat_ul_ipv6):
+	# 2.5kB packet does not fit into the uplink MTU after encapsulation
+	pkt_list, pkt = sniff_fragments(PF0.tap, is_encaped_ip_fragment, 2)
+	assert pkt.src == nat_vip and pkt[UDP].sport >= nat_local_min_port and pkt[UDP].sport < nat_local_max_port, \
+		f"Bad fragmented UDP packet (ip: {pkt.src}, sport: {pkt[UDP].sport})"
+	for frag in pkt_list:
+		assert len(frag[IPv6]) <= 1500, \
+			f"Fragment does not fit into the uplink MTU ({len(frag[IPv6])})"
+
+	reply = (IP(dst=pkt.src, src=pkt.dst) /
+			 UDP(sport=pkt[UDP].dport, dport=pkt[UDP].sport) /
+			 Raw(frag_payload))
+	outer = (Ether(dst=pkt_list[0][Ether].src, src=pkt_list[0][Ether].dst, type=0x86DD) /
+			 IPv6(dst=nat_ul_ipv6, src=pkt_list[0][IPv6].dst, nh=4))
+	delayed_sendp([ outer / frag for frag in fragment(reply, fragsize=1000) ], PF0.tap)
+
+
+def test_vf_to_pf_nat_fragmented(prepare_ipv4, grpc_client):
+	nat_ul_ipv6 = grpc_client.addnat(VM1.name, nat_vip, nat_local_min_port, nat_local_max_port)
+	threading.Thread(target=reply_fragmented_udp, args=(nat_ul_ipv6,)).start()
+
+	udp_pkt = (IP(dst=public_ip, src=VM1.ip) /
+			   UDP(sport=frag_sport, dport=frag_dport) /
+			   Raw(frag_payload))
+	delayed_sendp([ Ether(dst=PF0.mac, src=VM1.mac) / frag for frag in fragment(udp_pkt, fragsize=1000) ], VM1.tap)
+
+	# reassembled reply does not fit into the VM's MTU (set via DHCP)
+	pkt_list, pkt = sniff_fragments(VM1.tap, is_ip_fragment, 2)
+	assert pkt.dst == VM1.ip and pkt[UDP].dport == frag_sport, \
+		f"Bad fragmented UDP reply (ip: {pkt.dst}, dport: {pkt[UDP].dport})"
+	for frag in pkt_list:
+		assert len(frag[IP]) <= dhcp_mtu, \
+			f"Fragment does not fit into the VM's MTU ({len(frag[IP])})"
+
+	grpc_client.delnat(VM1.name)
+
+def test_vf_to_pf_fragments_mixed_vms(prepare_ipv4):
+	# same addresses and IP ID, but fragments come from two different VMs, they must not be put together
+	udp_pkt = (IP(dst=public_ip, src=VM1.ip, id=0x4242) /
+			   UDP(sport=frag_sport, dport=frag_dport) /
+			   Raw(frag_payload))
+	frags = fragment(udp_pkt, fragsize=1000)
+	delayed_sendp(Ether(dst=PF0.mac, src=VM1.mac) / frags[0], VM1.tap)
+	threading.Thread(target=delayed_sendp, args=([ Ether(dst=PF0.mac, src=VM2.mac) / frag for frag in frags[1:] ], VM2.tap)).start()
+
+	pkt_list = sniff(count=1, lfilter=is_encaped_ip_fragment, iface=PF0.tap, timeout=sniff_short_timeout)
+	assert len(pkt_list) == 0, \
+		"Fragments from different VMs reassembled into one packet"
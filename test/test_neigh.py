@@ -0,0 +1,81 @@
+# SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+# SPDX-License-Identifier: Apache-2.0
+
+import pytest
+import threading
+import time
+
+from helpers import *
+
+# the underlay router is only known from the kernel's neighbor table of the PF
+router_ll_ipv6 = "fe80::ffff"
+router_macs = [ "02:00:00:00:ff:01", "02:00:00:00:ff:02" ]
+# another router on the same link, dpservice must stick to the original one
+other_router_ll_ipv6 = "fe80::fffe"
+other_router_mac = "02:00:00:00:fe:01"
+
+def get_router_neigh():
+	# dpservice only follows the router entry it found at startup (if any)
+	for line in run_command(f"ip -6 neigh show dev {PF0.tap}").splitlines():
+		fields = line.split()
+		if "router" in fields and "lladdr" in fields:
+			return fields[0], fields[fields.index("lladdr") + 1], fields[-1].lower()
+	return None
+
+def set_router_neigh(ll_ipv6, mac, state="permanent"):
+	run_command(f"ip -6 neigh replace {ll_ipv6} lladdr {mac} dev {PF0.tap} router nud {state}")
+	# the change is passed to the worker asynchronously
+	time.sleep(0.5)
+
+def encaped_icmp_responder(used_macs):
+	pkt = sniff_packet(PF0.tap, is_encaped_icmp_pkt)
+	used_macs.append(pkt[Ether].dst)
+	reply_pkt = (Ether(dst=pkt[Ether].src, src=pkt[Ether].dst, type=0x86DD) /
+				 IPv6(dst=VM1.ul_ipv6, src=pkt[IPv6].dst, nh=4) /
+				 IP(dst=pkt[IP].src, src=pkt[IP].dst) /
+				 ICMP(type=0))
+	delayed_sendp(reply_pkt, PF0.tap)
+
+def get_used_router_mac():
+	used_macs = []
+	threading.Thread(target=encaped_icmp_responder, args=(used_macs,)).start()
+	icmp_echo_pkt = (Ether(dst=PF0.mac, src=VM1.mac, type=0x0800) /
+					 IP(dst=f"{neigh_vni1_ov_ip_prefix}.102", src=VM1.ip) /
+					 ICMP(type=8))
+	delayed_sendp(icmp_echo_pkt, VM1.tap)
+	pkt = sniff_packet(VM1.tap, is_icmp_pkt)
+	assert pkt[ICMP].type == 0, \
+		"Wrong ICMP reply"
+	return used_macs[0]
+
+def test_router_mac_change(request, prepare_ipv4):
+	if request.config.getoption("--hw"):
+		pytest.skip("Hardware testing is not supported for router neighbor changes")
+
+	orig_neigh = get_router_neigh()
+	ll_ipv6 = orig_neigh[0] if orig_neigh else router_ll_ipv6
+	orig_mac = get_used_router_mac()
+
+	try:
+		for router_mac in router_macs:
+			set_router_neigh(ll_ipv6, router_mac)
+			used_mac = get_used_router_mac()
+			assert used_mac == router_mac, \
+				f"Encapsulated packet not sent to the current router ({used_mac} instead of {router_mac})"
+
+		set_router_neigh(other_router_ll_ipv6, other_router_mac)
+		used_mac = get_used_router_mac()
+		assert used_mac == router_macs[-1], \
+			f"Encapsulated packet sent to another router on the link ({used_mac} instead of {router_macs[-1]})"
+		run_command(f"ip -6 neigh del {other_router_ll_ipv6} dev {PF0.tap}")
+	finally:
+		# removed entries are ignored by dpservice, the original MAC needs to be announced first
+		if orig_neigh:
+			set_router_neigh(ll_ipv6, orig_neigh[1], orig_neigh[2])
+		else:
+			set_router_neigh(ll_ipv6, orig_mac)
+			run_command(f"ip -6 neigh del {ll_ipv6} dev {PF0.tap}")
+
+	used_mac = get_used_router_mac()
+	assert used_mac == orig_mac, \
+		f"Original router not restored ({used_mac} instead of {orig_mac})"
@@ -0,0 +1,62 @@
+# SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+# SPDX-License-Identifier: Apache-2.0
+
+import pytest
+
+from helpers import *
+
+# addresses VM4 gets when re-created
+changed_ip = f"{ov_ip_prefix}{vni1}.1.44"
+changed_ipv6 = f"{ov_ipv6_prefix}{vni1}:1::44"
+
+def get_periodic_msg_type(pkt):
+	if ARP in pkt and pkt[ARP].op == 1 and pkt[ARP].psrc == gateway_ip:
+		return "garp"
+	if ICMPv6ND_NA in pkt and pkt[ICMPv6ND_NA].tgt == gateway_ipv6:
+		return "na"
+	if ICMPv6ND_RA in pkt:
+		return "ra"
+	return None
+
+def sniff_periodic_msgs(tap):
+	# every VM gets GARP, unsolicited NA and RA once per interval
+	msgs = {}
+	def collect(pkt):
+		msgs[get_periodic_msg_type(pkt)] = pkt
+		return len(msgs) == 3
+	sniff(iface=tap, lfilter=get_periodic_msg_type, stop_filter=collect,
+		  timeout=periodic_msg_interval + sniff_timeout)
+	assert len(msgs) == 3, \
+		f"Periodic messages not received (only {list(msgs.keys())})"
+	return msgs
+
+def check_garp(msgs, target_ip):
+	garp = msgs["garp"]
+	assert garp[Ether].dst == "ff:ff:ff:ff:ff:ff" and garp[ARP].pdst == target_ip, \
+		f"Bad GARP message (dst: {garp[Ether].dst}, target: {garp[ARP].pdst} instead of {target_ip})"
+
+def test_periodic_msg_iface_change(request, prepare_ifaces, grpc_client):
+	if request.config.getoption("--hw"):
+		pytest.skip("Hardware testing is not supported for re-creating interfaces")
+
+	interface_init(VM4.tap)
+	VM4.ul_ipv6 = grpc_client.addinterface(VM4.name, VM4.pci, VM4.vni, VM4.ip, VM4.ipv6)
+
+	# the VM is not known yet, GARP asks for its address (ARP cycle)
+	msgs = sniff_periodic_msgs(VM4.tap)
+	check_garp(msgs, VM4.ip)
+	own_mac = msgs["garp"][Ether].src
+	assert msgs["ra"][Ether].src == own_mac and msgs["ra"][ICMPv6NDOptSrcLLAddr].lladdr == own_mac, \
+		"Bad router advertisement"
+
+	# once the VM answers, GARP only announces the gateway
+	sendp(Ether(dst=own_mac, src=VM4.mac) /
+		  ARP(op=2, hwsrc=VM4.mac, psrc=VM4.ip, hwdst=own_mac, pdst=gateway_ip), iface=VM4.tap)
+	check_garp(sniff_periodic_msgs(VM4.tap), gateway_ip)
+
+	# a different VM on the same port needs to be found again, under its new address
+	grpc_client.delinterface(VM4.name)
+	VM4.ul_ipv6 = grpc_client.addinterface(VM4.name, VM4.pci, VM4.vni, changed_ip, changed_ipv6)
+	check_garp(sniff_periodic_msgs(VM4.tap), changed_ip)
+
+	grpc_client.delinterface(VM4.name)
@@ -58,3 +58,26 @@ def test_pf_to_vf_lb_ipv6_tcp(prepare_ifaces, grpc_client):
 	grpc_client.dellbprefix(VM1.name, lb_ip6_pfx)
 	grpc_client.dellb(lb_name)
 	grpc_client.delfwallrule(VM1.name, "fw0-vm1")
+
+def test_pf_to_vf_config_change(prepare_ifaces, grpc_client):
+	# established incoming flows skip the underlay lookup, configuration changes must still apply to them
+	prefix = "192.168.77.0/24"
+	prefix_ul_ipv6 = grpc_client.addprefix(VM1.name, prefix)
+	grpc_client.addfwallrule(VM1.name, "fw0-vm1", proto="udp", dst_port_min=7777, dst_port_max=7777)
+
+	pkt = (Ether(dst=ipv6_multicast_mac, src=PF0.mac, type=0x86DD) /
+		   IPv6(dst=prefix_ul_ipv6, src=router_ul_ipv6, nh=4) /
+		   IP(dst="192.168.77.1", src=public_ip) /
+		   UDP(sport=7776, dport=7777))
+	for i in range(2):
+		threading.Thread(target=delayed_sendp, args=(pkt, PF0.tap)).start()
+		sniff_packet(VM1.tap, is_udp_pkt)
+
+	grpc_client.delprefix(VM1.name, prefix)
+
+	threading.Thread(target=delayed_sendp, args=(pkt, PF0.tap)).start()
+	pkt_list = sniff(count=1, lfilter=is_udp_pkt, iface=VM1.tap, timeout=sniff_short_timeout)
+	assert len(pkt_list) == 0, \
+		"Packet of an established flow still delivered after its prefix was removed"
+
+	grpc_client.delfwallrule(VM1.name, "fw0-vm1")
@@ -0,0 +1,102 @@
+# SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+# SPDX-License-Identifier: Apache-2.0
+
+import threading
+
+from helpers import *
+
+# uplink (tap) MTU is 1500, the tunnel header takes 40 bytes of it
+pmtu_ipv4_len = 1480
+pmtu_ipv6_len = 1480
+pmtu_next_hop_mtu = 1460
+
+def is_icmp_frag_needed_pkt(pkt):
+	return ICMP in pkt and pkt[ICMP].type == 3 and pkt[ICMP].code == 4
+
+def is_icmpv6_too_big_pkt(pkt):
+	return ICMPv6PacketTooBig in pkt
+
+def test_vf_to_pf_pmtu_icmp(prepare_ipv4):
+	udp_pkt = (Ether(dst=PF0.mac, src=VM1.mac) /
+			   IP(dst=public_ip, src=VM1.ip, flags="DF") /
+			   UDP(sport=4321, dport=1234) /
+			   Raw(b"\x00" * (pmtu_ipv4_len - 28)))
+	# send from a thread, the reply is sniffed right away
+	threading.Thread(target=delayed_sendp, args=(udp_pkt, VM1.tap)).start()
+
+	pkt = sniff_packet(VM1.tap, is_icmp_frag_needed_pkt)
+	assert pkt[IP].dst == VM1.ip and pkt[ICMP].nexthopmtu == pmtu_next_hop_mtu, \
+		f"Bad ICMP fragmentation needed packet (dst: {pkt[IP].dst}, mtu: {pkt[ICMP].nexthopmtu})"
+	assert IPerror in pkt and pkt[IPerror].dst == public_ip and pkt[UDPerror].dport == 1234, \
+		"ICMP error does not contain the original packet"
+	assert len(pkt[IP]) <= 576, \
+		f"ICMP error too long ({len(pkt[IP])})"
+
+def test_vf_to_pf_pmtu_icmpv6(prepare_ipv4):
+	udp_pkt = (Ether(dst=PF0.mac, src=VM1.mac) /
+			   IPv6(dst=public_ipv6, src=VM1.ipv6) /
+			   UDP(sport=4321, dport=1234) /
+			   Raw(b"\x00" * (pmtu_ipv6_len - 48)))
+	threading.Thread(target=delayed_sendp, args=(udp_pkt, VM1.tap)).start()
+
+	pkt = sniff_packet(VM1.tap, is_icmpv6_too_big_pkt)
+	assert pkt[IPv6].dst == VM1.ipv6 and pkt[ICMPv6PacketTooBig].mtu == pmtu_next_hop_mtu, \
+		f"Bad ICMPv6 packet too big (dst: {pkt[IPv6].dst}, mtu: {pkt[ICMPv6PacketTooBig].mtu})"
+	assert IPerror6 in pkt and pkt[IPerror6].dst == public_ipv6, \
+		"ICMPv6 error does not contain the original packet"
+	assert len(pkt[IPv6]) <= 1280, \
+		f"ICMPv6 error too long ({len(pkt[IPv6])})"
+
+
+def test_vf_to_vf_mss_clamp(prepare_ipv4, grpc_client):
+	grpc_client.addfwallrule(VM2.name, "fw0-vm2", proto="tcp", dst_port_min=1236, dst_port_max=1236)
+	tcp_pkt = (Ether(dst=VM2.mac, src=VM1.mac, type=0x0800) /
+			   IP(dst=VM2.ip, src=VM1.ip) /
+			   TCP(dport=1236, flags="S", options=[('MSS', 1460)]))
+	# send from a thread, the reply is sniffed right away
+	threading.Thread(target=delayed_sendp, args=(tcp_pkt, VM1.tap)).start()
+
+	# VM's MTU is lower than the uplink's, it limits the segment size
+	pkt = sniff_packet(VM2.tap, is_tcp_pkt)
+	mss = dict(pkt[TCP].options).get('MSS')
+	assert mss == dhcp_mtu - 40, \
+		f"TCP MSS not clamped ({mss})"
+
+	grpc_client.delfwallrule(VM2.name, "fw0-vm2")
+
+def test_vf_to_pf_pmtu_egress_fwall(prepare_ipv4, grpc_client):
+	# the path MTU is checked before the firewall, packets not covered by egress rules are answered as well
+	grpc_client.addfwallrule(VM1.name, "fw0-vm1-egress", proto="tcp", dst_port_min=1235, dst_port_max=1235, direction="egress")
+	udp_pkt = (Ether(dst=PF0.mac, src=VM1.mac) /
+			   IP(dst=public_ip, src=VM1.ip, flags="DF") /
+			   UDP(sport=4322, dport=1234) /
+			   Raw(b"\x00" * (pmtu_ipv4_len - 28)))
+	threading.Thread(target=delayed_sendp, args=(udp_pkt, VM1.tap)).start()
+
+	pkt = sniff_packet(VM1.tap, is_icmp_frag_needed_pkt)
+	assert pkt[IP].dst == VM1.ip and pkt[UDPerror].sport == 4322, \
+		"ICMP error not sent for a packet outside of egress firewall rules"
+
+	grpc_client.delfwallrule(VM1.name, "fw0-vm1-egress")
+
+def send_lb_relay_pkt(lb_ul_ipv6):
+	# full uplink-sized packet, must not be fragmented
+	pkt = (Ether(dst=ipv6_multicast_mac, src=PF0.mac, type=0x86DD) /
+		   IPv6(dst=lb_ul_ipv6, src=local_ul_ipv6, nh=4) /
+		   IP(dst=lb_ip, src=public_ip, flags="DF") /
+		   TCP(sport=8990, dport=80) /
+		   Raw(b"\x00" * (pmtu_ipv4_len - 40)))
+	delayed_sendp(pkt, PF0.tap)
+
+def test_external_lb_relay_pmtu(prepare_ipv4, grpc_client):
+	# relayed packets are not checked, re-encapsulation keeps them at the size they were received with
+	lb_ul_ipv6 = grpc_client.createlb(lb_name, vni1, lb_ip, "tcp/80")
+	grpc_client.addlbtarget(lb_name, neigh_ul_ipv6)
+
+	threading.Thread(target=send_lb_relay_pkt, args=(lb_ul_ipv6,)).start()
+	pkt = sniff_packet(PF0.tap, is_tcp_pkt, skip=1)
+	assert pkt[IPv6].dst == neigh_ul_ipv6 and len(pkt[IPv6]) == pmtu_ipv4_len + 40, \
+		f"Full-sized packet not relayed as is (outer dst ipv6: {pkt[IPv6].dst}, length: {len(pkt[IPv6])})"
+
+	grpc_client.dellbtarget(lb_name, neigh_ul_ipv6)
+	grpc_client.dellb(lb_name)
@@ -1,27 +1,10 @@
 # SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
 # SPDX-License-Identifier: Apache-2.0
 
-import json
 import pytest
 from helpers import *
 
 
-BUFSIZE = 10240
-
-def get_telemetry(output, client, node):
-	client.send(f"{node},0\n".encode())
-	output[node] = json.loads(client.recv(BURSTSIZE).decode())[node]
-	json.dumps(output[node])
-
-def get_telemetry(request):
-	with socket.socket(socket.AF_UNIX, socket.SOCK_SEQPACKET) as client:
-		client.connect("/var/run/dpdk/rte/dpdk_telemetry.v2")
-		client.recv(BUFSIZE)
-		client.send(f"{request},0\n".encode())
-		response = json.loads(client.recv(BUFSIZE).decode())[request]
-		client.close()
-	return response
-
 def check_tel_graph(key):
 	expected_tel_rx_node_count = 6
 	tel = get_telemetry(f"/dp_service/graph/{key}")
@@ -49,6 +32,150 @@ def test_telemetry_nat(prepare_ifaces):
 	assert VM1.name in tel and VM2.name in tel and VM3.name in tel, \
 		"Running VMs not present in NAT telemetry"
 
+def test_telemetry_conntrack(prepare_ifaces):
+	for key in ("flow_count", "limit_drop_count"):
+		tel = get_telemetry(f"/dp_service/conntrack/{key}")
+		assert tel is not None, \
+			f"Missing conntrack {key} telemetry"
+		assert VM1.name in tel and VM2.name in tel and VM3.name in tel, \
+			f"Running VMs not present in conntrack {key} telemetry"
+
+def test_telemetry_tables(prepare_ifaces):
+	tel = get_telemetry("/dp_service/table/occupancy")
+	assert tel is not None, \
+		"Missing table telemetry"
+	for table in ("ipv4_flow_table", "flow_values", "ipv4_snat_table", "ipv4_lb_table", "vnf_handle_table", "vni_handle_table"):
+		assert table in tel, \
+			f"Missing {table} in table telemetry"
+		assert tel[table]["used"] <= tel[table]["capacity"], \
+			f"Invalid {table} occupancy"
+
+def test_telemetry_tx(prepare_ifaces):
+	tel = get_telemetry("/dp_service/tx/stats")
+	assert tel is not None, \
+		"Missing Tx telemetry"
+	for port in (VM1.name, VM2.name, VM3.name):
+		assert port in tel, \
+			f"Port {port} not present in Tx telemetry"
+		for key in ("flush", "retry", "drop"):
+			assert key in tel[port], \
+				f"Missing {key} count for port {port} in Tx telemetry"
+
+def test_telemetry_mtu(prepare_ifaces):
+	tel = get_telemetry("/dp_service/mtu/stats")
+	assert tel is not None, \
+		"Missing MTU telemetry"
+	for port in (VM1.name, VM2.name, VM3.name):
+		assert port in tel, \
+			f"Port {port} not present in MTU telemetry"
+		for key in ("icmp_sent", "icmp_limited", "mss_clamped", "gro_merged", "gso_segments"):
+			assert key in tel[port], \
+				f"Missing {key} count for port {port} in MTU telemetry"
+
+def test_telemetry_traffic(prepare_ifaces):
+	count = 5
+	# unknown ethertype gets dropped right after reception
+	pkt = Ether(dst=PF0.mac, src=VM1.mac, type=0x88B5) / Raw(b"\x00" * 50)
+	iface_before = get_telemetry("/dp_service/iface/stats")[VM1.name]
+	vni_before = get_telemetry("/dp_service/vni/stats")[str(VM1.vni)]
+	sendp([pkt] * count, iface=VM1.tap)
+	time.sleep(0.5)
+	iface_after = get_telemetry("/dp_service/iface/stats")[VM1.name]
+	vni_after = get_telemetry("/dp_service/vni/stats")[str(VM1.vni)]
+	for stats in ((iface_before, iface_after), (vni_before, vni_after)):
+		before, after = stats
+		assert after["rx_packets"] - before["rx_packets"] == count, \
+			"Invalid received packet count"
+		assert after["rx_bytes"] - before["rx_bytes"] == count * len(pkt), \
+			"Invalid received byte count"
+		assert after["drop_packets"] - before["drop_packets"] == count, \
+			"Invalid dropped packet count"
+		assert after["drop_bytes"] - before["drop_bytes"] == count * len(pkt), \
+			"Invalid dropped byte count"
+
+def test_telemetry_traffic_inbound(prepare_ifaces):
+	count = 5
+	# routed back to the underlay (PF-to-PF is not allowed), the drop belongs to the VM even though the packet came from a PF
+	pkt = (Ether(dst=ipv6_multicast_mac, src=PF0.mac, type=0x86DD) /
+		   IPv6(dst=VM1.ul_ipv6, src=router_ul_ipv6, nh=4) /
+		   IP(dst=public_ip, src=public_ip) /
+		   UDP(sport=7790, dport=7791))
+	# dropped after decapsulation
+	dropped_len = len(pkt) - len(pkt[IPv6]) + len(pkt[IP])
+	iface_before = get_telemetry("/dp_service/iface/stats")[VM1.name]
+	vni_before = get_telemetry("/dp_service/vni/stats")[str(VM1.vni)]
+	sendp([pkt] * count, iface=PF0.tap)
+	time.sleep(0.5)
+	iface_after = get_telemetry("/dp_service/iface/stats")[VM1.name]
+	vni_after = get_telemetry("/dp_service/vni/stats")[str(VM1.vni)]
+	for stats in ((iface_before, iface_after), (vni_before, vni_after)):
+		before, after = stats
+		assert after["drop_packets"] - before["drop_packets"] == count, \
+			"Inbound drops not accounted to the target interface"
+		assert after["drop_bytes"] - before["drop_bytes"] == count * dropped_len, \
+			"Invalid dropped byte count"
+
+def test_telemetry_drops(prepare_ifaces):
+	count = 3
+	pkt = Ether(dst=PF0.mac, src=VM1.mac, type=0x88B5) / Raw(b"\x00" * 50)
+	before = get_telemetry("/dp_service/drop/stats")
+	sendp([pkt] * count, iface=VM1.tap)
+	time.sleep(0.5)
+	after = get_telemetry("/dp_service/drop/stats")
+	for name in (VM1.name, "total"):
+		assert after[name].get("unsupported_protocol", 0) - before[name].get("unsupported_protocol", 0) == count, \
+			f"Invalid drop reason count for {name}"
+
+def test_telemetry_latency(prepare_ifaces):
+	tel = get_telemetry("/dp_service/latency/graph")
+	assert tel is not None and "graph_walk" in tel, \
+		"Missing graph walk latency telemetry"
+	walk = tel["graph_walk"]
+	assert walk["count"] > 0, \
+		"No graph walks sampled"
+	assert walk["p50"] <= walk["p90"] <= walk["p99"] <= walk["p999"] <= walk["max"], \
+		"Invalid graph walk latency percentiles"
+	tel = get_telemetry("/dp_service/latency/handlers")
+	assert tel is not None and "grpc_request" in tel, \
+		"Missing handler latency telemetry"
+	# interfaces have been set up via gRPC already
+	assert tel["grpc_request"]["count"] > 0, \
+		"No gRPC requests measured"
+
+def test_telemetry_worker(prepare_ifaces):
+	tel = get_telemetry("/dp_service/worker/stats")
+	assert tel is not None and len(tel) == 1, \
+		"Missing worker telemetry"
+	worker = next(iter(tel.values()))
+	assert worker["busy_cycles"] > 0 and worker["idle_cycles"] > 0, \
+		"Worker cycles not measured"
+	assert worker["busy_permille"] <= 1000, \
+		"Invalid worker busy ratio"
+
+def test_telemetry_numa(prepare_ifaces):
+	tel = get_telemetry("/dp_service/numa/placement")
+	assert tel is not None and "worker_socket" in tel, \
+		"Missing NUMA placement telemetry"
+	assert len(tel["ports"]) > 0, \
+		"Missing ports in NUMA placement telemetry"
+	objects = tel["objects"]
+	for name in (f"mbuf_pool_{tel['worker_socket']}", "grpc_tx_queue", "periodic_msg_queue"):
+		assert name in objects, \
+			f"Missing {name} in NUMA placement telemetry"
+	assert any(name.startswith("ipv4_flow_table_") for name in objects), \
+		"Missing flow table in NUMA placement telemetry"
+	for name, socket_id in objects.items():
+		assert socket_id == tel["worker_socket"], \
+			f"{name} is not on the worker's NUMA node"
+
+def test_telemetry_ipfrag(prepare_ifaces):
+	tel = get_telemetry("/dp_service/ipfrag/stats")
+	assert tel is not None, \
+		"Missing IP fragmentation telemetry"
+	for key in ("reassembled", "dropped_fragments", "fragmented", "fragments", "failed"):
+		assert key in tel, \
+			f"Missing {key} in IP fragmentation telemetry"
+
 def test_telemetry_virtsvc(request, prepare_ifaces):
 	if not request.config.getoption("--virtsvc"):
 		pytest.skip("Virtual services not enabled")
@@ -0,0 +1,123 @@
+# SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+# SPDX-License-Identifier: Apache-2.0
+
+import pytest
+import time
+
+from config import *
+from helpers import *
+
+limits_udp_port = 7788
+limits_tcp_port = 7789
+
+# Every test uses a different VM, so the limits do not interfere;
+# the rate limit is the lowest, so other tests need to send flows slowly enough
+
+
+def is_limits_udp_pkt(pkt):
+	return is_ipip_pkt(pkt) and UDP in pkt and pkt[UDP].dport == limits_udp_port
+
+def is_limits_tcp_pkt(pkt):
+	return TCP in pkt and pkt[TCP].dport == limits_tcp_port
+
+def send_and_count(pkts, send_iface, sniff_iface, lfilter):
+	sniffer = AsyncSniffer(iface=sniff_iface, lfilter=lfilter)
+	sniffer.start()
+	time.sleep(0.1)
+	sendp(pkts, iface=send_iface)
+	time.sleep(sniff_short_timeout)
+	return len(sniffer.stop())
+
+def send_outgoing_flows(vm, sports):
+	return send_and_count([ Ether(dst=PF0.mac, src=vm.mac, type=0x0800) /
+							IP(dst=public_ip, src=vm.ip) /
+							UDP(sport=sport, dport=limits_udp_port)
+							for sport in sports ],
+						  vm.tap, PF0.tap, is_limits_udp_pkt)
+
+def get_counters(vm):
+	return (get_telemetry("/dp_service/conntrack/flow_count")[vm.name],
+			get_telemetry("/dp_service/conntrack/limit_drop_count")[vm.name])
+
+def check_counters(vm, base, flows, drops):
+	flow_count, drop_count = get_counters(vm)
+	assert flow_count == base[0] + flows, \
+		f"Invalid flow count of {vm.name} ({flow_count} instead of {base[0] + flows})"
+	assert drop_count == base[1] + drops, \
+		f"Invalid limit drop count of {vm.name} ({drop_count} instead of {base[1] + drops})"
+
+
+def test_flow_limit(prepare_ipv4, flow_limit_policy):
+	if not flow_limit_policy:
+		pytest.skip("Flow limits need to be set")
+
+	base = get_counters(VM1)
+	sent = flow_limit + 4
+	allowed = flow_limit - base[0]
+	assert allowed > 0, \
+		"Flow limit already reached before the test"
+
+	# stay under the rate limit
+	forwarded = 0
+	for start in range(0, sent, flow_rate_limit // 2):
+		forwarded += send_outgoing_flows(VM1, range(4000 + start, 4000 + min(start + flow_rate_limit // 2, sent)))
+		time.sleep(1.1)
+
+	if flow_limit_policy == "drop":
+		assert forwarded == allowed, \
+			f"Flows over the limit not dropped ({forwarded} forwarded instead of {allowed})"
+		check_counters(VM1, base, allowed, sent - allowed)
+	else:
+		assert forwarded == sent, \
+			f"Flows over the limit dropped when only monitoring ({forwarded} forwarded instead of {sent})"
+		check_counters(VM1, base, sent, sent - allowed)
+
+
+def test_flow_rate_limit(prepare_ipv4, flow_limit_policy):
+	if not flow_limit_policy:
+		pytest.skip("Flow limits need to be set")
+
+	base = get_counters(VM2)
+	sent = flow_rate_limit + 4
+	assert base[0] + sent <= flow_limit, \
+		"Flow limit would be reached during the test"
+
+	# one burst is way faster than the one-second rate window
+	forwarded = send_outgoing_flows(VM2, range(5000, 5000 + sent))
+
+	if flow_limit_policy == "drop":
+		assert forwarded == flow_rate_limit, \
+			f"Flows over the rate limit not dropped ({forwarded} forwarded instead of {flow_rate_limit})"
+		check_counters(VM2, base, flow_rate_limit, sent - flow_rate_limit)
+	else:
+		assert forwarded == sent, \
+			f"Flows over the rate limit dropped when only monitoring ({forwarded} forwarded instead of {sent})"
+		check_counters(VM2, base, sent, sent - flow_rate_limit)
+
+
+def test_syn_limit(prepare_ipv4, grpc_client, flow_limit_policy):
+	if not flow_limit_policy:
+		pytest.skip("Flow limits need to be set")
+
+	grpc_client.addfwallrule(VM3.name, "fw-limits", proto="tcp", dst_port_min=limits_tcp_port, dst_port_max=limits_tcp_port)
+	base = get_counters(VM3)
+
+	# handshakes are never finished, one connection attempt over the limit and one not starting with SYN
+	syns = syn_limit + 1
+	pkts = [ Ether(dst=ipv6_multicast_mac, src=PF0.mac, type=0x86DD) /
+			 IPv6(dst=VM3.ul_ipv6, src=router_ul_ipv6, nh=4) /
+			 IP(dst=VM3.ip, src=public_ip) /
+			 TCP(sport=6000 + i, dport=limits_tcp_port, flags="S" if i < syns else "A")
+			 for i in range(syns + 1) ]
+	forwarded = send_and_count(pkts, PF0.tap, VM3.tap, is_limits_tcp_pkt)
+
+	grpc_client.delfwallrule(VM3.name, "fw-limits")
+
+	if flow_limit_policy == "drop":
+		assert forwarded == syn_limit, \
+			f"Connection attempts over the limit not dropped ({forwarded} forwarded instead of {syn_limit})"
+		check_counters(VM3, base, syn_limit, 2)
+	else:
+		assert forwarded == len(pkts), \
+			f"Connection attempts over the limit dropped when only monitoring ({forwarded} forwarded instead of {len(pkts)})"
+		check_counters(VM3, base, len(pkts), 2)
@@ -0,0 +1,82 @@
+# SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+# SPDX-License-Identifier: Apache-2.0
+
+import pytest
+import time
+
+from config import *
+from helpers import *
+
+# every flow takes two table entries, the first batch goes over the growth threshold (75%),
+# but still fits into the initial table
+first_batch = range(2000, 2028)
+second_batch = range(3000, 3012)
+flow_dport = 7777
+
+# table size is only updated when switching tables, but the usage only during flow aging
+table_timeout = 15
+
+
+def is_flow_table_pkt(pkt):
+	return is_ipip_pkt(pkt) and UDP in pkt and pkt[UDP].dport == flow_dport
+
+def send_flows(sports):
+	sniffer = AsyncSniffer(iface=PF0.tap, lfilter=is_flow_table_pkt)
+	sniffer.start()
+	time.sleep(0.1)
+	sendp([ Ether(dst=PF0.mac, src=VM1.mac, type=0x0800) /
+			IP(dst=public_ip, src=VM1.ip) /
+			UDP(sport=sport, dport=flow_dport)
+			for sport in sports ], iface=VM1.tap)
+	time.sleep(sniff_short_timeout)
+	pkts = sniffer.stop()
+	assert len(pkts) == len(sports), \
+		f"Only {len(pkts)} out of {len(sports)} packets forwarded"
+
+def get_flow_table():
+	return get_telemetry("/dp_service/table/occupancy")["ipv4_flow_table"]
+
+def get_flow_count():
+	return get_telemetry("/dp_service/conntrack/flow_count")[VM1.name]
+
+def wait_for_flow_table(condition, message):
+	end = time.monotonic() + table_timeout
+	while True:
+		table = get_flow_table()
+		if condition(table):
+			return table
+		assert time.monotonic() < end, message
+		time.sleep(1)
+
+
+def test_flow_table_growth(prepare_ipv4, small_flow_table):
+	if not small_flow_table:
+		pytest.skip("Small flow table needs to be used")
+
+	table = get_flow_table()
+	assert table["capacity"] == flow_table_size, \
+		f"Flow table does not start at the configured size ({table['capacity']} instead of {flow_table_size})"
+	base_used = table["used"]
+	base_flows = get_flow_count()
+
+	send_flows(first_batch)
+	wait_for_flow_table(lambda table: table["capacity"] > flow_table_size,
+						"Flow table did not grow over the threshold")
+
+	# new flows also migrate old ones to the bigger table
+	send_flows(second_batch)
+	expected_used = base_used + 2 * (len(first_batch) + len(second_batch))
+	table = wait_for_flow_table(lambda table: table["used"] == expected_used,
+								f"Flows lost during flow table migration (expected {expected_used} entries)")
+	assert table["migration_failed"] == 0, \
+		"Flows failed to migrate to the bigger table"
+	assert table["capacity"] <= flow_table_max_size, \
+		"Flow table grew over its maximum size"
+
+	# migrated flows need to be found, not created again
+	send_flows(first_batch)
+	assert get_flow_count() == base_flows + len(first_batch) + len(second_batch), \
+		"Migrated flows not found in the bigger flow table"
+	time.sleep(table_timeout / 3)
+	assert get_flow_table()["used"] == expected_used, \
+		"Migrated flows created again"
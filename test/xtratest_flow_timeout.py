@@ -2,6 +2,8 @@
 # SPDX-License-Identifier: Apache-2.0
 
 import pytest
+import socket
+import struct
 
 from config import *
 from helpers import *
@@ -44,6 +46,63 @@ def test_cntrack_nat_timeout_tcp(request, prepare_ipv4, grpc_client, fast_flow_t
 
 	grpc_client.delnat(VM1.name)
 
+# Layout of dpservice's IPv4 IPFIX template (256)
+IPFIX_IPV4_TEMPLATE_ID = 256
+IPFIX_IPV4_RECORD = struct.Struct("!4s4sHHB4s4sHHQIQQQQQQB")
+
+def receive_ipfix_records(collector, timeout=5):
+	records = []
+	collector.settimeout(timeout)
+	try:
+		while True:
+			msg = collector.recv(65535)
+			version, length = struct.unpack_from("!HH", msg, 0)
+			assert version == 10 and length == len(msg), \
+				"Invalid IPFIX message header"
+			offset = 16
+			while offset < length:
+				set_id, set_len = struct.unpack_from("!HH", msg, offset)
+				if set_id == IPFIX_IPV4_TEMPLATE_ID:
+					for pos in range(offset + 4, offset + set_len - IPFIX_IPV4_RECORD.size + 1, IPFIX_IPV4_RECORD.size):
+						records.append(IPFIX_IPV4_RECORD.unpack_from(msg, pos))
+				offset += set_len
+			collector.settimeout(1)
+	except socket.timeout:
+		pass
+	return records
+
+def test_ipfix_export_tcp(prepare_ipv4, grpc_client, fast_flow_timeout):
+	if not fast_flow_timeout:
+		pytest.skip("Fast flow timeout needs to be enabled")
+
+	with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as collector:
+		collector.bind(("127.0.0.1", ipfix_port))
+
+		nat_ul_ipv6 = grpc_client.addnat(VM1.name, nat_vip, nat_local_min_port, nat_local_min_port+1)
+		tester = TCPTesterPublic(VM1, 12346, nat_ul_ipv6, PF0, public_ip, 443, server_pkt_check=tcp_server_nat_pkt_check)
+		tester.communicate()
+		age_out_flows()
+		grpc_client.delnat(VM1.name)
+
+		records = [r for r in receive_ipfix_records(collector)
+				   if socket.inet_ntoa(r[0]) == VM1.ip and socket.inet_ntoa(r[1]) == public_ip and r[2] == 12346 and r[3] == 443]
+
+	assert len(records) == 1, \
+		"TCP flow not exported via IPFIX"
+	record = records[0]
+	assert record[4] == 6, \
+		"Invalid protocol in IPFIX record"
+	assert socket.inet_ntoa(record[5]) == nat_vip and record[7] == nat_local_min_port, \
+		"NAT translation missing in IPFIX record"
+	assert record[9] == vni1, \
+		"Invalid VNI in IPFIX record"
+	assert record[11] > 0 and record[13] > 0, \
+		"Packet counts missing in IPFIX record"
+	assert record[16] >= record[15], \
+		"Invalid flow times in IPFIX record"
+	assert record[17] == 3, \
+		"TCP flow end not detected in IPFIX record"
+
 def tcp_server_virtsvc_pkt_check(pkt):
 	assert pkt[IPv6].dst == virtsvc_tcp_svc_ipv6, \
 		"Request to wrong service IPv6 address"
@@ -0,0 +1,63 @@
+# SPDX-FileCopyrightText: 2023 SAP SE or an SAP affiliate company and IronCore contributors
+# SPDX-License-Identifier: Apache-2.0
+
+import json
+import pytest
+import statistics
+import time
+
+from config import *
+from helpers import *
+
+BUFSIZE = 10240
+
+def get_worker_stats():
+	with socket.socket(socket.AF_UNIX, socket.SOCK_SEQPACKET) as client:
+		client.connect("/var/run/dpdk/rte/dpdk_telemetry.v2")
+		client.recv(BUFSIZE)
+		client.send(b"/dp_service/worker/stats,0\n")
+		response = json.loads(client.recv(BUFSIZE).decode())["/dp_service/worker/stats"]
+	assert len(response) == 1, \
+		"Expected exactly one worker in telemetry"
+	return next(iter(response.values()))
+
+def arp_round_trip():
+	arp_packet = (Ether(dst="ff:ff:ff:ff:ff:ff") /
+				  ARP(pdst=gateway_ip, hwdst=VM1.mac, psrc="0.0.0.0"))
+	answer, unanswered = srp(arp_packet, iface=VM1.tap, type=ETH_P_ARP, timeout=sniff_timeout, verbose=0)
+	assert len(answer) == 1, \
+		"No ARP response"
+	sent, received = answer[0]
+	return received.time - sent.sent_time
+
+
+def test_idle_poll_backoff(request, prepare_ifaces, adaptive_polling):
+	if not adaptive_polling:
+		pytest.skip("Adaptive polling needs to be enabled")
+
+	before = get_worker_stats()
+	time.sleep(1)
+	after = get_worker_stats()
+
+	assert after['mode'] == "adaptive", \
+		"Worker is not in adaptive polling mode"
+	assert after['sleeps'] > before['sleeps'] or after['monitor_waits'] > before['monitor_waits'], \
+		"Idle worker did not back off"
+	busy = after['busy_cycles'] - before['busy_cycles']
+	idle = after['idle_cycles'] - before['idle_cycles']
+	assert busy < idle, \
+		f"Worker without traffic reported as busy ({busy} busy cycles, {idle} idle cycles)"
+
+def test_idle_poll_wakeup_latency(request, prepare_ifaces, adaptive_polling):
+	if not adaptive_polling:
+		pytest.skip("Adaptive polling needs to be enabled")
+
+	latencies = []
+	for i in range(10):
+		# let the worker reach the longest wait
+		time.sleep(0.2)
+		latencies.append(arp_round_trip())
+
+	latency = statistics.median(latencies)
+	assert latency < idle_wakeup_max_latency, \
+		f"Wake-up latency too high ({latency*1000:.3f}ms, all samples: {[ round(l*1000, 3) for l in latencies ]})"
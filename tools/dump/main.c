@@ -7,6 +7,7 @@
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <rte_eal.h>
 #include <rte_alarm.h>
@@ -55,6 +56,7 @@ static struct dp_pcap dp_pcap;
 static bool showing_nodes = false;
 static char node_filter[DP_GRAPHTRACE_NODE_REGEX_MAXLEN] = "";
 static char packet_filter[DP_GRAPHTRACE_FILTER_MAXLEN] = "";
+static uint64_t drop_reasons = 0;
 
 static bool interrupt = false;
 static bool primary_alive = false;
@@ -108,12 +110,14 @@ static void print_packet(__rte_unused struct dp_pcap *context, struct rte_mbuf *
 	char printbuf[512];
 	char node_buf[16];
 	char next_node_buf[16];
+	char reason_buf[32];
 	const char *node;
 	const char *next_node;
 	const char *arrow;
 
 	dp_graphtrace_sprint(pkt, printbuf, sizeof(printbuf));
 
+	*reason_buf = 0;
 	arrow = "->";
 	if (pktinfo->node) {
 		node = pktinfo->node->name;
@@ -128,6 +132,7 @@ static void print_packet(__rte_unused struct dp_pcap *context, struct rte_mbuf *
 		arrow = ">>";
 		if (pktinfo->dst_port_id == (uint16_t)-1) {
 			next_node = "DROP";
+			snprintf(reason_buf, sizeof(reason_buf), "[%s] ", dp_get_drop_reason_name(pktinfo->drop_reason));
 		} else {
 			snprintf(next_node_buf, sizeof(next_node_buf), "PORT %u", pktinfo->dst_port_id);
 			next_node = next_node_buf;
@@ -135,9 +140,9 @@ static void print_packet(__rte_unused struct dp_pcap *context, struct rte_mbuf *
 	}
 
 	tm = gmtime(&timestamp->tv_sec);
-	printf("%02d:%02d:%02d.%03d %u: " NODENAME_FMT " %s " NODENAME_FMT ": %s\n",
+	printf("%02d:%02d:%02d.%03d %u: " NODENAME_FMT " %s " NODENAME_FMT ": %s%s\n",
 		   tm->tm_hour, tm->tm_min, tm->tm_sec, (int)(timestamp->tv_usec/1000),
-		   pktinfo->pktid, node, arrow, next_node, printbuf);
+		   pktinfo->pktid, node, arrow, next_node, reason_buf, printbuf);
 
 	fflush(stdout);
 }
@@ -208,8 +213,11 @@ static int dp_graphtrace_start(struct dp_graphtrace *graphtrace)
 	struct dp_graphtrace_mp_reply reply;
 	struct dp_graphtrace_mp_request request = {
 		.action = DP_GRAPHTRACE_ACTION_START,
-		.params.start.drops = dp_conf_is_showing_drops(),
+		.params.start.drops = dp_conf_is_showing_drops() || drop_reasons,
 		.params.start.nodes = showing_nodes,
+		// no specific reason requested means all of them
+		.params.start.drop_reasons = drop_reasons ? drop_reasons : UINT64_MAX,
+		.params.start.drop_sample = (uint32_t)dp_conf_get_drop_sample(),
 	};
 	struct dp_graphtrace_params *filters = (struct dp_graphtrace_params *)graphtrace->filters->addr;
 
@@ -357,6 +365,22 @@ static int dp_argparse_opt_pcap(const char *arg)
 	return DP_OK;
 }
 
+static int dp_argparse_opt_drop_reason(const char *arg)
+{
+	for (unsigned int i = 0; i < DP_DROP_REASON_COUNT; ++i) {
+		if (!strcmp(arg, dp_get_drop_reason_name(i))) {
+			drop_reasons |= DP_DROP_REASON_MASK(i);
+			return DP_OK;
+		}
+	}
+
+	fprintf(stderr, "Invalid drop reason '%s', valid reasons are:", arg);
+	for (unsigned int i = 0; i < DP_DROP_REASON_COUNT; ++i)
+		fprintf(stderr, " %s", dp_get_drop_reason_name(i));
+	fprintf(stderr, "\n");
+	return DP_ERROR;
+}
+
 static int dp_argparse_opt_nodes(const char *arg)
 {
 	regex_t validation_re;
@@ -19,6 +19,8 @@ enum {
 	OPT_VERSION = 'v',
 _OPT_SHOPT_MAX = 255,
 	OPT_DROPS,
+	OPT_DROP_REASON,
+	OPT_DROP_SAMPLE,
 	OPT_NODES,
 	OPT_FILTER,
 	OPT_PCAP,
@@ -31,6 +33,8 @@ static const struct option dp_conf_longopts[] = {
 	{ "help", 0, 0, OPT_HELP },
 	{ "version", 0, 0, OPT_VERSION },
 	{ "drops", 0, 0, OPT_DROPS },
+	{ "drop-reason", 1, 0, OPT_DROP_REASON },
+	{ "drop-sample", 1, 0, OPT_DROP_SAMPLE },
 	{ "nodes", 1, 0, OPT_NODES },
 	{ "filter", 1, 0, OPT_FILTER },
 	{ "pcap", 1, 0, OPT_PCAP },
@@ -39,6 +43,7 @@ static const struct option dp_conf_longopts[] = {
 };
 
 static bool showing_drops = false;
+static int drop_sample = 1;
 static bool stop_mode = false;
 
 bool dp_conf_is_showing_drops(void)
@@ -46,6 +51,11 @@ bool dp_conf_is_showing_drops(void)
 	return showing_drops;
 }
 
+int dp_conf_get_drop_sample(void)
+{
+	return drop_sample;
+}
+
 bool dp_conf_is_stop_mode(void)
 {
 	return stop_mode;
@@ -55,6 +65,7 @@ bool dp_conf_is_stop_mode(void)
 
 /* These functions need to be implemented by the user of this generated code */
 static void dp_argparse_version(void);
+static int dp_argparse_opt_drop_reason(const char *arg);
 static int dp_argparse_opt_nodes(const char *arg);
 static int dp_argparse_opt_filter(const char *arg);
 static int dp_argparse_opt_pcap(const char *arg);
@@ -63,13 +74,15 @@ static int dp_argparse_opt_pcap(const char *arg);
 static inline void dp_argparse_help(const char *progname, FILE *outfile)
 {
 	fprintf(outfile, "Usage: %s [options]\n"
-		" -h, --help           display this help and exit\n"
-		" -v, --version        display version and exit\n"
-		"     --drops          show dropped packets\n"
-		"     --nodes=REGEX    show graph node traversal, limit to REGEX-matched nodes (empty string for all)\n"
-		"     --filter=FILTER  show only packets matching a pcap-style FILTER\n"
-		"     --pcap=FILE      write packets into a PCAP file\n"
-		"     --stop           do nothing, only make sure tracing is disabled in dp-service\n"
+		" -h, --help                display this help and exit\n"
+		" -v, --version             display version and exit\n"
+		"     --drops               show dropped packets\n"
+		"     --drop-reason=REASON  show only packets dropped for this reason (can be used multiple times, implies --drops)\n"
+		"     --drop-sample=N       show only every N-th dropped packet\n"
+		"     --nodes=REGEX         show graph node traversal, limit to REGEX-matched nodes (empty string for all)\n"
+		"     --filter=FILTER       show only packets matching a pcap-style FILTER\n"
+		"     --pcap=FILE           write packets into a PCAP file\n"
+		"     --stop                do nothing, only make sure tracing is disabled in dp-service\n"
 	, progname);
 }
 
@@ -79,6 +92,10 @@ static int dp_conf_parse_arg(int opt, const char *arg)
 	switch (opt) {
 	case OPT_DROPS:
 		return dp_argparse_store_true(&showing_drops);
+	case OPT_DROP_REASON:
+		return dp_argparse_opt_drop_reason(arg);
+	case OPT_DROP_SAMPLE:
+		return dp_argparse_int(arg, &drop_sample, 1, 1000000);
 	case OPT_NODES:
 		return dp_argparse_opt_nodes(arg);
 	case OPT_FILTER:
@@ -9,6 +9,7 @@
 /***********************************************************************/
 
 bool dp_conf_is_showing_drops(void);
+int dp_conf_get_drop_sample(void);
 bool dp_conf_is_stop_mode(void);
 
 enum dp_conf_runmode {